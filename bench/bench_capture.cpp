@@ -0,0 +1,40 @@
+// Sniffer path: RX callback into the packet ring, drained into a pcap file
+#include <LittleFS.h>
+#include <benchmark/benchmark.h>
+#include <modules/wifi/packet_ring.h>
+#include <modules/wifi/pcap_writer.h>
+#include <native_root.h>
+#include <string.h>
+
+static void BM_PacketRing_ReserveCommitPeek(benchmark::State &state) {
+    PacketRing ring;
+    ring.begin(64 * 1024);
+    size_t len = state.range(0), got;
+    for (auto _ : state) {
+        uint8_t *p = ring.reserve(len);
+        memset(p, 0xA5, len);
+        ring.commit();
+        benchmark::DoNotOptimize(ring.peek(got));
+        ring.release();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+}
+BENCHMARK(BM_PacketRing_ReserveCommitPeek)->Arg(64)->Arg(1500);
+
+static void BM_PcapWriter_WritePacket(benchmark::State &state) {
+    useTempNativeRoot();
+    PcapWriter writer(state.range(1), 1000);
+    writer.open(LittleFS, "/capture.pcap", PcapFormat::Pcap, false, PcapWriter::LINKTYPE_IEEE802_11_RADIOTAP);
+    uint8_t frame[256];
+    memset(frame, 0x5A, sizeof(frame));
+    PcapRadioInfo radio;
+    radio.rssi = -60;
+    radio.channel = 6;
+    size_t len = state.range(0);
+    uint32_t n = 0;
+    for (auto _ : state) writer.writePacket(frame, len, n / 1000, n++ % 1000 * 1000, &radio);
+    writer.close();
+    state.SetBytesProcessed(int64_t(state.iterations()) * len);
+    state.counters["file_writes"] = writer.fileWrites();
+}
+BENCHMARK(BM_PcapWriter_WritePacket)->Args({128, 512})->Args({128, 4096})->Args({256, 4096});
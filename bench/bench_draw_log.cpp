@@ -0,0 +1,108 @@
+// WebUI screen mirror: draw log pushes, and the bytes a viewer gets per frame as snapshot or delta
+#include <benchmark/benchmark.h>
+#include <core/tftLogger/draw_log.h>
+#include <stdio.h>
+#include <string.h>
+
+// Sizes of the PSRAM boards (MAX_LOG_ENTRIES, MAX_LOG_SIZE in tftLogger.h)
+static const size_t ENTRIES = 64;
+static const size_t ENTRY_SIZE = 128;
+static const size_t FRAME_HEADER = 9; // type, fromSeq, toSeq
+
+// Packets laid out like tft_logger's: 0xAA, size, function, big endian 16 bit arguments, text
+static size_t packet(uint8_t *p, uint8_t fn, const uint16_t *args, size_t nargs, const char *text = "") {
+    size_t n = 0;
+    p[n++] = 0xAA;
+    p[n++] = 0;
+    p[n++] = fn;
+    for (size_t i = 0; i < nargs; i++) {
+        p[n++] = args[i] >> 8;
+        p[n++] = args[i] & 0xFF;
+    }
+    memcpy(p + n, text, strlen(text));
+    n += strlen(text);
+    p[1] = n;
+    return n;
+}
+
+static void fillRect(uint8_t *p, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    uint16_t args[] = {x, y, w, h, color};
+    packet(p, 2, args, 5);
+}
+
+static void drawString(uint8_t *p, uint16_t x, uint16_t y, uint16_t fg, const char *text) {
+    uint16_t args[] = {x, y, 1, fg, 0};
+    packet(p, 16, args, 5, text);
+}
+
+// A menu of 40 items redrawn every frame, one frame in four scrolls it: mostly duplicates
+static void BM_DrawLog_PushRedraw(benchmark::State &state) {
+    DrawLog log;
+    log.begin(ENTRIES, ENTRY_SIZE);
+    uint8_t p[ENTRY_SIZE];
+    char text[32];
+    uint32_t frame = 0;
+    for (auto _ : state) {
+        uint32_t shift = frame % 4 == 0 ? frame : 0;
+        for (int i = 0; i < 40; i++) {
+            snprintf(text, sizeof(text), "Option %u", (unsigned)(i + shift));
+            drawString(p, 10, 10 + i * 10, 0xFFFF, text);
+            benchmark::DoNotOptimize(log.push(p));
+        }
+        frame++;
+    }
+    state.SetItemsProcessed(state.iterations() * 40);
+    state.counters["duplicates"] = log.duplicates();
+    state.counters["compactions"] = log.compactions();
+}
+BENCHMARK(BM_DrawLog_PushRedraw);
+
+// The selection moving down a 12 item menu: both rows painted over and redrawn. Counters give the
+// bytes a viewer receives per frame when sent the whole screen and when sent the delta.
+static void BM_DrawLog_MenuFrame(benchmark::State &state) {
+    DrawLog log;
+    log.begin(ENTRIES, ENTRY_SIZE);
+    uint8_t p[ENTRY_SIZE];
+    char text[32];
+    fillRect(p, 0, 0, 240, 135, 0);
+    log.push(p);
+    for (int i = 0; i < 12; i++) {
+        snprintf(text, sizeof(text), "Menu option %d", i);
+        drawString(p, 10, 10 + i * 10, 0xFFFF, text);
+        log.push(p);
+    }
+
+    auto bytesAfter = [&](uint32_t after) {
+        size_t bytes = 0;
+        log.forEach(after, [&](const uint8_t *e, uint32_t) { bytes += e[1]; });
+        return bytes;
+    };
+    uint32_t seen = log.seq();
+    size_t snapshotBytes = 0, deltaBytes = 0;
+    uint32_t frame = 0;
+    for (auto _ : state) {
+        int rows[2] = {(int)(frame % 12), (int)((frame + 1) % 12)};
+        for (int k = 0; k < 2; k++) {
+            int y = 10 + rows[k] * 10;
+            // what the logger does for a fillRect: drop the ops it covers, then log it
+            log.removeIf([&](const uint8_t *e) {
+                int px = e[3] << 8 | e[4], py = e[5] << 8 | e[6];
+                return px >= 5 && px < 235 && py >= y && py < y + 10;
+            });
+            fillRect(p, 5, y, 230, 10, k ? 0xF800 : 0);
+            log.push(p);
+            snprintf(text, sizeof(text), "Menu option %d", rows[k]);
+            drawString(p, 10, y, k ? 0 : 0xFFFF, text);
+            log.push(p);
+        }
+        snapshotBytes += FRAME_HEADER + bytesAfter(0);
+        deltaBytes += FRAME_HEADER + bytesAfter(seen);
+        seen = log.seq();
+        frame++;
+    }
+    using benchmark::Counter;
+    state.counters["snapshot_B/frame"] = Counter(snapshotBytes, Counter::kAvgIterations);
+    state.counters["delta_B/frame"] = Counter(deltaBytes, Counter::kAvgIterations);
+    state.counters["live"] = log.size();
+}
+BENCHMARK(BM_DrawLog_MenuFrame);
@@ -0,0 +1,47 @@
+// File browser listing: readFs() walk with the extension filter, and the sortList() ordering
+#include <LittleFS.h>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <core/file_list.h>
+#include <native_root.h>
+
+namespace {
+const char *LIST_DIR = "/BruceRF";
+
+void makeFolder(int entries) {
+    useTempNativeRoot();
+    const char *exts[] = {"sub", "ir", "txt", "SUB", "js"};
+    for (int i = 0; i < entries; i++) {
+        char name[64];
+        if (i % 10 == 0) snprintf(name, sizeof(name), "%s/Dir_%05d/keep", LIST_DIR, (i * 7919) % entries);
+        else snprintf(name, sizeof(name), "%s/signal_%05d.%s", LIST_DIR, (i * 7919) % entries, exts[i % 5]);
+        File f = LittleFS.open(name, FILE_WRITE, true);
+        f.close();
+    }
+}
+} // namespace
+
+static void BM_FileList_ReadFs(benchmark::State &state) {
+    makeFolder(state.range(0));
+    for (auto _ : state) {
+        readFs(LittleFS, LIST_DIR, "sub|ir");
+        benchmark::DoNotOptimize(fileList.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FileList_ReadFs)->Arg(100)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+static void BM_FileList_Sort(benchmark::State &state) {
+    std::vector<FileList> entries;
+    for (int i = 0; i < state.range(0); i++) {
+        int n = (i * 7919) % state.range(0);
+        entries.push_back({i % 10 ? "Signal_" + String(n) + ".sub" : "dir_" + String(n), i % 10 == 0, false});
+    }
+    for (auto _ : state) {
+        std::vector<FileList> list = entries;
+        std::sort(list.begin(), list.end(), sortList);
+        benchmark::DoNotOptimize(list.data());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FileList_Sort)->Arg(100)->Arg(2000)->Unit(benchmark::kMicrosecond);
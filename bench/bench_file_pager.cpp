@@ -0,0 +1,51 @@
+// Line index build, random line access and search on a large text file
+#include <LittleFS.h>
+#include <benchmark/benchmark.h>
+#include <core/file_pager.h>
+#include <native_root.h>
+
+namespace {
+const char *TEXT_PATH = "/bench.txt";
+
+void writeTextFile(int lines) {
+    useTempNativeRoot();
+    File f = LittleFS.open(TEXT_PATH, FILE_WRITE, true);
+    for (int i = 0; i < lines; i++) f.printf("%08d the quick brown fox jumps over the lazy dog %d\n", i, i * 31);
+    f.close();
+}
+} // namespace
+
+static void BM_FilePager_Index(benchmark::State &state) {
+    writeTextFile(state.range(0));
+    FilePager pager;
+    for (auto _ : state) {
+        pager.open(LittleFS, TEXT_PATH);
+        while (!pager.indexStep()) {}
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * pager.size());
+}
+BENCHMARK(BM_FilePager_Index)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+static void BM_FilePager_RandomLine(benchmark::State &state) {
+    writeTextFile(state.range(0));
+    FilePager pager;
+    pager.open(LittleFS, TEXT_PATH);
+    while (!pager.indexStep()) {}
+    uint32_t n = 0;
+    for (auto _ : state) {
+        n = (n * 1103515245u + 12345u) % pager.lineCount();
+        benchmark::DoNotOptimize(pager.line(n));
+    }
+}
+BENCHMARK(BM_FilePager_RandomLine)->Arg(100000);
+
+static void BM_FilePager_FindLastLine(benchmark::State &state) {
+    writeTextFile(state.range(0));
+    FilePager pager;
+    pager.open(LittleFS, TEXT_PATH);
+    char needle[16];
+    snprintf(needle, sizeof(needle), "%08d", int(state.range(0) - 1));
+    for (auto _ : state) benchmark::DoNotOptimize(pager.find(needle, 0));
+    state.SetBytesProcessed(int64_t(state.iterations()) * pager.size());
+}
+BENCHMARK(BM_FilePager_FindLastLine)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,48 @@
+// Text parse of a Flipper .ir file vs random access into its compiled cache
+#include <LittleFS.h>
+#include <benchmark/benchmark.h>
+#include <modules/ir/ir_database.h>
+#include <native_root.h>
+
+namespace {
+const char *IR_PATH = "/BruceIR/bench.ir";
+
+void writeIrFile(int signals) {
+    useTempNativeRoot();
+    File f = LittleFS.open(IR_PATH, FILE_WRITE, true);
+    f.print("Filetype: IR signals file\nVersion: 1\n");
+    for (int i = 0; i < signals; i++) {
+        f.printf("#\nname: Raw_%d\ntype: raw\nfrequency: 38000\nduty_cycle: 0.330000\ndata:", i);
+        for (int t = 0; t < 100; t++) f.printf(" %d", 500 + (i * 7 + t * 13) % 1200);
+        f.printf("\n#\nname: Power_%d\ntype: parsed\nprotocol: NEC\n", i);
+        f.printf("address: %02X 00 00 00\ncommand: %02X 00 00 00\n", i & 0xFF, (i * 3) & 0xFF);
+    }
+    f.close();
+}
+} // namespace
+
+static void BM_IrDatabase_ParseText(benchmark::State &state) {
+    writeIrFile(state.range(0));
+    size_t entries = 0;
+    for (auto _ : state) {
+        File f = LittleFS.open(IR_PATH);
+        IrDatabase::parse(f, [&](IrDbEntry &) { return ++entries, true; });
+    }
+    state.SetItemsProcessed(entries);
+}
+BENCHMARK(BM_IrDatabase_ParseText)->Arg(50)->Arg(500)->Unit(benchmark::kMillisecond);
+
+static void BM_IrDatabase_ReadCompiled(benchmark::State &state) {
+    writeIrFile(state.range(0));
+    IrDatabase db;
+    if (!db.open(LittleFS, IR_PATH)) return state.SkipWithError("open failed");
+    IrDbEntry entry;
+    uint32_t i = 0;
+    for (auto _ : state) {
+        i = (i * 1103515245u + 12345u) % db.count(); // jump around, like a menu selection
+        db.read(i, entry);
+        benchmark::DoNotOptimize(entry.timings.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IrDatabase_ReadCompiled)->Arg(50)->Arg(500);
@@ -0,0 +1,26 @@
+// Wardriving dedup table: inserts of new and already seen addresses
+#include <benchmark/benchmark.h>
+#include <modules/gps/mac_table.h>
+
+static void BM_MacTable_Insert(benchmark::State &state) {
+    MacTable table;
+    table.begin(state.range(0), state.range(0));
+    uint64_t mac = 0x0011223344ULL;
+    uint32_t n = 0;
+    for (auto _ : state) {
+        // one address in four repeats, roughly what a walk through a busy street looks like
+        uint64_t m = (n & 3) == 0 ? mac + (n >> 3) : mac + n;
+        benchmark::DoNotOptimize(table.insert(m, uint16_t(n++ >> 12)));
+    }
+    state.counters["evicted"] = table.evicted();
+}
+BENCHMARK(BM_MacTable_Insert)->Arg(4096)->Arg(65536);
+
+static void BM_MacTable_Contains(benchmark::State &state) {
+    MacTable table;
+    table.begin(65536, 65536);
+    for (uint64_t i = 0; i < 30000; i++) table.insert(i * 2654435761ULL, 0);
+    uint64_t i = 0;
+    for (auto _ : state) benchmark::DoNotOptimize(table.contains(i++ * 2654435761ULL));
+}
+BENCHMARK(BM_MacTable_Contains);
@@ -0,0 +1,4 @@
+#include <benchmark/benchmark.h>
+
+// Defined here rather than taken from benchmark_main, so the shim's main() never wins the link
+BENCHMARK_MAIN();
@@ -0,0 +1,56 @@
+// readSubFile() parsing of Flipper .sub files: a long RAW capture and a file of many keys
+#include <LittleFS.h>
+#include <benchmark/benchmark.h>
+#include <modules/rf/sub_file.h>
+#include <native_root.h>
+
+namespace {
+const char *SUB_PATH = "/BruceRF/bench.sub";
+
+void writeSubFile(int lines, bool raw) {
+    useTempNativeRoot();
+    File f = LittleFS.open(SUB_PATH, FILE_WRITE, true);
+    f.print("Filetype: Flipper SubGhz RAW File\r\nVersion: 1\r\nFrequency: 433920000\r\n");
+    f.print("Preset: FuriHalSubGhzPresetOok650Async\r\n");
+    f.printf("Protocol: %s\r\n", raw ? "RAW" : "Princeton");
+    for (int i = 0; i < lines; i++) {
+        if (raw) {
+            f.print("RAW_Data:");
+            for (int t = 0; t < 512; t++) f.printf(" %d", (t & 1 ? -1 : 1) * (300 + (i * 7 + t * 13) % 900));
+        } else {
+            f.printf("Bit: 24\r\nKey: 00 00 00 00 00 %02X %02X %02X\r\n", i & 0xFF, (i >> 8) & 0xFF, i * 3 & 0xFF);
+            f.print("TE: 400");
+        }
+        f.print("\r\n");
+    }
+    f.close();
+}
+
+void parse(benchmark::State &state) {
+    size_t signals = 0;
+    for (auto _ : state) {
+        RfCodes code;
+        std::vector<int> bits, bitRaws;
+        std::vector<uint64_t> keys;
+        std::vector<String> rawData;
+        File f = LittleFS.open(SUB_PATH);
+        parseSubFile(f, code, bits, bitRaws, keys, rawData);
+        signals = bits.size() + keys.size() + rawData.size();
+    }
+    if (signals == 0) state.SkipWithError("nothing parsed");
+    File f = LittleFS.open(SUB_PATH);
+    state.SetBytesProcessed(int64_t(state.iterations()) * f.size());
+}
+} // namespace
+
+static void BM_SubFile_Raw(benchmark::State &state) {
+    writeSubFile(state.range(0), true);
+    parse(state);
+}
+BENCHMARK(BM_SubFile_Raw)->Arg(20)->Arg(200)->Unit(benchmark::kMillisecond);
+
+static void BM_SubFile_Keys(benchmark::State &state) {
+    writeSubFile(state.range(0), false);
+    parse(state);
+}
+BENCHMARK(BM_SubFile_Keys)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
@@ -235,6 +235,7 @@ void InputHandler(void) {
 ** Turns off the device (deep sleep with BOOT button wakeup)
 **********************************************************************/
 void powerOff() {
+    beforePowerDown();
     // Turn off backlight
     analogWrite(TFT_BL, 0);
     // Turn off amplifier
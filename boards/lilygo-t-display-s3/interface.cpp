@@ -191,6 +191,7 @@ void InputHandler(void) {
 }
 
 void powerOff() {
+    beforePowerDown();
 #ifdef T_DISPLAY_S3
     tft.fillScreen(bruceConfig.bgColor);
     digitalWrite(PIN_POWER_ON, LOW);
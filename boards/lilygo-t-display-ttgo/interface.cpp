@@ -113,6 +113,7 @@ void InputHandler(void) {
 }
 
 void powerOff() {
+    beforePowerDown();
     tft.fillScreen(bruceConfig.bgColor);
     digitalWrite(TFT_BL, LOW);
     tft.writecommand(0x10);
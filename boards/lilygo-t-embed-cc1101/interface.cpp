@@ -192,6 +192,7 @@ void InputHandler(void) {
 }
 
 void powerOff() {
+    beforePowerDown();
 #ifdef T_EMBED_1101
     PPM.shutdown();
 #endif
@@ -326,6 +327,7 @@ void checkReboot() {
                     tft.fillScreen(bruceConfig.bgColor);
                     while (digitalRead(BK_BTN) == BTN_ACT);
                     delay(200);
+                    beforePowerDown();
                     powerDownNFC();
                     powerDownCC1101();
                     tft.sleep(true);
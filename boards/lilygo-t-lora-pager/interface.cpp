@@ -379,7 +379,10 @@ END:
     if (sel == BTN_ACT || esc == BTN_ACT) tm = millis();
 }
 
-void powerOff() { PPM.shutdown(); }
+void powerOff() {
+    beforePowerDown();
+    PPM.shutdown();
+}
 
 /***************************************************************************************
 ** Function name: isCharging()
@@ -72,8 +72,14 @@ void InputHandler(void) {
 ** location: mykeyboard.cpp
 ** Turns off the device (or try to)
 **********************************************************************/
-void powerOff() { M5.Power.powerOff(); }
-void goToDeepSleep() { M5.Power.deepSleep(); }
+void powerOff() {
+    beforePowerDown();
+    M5.Power.powerOff();
+}
+void goToDeepSleep() {
+    beforePowerDown();
+    M5.Power.deepSleep();
+}
 
 /*********************************************************************
 ** Function: checkReboot
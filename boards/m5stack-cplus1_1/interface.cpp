@@ -59,7 +59,10 @@ void InputHandler(void) {
     SelPress = selPressed;
 }
 
-void powerOff() { axp192.PowerOff(); }
+void powerOff() {
+    beforePowerDown();
+    axp192.PowerOff();
+}
 #ifndef LITE_VERSION
 /*********************************************************************
 ** Function: checkReboot
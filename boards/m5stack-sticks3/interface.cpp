@@ -193,7 +193,10 @@ void InputHandler(void) {
 ** location: mykeyboard.cpp
 ** Turns off the device (or try to)
 **********************************************************************/
-void powerOff() { M5.Power.powerOff(); }
+void powerOff() {
+    beforePowerDown();
+    M5.Power.powerOff();
+}
 
 /*********************************************************************
 ** Function: checkReboot
@@ -156,7 +156,10 @@ void InputHandler(void) {
 ** location: mykeyboard.cpp
 ** Turns off the device (or try to)
 **********************************************************************/
-void powerOff() { PPM.shutdown(); }
+void powerOff() {
+    beforePowerDown();
+    PPM.shutdown();
+}
 
 /*********************************************************************
 ** Function: checkReboot
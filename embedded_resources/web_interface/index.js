@@ -36,6 +36,7 @@ const EXECUTABLE = {
 
 const Dialog = {
   _bg: function (show) {
+    closeScreenSocket();
     let bg = $(".dialog-background");
     let dialogs = document.querySelectorAll(".dialog");
     dialogs.forEach((dialog) => {
@@ -117,6 +118,119 @@ const Dialog = {
   },
 };
 
+// Paged file viewer, the device only sends the requested lines (or hex rows)
+const Viewer = {
+  file: "",
+  hex: false,
+  first: 0,
+  count: 200,
+  rows: 0,
+  lines: 0,
+  indexed: false,
+  size: 0,
+  query: "",
+  open: async function (file) {
+    this.file = file;
+    this.hex = false;
+    this.query = "";
+    $(".dialog.viewer .viewer-file-name").textContent = file;
+    $(".act-viewer-hex").textContent = "Hex";
+    Dialog.show("viewer");
+    await this.load(0, { reload: 1 });
+  },
+  load: async function (first, extra) {
+    let params = {
+      fs: currentDrive,
+      name: this.file,
+      action: "view",
+      first: first,
+      count: this.count,
+      hex: this.hex ? 1 : 0,
+    };
+    Object.assign(params, extra || {});
+    Dialog.loading.show("Loading...");
+    try {
+      let r, nl;
+      // the device indexes and searches a slice per request, ask again until it gets there
+      while (true) {
+        r = await requestGet("/file", params);
+        nl = r.indexOf("\n");
+        let [state, a, b, c] = r.substring(0, nl).split(" ");
+        if (state === "index") {
+          Dialog.loading.show(`Indexing... ${Math.floor((a * 100) / b)}%`);
+        } else if (state === "more") {
+          params.first = a;
+          params.at = b;
+          Dialog.loading.show(`Searching... ${Math.floor((b * 100) / c)}%`);
+        } else {
+          break;
+        }
+        delete params.reload;
+      }
+      let [start, lines, indexed, size] = r.substring(0, nl).split(" ");
+      let body = r.substring(nl + 1);
+      this.first = parseInt(start);
+      this.lines = parseInt(lines);
+      this.indexed = indexed === "1";
+      this.size = parseInt(size);
+      this.rows = body === "" ? 0 : body.split("\n").length - 1;
+      $(".dialog.viewer .viewer-content").textContent = body;
+      $(".dialog.viewer .viewer-content").scrollTop = 0;
+      this.status();
+      return true;
+    } catch (error) {
+      return false;
+    } finally {
+      Dialog.loading.hide();
+    }
+  },
+  status: function () {
+    let text;
+    if (this.hex) {
+      let end = Math.min(this.first + this.rows * 16, this.size);
+      text = `0x${this.first.toString(16)}-0x${end.toString(16)} / 0x${this.size.toString(16)}`;
+    } else {
+      let total = this.lines + (this.indexed ? "" : "+");
+      text = `Lines ${this.first + 1}-${this.first + this.rows} / ${total}`;
+    }
+    $(".dialog.viewer .viewer-status").textContent = text;
+  },
+  page: async function (dir) {
+    let step = this.hex ? this.count * 16 : this.count;
+    let first = Math.max(0, this.first + dir * step);
+    if (dir > 0 && this.rows < this.count) return; // already at the end
+    await this.load(first);
+  },
+  goto: async function () {
+    let where = prompt(
+      this.hex ? "Go to offset (hex):" : "Go to line:",
+      this.hex ? this.first.toString(16) : this.first + 1,
+    );
+    if (where === null || where.trim() === "") return;
+    if (this.hex) {
+      await this.load(Math.floor(parseInt(where, 16) / 16) * 16);
+    } else {
+      await this.load(Math.max(0, parseInt(where) - 1));
+    }
+  },
+  find: async function () {
+    let query = prompt("Find:", this.query);
+    if (query === null || query === "") return;
+    let again = query === this.query;
+    this.query = query;
+    if (this.hex) this.toggleHex(false);
+    let from = again ? this.first + 1 : this.first;
+    if (await this.load(from, { find: query })) return;
+    if (from > 0 && (await this.load(0, { find: query }))) return; // wrap around
+    alert("Not found: " + query);
+  },
+  toggleHex: async function (reload = true) {
+    this.hex = !this.hex;
+    $(".act-viewer-hex").textContent = this.hex ? "Text" : "Hex";
+    if (reload) await this.load(0);
+  },
+};
+
 function handleAuthError() {
   if (
     confirm(
@@ -182,6 +296,45 @@ async function requestPost(url, data) {
   });
 }
 
+// Checksums run on the device in the background, the job is polled until it ends
+async function hashFile(drive, file) {
+  let id = await requestGet("/file", { fs: drive, action: "hash", name: file });
+  while (true) {
+    await new Promise((resolve) => setTimeout(resolve, 500));
+    let r = await requestGet("/hash", { id: id.trim() });
+    let [state, done, total] = r.split("\n")[0].split(" ");
+    if (state === "done") return r.substring(r.indexOf("\n") + 1);
+    if (state !== "running") throw new Error("hashing failed");
+    if (Number(total) > 0) {
+      Dialog.loading.show(`Hashing... ${Math.floor((done * 100) / total)}%`);
+    }
+  }
+}
+
+// POST with `body` sent as is, the other params go in the query string
+async function requestPostBody(url, params, body) {
+  return new Promise((resolve, reject) => {
+    let realUrl = url + "?" + new URLSearchParams(params).toString();
+    if (IS_DEV) realUrl = "/bruce" + realUrl;
+    let req = new XMLHttpRequest();
+    req.open("POST", realUrl, true);
+    // a text body that looks like a form would be parsed into parameters, so it goes as raw bytes
+    req.setRequestHeader("Content-Type", "application/octet-stream");
+    req.onload = () => {
+      if (req.status >= 200 && req.status < 300) {
+        resolve(req.responseText);
+      } else if (req.status === 401) {
+        handleAuthError();
+        reject(new Error(`Unauthorized access (401)`));
+      } else {
+        reject(new Error(`Request failed with status ${req.status}`));
+      }
+    };
+    req.onerror = () => reject(new Error("Network error"));
+    req.send(body);
+  });
+}
+
 function stringToId(str) {
   let hash = 0,
     i,
@@ -339,37 +492,37 @@ function syncScrolling() {
   lineNumbers.scrollTop = textarea.scrollTop;
 }
 
+function humanReadableSize(bytes) {
+  if (bytes < 1024) return bytes + " B";
+  if (bytes < 1024 * 1024) return (bytes / 1024).toFixed(2) + " kB";
+  if (bytes < 1024 * 1024 * 1024)
+    return (bytes / 1024 / 1024).toFixed(2) + " MB";
+  return (bytes / 1024 / 1024 / 1024).toFixed(2) + " GB";
+}
+
 function renderFileRow(fileList) {
   $("table.explorer tbody").innerHTML = "";
-  fileList
-    .split("\n")
-    .sort((a, b) => {
-      let [aFirst, ...aRest] = a.split(":");
-      let [bFirst, ...bRest] = b.split(":");
-
-      if (aFirst !== bFirst) {
-        return bFirst.localeCompare(aFirst);
-      }
+  if (currentPath !== "/") {
+    let e = T.pathRow();
+    let preFolder = currentPath.substring(0, currentPath.lastIndexOf("/"));
+    if (preFolder === "") preFolder = "/";
+    e.querySelector(".path-row").setAttribute("data-path", preFolder);
+    e.querySelector(".path-row td").classList.add("act-browse");
+    $("table.explorer tbody").appendChild(e);
+  }
 
-      let aRestStr = aRest.join(":").toLowerCase();
-      let bRestStr = bRest.join(":").toLowerCase();
-      return aRestStr.localeCompare(bRestStr);
+  fileList.files
+    .sort((a, b) => {
+      if (!!a.dir !== !!b.dir) return a.dir ? -1 : 1; // folders first
+      return a.name.toLowerCase().localeCompare(b.name.toLowerCase());
     })
-    .forEach((line) => {
+    .forEach((file) => {
       let e;
-      let [type, name, size] = line.split(":");
-      if (size === undefined) return;
+      let name = file.name;
       let dPath = (
         (currentPath.endsWith("/") ? currentPath : currentPath + "/") + name
       ).replace(/\/\//g, "/");
-      if (type === "pa") {
-        if (dPath === "/") return;
-        e = T.pathRow();
-        let preFolder = currentPath.substring(0, currentPath.lastIndexOf("/"));
-        if (preFolder === "") preFolder = "/";
-        e.querySelector(".path-row").setAttribute("data-path", preFolder);
-        e.querySelector(".path-row td").classList.add("act-browse");
-      } else if (type === "Fi") {
+      if (!file.dir) {
         e = T.fileRow();
         e.querySelector(".file-row").setAttribute("data-file", dPath);
         e.querySelector(".act-rename").setAttribute(
@@ -379,7 +532,9 @@ function renderFileRow(fileList) {
         e.querySelector(".col-name").classList.add("act-edit-file");
         e.querySelector(".col-name").textContent = name;
         e.querySelector(".col-name").setAttribute("title", name);
-        e.querySelector(".col-size").textContent = size;
+        e.querySelector(".col-size").textContent = humanReadableSize(
+          file.size,
+        );
         e.querySelector(".col-action").classList.add("type-file");
 
         let downloadUrl = `/file?fs=${currentDrive}&name=${encodeURIComponent(dPath)}&action=download`;
@@ -395,7 +550,7 @@ function renderFileRow(fileList) {
           );
           e.querySelector(".col-action").classList.add("executable");
         }
-      } else if (type === "Fo") {
+      } else {
         e = T.fileRow();
         e.querySelector(".col-name").classList.add("act-browse");
         e.querySelector(".file-row").setAttribute("data-path", dPath);
@@ -456,7 +611,7 @@ async function fetchFiles(drive, path) {
     fs: drive,
     folder: path,
   });
-  renderFileRow(req);
+  renderFileRow(JSON.parse(req));
   btnRefreshFolder.classList.remove("reloading");
 }
 
@@ -480,11 +635,11 @@ async function saveEditorFile(runFile = false) {
   if (isModified(editor)) {
     $(".act-save-edit-file").disabled = true;
     editor.setAttribute("data-hash", calcHash(editor.value));
-    await requestPost("/edit", {
-      fs: currentDrive,
-      name: filename,
-      content: editor.value,
-    });
+    await requestPostBody(
+      "/edit",
+      { fs: currentDrive, name: filename },
+      editor.value,
+    );
   }
 
   if (runFile) {
@@ -504,7 +659,8 @@ function isModified(target) {
 
 async function openNavigator() {
   Dialog.show("navigator");
-  await reloadScreen();
+  openScreenSocket();
+  if (!SCREEN_SOCKET) await reloadScreen();
   autoReloadScreen();
 }
 
@@ -513,9 +669,10 @@ async function runNavigation(direction) {
   if (SCREEN_NAVIGATING) return;
   SCREEN_NAVIGATING = true;
   try {
-    drawCanvasLoading();
+    // the screen socket brings the changes by itself
+    if (!screenSocketOpen()) drawCanvasLoading();
     await requestPost("/cm", { cmnd: `nav ${direction.toLowerCase()}` });
-    await reloadScreen();
+    if (!screenSocketOpen()) await reloadScreen();
   } catch (error) {
     alert("Failed to run command: " + error.message);
     console.error(error);
@@ -527,6 +684,10 @@ async function runNavigation(direction) {
 const btnForceReload = $("#force-reload");
 let SCREEN_RELOAD = false;
 async function reloadScreen() {
+  if (screenSocketOpen()) {
+    requestScreenSync();
+    return;
+  }
   if (SCREEN_RELOAD) return;
   SCREEN_RELOAD = true;
   btnForceReload.classList.add("reloading");
@@ -558,7 +719,7 @@ async function taskReloader() {
     return;
   }
 
-  await reloadScreen();
+  if (!screenSocketOpen()) await reloadScreen();
   setTimeout(taskReloader, timer);
   // better use setTimeout instead of setInterval to avoid overlapping calls
 }
@@ -573,10 +734,82 @@ async function autoReloadScreen() {
   if (timer > 0) taskReloader();
 }
 
+/// SCREEN SOCKET
+// Binary frames: [type][fromSeq][toSeq] (big endian uint32) + draw ops
+// "S" is the whole screen, "D" only the ops drawn after fromSeq
+let SCREEN_SOCKET = null;
+let SCREEN_SEQ = 0;
+let SCREEN_SYNCING = false;
+let SCREEN_RENDER = Promise.resolve();
+function screenSocketOpen() {
+  return SCREEN_SOCKET && SCREEN_SOCKET.readyState === WebSocket.OPEN;
+}
+
+function openScreenSocket() {
+  if (SCREEN_SOCKET || IS_DEV || !window.WebSocket) return;
+  const proto = window.location.protocol === "https:" ? "wss" : "ws";
+  const socket = new WebSocket(`${proto}://${window.location.host}/ws/screen`);
+  socket.binaryType = "arraybuffer";
+  socket.onmessage = (e) => {
+    const frame = new Uint8Array(e.data);
+    // frames are drawn one after the other, images make renderTFT async
+    SCREEN_RENDER = SCREEN_RENDER.then(() => renderScreenFrame(frame)).catch(
+      (error) => console.error("Failed to render screen:", error),
+    );
+  };
+  socket.onclose = () => {
+    if (SCREEN_SOCKET !== socket) return;
+    SCREEN_SOCKET = null;
+    // polling takes over until the socket is back
+    setTimeout(() => {
+      if ($(".dialog.navigator:not(.hidden)")) openScreenSocket();
+    }, 2000);
+  };
+  SCREEN_SOCKET = socket;
+  SCREEN_SEQ = 0;
+  SCREEN_SYNCING = true; // the device starts with a snapshot
+}
+
+function closeScreenSocket() {
+  if (!SCREEN_SOCKET) return;
+  const socket = SCREEN_SOCKET;
+  SCREEN_SOCKET = null;
+  socket.close();
+}
+
+function requestScreenSync() {
+  if (!screenSocketOpen()) return;
+  SCREEN_SYNCING = true;
+  SCREEN_SOCKET.send("sync");
+}
+
+async function renderScreenFrame(frame) {
+  if (frame.length < 9) return;
+  const view = new DataView(frame.buffer, frame.byteOffset);
+  const type = String.fromCharCode(frame[0]);
+  const fromSeq = view.getUint32(1);
+  const toSeq = view.getUint32(5);
+  const ops = frame.subarray(9);
+
+  if (type === "S") {
+    SCREEN_SYNCING = false;
+    await renderTFT(ops);
+  } else {
+    if (SCREEN_SYNCING) return; // a snapshot is on its way
+    if (fromSeq !== SCREEN_SEQ) {
+      requestScreenSync();
+      return;
+    }
+    if (ops.length > 0) await renderTFT(ops, false); // empty: only the sequence moves
+  }
+  SCREEN_SEQ = toSeq;
+}
+
 /// TFT RENDER
 let loadingDrawn = false;
 const imageCache = {}; // global
-async function renderTFT(data) {
+// full: data is the whole screen, otherwise it is drawn over the current one
+async function renderTFT(data, full = true) {
   loadingDrawn = false;
   const canvas = $("#navigator-screen");
   const ctx = canvas.getContext("2d");
@@ -689,8 +922,9 @@ async function renderTFT(data) {
   };
 
   let offset = 0;
-  ctx.clearRect(0, 0, canvas.width, canvas.height);
+  if (full) ctx.clearRect(0, 0, canvas.width, canvas.height);
   let screenText = []; // Collect all text rendered on screen
+  let cleared = full;
 
   while (offset < data.length) {
     ctx.beginPath();
@@ -714,6 +948,8 @@ async function renderTFT(data) {
         canvas.width = input.w;
         canvas.height = input.h;
       case 0: // FILLSCREEN
+        screenText = [];
+        cleared = true;
         ctx.fillStyle = color565toCSS(input.fg);
         ctx.fillRect(0, 0, canvas.width, canvas.height);
         break;
@@ -871,6 +1107,8 @@ async function renderTFT(data) {
     allText.includes("deauth") ||
     allText.includes("handshake");
 
+  // a partial redraw can only add to the text already on screen
+  if (!cleared && !isWiFiMenu) return;
   if (isWiFiMenu) {
     wifiWarning.classList.remove("hidden");
   } else {
@@ -1031,6 +1269,58 @@ $(".container").addEventListener("click", async (e) => {
     return;
   }
 
+  let actViewFile = e.target.closest(".act-view");
+  if (actViewFile) {
+    e.preventDefault();
+    let file = actViewFile.closest(".file-row").getAttribute("data-file");
+    if (!file) return;
+    await Viewer.open(file);
+    return;
+  }
+
+  let actViewerPage = e.target.closest(".act-viewer-page");
+  if (actViewerPage) {
+    e.preventDefault();
+    await Viewer.page(parseInt(actViewerPage.getAttribute("data-dir")));
+    return;
+  }
+
+  if (e.target.closest(".act-viewer-goto")) {
+    e.preventDefault();
+    await Viewer.goto();
+    return;
+  }
+
+  if (e.target.closest(".act-viewer-find")) {
+    e.preventDefault();
+    await Viewer.find();
+    return;
+  }
+
+  if (e.target.closest(".act-viewer-hex")) {
+    e.preventDefault();
+    await Viewer.toggleHex();
+    return;
+  }
+
+  let actHashFile = e.target.closest(".act-hash");
+  if (actHashFile) {
+    e.preventDefault();
+    let file = actHashFile.closest(".file-row").getAttribute("data-file");
+    if (!file) return;
+
+    Dialog.loading.show("Hashing...");
+    try {
+      let r = await hashFile(currentDrive, file);
+      alert(`${file}\n\n${r}`);
+    } catch (error) {
+      alert("Failed to hash file: " + error.message);
+    } finally {
+      Dialog.loading.hide();
+    }
+    return;
+  }
+
   let actDeleteFile = e.target.closest(".act-delete");
   if (actDeleteFile) {
     e.preventDefault();
@@ -1,10 +1,18 @@
-Import("env")
 import os
+import re
 import subprocess
 import hashlib
 import shutil
-
-PIOENV = env.subst("$PIOENV")
+import sys
+
+# Run by PlatformIO as a pre: script, or by hand to compile scripts to bytecode:
+#   python gen_mqjs_headers.py <pio env> script.js [more.js ...]
+try:
+    Import("env")
+    PIOENV = env.subst("$PIOENV")
+except NameError:
+    env = None
+    PIOENV = sys.argv[1] if len(sys.argv) > 1 else ""
 MQJS_PATH = os.path.join(".pio/libdeps", PIOENV, "mquickjs")
 
 BUILD_DIR = "lib/mquickjs_headers"
@@ -19,6 +27,18 @@ SRC = [
     os.path.join(MQJS_PATH, "mquickjs_build.c"),
 ]
 
+# Host .bjsc compiler: the engine plus the firmware stdlib without its natives
+BJSC = os.path.join(BUILD_DIR, "bjsc")
+BJSC_MAIN = os.path.join(BJS_INTERPRETER_PATH, "bjsc_host.c")
+BJSC_STDLIB = os.path.join(BUILD_DIR, "mqjs_stdlib_host.h")
+BJSC_SRC = [
+    BJSC_MAIN,
+    os.path.join(MQJS_PATH, "mquickjs.c"),
+    os.path.join(MQJS_PATH, "cutils.c"),
+    os.path.join(MQJS_PATH, "dtoa.c"),
+    os.path.join(MQJS_PATH, "libm.c"),
+]
+
 CFLAGS = [
     "-Wall",
     "-O2",
@@ -110,8 +130,9 @@ def _normalize_option_value(value) -> str:
 def compute_signature():
     # Any change here should force a rebuild.
     parts = []
-    parts.append("v=3")
+    parts.append("v=4")
     parts.append(f"watch_sha256={sha256_file(WATCH_FILE)}")
+    parts.append(f"bjsc_sha256={sha256_file(BJSC_MAIN)}")
 
     mqjs_build_c = os.path.join(MQJS_PATH, "mquickjs_build.c")
     parts.append(f"mquickjs_build_sha256={sha256_file(mqjs_build_c)}")
@@ -134,6 +155,14 @@ def needs_rebuild():
     print(old, compute_signature())
     return compute_signature() != old
 
+def missing_natives():
+    # Natives bound in mqjs_stdlib.c that the committed mqjs_stdlib.h doesn't reference yet
+    with open(WATCH_FILE, "r") as f:
+        wanted = set(re.findall(r"\bnative_\w+", f.read()))
+    with open(os.path.join(BJS_INTERPRETER_PATH, "mqjs_stdlib.h"), "r") as f:
+        present = set(re.findall(r"\bnative_\w+", f.read()))
+    return sorted(wanted - present)
+
 def write_build_stamp():
     with open(BUILD_SHA256, "w") as f:
         f.write(compute_signature())
@@ -144,6 +173,98 @@ def get_build_flag_value(flag_name):
     defines = {k: v for (k, v) in flags_with_value_list}
     return defines.get(flag_name)
 
+def _host_env(host_cc):
+    # Ensure the compiler's bin directory is in PATH so sub-processes
+    # (cc1, as, ld) can be found -- required on Windows/MSYS2.
+    cc_dir = os.path.dirname(shutil.which(host_cc) or host_cc)
+    sub_env = os.environ.copy()
+    if cc_dir:
+        sub_env["PATH"] = cc_dir + os.pathsep + sub_env.get("PATH", "")
+    return sub_env
+
+def _native_names():
+    # Natives implemented by the firmware, declared in the *_js.h headers
+    names = set()
+    for header in INCLUDES:
+        with open(os.path.join(BJS_INTERPRETER_PATH, header + ".h"), "r") as f:
+            names.update(re.findall(r"\b((?:js|native)_\w+)\s*\(", f.read()))
+    return names
+
+def write_host_stdlib(stdlib):
+    # Same ROM layout as the firmware, only the function pointers differ. The
+    # compiler never calls them, so the firmware natives become NULL.
+    natives = _native_names()
+    stdlib = re.sub(
+        r"(\{ \.\w+ = )(\w+)( \})",
+        lambda m: m.group(1) + ("NULL" if m.group(2) in natives else m.group(2)) + m.group(3),
+        stdlib,
+    )
+    stdlib = re.sub(
+        r"(js_c_finalizer_table\[\] = \{)(.*?)(\};)",
+        lambda m: m.group(1) + re.sub(r"\b\w+,", "NULL,", m.group(2)) + m.group(3),
+        stdlib,
+        flags=re.S,
+    )
+    with open(BJSC_STDLIB, "w") as f:
+        f.write('#include "user_classes_js.h"\n\n')
+        f.write(stdlib)
+
+def _run_host_cc(args, sub_env):
+    result = subprocess.run(args, capture_output=True, text=True, env=sub_env)
+    if result.returncode != 0:
+        if result.stdout:
+            print("gcc stdout:\n" + result.stdout)
+        if result.stderr:
+            print("gcc stderr:\n" + result.stderr)
+        raise subprocess.CalledProcessError(
+            result.returncode,
+            result.args,
+            output=result.stdout,
+            stderr=result.stderr,
+        )
+
+def run_generator(host_cc, sub_env):
+    # Build the generator as a native host executable. The output headers are
+    # still forced to 32-bit target format via the generator's `-m32` flag.
+    _run_host_cc([host_cc, *CFLAGS, "-o", GEN, *SRC], sub_env)
+    result = subprocess.run([GEN, "-m32"], capture_output=True, text=True, check=True, env=sub_env)
+    return result.stdout
+
+def build_bjsc(host_cc, sub_env):
+    # 32 bit like the target, so the images it writes load on the device
+    _run_host_cc(
+        [host_cc, *CFLAGS, "-I" + BUILD_DIR, "-I" + BJS_INTERPRETER_PATH, "-o", BJSC, *BJSC_SRC, "-lm"],
+        sub_env,
+    )
+
+def _bjsc_path():
+    return BJSC + ".exe" if os.path.exists(BJSC + ".exe") else BJSC
+
+def ensure_bjsc():
+    # Firmware builds only refresh bjsc along with the headers, build it here when it was never made
+    if os.path.exists(_bjsc_path()):
+        return
+    if not os.path.exists(MQJS_PATH):
+        raise RuntimeError(f"{MQJS_PATH} not found, build the firmware for this env once to fetch it.")
+    host_cc = _resolve_host_cc()
+    sub_env = _host_env(host_cc)
+    if not os.path.exists(BJSC_STDLIB):
+        write_host_stdlib(run_generator(host_cc, sub_env))
+    build_bjsc(host_cc, sub_env)
+
+def compile_scripts(scripts):
+    try:
+        ensure_bjsc()
+    except Exception as e:
+        print(f"Could not build the bjsc host compiler: {e}")
+        return 1
+    bjsc = _bjsc_path()
+    status = 0
+    for script in scripts:
+        if subprocess.run([bjsc, script]).returncode != 0:
+            status = 1
+    return status
+
 def generate_headers():
     if not os.path.exists(MQJS_PATH):
         return
@@ -163,7 +284,13 @@ def generate_headers():
     try:
         host_cc = _resolve_host_cc()
         if not shutil.which(host_cc):
+            missing = []
             if os.path.exists(os.path.join(BJS_INTERPRETER_PATH, "mqjs_stdlib.h")):
+                missing = missing_natives()
+            if missing:
+                # the old header builds, but the new functions would be silently missing in JS
+                print("mqjs_stdlib.h is older than mqjs_stdlib.c, it lacks: " + ", ".join(missing))
+            if os.path.exists(os.path.join(BJS_INTERPRETER_PATH, "mqjs_stdlib.h")) and not missing:
                 print("Host compiler not found; skipping mqjs_stdlib header generation.")
                 print("Set MQJS_HOST_CC or mqjs_host_cc to a GCC-compatible compiler, or use Docker.")
                 print("\nOn Windows:\n- install MSYS2 https://www.msys2.org/ at default path")
@@ -174,47 +301,25 @@ def generate_headers():
                 print("\nOn Mac:\n- run on terminal: xcode-select --install")
                 print("\nOn Linux:\n- run on terminal: sudo apt-get install -y --no-install-recommends gcc-multilib libc6-dev-i386\n\n")
                 return
-            raise RuntimeError("Host compiler not found and mqjs_stdlib.h is missing.")
-
-        # Build the generator as a native host executable. The output headers are
-        # still forced to 32-bit target format via the generator's `-m32` flag.
-        # Ensure the compiler's bin directory is in PATH so sub-processes
-        # (cc1, as, ld) can be found -- required on Windows/MSYS2.
-        cc_dir = os.path.dirname(shutil.which(host_cc) or host_cc)
-        sub_env = os.environ.copy()
-        if cc_dir:
-            sub_env["PATH"] = cc_dir + os.pathsep + sub_env.get("PATH", "")
-
-        gcc_result = subprocess.run(
-            [host_cc, *CFLAGS, "-o", GEN, *SRC],
-            capture_output=True,
-            text=True,
-            env=sub_env,
-        )
-        if gcc_result.returncode != 0:
-            if gcc_result.stdout:
-                print("gcc stdout:\n" + gcc_result.stdout)
-            if gcc_result.stderr:
-                print("gcc stderr:\n" + gcc_result.stderr)
-            raise subprocess.CalledProcessError(
-                gcc_result.returncode,
-                gcc_result.args,
-                output=gcc_result.stdout,
-                stderr=gcc_result.stderr,
-            )
+            raise RuntimeError("Host compiler not found and mqjs_stdlib.h is missing or out of date.")
+
+        sub_env = _host_env(host_cc)
+        stdlib = run_generator(host_cc, sub_env)
 
         print("gen_mqjs_headers.py Generating QuickJS headers for 32-bit targets")
 
         with open(os.path.join(BJS_INTERPRETER_PATH, "mqjs_stdlib.h"), "w") as f:
-            result = subprocess.run([GEN, "-m32"], capture_output=True, text=True, check=True, env=sub_env)
             for line in INCLUDES:
                 f.write(f'#include "{line}.h"\n')
             f.write("\n")
-            f.write(result.stdout)
+            f.write(stdlib)
+        write_host_stdlib(stdlib)
 
         with open(os.path.join(BUILD_DIR, "mquickjs_atom.h"), "w") as f:
             subprocess.check_call([GEN, "-a", "-m32"], stdout=f, env=sub_env)
 
+        build_bjsc(host_cc, sub_env)
+
     except Exception as e:
         print("\nError generating MicroQuickJS headers (gen_mqjs_headers.py).")
         print("This error occurs because the mqjs_stdlib.c file was modified.")
@@ -225,4 +330,10 @@ def generate_headers():
 
     write_build_stamp()
 
-generate_headers()
+if env is not None:
+    generate_headers()
+elif len(sys.argv) < 3:
+    print("usage: python gen_mqjs_headers.py <pio env> script.js [more.js ...]")
+    sys.exit(2)
+else:
+    sys.exit(compile_scripts(sys.argv[2:]))
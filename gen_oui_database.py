@@ -0,0 +1,85 @@
+import csv
+import struct
+import sys
+
+# Builds the offline vendor table read by src/core/oui_database.cpp from the IEEE MA-L registry:
+#   curl -o oui.csv https://standards-oui.ieee.org/oui/oui.csv
+#   python gen_oui_database.py oui.csv [oui.bin]
+# then copy oui.bin to /BruceOUI/oui.bin on the SD card or LittleFS.
+
+MAGIC = b"BOUI"
+VERSION = 1
+BLOCK_SIZE = 64  # records per RAM index entry, at most 128 (see OUIDB_MAX_BLOCK)
+MAX_NAME = 95  # OUI_DB_MAX_NAME minus the NUL
+HEADER = struct.Struct("<4sHHIIIII")
+
+
+def clean_name(name):
+    name = " ".join(name.split())
+    data = name.encode("utf-8")
+    if len(data) > MAX_NAME:
+        data = data[:MAX_NAME].decode("utf-8", "ignore").rstrip().encode("utf-8")
+    return data
+
+
+def read_registry(path):
+    vendors = {}
+    with open(path, newline="", encoding="utf-8-sig") as f:
+        for row in csv.DictReader(f):
+            assignment = (row.get("Assignment") or "").strip()
+            name = row.get("Organization Name") or ""
+            if len(assignment) != 6 or row.get("Registry", "MA-L").strip() != "MA-L":
+                continue
+            try:
+                prefix = int(assignment, 16)
+            except ValueError:
+                continue
+            name = clean_name(name)
+            if name:
+                vendors[prefix] = name
+    return vendors
+
+
+def build(vendors):
+    pool = bytearray()
+    offsets = {}
+    records = bytearray()
+    index = []
+    for i, prefix in enumerate(sorted(vendors)):
+        name = vendors[prefix]
+        if name not in offsets:
+            offsets[name] = len(pool)
+            pool += name + b"\0"
+        if i % BLOCK_SIZE == 0:
+            index.append(prefix)
+        records += prefix.to_bytes(3, "big") + offsets[name].to_bytes(3, "little")
+    if len(pool) >= 1 << 24:
+        raise ValueError("vendor pool does not fit 24 bit offsets")
+
+    index_offset = HEADER.size
+    records_offset = index_offset + 4 * len(index)
+    pool_offset = records_offset + len(records)
+    header = HEADER.pack(
+        MAGIC, VERSION, BLOCK_SIZE, len(vendors), index_offset, records_offset, pool_offset, len(pool)
+    )
+    return header + struct.pack("<%dI" % len(index), *index) + records + pool, len(offsets)
+
+
+def main(argv):
+    if len(argv) < 2 or len(argv) > 3:
+        print("usage: python gen_oui_database.py oui.csv [oui.bin]")
+        return 2
+    out = argv[2] if len(argv) == 3 else "oui.bin"
+    vendors = read_registry(argv[1])
+    if not vendors:
+        print("%s: no MA-L assignments found" % argv[1])
+        return 1
+    data, names = build(vendors)
+    with open(out, "wb") as f:
+        f.write(data)
+    print("%s -> %s: %d prefixes, %d vendors, %d bytes" % (argv[1], out, len(vendors), names, len(data)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -2,6 +2,7 @@
 #define __MENU_ITEM_INTERFACE_H__
 
 #include "core/display.h"
+#include "core/icon_cache.h"
 #include <globals.h>
 
 class MenuItemInterface {
@@ -10,15 +11,15 @@ public:
     virtual void optionsMenu(void) = 0;
     virtual void drawIcon(float scale = 1) = 0;
     virtual void drawIconImg() {
-        drawImg(
-            *bruceConfig.themeFS(),
-            bruceConfig.getThemeItemImg(themePath()),
-            0,
-            imgCenterY,
-            true,
-            bruceConfig.theme.gifDuration,
-            false
-        );
+        FS &fs = *bruceConfig.themeFS();
+        String path = bruceConfig.getThemeItemImg(themePath());
+        if (iconCache.draw(fs, path, 0, imgCenterY, true)) return;
+        drawImg(fs, path, 0, imgCenterY, true, bruceConfig.theme.gifDuration, false);
+    }
+    // Decodes the theme image in the background so showing this item later is a copy from RAM
+    void prefetchIconImg() {
+        if (!checkTheme()) return;
+        iconCache.prefetch(*bruceConfig.themeFS(), bruceConfig.getThemeItemImg(themePath()));
     }
     virtual bool hasTheme() = 0;
     virtual String themePath() = 0;
@@ -1,5 +1,6 @@
 #ifndef __DISPLAY_LOGER
 #define __DISPLAY_LOGER
+#include "core/tftLogger/draw_log.h"
 #ifdef HAS_SCREEN
 #include <display/tft.h>
 #define BRUCE_TFT_DRIVER tft_display
@@ -52,14 +53,17 @@ struct tftLog {
 };
 class tft_logger : public BRUCE_TFT_DRIVER {
 private:
-    tftLog *log = nullptr;
+    DrawLog log;
+    SemaphoreHandle_t logLock = NULL; // the WebUI reads the log from the async_tcp task
     char (*images)[MAX_LOG_IMG_PATH] = nullptr;
-    uint8_t logWriteIndex = 0;
-    uint8_t logCount = 0;
     bool isSleeping = false;
     bool logging = false;
     bool _logging = false;
     void clearLog();
+    void lockLog();
+    void unlockLog();
+    size_t writeScreenInfo(uint8_t *buffer);
+    size_t writeLogEntry(const uint8_t *entry, uint8_t *out);
     bool async_serial = false;
     TaskHandle_t asyncSerialTask = NULL;
     QueueHandle_t asyncSerialQueue = NULL;
@@ -97,7 +101,12 @@ public:
     // display will still be logged, in order to keep WebUI Navigator working
     void inline setSleepMode(bool mode) { isSleeping = mode; }
 
-    void getBinLog(uint8_t *outBuffer, size_t &outSize);
+    // Screen info followed by every draw op on screen. `lastSeq` gets the sequence it is current to.
+    void getBinLog(uint8_t *outBuffer, size_t &outSize, uint32_t *lastSeq = nullptr);
+    // Draw ops logged after `afterSeq`, at most `maxSize` bytes, advancing `afterSeq` past what was
+    // written. False if some of them were already dropped from the log: getBinLog is needed to resync.
+    bool getBinLogSince(uint32_t &afterSeq, uint8_t *outBuffer, size_t maxSize, size_t &outSize);
+    uint32_t getLogSeq() { return log.seq(); }
     bool removeLogEntriesInsideRect(int rx, int ry, int rw, int rh);
     void removeOverlappedImages(int x, int y, int center, int ms);
 
@@ -159,7 +168,6 @@ public:
     size_t printf(const char *format, ...);
 
 protected:
-    bool isLogEqual(const tftLog &a, const tftLog &b);
     void pushLogIfUnique(const tftLog &l);
     // void checkAndLog(tftFuncs f, std::initializer_list<int32_t> values);
     template <typename... Args> void checkAndLog(tftFuncs f, Args... args) {
@@ -179,7 +187,6 @@ protected:
         logging = false;
     }
     void restoreLogger();
-    void addLogEntry(const uint8_t *buffer, uint8_t size);
     void logWriteHeader(uint8_t *buffer, uint8_t &pos, tftFuncs fn);
     void writeUint16(uint8_t *buffer, uint8_t &pos, uint16_t value);
 };
@@ -0,0 +1,338 @@
+#include "tft.h"
+
+#if defined(USE_NULL_DISPLAY)
+#include <cmath>
+#include <cstdio>
+
+void null_canvas::resize(int16_t w, int16_t h) {
+    _width = w > 0 ? w : 0;
+    _height = h > 0 ? h : 0;
+    _fb.assign(static_cast<size_t>(_width) * _height, 0);
+}
+
+void null_canvas::drawPixel(int32_t x, int32_t y, uint32_t color) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    _fb[y * _width + x] = static_cast<uint16_t>(color);
+}
+
+uint16_t null_canvas::readPixel(int32_t x, int32_t y) const {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+    return _fb[y * _width + x];
+}
+
+void null_canvas::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+    int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    for (;;) {
+        drawPixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void null_canvas::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { fillRect(x, y, w, 1, color); }
+
+void null_canvas::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) { fillRect(x, y, 1, h, color); }
+
+void null_canvas::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void null_canvas::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    int32_t x0 = std::max<int32_t>(x, 0), y0 = std::max<int32_t>(y, 0);
+    int32_t x1 = std::min<int32_t>(x + w, _width), y1 = std::min<int32_t>(y + h, _height);
+    for (int32_t row = y0; row < y1; ++row) {
+        std::fill(&_fb[row * _width + x0], &_fb[row * _width + x1], static_cast<uint16_t>(color));
+    }
+}
+
+void null_canvas::fillRectHGradient(
+    int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color1, uint32_t color2
+) {
+    (void)color2;
+    fillRect(x, y, w, h, color1);
+}
+
+void null_canvas::fillRectVGradient(
+    int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color1, uint32_t color2
+) {
+    (void)color2;
+    fillRect(x, y, w, h, color1);
+}
+
+void null_canvas::fillScreen(uint32_t color) { std::fill(_fb.begin(), _fb.end(), static_cast<uint16_t>(color)); }
+
+void null_canvas::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+    (void)r;
+    drawRect(x, y, w, h, color);
+}
+
+void null_canvas::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color) {
+    (void)r;
+    fillRect(x, y, w, h, color);
+}
+
+void null_canvas::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) { drawEllipse(x0, y0, r, r, color); }
+
+void null_canvas::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) { fillEllipse(x0, y0, r, r, color); }
+
+void null_canvas::drawEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color) {
+    if (rx <= 0 || ry <= 0) return;
+    int32_t steps = 4 * (rx + ry);
+    for (int32_t i = 0; i < steps; ++i) {
+        float a = 2.0f * (float)PI * i / steps;
+        drawPixel(x0 + lroundf(rx * cosf(a)), y0 + lroundf(ry * sinf(a)), color);
+    }
+}
+
+void null_canvas::fillEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color) {
+    if (rx <= 0 || ry <= 0) return;
+    for (int32_t dy = -ry; dy <= ry; ++dy) {
+        int32_t dx = lroundf(rx * sqrtf(1.0f - (float)(dy * dy) / (float)(ry * ry)));
+        drawFastHLine(x0 - dx, y0 + dy, 2 * dx + 1, color);
+    }
+}
+
+void null_canvas::drawTriangle(
+    int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color
+) {
+    drawLine(x0, y0, x1, y1, color);
+    drawLine(x1, y1, x2, y2, color);
+    drawLine(x2, y2, x0, y0, color);
+}
+
+void null_canvas::fillTriangle(
+    int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color
+) {
+    int32_t minY = std::min({y0, y1, y2}), maxY = std::max({y0, y1, y2});
+    int32_t minX = std::min({x0, x1, x2}), maxX = std::max({x0, x1, x2});
+    auto edge = [](int32_t ax, int32_t ay, int32_t bx, int32_t by, int32_t px, int32_t py) {
+        return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+    };
+    for (int32_t y = minY; y <= maxY; ++y) {
+        for (int32_t x = minX; x <= maxX; ++x) {
+            int32_t e0 = edge(x0, y0, x1, y1, x, y);
+            int32_t e1 = edge(x1, y1, x2, y2, x, y);
+            int32_t e2 = edge(x2, y2, x0, y0, x, y);
+            if ((e0 >= 0 && e1 >= 0 && e2 >= 0) || (e0 <= 0 && e1 <= 0 && e2 <= 0)) drawPixel(x, y, color);
+        }
+    }
+}
+
+void null_canvas::drawArc(
+    int32_t x, int32_t y, int32_t r, int32_t ir, uint32_t startAngle, uint32_t endAngle, uint32_t fg_color,
+    uint32_t bg_color, bool smoothArc
+) {
+    (void)bg_color;
+    (void)smoothArc;
+    for (uint32_t deg = startAngle; deg < endAngle; ++deg) {
+        // TFT_eSPI arcs start at 6 o'clock and run clockwise
+        float a = (deg + 90) * (float)PI / 180.0f;
+        for (int32_t rr = ir; rr <= r; ++rr) drawPixel(x + lroundf(rr * cosf(a)), y + lroundf(rr * sinf(a)), fg_color);
+    }
+}
+
+void null_canvas::drawWideLine(
+    float ax, float ay, float bx, float by, float wd, uint32_t fg_color, uint32_t bg_color
+) {
+    (void)wd;
+    (void)bg_color;
+    drawLine(lroundf(ax), lroundf(ay), lroundf(bx), lroundf(by), fg_color);
+}
+
+void null_canvas::drawXBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color) {
+    if (!bitmap) return;
+    int32_t stride = (w + 7) / 8;
+    for (int32_t row = 0; row < h; ++row) {
+        for (int32_t col = 0; col < w; ++col) {
+            if (bitmap[row * stride + col / 8] & (1 << (col & 7))) drawPixel(x + col, y + row, color);
+        }
+    }
+}
+
+void null_canvas::drawXBitmap(
+    int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg
+) {
+    fillRect(x, y, w, h, bg);
+    drawXBitmap(x, y, bitmap, w, h, color);
+}
+
+void null_canvas::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+    if (!data) return;
+    for (int32_t row = 0; row < h; ++row) {
+        for (int32_t col = 0; col < w; ++col) {
+            uint16_t color = data[row * w + col];
+            if (_swapBytes) color = static_cast<uint16_t>((color >> 8) | (color << 8));
+            drawPixel(x + col, y + row, color);
+        }
+    }
+}
+
+void null_canvas::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data) {
+    pushImage(x, y, w, h, const_cast<const uint16_t *>(data));
+}
+
+void null_canvas::pushImage(
+    int32_t x, int32_t y, int32_t w, int32_t h, uint8_t *data, bool bpp8, uint16_t *cmap
+) {
+    if (!data || !bpp8 || !cmap) return;
+    for (int32_t row = 0; row < h; ++row) {
+        for (int32_t col = 0; col < w; ++col) drawPixel(x + col, y + row, cmap[data[row * w + col]]);
+    }
+}
+
+void null_canvas::pushImage(
+    int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t *data, bool bpp8, uint16_t *cmap
+) {
+    pushImage(x, y, w, h, const_cast<uint8_t *>(data), bpp8, cmap);
+}
+
+bool null_canvas::dumpPPM(const char *hostPath) const {
+    FILE *f = fopen(hostPath, "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", _width, _height);
+    for (uint16_t c : _fb) {
+        uint8_t rgb[3] = {
+            static_cast<uint8_t>((c >> 8) & 0xF8),
+            static_cast<uint8_t>((c >> 3) & 0xFC),
+            static_cast<uint8_t>((c << 3) & 0xF8)
+        };
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+    return true;
+}
+
+tft_display::tft_display(int16_t _W, int16_t _H) : null_canvas(_W, _H) {}
+
+void tft_display::setRotation(uint8_t r) {
+    _rotation = r & 3;
+    int16_t shortSide = std::min(_width, _height), longSide = std::max(_width, _height);
+    if (_rotation & 1) resize(longSide, shortSide);
+    else resize(shortSide, longSide);
+}
+
+int16_t tft_display::textWidth(const String &s, uint8_t font) const {
+    (void)font;
+    return static_cast<int16_t>(s.length() * 6 * _textSize);
+}
+
+int16_t tft_display::textWidth(const char *s, uint8_t font) const {
+    (void)font;
+    return static_cast<int16_t>(strlen(s) * 6 * _textSize);
+}
+
+void tft_display::setTextColor(uint16_t c, uint16_t b, bool bgfill) {
+    (void)bgfill;
+    _textColor = c;
+    _textBgColor = b;
+}
+
+int16_t tft_display::drawString(const String &string, int32_t x, int32_t y, uint8_t font) {
+    (void)font;
+    return drawAlignedString(string, x, y, _textDatum);
+}
+
+int16_t tft_display::drawCentreString(const String &string, int32_t x, int32_t y, uint8_t font) {
+    (void)font;
+    return drawAlignedString(string, x, y, TC_DATUM);
+}
+
+int16_t tft_display::drawRightString(const String &string, int32_t x, int32_t y, uint8_t font) {
+    (void)font;
+    return drawAlignedString(string, x, y, TR_DATUM);
+}
+
+// There is no font renderer on the host, glyphs are drawn as filled cells
+// so layout and overdraw can still be checked on the framebuffer
+size_t tft_display::write(uint8_t c) {
+    int16_t cw = 6 * _textSize, ch = 8 * _textSize;
+    if (c == '\n') {
+        _cursorX = 0;
+        _cursorY += ch;
+        return 1;
+    }
+    if (c == '\r') return 1;
+    if (_textWrap && _cursorX + cw > _width) {
+        _cursorX = 0;
+        _cursorY += ch;
+    }
+    if (_textBgColor != _textColor) fillRect(_cursorX, _cursorY, cw, ch, _textBgColor);
+    if (c != ' ') fillRect(_cursorX + _textSize, _cursorY + _textSize, cw - 2 * _textSize, ch - 2 * _textSize, _textColor);
+    _cursorX += cw;
+    return 1;
+}
+
+int16_t tft_display::drawAlignedString(const String &s, int32_t x, int32_t y, uint8_t datum) {
+    int16_t w = static_cast<int16_t>(s.length() * 6 * _textSize);
+    int16_t h = static_cast<int16_t>(8 * _textSize);
+    int32_t cx = x;
+    int32_t cy = y;
+    switch (datum) {
+        case TC_DATUM: cx -= w / 2; break;
+        case TR_DATUM: cx -= w; break;
+        case MC_DATUM:
+            cx -= w / 2;
+            cy -= h / 2;
+            break;
+        case MR_DATUM:
+            cx -= w;
+            cy -= h / 2;
+            break;
+        case BC_DATUM:
+            cx -= w / 2;
+            cy -= h;
+            break;
+        case BR_DATUM:
+            cx -= w;
+            cy -= h;
+            break;
+        case BL_DATUM: cy -= h; break;
+        default: break;
+    }
+    bool wrap = _textWrap;
+    _textWrap = false;
+    setCursor(cx, cy);
+    Print::print(s);
+    _textWrap = wrap;
+    return w;
+}
+
+void *tft_sprite::createSprite(int16_t w, int16_t h, uint8_t frames) {
+    (void)frames;
+    resize(w, h);
+    return _fb.empty() ? nullptr : _fb.data();
+}
+
+void tft_sprite::blitTo(null_canvas *dest, int32_t x, int32_t y, uint32_t transparent) const {
+    if (!dest) return;
+    for (int32_t row = 0; row < _height; ++row) {
+        for (int32_t col = 0; col < _width; ++col) {
+            uint16_t c = _fb[row * _width + col];
+            if (c == transparent) continue;
+            dest->drawPixel(x + col, y + row, c);
+        }
+    }
+}
+
+void tft_sprite::pushSprite(int32_t x, int32_t y, uint32_t transparent) {
+    blitTo(_parent, x, y, transparent);
+}
+
+void tft_sprite::pushToSprite(tft_sprite *dest, int32_t x, int32_t y, uint32_t transparent) {
+    blitTo(dest, x, y, transparent);
+}
+
+#endif
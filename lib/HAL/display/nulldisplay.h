@@ -0,0 +1,167 @@
+#ifndef LIB_HAL_NULLDISPLAY_H
+#define LIB_HAL_NULLDISPLAY_H
+#include <pins_arduino.h>
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <cstdarg>
+#include <cstdint>
+#include <vector>
+
+#include "tft_defines.h"
+
+// RGB565 memory canvas shared by the null display and its sprites.
+// Used by the native (host) env: draws land in RAM so they can be inspected,
+// dumped or simply discarded, without any panel attached.
+class null_canvas {
+public:
+    null_canvas(int16_t w = 0, int16_t h = 0) { resize(w, h); }
+
+    void drawPixel(int32_t x, int32_t y, uint32_t color);
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+    void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillRectHGradient(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color1, uint32_t color2);
+    void fillRectVGradient(int16_t x, int16_t y, int16_t w, int16_t h, uint32_t color1, uint32_t color2);
+    void fillScreen(uint32_t color);
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+    void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+    void drawTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
+    void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
+    void drawEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color);
+    void fillEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color);
+    void drawArc(
+        int32_t x, int32_t y, int32_t r, int32_t ir, uint32_t startAngle, uint32_t endAngle,
+        uint32_t fg_color, uint32_t bg_color, bool smoothArc = true
+    );
+    void drawWideLine(
+        float ax, float ay, float bx, float by, float wd, uint32_t fg_color, uint32_t bg_color = 0x00FFFFFF
+    );
+    void drawXBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
+    void drawXBitmap(
+        int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg
+    );
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data);
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t *data, bool bpp8, uint16_t *cmap);
+    void
+    pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t *data, bool bpp8, uint16_t *cmap);
+
+    void setSwapBytes(bool swap) { _swapBytes = swap; }
+    bool getSwapBytes() const { return _swapBytes; }
+    uint16_t color565(uint8_t r, uint8_t g, uint8_t b) const {
+        return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    // Raw RGB565 pixels, row major, width() * height() entries
+    const uint16_t *framebuffer() const { return _fb.empty() ? nullptr : _fb.data(); }
+    uint16_t readPixel(int32_t x, int32_t y) const;
+    // Writes the canvas as a binary PPM, handy to diff screens on the host
+    bool dumpPPM(const char *hostPath) const;
+
+protected:
+    void resize(int16_t w, int16_t h);
+
+    std::vector<uint16_t> _fb;
+    int16_t _width = 0;
+    int16_t _height = 0;
+    bool _swapBytes = false;
+};
+
+class tft_display : public null_canvas, public Print {
+public:
+    explicit tft_display(int16_t _W = TFT_WIDTH, int16_t _H = TFT_HEIGHT);
+    friend class tft_sprite;
+    friend class tft_logger;
+
+    void begin(uint32_t speed = 0) { (void)speed; }
+    void init(uint8_t tc = 0) { (void)tc; }
+    void setRotation(uint8_t r);
+    void invertDisplay(bool i) { (void)i; }
+    void sleep(bool value) { (void)value; }
+
+    int16_t textWidth(const String &s, uint8_t font = 1) const;
+    int16_t textWidth(const char *s, uint8_t font = 1) const;
+
+    void setCursor(int16_t x, int16_t y) {
+        _cursorX = x;
+        _cursorY = y;
+    }
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+    void setTextSize(uint8_t s) { _textSize = s ? s : 1; }
+    void setTextColor(uint16_t c) { _textColor = c; }
+    void setTextColor(uint16_t c, uint16_t b, bool bgfill = false);
+    void setTextDatum(uint8_t d) { _textDatum = d; }
+    uint8_t getTextDatum() const { return _textDatum; }
+    void setTextFont(uint8_t f) { _textFont = f; }
+    void setTextWrap(bool wrapX, bool wrapY = false) { _textWrap = wrapX; }
+    int16_t drawString(const String &string, int32_t x, int32_t y, uint8_t font = 1);
+    int16_t drawCentreString(const String &string, int32_t x, int32_t y, uint8_t font = 1);
+    int16_t drawRightString(const String &string, int32_t x, int32_t y, uint8_t font = 1);
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+    using Print::print;
+    using Print::printf;
+    using Print::println;
+
+    SPIClass &getSPIinstance() { return _spi; }
+    void writecommand(uint8_t c) { (void)c; }
+
+    uint32_t getTextColor() const { return _textColor; }
+    uint32_t getTextBgColor() const { return _textBgColor; }
+    uint8_t getTextSize() const { return _textSize; }
+    uint8_t getRotation() const { return _rotation; }
+    int16_t fontHeight(int16_t font = 1) const { return (void)font, static_cast<int16_t>(_textSize * 8); }
+    null_canvas *native() { return this; }
+
+private:
+    int16_t drawAlignedString(const String &s, int32_t x, int32_t y, uint8_t datum);
+
+    SPIClass _spi;
+    int16_t _cursorX = 0;
+    int16_t _cursorY = 0;
+    uint32_t _textColor = 0xFFFF;
+    uint32_t _textBgColor = 0x0000;
+    uint8_t _textSize = 1;
+    uint8_t _textDatum = 0;
+    uint8_t _textFont = 1;
+    uint8_t _rotation = 0;
+    bool _textWrap = true;
+};
+
+class tft_sprite : public null_canvas {
+public:
+    explicit tft_sprite(tft_display *parent) : _parent(parent) {}
+    ~tft_sprite() = default;
+
+    void *createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+    void deleteSprite() { resize(0, 0); }
+    void setColorDepth(uint8_t depth) { (void)depth; }
+
+    void setCursor(int16_t x, int16_t y) {}
+    void setTextColor(uint16_t c, uint16_t b = 0, bool bgfill = false) {}
+    void setTextDatum(uint8_t d) {}
+    void setTextSize(uint8_t s) {}
+    int16_t drawString(const String &string, int32_t x, int32_t y, uint8_t font = 1) {
+        return static_cast<int16_t>(string.length() * 6);
+    }
+
+    void pushSprite(int32_t x, int32_t y, uint32_t transparent = TFT_TRANSPARENT);
+    void pushToSprite(tft_sprite *dest, int32_t x, int32_t y, uint32_t transparent = TFT_TRANSPARENT);
+
+private:
+    void blitTo(null_canvas *dest, int32_t x, int32_t y, uint32_t transparent) const;
+
+    tft_display *_parent;
+};
+
+#endif // LIB_HAL_NULLDISPLAY_H
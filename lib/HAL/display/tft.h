@@ -2,7 +2,8 @@
 #define LIB_HAL_DISPLAY_TFT_H
 #include <pins_arduino.h>
 
-#if !defined(USE_ARDUINO_GFX) && !defined(USE_LOVYANGFX) && !defined(USE_TFT_ESPI) && !defined(USE_M5GFX)
+#if !defined(USE_ARDUINO_GFX) && !defined(USE_LOVYANGFX) && !defined(USE_TFT_ESPI) && !defined(USE_M5GFX) &&     \
+    !defined(USE_NULL_DISPLAY)
 #define USE_TFT_ESPI
 #endif
 
@@ -22,5 +23,8 @@ class tft_logger;
 #elif defined(USE_M5GFX)
 #include "m5gfx.h"
 
+#elif defined(USE_NULL_DISPLAY)
+#include "nulldisplay.h"
+
 #endif
 #endif // LIB_HAL_DISPLAY_TFT_H
@@ -0,0 +1,37 @@
+#include "Arduino.h"
+#include <chrono>
+#include <random>
+#include <thread>
+
+static const auto bootTime = std::chrono::steady_clock::now();
+static std::mt19937 rng(0xB4CE);
+
+unsigned long millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - bootTime)
+        .count();
+}
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime)
+        .count();
+}
+
+void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+void yield() { std::this_thread::yield(); }
+
+long random(long max) { return max > 0 ? random(0, max) : 0; }
+
+long random(long min, long max) {
+    if (min >= max) return min;
+    return std::uniform_int_distribution<long>(min, max - 1)(rng);
+}
+
+void randomSeed(unsigned long seed) { rng.seed(seed); }
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    if (in_max == in_min) return out_min;
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
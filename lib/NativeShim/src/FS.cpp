@@ -0,0 +1,189 @@
+#include "FS.h"
+#include <cstring>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+class HostFileImpl {
+public:
+    ~HostFileImpl() { close(); }
+    void close() {
+        if (fp) fclose(fp);
+        if (dir) closedir(dir);
+        fp = nullptr;
+        dir = nullptr;
+    }
+
+    const FS *fs = nullptr;
+    std::string path; // path inside the mounted filesystem, always starting with '/'
+    std::string host; // path on the host
+    FILE *fp = nullptr;
+    DIR *dir = nullptr;
+};
+
+static const char *nativeRoot() {
+    const char *root = getenv("BRUCE_NATIVE_ROOT");
+    return root && *root ? root : "./native_fs";
+}
+
+static void makeParents(const std::string &host) {
+    for (size_t i = 1; i < host.size(); i++) {
+        if (host[i] != '/') continue;
+        ::mkdir(host.substr(0, i).c_str(), 0755);
+    }
+}
+
+std::string FS::hostPath(const char *path) const {
+    std::string r = std::string(nativeRoot()) + "/" + _mount;
+    if (!path || path[0] != '/') r += "/";
+    if (path) r += path;
+    return r;
+}
+
+File FS::open(const char *path, const char *mode, const bool create) {
+    if (!path || !mode) return File();
+    auto impl = std::make_shared<HostFileImpl>();
+    impl->fs = this;
+    impl->path = path[0] == '/' ? path : std::string("/") + path;
+    impl->host = hostPath(impl->path.c_str());
+
+    struct stat st;
+    bool found = stat(impl->host.c_str(), &st) == 0;
+    if (found && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(impl->host.c_str());
+        return impl->dir ? File(impl) : File();
+    }
+    if (mode[0] == 'r' && !found) return File();
+    if (create || mode[0] != 'r') makeParents(impl->host);
+
+    std::string m = mode;
+    if (m.find('b') == std::string::npos) m += 'b';
+    impl->fp = fopen(impl->host.c_str(), m.c_str());
+    return impl->fp ? File(impl) : File();
+}
+
+bool FS::exists(const char *path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char *path) { return unlink(hostPath(path).c_str()) == 0; }
+
+bool FS::rename(const char *pathFrom, const char *pathTo) {
+    std::string to = hostPath(pathTo);
+    makeParents(to);
+    return ::rename(hostPath(pathFrom).c_str(), to.c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path) {
+    std::string host = hostPath(path);
+    makeParents(host + "/");
+    struct stat st;
+    return stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool FS::rmdir(const char *path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+
+size_t File::write(const uint8_t *buf, size_t size) {
+    if (!_p || !_p->fp) return 0;
+    return fwrite(buf, 1, size, _p->fp);
+}
+
+int File::available() {
+    if (!_p || !_p->fp) return 0;
+    size_t s = size(), p = position();
+    return p < s ? (int)std::min<size_t>(s - p, 0x7FFFFFFF) : 0;
+}
+
+int File::read() {
+    if (!_p || !_p->fp) return -1;
+    int c = fgetc(_p->fp);
+    return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+    if (!_p || !_p->fp) return -1;
+    int c = fgetc(_p->fp);
+    if (c == EOF) return -1;
+    ungetc(c, _p->fp);
+    return c;
+}
+
+void File::flush() {
+    if (_p && _p->fp) fflush(_p->fp);
+}
+
+size_t File::read(uint8_t *buf, size_t size) {
+    if (!_p || !_p->fp) return 0;
+    return fread(buf, 1, size, _p->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!_p || !_p->fp) return false;
+    int whence = mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END;
+    return fseek(_p->fp, (long)pos, whence) == 0;
+}
+
+size_t File::position() const {
+    if (!_p || !_p->fp) return 0;
+    long p = ftell(_p->fp);
+    return p < 0 ? 0 : (size_t)p;
+}
+
+size_t File::size() const {
+    if (!_p) return 0;
+    if (_p->fp) fflush(_p->fp);
+    struct stat st;
+    return stat(_p->host.c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+    if (_p) _p->close();
+    _p.reset();
+}
+
+File::operator bool() const { return _p && (_p->fp || _p->dir); }
+
+time_t File::getLastWrite() {
+    if (!_p) return 0;
+    struct stat st;
+    return stat(_p->host.c_str(), &st) == 0 ? st.st_mtime : 0;
+}
+
+const char *File::path() const { return _p ? _p->path.c_str() : nullptr; }
+
+const char *File::name() const {
+    if (!_p) return nullptr;
+    size_t slash = _p->path.find_last_of('/');
+    return _p->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+bool File::isDirectory(void) { return _p && _p->dir; }
+
+File File::openNextFile(const char *mode) {
+    if (!_p || !_p->dir) return File();
+    struct dirent *e;
+    while ((e = readdir(_p->dir)) != nullptr) {
+        if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+        std::string child = _p->path == "/" ? "/" + std::string(e->d_name) : _p->path + "/" + e->d_name;
+        return const_cast<FS *>(_p->fs)->open(child.c_str(), mode);
+    }
+    return File();
+}
+
+String File::getNextFileName(bool *isDir) {
+    File f = openNextFile();
+    if (isDir) *isDir = f && f.isDirectory();
+    return f ? String(f.path()) : String();
+}
+
+void File::rewindDirectory(void) {
+    if (_p && _p->dir) rewinddir(_p->dir);
+}
+
+} // namespace fs
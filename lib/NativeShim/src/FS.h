@@ -0,0 +1,96 @@
+#ifndef NATIVE_SHIM_FS_H
+#define NATIVE_SHIM_FS_H
+// fs::FS / fs::File backed by a directory on the host.
+// Each mounted filesystem maps "/" onto <root>/<mount>, where <root> comes from
+// the BRUCE_NATIVE_ROOT environment variable (defaults to ./native_fs).
+#include "Stream.h"
+#include <cstdio>
+#include <ctime>
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class HostFileImpl;
+typedef std::shared_ptr<HostFileImpl> FileImplPtr;
+
+class File : public Stream {
+public:
+    File(FileImplPtr p = FileImplPtr()) : _p(p) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t read(uint8_t *buf, size_t size);
+    size_t readBytes(uint8_t *buffer, size_t length) override { return read(buffer, length); }
+    using Stream::readBytes;
+    bool seek(uint32_t pos, SeekMode mode);
+    bool seek(uint32_t pos) { return seek(pos, SeekSet); }
+    size_t position() const;
+    size_t size() const;
+    void close();
+    operator bool() const;
+    time_t getLastWrite();
+    const char *path() const;
+    const char *name() const;
+
+    bool isDirectory(void);
+    File openNextFile(const char *mode = FILE_READ);
+    String getNextFileName(bool *isDir = nullptr);
+    void rewindDirectory(void);
+
+private:
+    FileImplPtr _p;
+};
+
+class FS {
+public:
+    explicit FS(const char *mount) : _mount(mount) {}
+
+    bool begin(bool formatOnFail = false) { return (void)formatOnFail, true; }
+    void end() {}
+    File open(const char *path, const char *mode = FILE_READ, const bool create = false);
+    File open(const String &path, const char *mode = FILE_READ, const bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool rename(const char *pathFrom, const char *pathTo);
+    bool rename(const String &pathFrom, const String &pathTo) {
+        return rename(pathFrom.c_str(), pathTo.c_str());
+    }
+    bool mkdir(const char *path);
+    bool mkdir(const String &path) { return mkdir(path.c_str()); }
+    bool rmdir(const char *path);
+    bool rmdir(const String &path) { return rmdir(path.c_str()); }
+    uint64_t totalBytes() { return 16ULL * 1024 * 1024; }
+    uint64_t usedBytes() { return 0; }
+
+    // Absolute host path for a path inside this filesystem
+    std::string hostPath(const char *path) const;
+
+private:
+    const char *_mount;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+#endif // NATIVE_SHIM_FS_H
@@ -0,0 +1,34 @@
+#include "HardwareSerial.h"
+#include <cstdio>
+#include <poll.h>
+#include <unistd.h>
+
+HostSerial Serial;
+
+int HostSerial::available() {
+    if (_peeked >= 0) return 1;
+    pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    return poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) ? 1 : 0;
+}
+
+int HostSerial::read() {
+    if (_peeked >= 0) {
+        int c = _peeked;
+        _peeked = -1;
+        return c;
+    }
+    if (!available()) return -1;
+    uint8_t c;
+    return ::read(STDIN_FILENO, &c, 1) == 1 ? c : -1;
+}
+
+int HostSerial::peek() {
+    if (_peeked < 0) _peeked = read();
+    return _peeked;
+}
+
+size_t HostSerial::write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+
+size_t HostSerial::write(const uint8_t *buffer, size_t size) { return fwrite(buffer, 1, size, stdout); }
+
+void HostSerial::flush() { fflush(stdout); }
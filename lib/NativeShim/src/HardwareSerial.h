@@ -0,0 +1,27 @@
+#ifndef NATIVE_SHIM_HARDWARESERIAL_H
+#define NATIVE_SHIM_HARDWARESERIAL_H
+#include "Stream.h"
+
+// Serial port backed by the process stdin/stdout.
+// Reads are non-blocking, so CLI code polling available() keeps running.
+class HostSerial : public Stream {
+public:
+    void begin(unsigned long baud = 115200) { (void)baud; }
+    void end() {}
+    operator bool() const { return true; }
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    void flush() override;
+
+private:
+    int _peeked = -1;
+};
+
+extern HostSerial Serial;
+
+#endif // NATIVE_SHIM_HARDWARESERIAL_H
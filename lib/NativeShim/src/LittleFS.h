@@ -0,0 +1,7 @@
+#ifndef NATIVE_SHIM_LITTLEFS_H
+#define NATIVE_SHIM_LITTLEFS_H
+#include "FS.h"
+
+extern fs::FS LittleFS;
+
+#endif // NATIVE_SHIM_LITTLEFS_H
@@ -0,0 +1,73 @@
+#include "Print.h"
+#include "Stream.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::write(const char *s) {
+    if (!s) return 0;
+    return write((const uint8_t *)s, strlen(s));
+}
+
+size_t Print::printf(const char *format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(small, sizeof(small), format, copy);
+    va_end(copy);
+    if (len < 0) {
+        va_end(args);
+        return 0;
+    }
+    if ((size_t)len < sizeof(small)) {
+        va_end(args);
+        return write((const uint8_t *)small, len);
+    }
+    std::vector<char> big(len + 1);
+    vsnprintf(big.data(), big.size(), format, args);
+    va_end(args);
+    return write((const uint8_t *)big.data(), len);
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0) break;
+        buffer[count++] = (uint8_t)c;
+    }
+    return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0 || c == terminator) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readString() {
+    std::string s;
+    int c;
+    while ((c = read()) >= 0) s += (char)c;
+    return String(s);
+}
+
+String Stream::readStringUntil(char terminator) {
+    std::string s;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) s += (char)c;
+    return String(s);
+}
@@ -0,0 +1,17 @@
+#ifndef NATIVE_SHIM_SD_H
+#define NATIVE_SHIM_SD_H
+#include "FS.h"
+#include "SPI.h"
+
+namespace fs {
+class HostSDFS : public FS {
+public:
+    HostSDFS() : FS("sd") {}
+    template <typename... Args> bool begin(Args...) { return true; }
+    uint64_t cardSize() { return totalBytes(); }
+};
+} // namespace fs
+
+extern fs::HostSDFS SD;
+
+#endif // NATIVE_SHIM_SD_H
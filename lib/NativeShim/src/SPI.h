@@ -0,0 +1,12 @@
+#ifndef NATIVE_SHIM_SPI_H
+#define NATIVE_SHIM_SPI_H
+#include <cstdint>
+
+class SPIClass {
+public:
+    explicit SPIClass(uint8_t bus = 0) { (void)bus; }
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+};
+
+#endif // NATIVE_SHIM_SPI_H
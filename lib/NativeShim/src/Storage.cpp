@@ -0,0 +1,24 @@
+#include "LittleFS.h"
+#include "SD.h"
+#include "native_root.h"
+#include <filesystem>
+#include <stdlib.h>
+
+fs::FS LittleFS("littlefs");
+fs::HostSDFS SD;
+
+static std::string tempRoot;
+
+std::string useTempNativeRoot() {
+    if (!tempRoot.empty()) return tempRoot;
+    const char *tmp = getenv("TMPDIR");
+    std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") + "/bruce_native_XXXXXX";
+    if (!mkdtemp(&pattern[0])) return "";
+    tempRoot = pattern;
+    setenv("BRUCE_NATIVE_ROOT", tempRoot.c_str(), 1);
+    atexit([]() {
+        std::error_code ec;
+        std::filesystem::remove_all(tempRoot, ec);
+    });
+    return tempRoot;
+}
@@ -0,0 +1,107 @@
+#include "WString.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+static std::string toBase(unsigned long long v, unsigned char base, bool negative) {
+    if (base < 2 || base > 36) base = 10;
+    char buf[72];
+    int pos = sizeof(buf) - 1;
+    buf[pos] = 0;
+    do {
+        int digit = v % base;
+        buf[--pos] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        v /= base;
+    } while (v && pos > 1);
+    if (negative) buf[--pos] = '-';
+    return std::string(&buf[pos]);
+}
+
+static std::string signedToBase(long long v, unsigned char base) {
+    if (base == 10 && v < 0) return toBase((unsigned long long)(-(v + 1)) + 1, 10, true);
+    return toBase((unsigned long long)v, base, false);
+}
+
+String::String(unsigned char v, unsigned char base) : _s(toBase(v, base, false)) {}
+String::String(int v, unsigned char base) : _s(signedToBase(v, base)) {}
+String::String(unsigned int v, unsigned char base) : _s(toBase(v, base, false)) {}
+String::String(long v, unsigned char base) : _s(signedToBase(v, base)) {}
+String::String(unsigned long v, unsigned char base) : _s(toBase(v, base, false)) {}
+String::String(long long v, unsigned char base) : _s(signedToBase(v, base)) {}
+String::String(unsigned long long v, unsigned char base) : _s(toBase(v, base, false)) {}
+
+String::String(float v, unsigned int decimals) : String((double)v, decimals) {}
+
+String::String(double v, unsigned int decimals) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    _s = buf;
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+    if (_s.length() != s._s.length()) return false;
+    for (size_t i = 0; i < _s.length(); i++) {
+        if (tolower((unsigned char)_s[i]) != tolower((unsigned char)s._s[i])) return false;
+    }
+    return true;
+}
+
+bool String::startsWith(const String &prefix, unsigned int offset) const {
+    if (offset > _s.length()) return false;
+    return _s.compare(offset, prefix._s.length(), prefix._s) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+    if (suffix._s.length() > _s.length()) return false;
+    return _s.compare(_s.length() - suffix._s.length(), suffix._s.length(), suffix._s) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= _s.length()) return String();
+    if (to > _s.length()) to = _s.length();
+    return String(_s.substr(from, to - from));
+}
+
+void String::replace(char find, char replace) { std::replace(_s.begin(), _s.end(), find, replace); }
+
+void String::replace(const String &find, const String &replace) {
+    if (find._s.empty()) return;
+    size_t pos = 0;
+    while ((pos = _s.find(find._s, pos)) != std::string::npos) {
+        _s.replace(pos, find._s.length(), replace._s);
+        pos += replace._s.length();
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= _s.length()) return;
+    _s.erase(index, count);
+}
+
+void String::toLowerCase() {
+    for (auto &c : _s) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (auto &c : _s) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t b = 0, e = _s.length();
+    while (b < e && isspace((unsigned char)_s[b])) b++;
+    while (e > b && isspace((unsigned char)_s[e - 1])) e--;
+    _s = _s.substr(b, e - b);
+}
+
+void String::getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index) const {
+    if (!bufsize || !buf) return;
+    if (index >= _s.length()) {
+        buf[0] = 0;
+        return;
+    }
+    size_t n = std::min<size_t>(bufsize - 1, _s.length() - index);
+    memcpy(buf, _s.data() + index, n);
+    buf[n] = 0;
+}
@@ -0,0 +1,137 @@
+#ifndef NATIVE_SHIM_WSTRING_H
+#define NATIVE_SHIM_WSTRING_H
+// Host replacement for the Arduino String class, backed by std::string.
+// Only the subset used by Bruce core code is implemented.
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+class String {
+public:
+    String() = default;
+    String(const char *s) : _s(s ? s : "") {}
+    String(const char *s, size_t len) : _s(s ? std::string(s, len) : std::string()) {}
+    explicit String(const std::string &s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    explicit String(unsigned char v, unsigned char base = 10);
+    explicit String(int v, unsigned char base = 10);
+    explicit String(unsigned int v, unsigned char base = 10);
+    explicit String(long v, unsigned char base = 10);
+    explicit String(unsigned long v, unsigned char base = 10);
+    explicit String(long long v, unsigned char base = 10);
+    explicit String(unsigned long long v, unsigned char base = 10);
+    explicit String(float v, unsigned int decimals = 2);
+    explicit String(double v, unsigned int decimals = 2);
+
+    unsigned int length() const { return _s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    const char *c_str() const { return _s.c_str(); }
+    bool reserve(unsigned int size) {
+        _s.reserve(size);
+        return true;
+    }
+    void clear() { _s.clear(); }
+
+    char charAt(unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    void setCharAt(unsigned int i, char c) {
+        if (i < _s.length()) _s[i] = c;
+    }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char &operator[](unsigned int i) { return _s[i]; }
+
+    bool concat(const String &s) {
+        _s += s._s;
+        return true;
+    }
+    bool concat(const char *s) {
+        if (s) _s += s;
+        return true;
+    }
+    bool concat(const char *s, unsigned int len) {
+        if (s) _s.append(s, len);
+        return true;
+    }
+    bool concat(char c) {
+        _s += c;
+        return true;
+    }
+    template <typename T> bool concat(T v) { return concat(String(v)); }
+
+    String &operator+=(const String &s) { return concat(s), *this; }
+    String &operator+=(const char *s) { return concat(s), *this; }
+    String &operator+=(char c) { return concat(c), *this; }
+    template <typename T> String &operator+=(T v) { return concat(String(v)), *this; }
+
+    bool equals(const String &s) const { return _s == s._s; }
+    bool equalsIgnoreCase(const String &s) const;
+    int compareTo(const String &s) const { return _s.compare(s._s); }
+    bool operator==(const String &s) const { return _s == s._s; }
+    bool operator==(const char *s) const { return _s == (s ? s : ""); }
+    bool operator!=(const String &s) const { return _s != s._s; }
+    bool operator!=(const char *s) const { return !(*this == s); }
+    bool operator<(const String &s) const { return _s < s._s; }
+    bool operator>(const String &s) const { return _s > s._s; }
+    bool startsWith(const String &prefix) const { return _s.rfind(prefix._s, 0) == 0; }
+    bool startsWith(const String &prefix, unsigned int offset) const;
+    bool endsWith(const String &suffix) const;
+
+    int indexOf(char c, unsigned int from = 0) const { return npos(_s.find(c, from)); }
+    int indexOf(const String &s, unsigned int from = 0) const { return npos(_s.find(s._s, from)); }
+    int lastIndexOf(char c) const { return npos(_s.rfind(c)); }
+    int lastIndexOf(char c, unsigned int from) const { return npos(_s.rfind(c, from)); }
+    int lastIndexOf(const String &s) const { return npos(_s.rfind(s._s)); }
+    int lastIndexOf(const String &s, unsigned int from) const { return npos(_s.rfind(s._s, from)); }
+    String substring(unsigned int from) const { return substring(from, _s.length()); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(char find, char replace);
+    void replace(const String &find, const String &replace);
+    void remove(unsigned int index) { remove(index, (unsigned int)-1); }
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const { return strtol(_s.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(_s.c_str(), nullptr); }
+    double toDouble() const { return strtod(_s.c_str(), nullptr); }
+
+    void getBytes(unsigned char *buf, unsigned int bufsize, unsigned int index = 0) const;
+    void toCharArray(char *buf, unsigned int bufsize, unsigned int index = 0) const {
+        getBytes((unsigned char *)buf, bufsize, index);
+    }
+
+    const std::string &str() const { return _s; }
+
+private:
+    static int npos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    std::string _s;
+};
+
+inline String operator+(const String &a, const String &b) {
+    String r(a);
+    r += b;
+    return r;
+}
+inline String operator+(const String &a, const char *b) {
+    String r(a);
+    r += b;
+    return r;
+}
+inline String operator+(const char *a, const String &b) {
+    String r(a);
+    r += b;
+    return r;
+}
+inline String operator+(const String &a, char b) {
+    String r(a);
+    r += b;
+    return r;
+}
+template <typename T> inline String operator+(const String &a, T b) {
+    String r(a);
+    r += String(b);
+    return r;
+}
+
+#endif // NATIVE_SHIM_WSTRING_H
@@ -0,0 +1,22 @@
+#ifndef NATIVE_SHIM_ESP_HEAP_CAPS_H
+#define NATIVE_SHIM_ESP_HEAP_CAPS_H
+// The host has a single heap, every capability maps onto malloc/free
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+inline void *heap_caps_malloc(size_t size, uint32_t caps) { return (void)caps, malloc(size); }
+inline void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) { return (void)caps, calloc(n, size); }
+inline void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps) { return (void)caps, realloc(ptr, size); }
+inline void heap_caps_free(void *ptr) { free(ptr); }
+inline void *ps_malloc(size_t size) { return malloc(size); }
+inline void *ps_calloc(size_t n, size_t size) { return calloc(n, size); }
+inline bool psramFound() { return true; }
+
+#endif // NATIVE_SHIM_ESP_HEAP_CAPS_H
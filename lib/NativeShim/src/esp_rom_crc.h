@@ -0,0 +1,16 @@
+#ifndef NATIVE_SHIM_ESP_ROM_CRC_H
+#define NATIVE_SHIM_ESP_ROM_CRC_H
+// Same contract as the ROM routine: crc = esp_rom_crc32_le(crc, buf, len), starting from 0
+#include <cstddef>
+#include <cstdint>
+
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+#endif // NATIVE_SHIM_ESP_ROM_CRC_H
@@ -0,0 +1,10 @@
+#include "Arduino.h"
+
+// Sketches built for the host may only need setup(), or nothing at all
+__attribute__((weak)) void setup() {}
+__attribute__((weak)) void loop() { exit(0); }
+
+int main() {
+    setup();
+    for (;;) loop();
+}
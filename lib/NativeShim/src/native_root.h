@@ -0,0 +1,9 @@
+#ifndef NATIVE_SHIM_NATIVE_ROOT_H
+#define NATIVE_SHIM_NATIVE_ROOT_H
+#include <string>
+
+// Points LittleFS and SD at a fresh directory under $TMPDIR, for tests and benchmarks.
+// The directory is removed when the process exits.
+std::string useTempNativeRoot();
+
+#endif // NATIVE_SHIM_NATIVE_ROOT_H
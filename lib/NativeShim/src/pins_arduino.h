@@ -0,0 +1,15 @@
+#ifndef Pins_Arduino_h
+#define Pins_Arduino_h
+// Virtual board used by the native env: a framebuffer sized like the StickC Plus2
+
+#define HAS_SCREEN 1
+#define ROTATION 1
+#define TFT_WIDTH 135
+#define TFT_HEIGHT 240
+
+#define SDCARD_CS -1
+#define SDCARD_SCK -1
+#define SDCARD_MISO -1
+#define SDCARD_MOSI -1
+
+#endif /* Pins_Arduino_h */
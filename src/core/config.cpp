@@ -1,4 +1,5 @@
 #include "config.h"
+#include "config_store.h"
 #include "mifare_keys_manager.h"
 #include "sd_functions.h"
 
@@ -62,6 +63,7 @@ JsonDocument BruceConfig::toJson() const {
     setting["startupApp"] = startupApp;
     setting["startupAppJSInterpreterFile"] = startupAppJSInterpreterFile;
     setting["wigleBasicToken"] = wigleBasicToken;
+    setting["wardrivingGzip"] = wardrivingGzip;
     setting["devMode"] = devMode;
     setting["colorInverted"] = colorInverted;
 
@@ -94,6 +96,7 @@ void BruceConfig::fromFile(bool checkFS) {
         else return;
     }
 
+    ConfigStore::recover(*fs, filepath);
     if (!fs->exists(filepath)) {
         log_i("Config file not found. Creating default config");
         return saveFile();
@@ -353,6 +356,12 @@ void BruceConfig::fromFile(bool checkFS) {
         count++;
         log_e("Fail");
     }
+    if (!setting["wardrivingGzip"].isNull()) {
+        wardrivingGzip = setting["wardrivingGzip"].as<bool>();
+    } else {
+        count++;
+        log_e("Fail");
+    }
     if (!setting["devMode"].isNull()) {
         devMode = setting["devMode"].as<int>();
     } else {
@@ -418,29 +427,21 @@ void BruceConfig::fromFile(bool checkFS) {
     log_i("Using config from file");
 }
 
+// Takes a snapshot of the settings, the file itself is written by configStore once
+// the changes settle down (see config_store.h). Use commit() to write it right away.
 void BruceConfig::saveFile() {
-    FS *fs = &LittleFS;
-    JsonDocument jsonDoc = toJson();
-
-    // Open file for writing
-    File file = fs->open(filepath, FILE_WRITE);
-    if (!file) {
-        log_e("Failed to open config file");
-        file.close();
+    String payload;
+    if (serializeJsonPretty(toJson(), payload) < 5) {
+        log_e("Failed to serialize config");
         return;
-    };
-
-    // Serialize JSON to file
-    serializeJsonPretty(jsonDoc, Serial);
-    if (serializeJsonPretty(jsonDoc, file) < 5) log_e("Failed to write config file");
-    else log_i("config file written successfully");
-
-    file.close();
-
-    if (setupSdCard()) copyToFs(LittleFS, SD, filepath, false);
+    }
+    configStore.submit(filepath, std::move(payload), setupSdCard());
 }
 
+void BruceConfig::commit() { configStore.flush(); }
+
 void BruceConfig::factoryReset() {
+    configStore.flush();
     FS *fs = &LittleFS;
     fs->rename(String(filepath), "/bak." + String(filepath).substring(1));
     if (setupSdCard()) SD.rename(String(filepath), "/bak." + String(filepath).substring(1));
@@ -723,6 +724,11 @@ void BruceConfig::setWigleBasicToken(String value) {
     saveFile();
 }
 
+void BruceConfig::setWardrivingGzip(bool value) {
+    wardrivingGzip = value;
+    saveFile();
+}
+
 void BruceConfig::setDevMode(int value) {
     devMode = value;
     validateDevModeValue();
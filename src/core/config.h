@@ -82,6 +82,7 @@ public:
     String startupApp = "";
     String startupAppJSInterpreterFile = "";
     String wigleBasicToken = "";
+    bool wardrivingGzip = false; // write wardriving logs as .csv.gz
     int devMode = 0;
     int colorInverted = 1;
     int badUSBBLEKeyboardLayout = 0;
@@ -107,6 +108,7 @@ public:
     // Operations
     /////////////////////////////////////////////////////////////////////////////////////
     void saveFile();
+    void commit();
     void fromFile(bool checkFS = true);
     void factoryReset();
     void validateConfig();
@@ -175,6 +177,7 @@ public:
     void setStartupApp(String value);
     void setStartupAppJSInterpreterFile(String value);
     void setWigleBasicToken(String value);
+    void setWardrivingGzip(bool value);
     void setDevMode(int value);
     void validateDevModeValue();
     void setColorInverted(int value);
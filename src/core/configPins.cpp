@@ -1,4 +1,5 @@
 #include "configPins.h"
+#include "config_store.h"
 #include "esp_mac.h"
 #include "sd_functions.h"
 #include <globals.h>
@@ -249,6 +250,7 @@ void BruceConfigPins::loadFile(JsonDocument &jsonDoc, bool checkFS) {
         else return;
     }
 
+    ConfigStore::recover(*fs, filepath);
     if (!fs->exists(filepath)) return createFile();
 
     File file;
@@ -278,26 +280,18 @@ void BruceConfigPins::fromFile(bool checkFS) {
 void BruceConfigPins::createFile() {
     JsonDocument jsonDoc;
     toJson(jsonDoc.to<JsonObject>());
-    serializeJsonPretty(jsonDoc, Serial);
+    submitFile(jsonDoc);
+}
 
-    // Open file for writing
-    FS *fs = &LittleFS;
-    File file = fs->open(filepath, FILE_WRITE);
-    if (!file) {
-        log_e("Failed to open config file");
-        file.close();
+void BruceConfigPins::submitFile(JsonDocument &jsonDoc) {
+    String payload;
+    if (serializeJsonPretty(jsonDoc, payload) < 5) {
+        log_e("Failed to serialize config pins");
         return;
-    };
-
-    // Serialize JSON to file
-    if (serializeJsonPretty(jsonDoc, file) < 5) log_e("Failed to write config file");
-    else log_i("config file written successfully");
-
-    file.close();
+    }
     jsonDoc.clear();
-
     // don't try to mount SD Card if not previously mounted
-    if (sdcardMounted) copyToFs(LittleFS, SD, filepath, false);
+    configStore.submit(filepath, std::move(payload), sdcardMounted);
 }
 
 void BruceConfigPins::saveFile() {
@@ -308,26 +302,11 @@ void BruceConfigPins::saveFile() {
 
     jsonDoc.remove(getMacAddress());
     toJson(jsonDoc.as<JsonObject>());
-
-    // Open file for writing
-    FS *fs = &LittleFS;
-    File file = fs->open(filepath, FILE_WRITE);
-    if (!file) {
-        log_e("Failed to open config file");
-        return;
-    };
-
-    // Serialize JSON to file
-    if (serializeJsonPretty(jsonDoc, file) < 5) log_e("Failed to write config file");
-    else log_i("config file written successfully");
-
-    file.close();
-    jsonDoc.clear();
-    // don't try to mount SD Card if not previously mounted
-    if (sdcardMounted) copyToFs(LittleFS, SD, filepath, false);
+    submitFile(jsonDoc);
 }
 
 void BruceConfigPins::factoryReset() {
+    configStore.flush();
     FS *fs = &LittleFS;
     fs->rename(String(filepath), "/bak." + String(filepath).substring(1));
     // don't try to mount SD Card if not previously mounted
@@ -213,6 +213,7 @@ public:
     /////////////////////////////////////////////////////////////////////////////////////
     void createFile();
     void saveFile();
+    void submitFile(JsonDocument &jsonDoc);
     void fromFile(bool checkFS = true);
     void loadFile(JsonDocument &jsonDoc, bool checkFS = true);
     void factoryReset();
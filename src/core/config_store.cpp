@@ -0,0 +1,136 @@
+#include "config_store.h"
+#include <LittleFS.h>
+#include <SD.h>
+#include <algorithm>
+#include <globals.h>
+
+ConfigStore configStore;
+
+bool ConfigStore::begin() {
+    if (!_lock) _lock = xSemaphoreCreateMutexStatic(&_lockBuffer);
+    if (!_ioLock) _ioLock = xSemaphoreCreateMutexStatic(&_ioLockBuffer);
+    if (!_task) {
+        BaseType_t res = xTaskCreate(persistTask, "config_store", 4096, this, 1, &_task);
+        if (res != pdPASS) _task = nullptr;
+    }
+    return _task != nullptr;
+}
+
+void ConfigStore::submit(const char *path, String &&payload, bool mirrorToSd) {
+    if (!begin()) {
+        // No task to defer to, write in place like before
+        writeAtomic(LittleFS, path, payload);
+        if (mirrorToSd && sdcardMounted) writeAtomic(SD, path, payload);
+        return;
+    }
+    uint32_t now = millis();
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Entry *entry = nullptr;
+    for (auto &e : _entries) {
+        if (strcmp(e.path, path) == 0) entry = &e;
+    }
+    if (!entry) {
+        _entries.push_back(Entry());
+        entry = &_entries.back();
+        entry->path = path;
+    }
+    if (!entry->dirty) entry->firstChange = now;
+    entry->lastChange = now;
+    entry->payload = std::move(payload);
+    entry->mirrorToSd = entry->mirrorToSd || mirrorToSd;
+    entry->dirty = true;
+    xSemaphoreGive(_lock);
+    xTaskNotifyGive(_task);
+}
+
+bool ConfigStore::pending() {
+    if (!_lock) return false;
+    bool dirty = false;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (auto &e : _entries) dirty = dirty || e.dirty;
+    xSemaphoreGive(_lock);
+    return dirty;
+}
+
+void ConfigStore::flush() {
+    if (!_lock) return;
+    writeDue(true);
+}
+
+// Writes the entries whose quiet period expired (all dirty ones with force) and
+// returns how long until the next one is due, portMAX_DELAY if nothing is pending
+uint32_t ConfigStore::writeDue(bool force) {
+    xSemaphoreTake(_ioLock, portMAX_DELAY);
+    uint32_t nextDue = portMAX_DELAY;
+    for (size_t i = 0;; i++) {
+        Entry snapshot;
+        bool write = false;
+        uint32_t now = millis();
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        if (i >= _entries.size()) {
+            xSemaphoreGive(_lock);
+            break;
+        }
+        Entry &e = _entries[i];
+        if (e.dirty) {
+            uint32_t quiet = now - e.lastChange;
+            uint32_t age = now - e.firstChange;
+            if (force || quiet >= SAVE_DELAY_MS || age >= MAX_DELAY_MS) {
+                snapshot.path = e.path;
+                snapshot.payload = std::move(e.payload);
+                snapshot.mirrorToSd = e.mirrorToSd;
+                e.payload = String();
+                e.mirrorToSd = false;
+                e.dirty = false;
+                write = true;
+            } else {
+                uint32_t wait = std::min(SAVE_DELAY_MS - quiet, MAX_DELAY_MS - age);
+                nextDue = std::min(nextDue, wait);
+            }
+        }
+        xSemaphoreGive(_lock);
+
+        if (!write) continue;
+        if (writeAtomic(LittleFS, snapshot.path, snapshot.payload)) log_i("config file written successfully");
+        else log_e("Failed to write config file %s", snapshot.path);
+        // don't try to mount SD Card from here, only mirror if it's already mounted
+        if (snapshot.mirrorToSd && sdcardMounted && !writeAtomic(SD, snapshot.path, snapshot.payload)) {
+            log_e("Failed to mirror config file %s to SD", snapshot.path);
+        }
+    }
+    xSemaphoreGive(_ioLock);
+    return nextDue;
+}
+
+void ConfigStore::persistTask(void *param) {
+    ConfigStore *store = (ConfigStore *)param;
+    uint32_t wait = portMAX_DELAY;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, wait == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(wait));
+        wait = store->writeDue(false);
+    }
+}
+
+bool ConfigStore::writeAtomic(FS &fs, const char *path, const String &payload) {
+    if (payload.length() < 5) return false;
+    String tmpPath = String(path) + ".tmp";
+    File file = fs.open(tmpPath, FILE_WRITE);
+    if (!file) return false;
+    size_t written = file.write((const uint8_t *)payload.c_str(), payload.length());
+    file.close();
+    if (written != payload.length()) {
+        fs.remove(tmpPath);
+        return false;
+    }
+    // LittleFS replaces the destination on rename, FAT needs it removed first
+    if (fs.rename(tmpPath, path)) return true;
+    fs.remove(path);
+    return fs.rename(tmpPath, path);
+}
+
+void ConfigStore::recover(FS &fs, const char *path) {
+    String tmpPath = String(path) + ".tmp";
+    if (!fs.exists(tmpPath)) return;
+    if (fs.exists(path)) fs.remove(tmpPath);
+    else fs.rename(tmpPath, path);
+}
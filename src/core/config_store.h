@@ -0,0 +1,57 @@
+#ifndef __BRUCE_CONFIG_STORE_H__
+#define __BRUCE_CONFIG_STORE_H__
+
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <vector>
+
+// Deferred persistence for the JSON config files (/bruce.conf, /bruce-pins.conf).
+// Setters hand over a serialized snapshot, only the newest one per file is kept.
+// A background task writes it to LittleFS once no change arrived for SAVE_DELAY_MS
+// (or MAX_DELAY_MS after the first pending change), using a temp file + rename so a
+// power loss never leaves a truncated config, then mirrors it to the SD card.
+class ConfigStore {
+public:
+    static const uint32_t SAVE_DELAY_MS = 1500;
+    static const uint32_t MAX_DELAY_MS = 10000;
+
+    // Replaces the pending content of `path`. mirrorToSd also writes it to the SD root if mounted.
+    void submit(const char *path, String &&payload, bool mirrorToSd);
+    // Writes every pending snapshot now. Restart paths call it (bruceConfig.commit()) before they
+    // leave, power off and deep sleep through beforePowerDown(). Nothing flushes behind their back.
+    void flush();
+    bool pending();
+
+    // Writes `payload` to `path`.tmp and renames it over `path`
+    static bool writeAtomic(FS &fs, const char *path, const String &payload);
+    // Restores `path` from a temp file left by an interrupted writeAtomic
+    static void recover(FS &fs, const char *path);
+
+private:
+    struct Entry {
+        const char *path;
+        String payload;
+        bool mirrorToSd = false;
+        bool dirty = false;
+        uint32_t firstChange = 0;
+        uint32_t lastChange = 0;
+    };
+
+    bool begin();
+    uint32_t writeDue(bool force);
+    static void persistTask(void *param);
+
+    std::vector<Entry> _entries;
+    SemaphoreHandle_t _lock = nullptr; // guards _entries
+    StaticSemaphore_t _lockBuffer;
+    SemaphoreHandle_t _ioLock = nullptr; // serializes writers (task vs flush)
+    StaticSemaphore_t _ioLockBuffer;
+    TaskHandle_t _task = nullptr;
+};
+
+extern ConfigStore configStore;
+
+#endif
@@ -14,6 +14,7 @@ EspConnection::~EspConnection() {
     esp_now_unregister_recv_cb();
 
     esp_now_deinit();
+    endTransfer();
 }
 
 bool EspConnection::beginSend() {
@@ -57,6 +58,21 @@ bool EspConnection::beginEspnow() {
     return true;
 }
 
+bool EspConnection::beginTransfer() {
+    xferSendResult = -1;
+    if (!xferFrames.ready() && !xferFrames.begin(16 * 1024)) return false;
+    xferActive = true;
+    return true;
+}
+
+void EspConnection::endTransfer() {
+    // Cut the recv path off first: once past this, no callback is writing into the ring
+    portENTER_CRITICAL(&xferRecvMux);
+    xferActive = false;
+    portEXIT_CRITICAL(&xferRecvMux);
+    xferFrames.end();
+}
+
 EspConnection::Message EspConnection::createMessage(String text) {
     Message message;
 
@@ -70,19 +86,6 @@ EspConnection::Message EspConnection::createMessage(String text) {
     return message;
 }
 
-EspConnection::Message EspConnection::createFileMessage(File file) {
-    Message message;
-    String path = String(file.path());
-
-    message.isFile = true;
-    message.totalBytes = file.size();
-
-    strncpy(message.filename, file.name(), ESP_FILENAME_SIZE);
-    strncpy(message.filepath, path.substring(0, path.lastIndexOf("/")).c_str(), ESP_FILEPATH_SIZE);
-
-    return message;
-}
-
 EspConnection::Message EspConnection::createPingMessage() {
     Message message;
     message.ping = true;
@@ -179,6 +182,11 @@ void EspConnection::appendPeerToList(const uint8_t *mac) {
 }
 
 void EspConnection::onDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
+    if (xferActive) {
+        // paces the transfer loop, one report per frame: no logging here
+        xferSendResult = status == ESP_NOW_SEND_SUCCESS ? 1 : 0;
+        return;
+    }
     if (status == ESP_NOW_SEND_SUCCESS) {
         sendStatus = SUCCESS;
         Serial.println("ESPNOW send success");
@@ -189,6 +197,18 @@ void EspConnection::onDataSent(const uint8_t *mac_addr, esp_now_send_status_t st
 }
 
 void EspConnection::onDataRecv(const uint8_t *mac, const uint8_t *incomingData, int len) {
+    if (espnowXferIsFrame(incomingData, len, sizeof(Message))) {
+        portENTER_CRITICAL(&xferRecvMux);
+        uint8_t *record = xferActive ? xferFrames.reserve(6 + len) : nullptr;
+        if (record) { // else dropped, the sender will retransmit
+            memcpy(record, mac, 6);
+            memcpy(record + 6, incomingData, len);
+            xferFrames.commit();
+        }
+        portEXIT_CRITICAL(&xferRecvMux);
+        return;
+    }
+
     Message recvMessage;
 
     // Use reinterpret_cast and copy assignment
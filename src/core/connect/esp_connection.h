@@ -1,6 +1,8 @@
 #ifndef __ESP_CONNECTION_H__
 #define __ESP_CONNECTION_H__
 #if !defined(LITE_VERSION)
+#include "espnow_transfer.h"
+#include "modules/wifi/packet_ring.h"
 #include <esp_now.h>
 #include <globals.h>
 #include <vector>
@@ -9,6 +11,17 @@
 #define ESP_FILEPATH_SIZE 50
 #define ESP_DATA_SIZE 150
 
+// Sends protocol v2 frames (espnow_transfer.h) to one peer
+class EspNowRadioTransport : public EspNowTransport {
+public:
+    explicit EspNowRadioTransport(const uint8_t *mac) { setPeer(mac); }
+    void setPeer(const uint8_t *mac) { memcpy(_mac, mac, 6); }
+    bool send(const uint8_t *frame, size_t len) override { return esp_now_send(_mac, frame, len) == ESP_OK; }
+
+private:
+    uint8_t _mac[6];
+};
+
 class EspConnection {
 public:
     enum Status {
@@ -54,11 +67,20 @@ protected:
     uint8_t broadcastAddress[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
     std::vector<Message> recvQueue;
 
+    // Protocol v2 frames, filled by the radio callbacks and drained by the transfer loop.
+    // Records are the sender MAC (6 bytes) followed by the frame.
+    PacketRing xferFrames;
+    volatile int8_t xferSendResult = -1; // last onDataSent status, -1 once consumed
+    volatile bool xferActive = false;
+    portMUX_TYPE xferRecvMux = portMUX_INITIALIZER_UNLOCKED; // xferActive vs a recv callback in the ring
+
     bool beginSend();
     bool beginEspnow();
 
+    bool beginTransfer();
+    void endTransfer();
+
     Message createMessage(String text);
-    Message createFileMessage(File file);
     Message createPingMessage();
     Message createPongMessage();
 
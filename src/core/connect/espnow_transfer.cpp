@@ -0,0 +1,463 @@
+#if !defined(LITE_VERSION)
+#include "espnow_transfer.h"
+#include <string.h>
+
+static void putHeader(uint8_t *frame, uint8_t type, uint8_t session, uint32_t seq) {
+    frame[0] = ESPNOW_XFER_MAGIC;
+    frame[1] = type;
+    frame[2] = session;
+    frame[3] = seq & 0xFF;
+    frame[4] = (seq >> 8) & 0xFF;
+    frame[5] = (seq >> 16) & 0xFF;
+}
+
+static uint32_t getSeq(const uint8_t *frame) {
+    return frame[3] | (frame[4] << 8) | ((uint32_t)frame[5] << 16);
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool espnowXferIsFrame(const uint8_t *frame, size_t len, size_t legacyMessageSize) {
+    return len >= ESPNOW_XFER_HEADER_SIZE && len <= ESPNOW_XFER_MAX_FRAME && len != legacyMessageSize &&
+           frame[0] == ESPNOW_XFER_MAGIC && frame[1] >= XFER_SESSION && frame[1] <= XFER_ABORT;
+}
+
+uint32_t espnowXferCrc32(uint32_t crc, const uint8_t *data, size_t len) {
+    // Nibble table: 64 bytes of flash, fast enough for radio rates
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+/*********************************************************************
+**  Sender
+**********************************************************************/
+bool EspNowFileSender::begin(
+    File &file, const String &dir, const String &name, uint32_t now, uint8_t window
+) {
+    static uint8_t sessionCounter = 0;
+
+    _path = dir + "/" + name;
+    if (!file || _path.length() + 6 > ESPNOW_XFER_PAYLOAD) return false;
+
+    _file = &file;
+    _file->seek(0, SeekSet);
+    _size = file.size();
+    _chunks = (_size + ESPNOW_XFER_PAYLOAD - 1) / ESPNOW_XFER_PAYLOAD;
+    _window = window < 1 ? 1 : (window > ESPNOW_XFER_MAX_WINDOW ? ESPNOW_XFER_MAX_WINDOW : window);
+    _session = (uint8_t)(now ^ (++sessionCounter * 37)) | 1;
+    _base = _next = 0;
+    _crc = 0;
+    _txBusy = false;
+    _txSeq = -1;
+    _controlTries = 0;
+    _lastHeard = now;
+    _retransmits = 0;
+    memset(_slots, 0, sizeof(_slots));
+    _state = XFER_CONNECTING;
+    sendControl(XFER_SESSION, now);
+    return true;
+}
+
+uint32_t EspNowFileSender::bytesAcked() const {
+    uint64_t acked = (uint64_t)_base * ESPNOW_XFER_PAYLOAD;
+    return acked > _size ? _size : (uint32_t)acked;
+}
+
+bool EspNowFileSender::sendControl(uint8_t type, uint32_t now) {
+    if (_txBusy) return false;
+
+    uint8_t frame[ESPNOW_XFER_MAX_FRAME];
+    size_t len = ESPNOW_XFER_HEADER_SIZE;
+    putHeader(frame, type, _session, 0);
+    if (type == XFER_SESSION) {
+        put32(frame + len, _size);
+        frame[len + 4] = _window;
+        memcpy(frame + len + 5, _path.c_str(), _path.length() + 1);
+        len += 5 + _path.length() + 1;
+    } else if (type == XFER_END) {
+        put32(frame + len, _crc);
+        len += 4;
+    }
+
+    _lastControl = now;
+    _controlTries++;
+    _txSeq = -1;
+    _txBusy = _transport.send(frame, len);
+    return _txBusy;
+}
+
+bool EspNowFileSender::sendChunk(uint32_t seq, uint32_t now) {
+    uint8_t frame[ESPNOW_XFER_MAX_FRAME];
+    uint32_t offset = seq * ESPNOW_XFER_PAYLOAD;
+    size_t len = _size - offset < ESPNOW_XFER_PAYLOAD ? _size - offset : ESPNOW_XFER_PAYLOAD;
+
+    if (_file->position() != offset) _file->seek(offset, SeekSet);
+    if (_file->read(frame + ESPNOW_XFER_HEADER_SIZE, len) != len) {
+        fail(XFER_FAILED);
+        return false;
+    }
+    putHeader(frame, XFER_DATA, _session, seq);
+
+    Slot &s = slot(seq);
+    if (seq == _next) {
+        // first transmission, chunks leave in order so the CRC follows the file
+        _crc = espnowXferCrc32(_crc, frame + ESPNOW_XFER_HEADER_SIZE, len);
+        _next++;
+        s.retries = 0;
+        s.acked = false;
+    } else {
+        s.retries++;
+        _retransmits++;
+    }
+    s.sentAt = now;
+    s.lost = false;
+
+    _txSeq = seq;
+    _txBusy = _transport.send(frame, ESPNOW_XFER_HEADER_SIZE + len);
+    return _txBusy;
+}
+
+void EspNowFileSender::advanceBase() {
+    while (_base < _next && slot(_base).acked) _base++;
+    if (_state == XFER_SENDING && _base == _chunks) {
+        _state = XFER_CLOSING;
+        _controlTries = 0;
+    }
+}
+
+void EspNowFileSender::fail(EspNowXferState state) {
+    uint8_t frame[ESPNOW_XFER_HEADER_SIZE];
+    putHeader(frame, XFER_ABORT, _session, 0);
+    _transport.send(frame, sizeof(frame));
+    _state = state;
+}
+
+void EspNowFileSender::abort() {
+    if (_state != XFER_IDLE && !finished()) fail(XFER_ABORTED);
+}
+
+void EspNowFileSender::poll(uint32_t now) {
+    if (_state == XFER_IDLE || finished()) return;
+    if (now - _lastHeard > ESPNOW_XFER_IDLE_TIMEOUT_MS) return fail(XFER_FAILED);
+    if (_txBusy) return;
+
+    if (_state == XFER_CONNECTING || _state == XFER_CLOSING) {
+        if (_controlTries > 0 && now - _lastControl < ESPNOW_XFER_CONTROL_RETRY_MS) return;
+        if (_controlTries >= ESPNOW_XFER_MAX_RETRIES) return fail(XFER_FAILED);
+        sendControl(_state == XFER_CONNECTING ? XFER_SESSION : XFER_END, now);
+        return;
+    }
+
+    // Retransmissions first, oldest chunk first
+    for (uint32_t seq = _base; seq < _next; seq++) {
+        Slot &s = slot(seq);
+        if (s.acked || (!s.lost && now - s.sentAt < ESPNOW_XFER_RTO_MS)) continue;
+        if (s.retries >= ESPNOW_XFER_MAX_RETRIES) return fail(XFER_FAILED);
+        sendChunk(seq, now);
+        return;
+    }
+
+    if (_next < _chunks && _next < _base + _window) sendChunk(_next, now);
+}
+
+void EspNowFileSender::onSent(bool ok) {
+    _txBusy = false;
+    if (!ok && _txSeq >= (int32_t)_base && _txSeq < (int32_t)_next) {
+        Slot &s = slot(_txSeq);
+        if (!s.acked) s.lost = true;
+    }
+    _txSeq = -1;
+}
+
+void EspNowFileSender::onFrame(const uint8_t *frame, size_t len, uint32_t now) {
+    if (len < ESPNOW_XFER_HEADER_SIZE || frame[0] != ESPNOW_XFER_MAGIC || frame[2] != _session) return;
+    if (_state == XFER_IDLE || finished()) return;
+    _lastHeard = now;
+
+    const uint8_t *payload = frame + ESPNOW_XFER_HEADER_SIZE;
+    size_t payloadLen = len - ESPNOW_XFER_HEADER_SIZE;
+    switch (frame[1]) {
+        case XFER_SESSION_ACK:
+            if (_state != XFER_CONNECTING || payloadLen < 2) return;
+            if (payload[0] != 0) return fail(XFER_FAILED);
+            if (payload[1] >= 1 && payload[1] < _window) _window = payload[1];
+            _state = XFER_SENDING;
+            advanceBase(); // empty file: straight to END
+            break;
+
+        case XFER_ACK: {
+            if (_state != XFER_SENDING || payloadLen < 4) return;
+            uint32_t cumulative = getSeq(frame);
+            uint32_t bitmap = get32(payload);
+            for (uint32_t seq = _base; seq < cumulative && seq < _next; seq++) slot(seq).acked = true;
+            // Chunks below the highest one received are gone, unless they were just resent
+            int highest = -1;
+            for (int i = 0; i < ESPNOW_XFER_MAX_WINDOW; i++) {
+                if (bitmap & (1UL << i)) highest = i;
+            }
+            for (int i = -1; i <= highest; i++) {
+                uint32_t seq = cumulative + 1 + i;
+                if (seq < _base || seq >= _next) continue;
+                Slot &s = slot(seq);
+                if (i >= 0 && (bitmap & (1UL << i))) {
+                    s.acked = true;
+                } else if (!s.acked && now - s.sentAt >= ESPNOW_XFER_RTO_MS / 5) {
+                    s.lost = true;
+                }
+            }
+            advanceBase();
+            break;
+        }
+
+        case XFER_END_ACK:
+            if (_state != XFER_CLOSING || payloadLen < 1) return;
+            _state = payload[0] == 0 ? XFER_DONE : XFER_FAILED;
+            break;
+
+        case XFER_ABORT: _state = XFER_ABORTED; break;
+    }
+}
+
+/*********************************************************************
+**  Receiver
+**********************************************************************/
+EspNowFileReceiver::~EspNowFileReceiver() { release(); }
+
+uint32_t EspNowFileReceiver::chunkLen(uint32_t seq) const {
+    uint32_t offset = seq * ESPNOW_XFER_PAYLOAD;
+    return _size - offset < ESPNOW_XFER_PAYLOAD ? _size - offset : ESPNOW_XFER_PAYLOAD;
+}
+
+void EspNowFileReceiver::sendControl(uint8_t type, const uint8_t *payload, size_t len) {
+    uint8_t frame[ESPNOW_XFER_MAX_FRAME];
+    putHeader(frame, type, _session, type == XFER_ACK ? _expected : 0);
+    if (len) memcpy(frame + ESPNOW_XFER_HEADER_SIZE, payload, len);
+    _transport.send(frame, ESPNOW_XFER_HEADER_SIZE + len);
+}
+
+void EspNowFileReceiver::sendAck() {
+    uint8_t bitmap[4];
+    put32(bitmap, _present);
+    sendControl(XFER_ACK, bitmap, sizeof(bitmap));
+    _unacked = 0;
+}
+
+void EspNowFileReceiver::release() {
+    free(_reorder);
+    _reorder = nullptr;
+    free(_writeBuf);
+    _writeBuf = nullptr;
+    if (_file) _file.close();
+}
+
+void EspNowFileReceiver::startSession(const uint8_t *frame, size_t len, uint32_t now) {
+    const uint8_t *payload = frame + ESPNOW_XFER_HEADER_SIZE;
+    size_t payloadLen = len - ESPNOW_XFER_HEADER_SIZE;
+    if (payloadLen < 6 || payload[payloadLen - 1] != '\0') return;
+
+    _session = frame[2];
+    _size = get32(payload);
+    _chunks = (_size + ESPNOW_XFER_PAYLOAD - 1) / ESPNOW_XFER_PAYLOAD;
+    _window = payload[4] < 1 ? 1 : payload[4];
+    if (_window > ESPNOW_XFER_MAX_WINDOW) _window = ESPNOW_XFER_MAX_WINDOW;
+    _expected = _received = _crc = _present = 0;
+    _writeLen = 0;
+    _writeError = false;
+    _unacked = 0;
+    _lastHeard = now;
+
+    String path = String((const char *)payload + 5);
+    int slash = path.lastIndexOf('/');
+    String dir = slash > 0 ? path.substring(0, slash) : String(""); // "" is the root, as in v1
+    String name = path.substring(slash + 1);
+
+    uint8_t ack[2] = {0, _window};
+    _reorder = (uint8_t *)malloc(_window * ESPNOW_XFER_PAYLOAD);
+    _writeBuf = (uint8_t *)malloc(WRITE_BUFFER_SIZE);
+    if (_reorder && _writeBuf) _file = _open(dir, name, _size);
+    if (!_file) {
+        ack[0] = 1;
+        release();
+        _state = XFER_FAILED;
+    } else {
+        _state = XFER_SENDING;
+    }
+    sendControl(XFER_SESSION_ACK, ack, sizeof(ack));
+}
+
+void EspNowFileReceiver::flush() {
+    if (_writeLen == 0) return;
+    if (_file.write(_writeBuf, _writeLen) != _writeLen) _writeError = true;
+    _writeLen = 0;
+}
+
+void EspNowFileReceiver::append(const uint8_t *data, size_t len) {
+    _crc = espnowXferCrc32(_crc, data, len);
+    if (_writeLen + len > WRITE_BUFFER_SIZE) flush();
+    memcpy(_writeBuf + _writeLen, data, len);
+    _writeLen += len;
+    _received += len;
+}
+
+void EspNowFileReceiver::onData(uint32_t seq, const uint8_t *data, size_t len, uint32_t now) {
+    if (seq >= _chunks || len != chunkLen(seq)) return;
+
+    if (seq < _expected) {
+        sendAck(); // our ack was lost
+        return;
+    }
+    if (seq >= _expected + _window) return;
+
+    if (seq > _expected) {
+        uint32_t bit = 1UL << (seq - _expected - 1);
+        if (!(_present & bit)) {
+            memcpy(_reorder + (seq % _window) * ESPNOW_XFER_PAYLOAD, data, len);
+            _present |= bit;
+        }
+        sendAck(); // tells the sender about the gap right away
+        return;
+    }
+
+    append(data, len);
+    _expected++;
+    // bit i now stands for _expected + i: drain what was waiting behind the gap
+    bool ready = _present & 1;
+    _present >>= 1;
+    while (ready) {
+        append(_reorder + (_expected % _window) * ESPNOW_XFER_PAYLOAD, chunkLen(_expected));
+        _expected++;
+        ready = _present & 1;
+        _present >>= 1;
+    }
+
+    if (_unacked++ == 0) _firstUnackedAt = now;
+    if (_unacked >= (_window + 3) / 4 || _expected == _chunks) sendAck();
+}
+
+void EspNowFileReceiver::finish(uint32_t crc) {
+    flush();
+    if (_writeError) {
+        _endStatus = 2;
+    } else if (_expected != _chunks || _received != _size || crc != _crc) {
+        _endStatus = 1;
+    } else {
+        _endStatus = 0;
+    }
+    release();
+    _state = _endStatus == 0 ? XFER_DONE : XFER_FAILED;
+    sendControl(XFER_END_ACK, &_endStatus, 1);
+}
+
+void EspNowFileReceiver::onFrame(const uint8_t *frame, size_t len, uint32_t now) {
+    if (len < ESPNOW_XFER_HEADER_SIZE || frame[0] != ESPNOW_XFER_MAGIC) return;
+
+    if (frame[1] == XFER_SESSION) {
+        if (_state == XFER_IDLE) return startSession(frame, len, now);
+        if (frame[2] == _session) {
+            // the sender missed our answer
+            uint8_t ack[2] = {(uint8_t)(_state == XFER_FAILED ? 1 : 0), _window};
+            sendControl(XFER_SESSION_ACK, ack, sizeof(ack));
+        }
+        return;
+    }
+    if (_state == XFER_IDLE || frame[2] != _session) return;
+    _lastHeard = now;
+
+    switch (frame[1]) {
+        case XFER_DATA:
+            if (_state == XFER_SENDING) {
+                onData(getSeq(frame), frame + ESPNOW_XFER_HEADER_SIZE, len - ESPNOW_XFER_HEADER_SIZE, now);
+            } else if (_state == XFER_DONE) {
+                sendAck(); // late retransmission, everything is here
+            }
+            break;
+
+        case XFER_END:
+            if (len < ESPNOW_XFER_HEADER_SIZE + 4) return;
+            if (_state == XFER_SENDING) {
+                finish(get32(frame + ESPNOW_XFER_HEADER_SIZE));
+            } else if (_state == XFER_DONE || _state == XFER_FAILED) {
+                sendControl(XFER_END_ACK, &_endStatus, 1); // END_ACK was lost
+            }
+            break;
+
+        case XFER_ABORT:
+            if (finished()) return;
+            release();
+            _state = XFER_ABORTED;
+            break;
+    }
+}
+
+void EspNowFileReceiver::poll(uint32_t now) {
+    if (_state != XFER_SENDING) return;
+    if (now - _lastHeard > ESPNOW_XFER_IDLE_TIMEOUT_MS) {
+        release();
+        _state = XFER_FAILED;
+        return;
+    }
+    // Don't leave the tail of a burst unacked until the sender times out
+    if (_unacked > 0 && now - _firstUnackedAt >= ESPNOW_XFER_RTO_MS / 10) sendAck();
+}
+
+void EspNowFileReceiver::abort() {
+    if (_state == XFER_IDLE || finished()) {
+        _state = XFER_ABORTED;
+        return;
+    }
+    sendControl(XFER_ABORT, nullptr, 0);
+    release();
+    _state = XFER_ABORTED;
+}
+
+/*********************************************************************
+**  Loopback transport
+**********************************************************************/
+bool EspNowLoopback::send(const uint8_t *frame, size_t len) {
+    _sent++;
+    bool delivered = _dropEvery == 0 || _sent % _dropEvery != 0;
+    if (delivered && _peer) _peer->_inbox.emplace_back(frame, frame + len);
+    _reports.push_back(delivered);
+    return true;
+}
+
+void EspNowLoopback::deliver(EspNowFileSender &sender, uint32_t now) {
+    while (!_reports.empty()) {
+        bool ok = _reports.front();
+        _reports.pop_front();
+        sender.onSent(ok);
+    }
+    while (!_inbox.empty()) {
+        std::vector<uint8_t> frame = std::move(_inbox.front());
+        _inbox.pop_front();
+        sender.onFrame(frame.data(), frame.size(), now);
+    }
+}
+
+void EspNowLoopback::deliver(EspNowFileReceiver &receiver, uint32_t now) {
+    _reports.clear(); // the receiver doesn't pace on send reports
+    while (!_inbox.empty()) {
+        std::vector<uint8_t> frame = std::move(_inbox.front());
+        _inbox.pop_front();
+        receiver.onFrame(frame.data(), frame.size(), now);
+    }
+}
+#endif
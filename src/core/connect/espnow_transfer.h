@@ -0,0 +1,204 @@
+#ifndef __ESPNOW_TRANSFER_H__
+#define __ESPNOW_TRANSFER_H__
+#if !defined(LITE_VERSION)
+#include <Arduino.h>
+#include <FS.h>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// ESP-NOW file transfer, protocol v2.
+//
+// Every frame starts with a 6 byte header: magic, type, session id and a 24 bit sequence number.
+//   SESSION      sender -> receiver   size, window, "dir/name"      (repeated until SESSION_ACK)
+//   SESSION_ACK  receiver -> sender   status, window granted
+//   DATA         sender -> receiver   up to ESPNOW_XFER_PAYLOAD bytes of chunk `seq`
+//   ACK          receiver -> sender   seq = next expected chunk, bitmap of the 32 chunks after it
+//   END          sender -> receiver   CRC32 of the whole file       (repeated until END_ACK)
+//   END_ACK      receiver -> sender   status
+//   ABORT        either way
+// The sender keeps up to `window` chunks in flight and sends one frame at a time: the next one
+// leaves when the radio reports the previous one (onSent), so a failed MAC ack is retransmitted
+// at once. Chunks missing from the ACK bitmap or unacked for ESPNOW_XFER_RTO_MS are resent.
+//
+// The engine has no radio nor RTOS dependency: frames go through an EspNowTransport, incoming
+// ones and send reports are handed in by the caller, time comes from poll(now). See
+// EspNowLoopback to run both ends on a host.
+
+#define ESPNOW_XFER_MAGIC 0xB5
+#define ESPNOW_XFER_HEADER_SIZE 6
+#define ESPNOW_XFER_PAYLOAD 240
+#define ESPNOW_XFER_MAX_FRAME (ESPNOW_XFER_HEADER_SIZE + ESPNOW_XFER_PAYLOAD)
+#define ESPNOW_XFER_MAX_WINDOW 32
+#define ESPNOW_XFER_RTO_MS 250
+#define ESPNOW_XFER_CONTROL_RETRY_MS 300
+#define ESPNOW_XFER_MAX_RETRIES 20
+#define ESPNOW_XFER_IDLE_TIMEOUT_MS 5000
+// A finished receiver keeps answering this long, for a sender that missed the END_ACK
+#define ESPNOW_XFER_LINGER_MS (3 * ESPNOW_XFER_CONTROL_RETRY_MS)
+
+enum EspNowXferFrame : uint8_t {
+    XFER_SESSION = 1,
+    XFER_SESSION_ACK,
+    XFER_DATA,
+    XFER_ACK,
+    XFER_END,
+    XFER_END_ACK,
+    XFER_ABORT,
+};
+
+enum EspNowXferState : uint8_t {
+    XFER_IDLE,
+    XFER_CONNECTING,
+    XFER_SENDING,
+    XFER_CLOSING,
+    XFER_DONE,
+    XFER_FAILED,
+    XFER_ABORTED,
+};
+
+// True for frames of this protocol, v1 EspConnection::Message frames are never this size
+bool espnowXferIsFrame(const uint8_t *frame, size_t len, size_t legacyMessageSize);
+
+// Standard (zlib) CRC32, `crc` is the value returned by the previous call, 0 to start
+uint32_t espnowXferCrc32(uint32_t crc, const uint8_t *data, size_t len);
+
+class EspNowTransport {
+public:
+    virtual ~EspNowTransport() {}
+    // Queues one frame. The outcome is reported later through the endpoint's onSent().
+    // Returns false when the frame could not even be queued.
+    virtual bool send(const uint8_t *frame, size_t len) = 0;
+};
+
+class EspNowFileSender {
+public:
+    explicit EspNowFileSender(EspNowTransport &transport) : _transport(transport) {}
+
+    // `file` must stay open until the transfer is finished
+    bool begin(File &file, const String &dir, const String &name, uint32_t now, uint8_t window = 16);
+    void poll(uint32_t now);
+    void onSent(bool ok);
+    void onFrame(const uint8_t *frame, size_t len, uint32_t now);
+    void abort();
+
+    EspNowXferState state() const { return _state; }
+    bool finished() const { return _state >= XFER_DONE; }
+    uint32_t totalBytes() const { return _size; }
+    uint32_t bytesAcked() const;
+    uint32_t retransmits() const { return _retransmits; }
+
+private:
+    struct Slot {
+        uint32_t sentAt;
+        uint8_t retries;
+        bool acked;
+        bool lost;
+    };
+
+    EspNowTransport &_transport;
+    File *_file = nullptr;
+    String _path;
+    EspNowXferState _state = XFER_IDLE;
+    uint8_t _session = 0;
+    uint8_t _window = 16;
+    uint32_t _size = 0;
+    uint32_t _chunks = 0;
+    uint32_t _base = 0; // first unacked chunk
+    uint32_t _next = 0; // first chunk never sent
+    uint32_t _crc = 0;  // over chunks [0, _next)
+    Slot _slots[ESPNOW_XFER_MAX_WINDOW];
+    bool _txBusy = false;
+    int32_t _txSeq = -1; // data chunk waiting for its send report
+    uint32_t _lastControl = 0;
+    uint8_t _controlTries = 0;
+    uint32_t _lastHeard = 0;
+    uint32_t _retransmits = 0;
+
+    Slot &slot(uint32_t seq) { return _slots[seq % ESPNOW_XFER_MAX_WINDOW]; }
+    bool sendControl(uint8_t type, uint32_t now);
+    bool sendChunk(uint32_t seq, uint32_t now);
+    void advanceBase();
+    void fail(EspNowXferState state);
+};
+
+class EspNowFileReceiver {
+public:
+    // Opens the destination for a new session, an invalid File refuses it
+    typedef std::function<File(const String &dir, const String &name, uint32_t size)> OpenCallback;
+
+    EspNowFileReceiver(EspNowTransport &transport, OpenCallback open) : _transport(transport), _open(open) {}
+    ~EspNowFileReceiver();
+
+    void onFrame(const uint8_t *frame, size_t len, uint32_t now);
+    void poll(uint32_t now);
+    void abort();
+
+    EspNowXferState state() const { return _state; }
+    bool finished() const { return _state >= XFER_DONE; }
+    uint32_t totalBytes() const { return _size; }
+    uint32_t bytesReceived() const { return _received; }
+
+private:
+    static const size_t WRITE_BUFFER_SIZE = 4096;
+
+    EspNowTransport &_transport;
+    OpenCallback _open;
+    File _file;
+    EspNowXferState _state = XFER_IDLE;
+    uint8_t _session = 0;
+    uint8_t _window = 16;
+    uint32_t _size = 0;
+    uint32_t _chunks = 0;
+    uint32_t _expected = 0; // next in-order chunk
+    uint32_t _received = 0; // bytes written in order
+    uint32_t _crc = 0;
+    uint8_t *_reorder = nullptr; // _window chunks after _expected
+    uint32_t _present = 0;       // bit i: chunk _expected + 1 + i is in _reorder
+    uint8_t *_writeBuf = nullptr;
+    size_t _writeLen = 0;
+    bool _writeError = false;
+    uint8_t _unacked = 0;
+    uint32_t _firstUnackedAt = 0;
+    uint32_t _lastHeard = 0;
+    uint8_t _endStatus = 0;
+
+    uint32_t chunkLen(uint32_t seq) const;
+    void startSession(const uint8_t *frame, size_t len, uint32_t now);
+    void onData(uint32_t seq, const uint8_t *data, size_t len, uint32_t now);
+    void append(const uint8_t *data, size_t len);
+    void flush();
+    void finish(uint32_t crc);
+    void sendAck();
+    void sendControl(uint8_t type, const uint8_t *payload, size_t len);
+    void release();
+};
+
+// In-memory transport: whatever one end sends is queued for the other. dropEvery > 0 loses one
+// frame in dropEvery (reported as a failed send, like a missing MAC ack) to exercise retransmits.
+//   EspNowLoopback a, b; a.connect(&b); ...
+//   loop: sender.poll(t); receiver.poll(t);
+//         a.deliver(sender, t); b.deliver(receiver, t);
+class EspNowLoopback : public EspNowTransport {
+public:
+    void connect(EspNowLoopback *peer) {
+        _peer = peer;
+        peer->_peer = this;
+    }
+    void setDropEvery(uint32_t n) { _dropEvery = n; }
+    bool send(const uint8_t *frame, size_t len) override;
+
+    void deliver(EspNowFileSender &sender, uint32_t now);
+    void deliver(EspNowFileReceiver &receiver, uint32_t now);
+    uint32_t framesSent() const { return _sent; }
+
+private:
+    EspNowLoopback *_peer = nullptr;
+    uint32_t _dropEvery = 0;
+    uint32_t _sent = 0;
+    std::deque<std::vector<uint8_t>> _inbox;
+    std::deque<bool> _reports;
+};
+
+#endif
+#endif
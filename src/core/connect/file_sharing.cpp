@@ -15,47 +15,62 @@ void FileSharing::sendFile() {
         delay(1000);
         return;
     }
+    if (!beginTransfer()) {
+        displayError("Out of memory");
+        delay(1000);
+        return;
+    }
 
-    Message message = createFileMessage(file);
-
-    esp_err_t response;
-    sendStatus = STARTED;
+    String path = String(file.path());
+    EspNowRadioTransport transport(dstAddress);
+    EspNowFileSender sender(transport);
+    if (!sender.begin(file, path.substring(0, path.lastIndexOf("/")), file.name(), millis())) {
+        displayError("File path too long");
+        file.close();
+        endTransfer();
+        delay(1000);
+        return;
+    }
 
     drawMainBorderWithTitle("SEND FILE");
     padprintln("");
     padprintln("Sending...");
 
-    delay(100);
-
-    while (file.available()) {
-        if (check(EscPress)) sendStatus = ABORTED;
+    uint32_t lastDraw = 0;
+    while (!sender.finished()) {
+        if (check(EscPress)) sender.abort();
 
-        if (sendStatus == ABORTED || sendStatus == FAILED) {
-            message.done = true;
-            message.dataSize = 0;
-            esp_now_send(dstAddress, (uint8_t *)&message, sizeof(message));
-            displayError("Error sending file");
-            break;
+        int8_t sent = xferSendResult;
+        if (sent >= 0) {
+            xferSendResult = -1;
+            sender.onSent(sent == 1);
         }
-
-        size_t bytesRead = file.readBytes(message.data, ESP_DATA_SIZE);
-        message.dataSize = bytesRead;
-        message.bytesSent = min(message.bytesSent + bytesRead, message.totalBytes);
-        message.done = message.bytesSent == message.totalBytes;
-
-        response = esp_now_send(dstAddress, (uint8_t *)&message, sizeof(message));
-        if (response != ESP_OK) {
-            Serial.printf("Send file response: %s\n", esp_err_to_name(response));
-            sendStatus = FAILED;
+        size_t len;
+        const uint8_t *record;
+        while ((record = xferFrames.peek(len)) != nullptr) {
+            sender.onFrame(record + 6, len - 6, millis());
+            xferFrames.release();
         }
+        sender.poll(millis());
 
-        progressHandler(file.position(), file.size(), "Sending...");
-        delay(100);
+        if (millis() - lastDraw > 200) {
+            progressHandler(sender.bytesAcked(), sender.totalBytes(), "Sending...");
+            lastDraw = millis();
+        }
+        // the next frame leaves as soon as the radio reports the previous one
+        if (xferSendResult < 0 && xferFrames.empty()) vTaskDelay(1);
     }
 
-    if (message.bytesSent == message.totalBytes) displaySuccess("File sent");
+    Serial.printf(
+        "ESPNOW send: %u bytes, %u retransmits\n",
+        (unsigned)sender.totalBytes(),
+        (unsigned)sender.retransmits()
+    );
+    if (sender.state() == XFER_DONE) displaySuccess("File sent");
+    else displayError("Error sending file");
 
     file.close();
+    endTransfer();
     delay(1000);
 }
 
@@ -65,56 +80,78 @@ void FileSharing::receiveFile() {
     padprintln("Waiting...");
 
     recvFileName = "";
-    recvQueue = {};
     recvStatus = CONNECTING;
 
     if (!beginEspnow()) return;
+    if (!beginTransfer()) {
+        displayError("Out of memory");
+        delay(1000);
+        return;
+    }
 
-    delay(100);
-
-    while (1) {
-        if (check(EscPress)) recvStatus = ABORTED;
-
-        if (recvStatus == ABORTED || recvStatus == FAILED) {
-            displayError("Error receiving file");
-            break;
-        }
-        if (recvStatus == SUCCESS) {
-            displaySuccess("File received");
-            break;
+    FS *fs = nullptr;
+    EspNowRadioTransport transport(broadcastAddress);
+    EspNowFileReceiver receiver(transport, [&](const String &dir, const String &name, uint32_t size) {
+        if (!getFsStorage(fs)) return File();
+        createFilename(fs, dir, name);
+        return fs->open(recvFileName, FILE_WRITE);
+    });
+
+    auto drainFrames = [&]() {
+        size_t len;
+        const uint8_t *record;
+        while ((record = xferFrames.peek(len)) != nullptr) {
+            if (receiver.state() == XFER_IDLE) {
+                // answers go to whoever opens the session
+                setupPeer(record);
+                transport.setPeer(record);
+            }
+            receiver.onFrame(record + 6, len - 6, millis());
+            xferFrames.release();
         }
+    };
 
-        if (!recvQueue.empty()) {
-            Message recvFileMessage = recvQueue.front();
-            recvQueue.erase(recvQueue.begin());
-
-            progressHandler(recvFileMessage.bytesSent, recvFileMessage.totalBytes, "Receiving...");
+    uint32_t lastDraw = 0;
+    while (!receiver.finished()) {
+        if (check(EscPress)) receiver.abort();
+        drainFrames();
+        receiver.poll(millis());
 
-            if (!appendToFile(recvFileMessage)) {
-                recvStatus = FAILED;
-                Serial.println("Failed appending to file");
-            }
-            if (recvFileMessage.done) {
-                Serial.println("Recv done");
-                recvStatus = recvFileMessage.bytesSent == recvFileMessage.totalBytes ? SUCCESS : FAILED;
-            }
+        if (receiver.state() != XFER_IDLE && millis() - lastDraw > 200) {
+            progressHandler(receiver.bytesReceived(), receiver.totalBytes(), "Receiving...");
+            lastDraw = millis();
         }
+        if (xferFrames.empty()) vTaskDelay(1);
+    }
+    // The sender repeats END until our END_ACK gets through, onFrame() answers it again
+    if (receiver.state() != XFER_ABORTED) {
+        uint32_t finishedAt = millis();
+        while (millis() - finishedAt < ESPNOW_XFER_LINGER_MS) {
+            drainFrames();
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+    }
+    endTransfer();
 
-        delay(100);
+    recvStatus = receiver.state() == XFER_DONE ? SUCCESS : FAILED;
+    if (recvStatus != SUCCESS) {
+        // never leave half a file behind
+        if (fs && recvFileName != "") fs->remove(recvFileName);
+        displayError("Error receiving file");
+        delay(1000);
+        return;
     }
 
+    displaySuccess("File received");
     delay(1000);
 
-    if (recvStatus == SUCCESS) {
-        drawMainBorderWithTitle("RECEIVE FILE");
-        padprintln("");
-        padprintln("File received: ");
-        padprintln(recvFileName);
-        padprintln("\n");
-        padprintln("Press any key to leave");
-        while (!check(AnyKeyPress)) vTaskDelay(50 / portTICK_PERIOD_MS);
-        ;
-    }
+    drawMainBorderWithTitle("RECEIVE FILE");
+    padprintln("");
+    padprintln("File received: ");
+    padprintln(recvFileName);
+    padprintln("\n");
+    padprintln("Press any key to leave");
+    while (!check(AnyKeyPress)) vTaskDelay(50 / portTICK_PERIOD_MS);
 }
 
 File FileSharing::selectFile() {
@@ -134,25 +171,7 @@ File FileSharing::selectFile() {
     return file;
 }
 
-bool FileSharing::appendToFile(FileSharing::Message fileMessage) {
-    FS *fs;
-    if (!getFsStorage(fs)) return false;
-
-    if (recvFileName == "") createFilename(fs, fileMessage);
-
-    File file = (*fs).open(recvFileName, FILE_APPEND);
-    if (!file) return false;
-
-    file.write((const uint8_t *)fileMessage.data, fileMessage.dataSize);
-    file.close();
-
-    return true;
-}
-
-void FileSharing::createFilename(FS *fs, FileSharing::Message fileMessage) {
-    String messageFilename = String(fileMessage.filename);
-    String messageFilepath = String(fileMessage.filepath);
-
+void FileSharing::createFilename(FS *fs, const String &messageFilepath, const String &messageFilename) {
     String filename = messageFilename.substring(0, messageFilename.lastIndexOf("."));
     String ext = messageFilename.substring(messageFilename.lastIndexOf("."));
 
@@ -1,10 +1,13 @@
 #include "display.h"
 #include "core/wifi/webInterface.h" // for server
 #include "core/wifi/wg.h"           //for isConnectedWireguard to print wireguard lock
+#include "image_cache.h"
+#include "image_decode.h"
 #include "mykeyboard.h"
 #include "settings.h" //for timeStr
 #include "utils.h"
 #include <JPEGDecoder.h>
+#include <esp_heap_caps.h>
 #include <interface.h> //for charging ischarging to print charging indicator
 #include <memory>
 
@@ -1206,6 +1209,7 @@ bool showJpeg(FS &fs, String filename, int x, int y, bool center) {
 
     bool decoded = false;
     if (data_array) {
+        takeJpegDecoder();
         decoded = JpegDec.decodeArray(data_array, data_size);
     } else {
         displayError(filename + " Fail");
@@ -1221,6 +1225,7 @@ bool showJpeg(FS &fs, String filename, int x, int y, bool center) {
         }
         jpegRender(x, y);
     }
+    giveJpegDecoder();
     // calculate how long it took to draw the image
     drawTime = millis() - drawTime; // Calculate the time it took
 
@@ -1237,6 +1242,7 @@ bool showJpeg(FS &fs, String filename, int x, int y, bool center) {
 bool showJpeg(const uint8_t *data_array, size_t data_size, int x, int y, bool center) {
     bool decoded = false;
     if (data_array) {
+        takeJpegDecoder();
         decoded = JpegDec.decodeArray(data_array, data_size);
     } else {
         return false;
@@ -1249,10 +1255,87 @@ bool showJpeg(const uint8_t *data_array, size_t data_size, int x, int y, bool ce
         }
         jpegRender(x, y);
     }
+    giveJpegDecoder();
 
     return true;
 }
 
+// Pushes the decoded cache of `filename`, band after band, skipping the bands outside the screen.
+// False when there is no up to date cache.
+static bool drawImageCache(FS &fs, const String &filename, int x, int y, bool center) {
+    ImageCacheSource source;
+    if (!imageCacheSource(fs, filename, bruceConfig.bgColor, source)) return false;
+    ImageCacheReader reader;
+    if (!reader.open(fs, imageCachePath(filename), source)) return false;
+
+    if (center) {
+        x = x + (tftWidth - reader.width()) / 2;
+        y = y + (tftHeight - reader.height()) / 2;
+    }
+    if (x >= tft.width() || y >= tft.height()) return false;
+
+    size_t bytes = (size_t)reader.bandRows() * reader.width() * sizeof(uint16_t);
+    uint16_t *band = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    if (!band) band = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    if (!band) return false;
+
+    bool swapBytes = tft.getSwapBytes();
+    tft.setSwapBytes(true);
+    bool ok = true;
+    for (uint16_t b = 0; ok && b < reader.bands(); b++) {
+        int top = y + b * reader.bandRows();
+        if (top >= tft.height()) break;
+        if (top + reader.rowsIn(b) <= 0) continue;
+        uint16_t rows = reader.readBand(b, band);
+        ok = rows > 0;
+        if (ok) tft.pushImage(x, top, reader.width(), rows, band);
+    }
+    tft.setSwapBytes(swapBytes);
+    heap_caps_free(band);
+    return ok;
+}
+
+bool buildImageCache(FS &fs, String filename) {
+    ImageCacheSource source;
+    if (!imageCacheSource(fs, filename, bruceConfig.bgColor, source)) return false;
+    String cachePath = imageCachePath(filename);
+    {
+        ImageCacheReader reader;
+        if (reader.open(fs, cachePath, source)) return true;
+    }
+
+    DecodedImage image;
+    if (!decodeImage(fs, filename, image, bruceConfig.bgColor)) return false;
+    bool ok = writeImageCache(fs, cachePath, image.pixels, image.width, image.height, source);
+    image.release();
+
+    // <dir>/tmp/<name>.bin, what older versions left next to PNGs
+    String legacy = cachePath.substring(0, cachePath.lastIndexOf('.'));
+    legacy = legacy.substring(0, legacy.lastIndexOf('.')) + ".bin";
+    if (fs.exists(legacy)) fs.remove(legacy);
+    return ok;
+}
+
+int warmImageCaches(FS &fs, String folder) {
+    std::vector<String> images;
+    File dir = fs.open(folder);
+    if (!dir || !dir.isDirectory()) return 0;
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+        String path = folder + (folder.endsWith("/") ? "" : "/") + f.name();
+        if (!f.isDirectory() && isDecodableImage(path)) images.push_back(path);
+        f.close();
+    }
+    dir.close();
+
+    int built = 0;
+    for (size_t i = 0; i < images.size(); i++) {
+        progressHandler(i, images.size(), "Caching images");
+        if (buildImageCache(fs, images[i])) built++;
+    }
+    progressHandler(images.size(), images.size(), "Caching images");
+    return built;
+}
+
 #if !defined(LITE_VERSION)
 // ####################################################################################################
 //  Draw a GIF on the TFT
@@ -1429,6 +1512,9 @@ bool showGif(
 ) {
     if (!fs->exists(filename)) return false;
 
+    // the cached first frame is up while the decoder gets going
+    drawImageCache(*fs, filename, x, y, center);
+
     Gif gif;
     bool success = gif.openGIF(fs, filename);
     if (!success) { return false; }
@@ -1651,6 +1737,8 @@ bool drawImg(FS &fs, String filename, int x, int y, bool center, int playDuratio
     uint8_t fls = 2;         // 2 for Little FS
     if (&fs == &SD) fls = 0; // 0 for SD
     tft.imageToBin(fls, filename, x, y, center, playDurationMs);
+    bool cached = ext.endsWith("jpg") || ext.endsWith("bmp");
+    if (cached && drawImageCache(fs, filename, x, y, center)) return true;
     if (ext.endsWith("jpg")) return showJpeg(fs, filename, x, y, center);
     else if (ext.endsWith("bmp")) return drawBmp(fs, filename, x, y, center);
     else if (ext.endsWith("png")) return drawPNG(fs, filename, x, y, center);
@@ -1675,9 +1763,6 @@ bool drawImg(FS &fs, String filename, int x, int y, bool center, int playDuratio
 #define MAX_IMAGE_WIDTH TFT_HEIGHT
 #endif
 PNG *png = nullptr;
-// Optional pointer to write decoded lines into a cached BIN file
-static File *pngBinOut = nullptr;
-static bool pngCacheOnly = false;
 // Optionally use heap capabilities on ESP32 to pick the best memory region for the decoder
 #if defined(ESP32)
 #include <esp_heap_caps.h>
@@ -1713,89 +1798,21 @@ int PNGDraw(PNGDRAW *pDraw) {
     uint8_t g = ((uint16_t)bruceConfig.bgColor & 0x07E0) >> 3;
     uint8_t b = ((uint16_t)bruceConfig.bgColor & 0x001F) << 3;
     png->getLineAsRGB565(pDraw, usPixels, PNG_RGB565_BIG_ENDIAN, b << 16 | g << 8 | r);
-    if (!pngCacheOnly) {
-        tft.drawPixel(0, 0, 0);
-        tft.drawPixel(0, 0, 0);
-        tft.pushImage(xpos, ypos + pDraw->y, pDraw->iWidth, 1, usPixels);
-    }
-    if (pngBinOut) { pngBinOut->write((uint8_t *)usPixels, pDraw->iWidth * sizeof(uint16_t)); }
+    tft.drawPixel(0, 0, 0);
+    tft.drawPixel(0, 0, 0);
+    tft.pushImage(xpos, ypos + pDraw->y, pDraw->iWidth, 1, usPixels);
     return 1;
 }
 
-// Build a cache path alongside the PNG: <dir>/tmp/<basename>.bin
-static String buildPngBinPath(const String &pngPath) {
-    int slash = pngPath.lastIndexOf('/');
-    String dir = (slash >= 0) ? pngPath.substring(0, slash) : "";
-    String name = pngPath.substring(slash + 1);
-    int dot = name.lastIndexOf('.');
-    if (dot > 0) name = name.substring(0, dot);
-
-    String tmpDir = dir.length() ? dir + "/tmp" : "/tmp";
-    if (!tmpDir.startsWith("/")) tmpDir = "/" + tmpDir;
-
-    return tmpDir + "/" + name + ".bin";
-}
-
-static bool ensureTmpDir(FS &fs, const String &binPath) {
-    int slash = binPath.lastIndexOf('/');
-    if (slash < 0) return false;
-    String dir = binPath.substring(0, slash);
-    if (fs.exists(dir)) return true;
-    return fs.mkdir(dir);
-}
-
-// Render a previously cached BIN (RGB565 LE with 2-byte width/height header)
-static bool drawPngBin(FS &fs, const String &binPath, int x, int y, bool center) {
-    File f = fs.open(binPath, FILE_READ);
-    if (!f) return false;
-
-    uint16_t w = 0, h = 0;
-    if (f.read((uint8_t *)&w, sizeof(uint16_t)) != sizeof(uint16_t) ||
-        f.read((uint8_t *)&h, sizeof(uint16_t)) != sizeof(uint16_t)) {
-        f.close();
-        return false;
-    }
-
-    if (center) {
-        x = x + (tftWidth - w) / 2;
-        y = y + (tftHeight - h) / 2;
-    }
-
-    if (x >= tft.width() || y >= tft.height()) {
-        f.close();
-        return false;
-    }
-
-    std::unique_ptr<uint16_t[]> line(new (std::nothrow) uint16_t[w]);
-    if (!line) {
-        f.close();
-        return false;
-    }
-
-    size_t rowBytes = w * sizeof(uint16_t);
-    for (uint16_t row = 0; row < h; ++row) {
-        if (f.read((uint8_t *)line.get(), rowBytes) != rowBytes) {
-            f.close();
-            return false;
-        }
-        tft.pushImage(x, y + row, w, 1, line.get());
-    }
-
-    f.close();
-    return true;
-}
-
 bool drawPNG(FS &fs, String filename, int x, int y, bool center) {
     if ((x >= tft.width()) || (y >= tft.height())) return false;
     _fs = &fs;
     uint32_t dt = millis();
 
-    String binPath = buildPngBinPath(filename);
-    if (fs.exists(binPath)) {
-        if (pngCacheOnly) return true; // cache already ready
-        if (drawPngBin(fs, binPath, x, y, center)) return true;
-        fs.remove(binPath); // stale cache, fall back to decode
-    }
+    // Decoding once into the cache and drawing that is faster than the line by line path below,
+    // which is only left for when there is not enough memory for the whole image
+    if (drawImageCache(fs, filename, x, y, center)) return true;
+    if (buildImageCache(fs, filename) && drawImageCache(fs, filename, x, y, center)) return true;
 
     // Allocate decoder only while drawing, then release to keep RAM available for Wi-Fi/AP usage
 #if defined(ESP32)
@@ -1825,18 +1842,8 @@ bool drawPNG(FS &fs, String filename, int x, int y, bool center) {
         // Serial.printf("image specs: (%d x %d), %d bpp, pixel type: %d\n", png->getWidth(),
         // png->getHeight(), png->getBpp(), png->getPixelType());
 
-        File binFile;
-        if (ensureTmpDir(fs, binPath)) {
-            binFile = fs.open(binPath, FILE_WRITE);
-            if (binFile) {
-                uint16_t w = png->getWidth();
-                uint16_t h = png->getHeight();
-                binFile.write((uint8_t *)&w, sizeof(uint16_t));
-                binFile.write((uint8_t *)&h, sizeof(uint16_t));
-                pngBinOut = &binFile;
-            }
-        }
-
+        xpos = x;
+        ypos = y;
         if (center) {
             xpos = x + (tftWidth - png->getWidth()) / 2;
             ypos = y + (tftHeight - png->getHeight()) / 2;
@@ -1849,21 +1856,10 @@ bool drawPNG(FS &fs, String filename, int x, int y, bool center) {
             png->close();
         }
 
-        if (pngBinOut) {
-            pngBinOut->close();
-            pngBinOut = nullptr;
-        } else {
-            if (fs.exists(binPath) && rc != PNG_SUCCESS) fs.remove(binPath);
-        }
-        if (rc != PNG_SUCCESS && fs.exists(binPath)) { fs.remove(binPath); }
-
         // How long did rendering take...
         Serial.print("PNG Loaded in ");
         Serial.print(millis() - dt);
         Serial.println("ms");
-    } else {
-        // Decode/open failed, ensure no stale cache
-        if (fs.exists(binPath)) fs.remove(binPath);
     }
 
     // Destroy placement-new object and free memory so RAM is available after rendering
@@ -1878,20 +1874,7 @@ bool drawPNG(FS &fs, String filename, int x, int y, bool center) {
 
     return rc == PNG_SUCCESS;
 }
-
-// Prepare (or verify) the cached BIN for a PNG without rendering it on screen
-bool preparePngBin(FS &fs, String filename) {
-    bool previous = pngCacheOnly;
-    pngCacheOnly = true;
-    bool ok = drawPNG(fs, filename, 0, 0, false);
-    pngCacheOnly = previous;
-    return ok;
-}
 #else
-bool preparePngBin(FS &fs, String filename) {
-    log_w("PNG: Not supported in this version");
-    return true;
-}
 bool drawPNG(FS &fs, String filename, int x, int y, bool center) {
     log_w("PNG: Not supported in this version");
     return false;
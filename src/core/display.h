@@ -98,7 +98,10 @@ bool drawImg(
     bool resetButtonStatus = true
 );
 bool drawPNG(FS &fs, String filename, int x, int y, bool center);
-bool preparePngBin(FS &fs, String filename);
+// Decodes `filename` into its <dir>/tmp/<name>.bic cache unless an up to date one is there
+bool buildImageCache(FS &fs, String filename);
+// Builds the caches of every image in `folder`, returns how many are ready
+int warmImageCaches(FS &fs, String folder);
 bool drawBmp(FS &fs, String filename, int x = 0, int y = 0, bool center = false);
 #if !defined(LITE_VERSION)
 bool showGif(
@@ -0,0 +1,46 @@
+#include "file_edit.h"
+
+bool FileEdit::begin(FS &fs, const String &path) {
+    static uint32_t sequence = 0;
+    abandon();
+    _fs = &fs;
+    _path = path;
+    _temp = path + FILE_EDIT_TEMP_SUFFIX + String(++sequence, HEX);
+    _written = 0;
+    _failed = false;
+    _file = fs.open(_temp, FILE_WRITE);
+    _owned = (bool)_file;
+    return _owned;
+}
+
+bool FileEdit::write(const uint8_t *data, size_t len) {
+    if (!_file || _failed) return false;
+    size_t n = _file.write(data, len);
+    _written += n;
+    if (n != len) _failed = true;
+    return !_failed;
+}
+
+bool FileEdit::commit(size_t expected) {
+    if (!_owned) return false;
+    if (_file) _file.close();
+    if (_failed || _written != expected) {
+        abandon();
+        return false;
+    }
+    // LittleFS renames over the old file atomically, FAT refuses an existing name
+    bool moved = _fs->rename(_temp, _path);
+    if (!moved) {
+        _fs->remove(_path);
+        moved = _fs->rename(_temp, _path);
+    }
+    if (moved) _owned = false;
+    else abandon();
+    return moved;
+}
+
+void FileEdit::abandon() {
+    if (_file) _file.close();
+    if (_owned && _fs->exists(_temp)) _fs->remove(_temp);
+    _owned = false;
+}
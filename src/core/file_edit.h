@@ -0,0 +1,37 @@
+#ifndef __FILE_EDIT_H__
+#define __FILE_EDIT_H__
+#include <Arduino.h>
+#include <FS.h>
+
+// The new content of a file, written as it arrives to a temp file next to it and put in place by
+// commit() once all of it was written. Every edit gets its own temp name, so abandoning one only
+// ever removes what that edit wrote, even while another edit of the same file is in flight.
+
+#define FILE_EDIT_TEMP_SUFFIX ".edit~"
+
+class FileEdit {
+public:
+    ~FileEdit() { abandon(); }
+
+    bool begin(FS &fs, const String &path);
+    // False once a write came up short, commit() then fails
+    bool write(const uint8_t *data, size_t len);
+    // Replaces the file with what was written, if that is `expected` bytes
+    bool commit(size_t expected);
+    // Closes and removes the temp file, unless commit() already moved it
+    void abandon();
+
+    const String &tempPath() const { return _temp; }
+    size_t written() const { return _written; }
+
+private:
+    FS *_fs = nullptr;
+    String _path;
+    String _temp;
+    File _file;
+    size_t _written = 0;
+    bool _failed = false;
+    bool _owned = false; // the temp file is ours to remove
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "file_hash.h"
+#include <MD5Builder.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <mbedtls/sha256.h>
+
+namespace {
+// Kept between calls: hashing a firmware image should not fragment the heap every time
+uint8_t *hashBuffer = nullptr;
+SemaphoreHandle_t hashLock = nullptr;
+StaticSemaphore_t hashLockBuffer;
+
+uint8_t *acquireBuffer() {
+    if (!hashLock) hashLock = xSemaphoreCreateMutexStatic(&hashLockBuffer);
+    xSemaphoreTake(hashLock, portMAX_DELAY);
+    if (!hashBuffer) {
+        hashBuffer = (uint8_t *)heap_caps_malloc(FILE_HASH_CHUNK_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!hashBuffer) hashBuffer = (uint8_t *)heap_caps_malloc(FILE_HASH_CHUNK_SIZE, MALLOC_CAP_8BIT);
+    }
+    if (!hashBuffer) xSemaphoreGive(hashLock);
+    return hashBuffer;
+}
+
+void releaseBuffer() { xSemaphoreGive(hashLock); }
+
+String toHex(const uint8_t *data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    String out;
+    out.reserve(len * 2);
+    for (size_t i = 0; i < len; i++) {
+        out += digits[data[i] >> 4];
+        out += digits[data[i] & 0x0F];
+    }
+    return out;
+}
+} // namespace
+
+uint8_t hashAlgoFromString(const String &name) {
+    if (name.equalsIgnoreCase("md5")) return HASH_MD5;
+    if (name.equalsIgnoreCase("crc32")) return HASH_CRC32;
+    if (name.equalsIgnoreCase("sha256")) return HASH_SHA256;
+    return 0;
+}
+
+bool hashFile(FS &fs, const String &path, uint8_t algos, FileHashes &out, FileHashProgress onProgress) {
+    out = FileHashes();
+    if (!(algos & HASH_ALL)) return false;
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) return false;
+
+    uint8_t *buf = acquireBuffer();
+    if (!buf) {
+        file.close();
+        return false;
+    }
+
+    MD5Builder md5;
+    mbedtls_sha256_context sha;
+    uint32_t crc = 0;
+    if (algos & HASH_MD5) md5.begin();
+    if (algos & HASH_SHA256) {
+        mbedtls_sha256_init(&sha);
+        mbedtls_sha256_starts(&sha, 0);
+    }
+
+    size_t total = file.size();
+    size_t done = 0;
+    size_t nextReport = FILE_HASH_PROGRESS_STEP;
+    bool ok = true;
+    while (done < total) {
+        int n = file.read(buf, FILE_HASH_CHUNK_SIZE);
+        if (n <= 0) {
+            ok = false;
+            break;
+        }
+        if (algos & HASH_MD5) md5.add(buf, n);
+        if (algos & HASH_SHA256) mbedtls_sha256_update(&sha, buf, n);
+        if (algos & HASH_CRC32) crc = esp_rom_crc32_le(crc, buf, n);
+        done += n;
+        if (onProgress && done >= nextReport) {
+            onProgress(done, total);
+            nextReport = done + FILE_HASH_PROGRESS_STEP;
+        }
+    }
+    releaseBuffer();
+    file.close();
+    if (onProgress && ok) onProgress(done, total);
+
+    if (algos & HASH_SHA256) {
+        uint8_t digest[32];
+        if (ok && mbedtls_sha256_finish(&sha, digest) == 0) out.sha256 = toHex(digest, sizeof(digest));
+        mbedtls_sha256_free(&sha);
+    }
+    if (!ok) return false;
+    if (algos & HASH_MD5) {
+        md5.calculate();
+        out.md5 = md5.toString();
+    }
+    if (algos & HASH_CRC32) {
+        char s[9];
+        snprintf(s, sizeof(s), "%08lX", (unsigned long)crc);
+        out.crc32 = s;
+    }
+    return true;
+}
+
+String hashFile(FS &fs, const String &path, FileHashAlgo algo, FileHashProgress onProgress) {
+    FileHashes hashes;
+    if (!hashFile(fs, path, (uint8_t)algo, hashes, onProgress)) return "";
+    if (algo == HASH_MD5) return hashes.md5;
+    if (algo == HASH_CRC32) return hashes.crc32;
+    if (algo == HASH_SHA256) return hashes.sha256;
+    return "";
+}
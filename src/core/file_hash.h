@@ -0,0 +1,42 @@
+#ifndef __FILE_HASH_H__
+#define __FILE_HASH_H__
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+
+// Algorithms accepted by hashFile(), can be combined to hash a file once for several digests
+enum FileHashAlgo : uint8_t {
+    HASH_MD5 = 1 << 0,
+    HASH_CRC32 = 1 << 1,
+    HASH_SHA256 = 1 << 2,
+    HASH_ALL = HASH_MD5 | HASH_CRC32 | HASH_SHA256,
+};
+
+// Hex digests. CRC32 is uppercase and MSB first, as the crc32 command always printed it
+struct FileHashes {
+    String md5;
+    String crc32;
+    String sha256;
+};
+
+// Called every FILE_HASH_PROGRESS_STEP bytes and at the end of the file
+typedef std::function<void(size_t done, size_t total)> FileHashProgress;
+
+const size_t FILE_HASH_CHUNK_SIZE = 4096;
+const size_t FILE_HASH_PROGRESS_STEP = 64 * 1024;
+
+// Streams `path` in FILE_HASH_CHUNK_SIZE blocks through the selected algorithms.
+// MD5 uses the ROM implementation, SHA-256 the mbedTLS (hardware accelerated) one and
+// CRC32 the ROM table. The read buffer is DMA capable and shared by every caller.
+bool hashFile(
+    FS &fs, const String &path, uint8_t algos, FileHashes &out, FileHashProgress onProgress = nullptr
+);
+
+// Single algorithm helpers, return "" on error
+String hashFile(FS &fs, const String &path, FileHashAlgo algo, FileHashProgress onProgress = nullptr);
+
+// Parses "md5", "crc32" or "sha256", returns 0 when unknown
+uint8_t hashAlgoFromString(const String &name);
+
+#endif
@@ -0,0 +1,94 @@
+#include "file_list.h"
+#include <algorithm> // for std::sort
+
+std::vector<FileList> fileList;
+
+/***************************************************************************************
+** Function name: sortList
+** Description:   sort files/folders by name
+***************************************************************************************/
+bool sortList(const FileList &a, const FileList &b) {
+    if (a.folder != b.folder) {
+        return a.folder > b.folder; // true if a is a folder and b is not
+    }
+    // Order items alphabetically
+    String fa = a.filename.c_str();
+    fa.toUpperCase();
+    String fb = b.filename.c_str();
+    fb.toUpperCase();
+    return fa < fb;
+}
+
+/***************************************************************************************
+** Function name: checkExt
+** Description:   check file extension
+***************************************************************************************/
+bool checkExt(String ext, String pattern) {
+    ext.toUpperCase();
+    pattern.toUpperCase();
+    if (ext == pattern) return true;
+
+    // If the pattern is a list of extensions (e.g., "TXT|JPG|PNG"), split and check
+    int start = 0;
+    int end = pattern.indexOf('|');
+    while (end != -1) {
+        String currentExt = pattern.substring(start, end);
+        if (ext == currentExt) { return true; }
+        start = end + 1;
+        end = pattern.indexOf('|', start);
+    }
+
+    // Check the last extension in the list
+    String lastExt = pattern.substring(start);
+    return ext == lastExt;
+}
+
+/***************************************************************************************
+** Function name: readFs
+** Description:   read files/folders from a folder
+***************************************************************************************/
+void readFs(FS fs, String folder, String allowed_ext) {
+    int allFilesCount = 0;
+    fileList.clear();
+    FileList object;
+
+    File root = fs.open(folder);
+    if (!root || !root.isDirectory()) { return; }
+
+    while (true) {
+        bool isDir;
+        String fullPath = root.getNextFileName(&isDir);
+        String nameOnly = fullPath.substring(fullPath.lastIndexOf("/") + 1);
+        if (fullPath == "") { break; }
+        // Serial.printf("Path: %s (isDir: %d)\n", fullPath.c_str(), isDir);
+
+        if (isDir) {
+            object.filename = nameOnly;
+            object.folder = true;
+            object.operation = false;
+            fileList.push_back(object);
+        } else {
+            int dotIndex = nameOnly.lastIndexOf(".");
+            String ext = dotIndex >= 0 ? nameOnly.substring(dotIndex + 1) : "";
+            if (allowed_ext == "*" || checkExt(ext, allowed_ext)) {
+                object.filename = nameOnly;
+                object.folder = false;
+                object.operation = false;
+                fileList.push_back(object);
+            }
+        }
+    }
+    root.close();
+
+    // Sort folders/files
+    std::sort(fileList.begin(), fileList.end(), sortList);
+
+    Serial.println("Files listed with: " + String(fileList.size()) + " files/folders found");
+
+    // Adds Operational btn at the botton
+    object.filename = "> Back";
+    object.folder = false;
+    object.operation = true;
+
+    fileList.push_back(object);
+}
@@ -0,0 +1,24 @@
+#ifndef __FILE_LIST_H__
+#define __FILE_LIST_H__
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+
+// Entries of the folder shown by the file browser (loopSD), filled by readFs()
+struct FileList {
+    String filename;
+    bool folder;
+    bool operation;
+};
+
+extern std::vector<FileList> fileList;
+
+// Lists `folder` into fileList, folders first then by name, and appends the "> Back" entry.
+// allowed_ext is "*" or a list like "TXT|JPG".
+void readFs(FS fs, String folder, String allowed_ext = "*");
+
+bool sortList(const FileList &a, const FileList &b);
+
+bool checkExt(String ext, String pattern);
+
+#endif
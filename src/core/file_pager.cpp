@@ -0,0 +1,223 @@
+#include "file_pager.h"
+#include <ctype.h>
+
+bool FilePager::open(FS &fs, const String &path) {
+    close();
+    _file = fs.open(path, "r");
+    if (!_file || _file.isDirectory()) {
+        close();
+        return false;
+    }
+    _size = _file.size();
+    _checkpoints.push_back(0);
+    _lines = _size ? 1 : 0;
+    _complete = _size == 0;
+    return true;
+}
+
+void FilePager::close() {
+    if (_file) _file.close();
+    _size = 0;
+    _checkpoints.clear();
+    _checkpoints.shrink_to_fit();
+    _stride = FILE_PAGER_STRIDE;
+    _lines = 0;
+    _scanPos = 0;
+    _complete = false;
+    _window.clear();
+    _windowFirst = 0;
+    _windowEof = false;
+}
+
+void FilePager::addLine(uint32_t offset) {
+    if (_lines % _stride == 0 && _checkpoints.size() >= FILE_PAGER_MAX_CHECKPOINTS) {
+        // keep every other checkpoint: still multiples of the doubled stride
+        size_t kept = 0;
+        for (size_t i = 0; i < _checkpoints.size(); i += 2) _checkpoints[kept++] = _checkpoints[i];
+        _checkpoints.resize(kept);
+        _stride *= 2;
+    }
+    if (_lines % _stride == 0) _checkpoints.push_back(offset);
+    _lines++;
+}
+
+bool FilePager::indexStep(size_t budget) {
+    if (_complete || !_file) return true;
+
+    uint8_t buf[512];
+    size_t done = 0;
+    _file.seek(_scanPos);
+    while (done < budget && _scanPos < _size) {
+        size_t n = _file.read(buf, min<size_t>(sizeof(buf), _size - _scanPos));
+        if (n == 0 || n > sizeof(buf)) {
+            _size = _scanPos; // read error, show what could be read
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            // a line starts after every '\n', except one ending the file
+            if (buf[i] == '\n' && _scanPos + i + 1 < _size) addLine(_scanPos + i + 1);
+        }
+        _scanPos += n;
+        done += n;
+    }
+    _complete = _scanPos >= _size;
+    return _complete;
+}
+
+bool FilePager::lineOffset(uint32_t line, uint32_t &offset) {
+    while (line >= _lines && !_complete) indexStep();
+    if (line >= _lines) return false;
+
+    uint32_t current = line / _stride * _stride;
+    offset = _checkpoints[line / _stride];
+    if (current == line) return true;
+
+    Reader reader(_file, offset);
+    int c;
+    while (current < line && (c = reader.next()) >= 0) {
+        if (c == '\n') current++;
+    }
+    offset = reader.pos;
+    return current == line;
+}
+
+uint32_t FilePager::lineAt(uint32_t offset) {
+    if (offset >= _size) offset = _size ? _size - 1 : 0;
+    while (_scanPos <= offset && !_complete) indexStep();
+    if (_lines == 0) return 0;
+
+    // last checkpoint at or before offset
+    size_t lo = 0, hi = _checkpoints.size();
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (_checkpoints[mid] <= offset) lo = mid;
+        else hi = mid;
+    }
+    uint32_t line = lo * _stride;
+    Reader reader(_file, _checkpoints[lo]);
+    int c;
+    while (reader.pos < offset && (c = reader.next()) >= 0) {
+        if (c == '\n') line++;
+    }
+    return line;
+}
+
+bool FilePager::readLine(Reader &reader, String &out, size_t maxLen) {
+    out = "";
+    if (reader.pos >= _size) return false;
+
+    char chunk[64];
+    size_t chunkLen = 0, total = 0;
+    int c;
+    while ((c = reader.next()) >= 0 && c != '\n') {
+        if (total++ >= maxLen) continue; // skip the rest of the line
+        chunk[chunkLen++] = c;
+        if (chunkLen == sizeof(chunk)) {
+            out.concat(chunk, chunkLen);
+            chunkLen = 0;
+        }
+    }
+    if (chunkLen) out.concat(chunk, chunkLen);
+    if (out.endsWith("\r")) out.remove(out.length() - 1);
+    return true;
+}
+
+void FilePager::loadWindow(uint32_t first) {
+    _window.clear();
+    _windowFirst = first;
+    _windowEof = true;
+    uint32_t offset;
+    if (!lineOffset(first, offset)) return;
+
+    Reader reader(_file, offset);
+    String text;
+    while (_window.size() < FILE_PAGER_WINDOW && readLine(reader, text, FILE_PAGER_MAX_LINE))
+        _window.push_back(text);
+    _windowEof = reader.pos >= _size;
+}
+
+void FilePager::prefetch(uint32_t first, uint32_t count) {
+    if (count > FILE_PAGER_WINDOW) count = FILE_PAGER_WINDOW;
+    bool cached = first >= _windowFirst && (first + count <= _windowFirst + _window.size() || _windowEof);
+    if (cached || (_complete && first >= _lines)) return;
+    // keep a third of the spare lines above, scrolling back is less common than forward
+    uint32_t margin = (FILE_PAGER_WINDOW - count) / 3;
+    loadWindow(first > margin ? first - margin : 0);
+}
+
+const String *FilePager::line(uint32_t n) {
+    prefetch(n, 1);
+    if (n < _windowFirst || n >= _windowFirst + _window.size()) return nullptr;
+    return &_window[n - _windowFirst];
+}
+
+int32_t FilePager::find(
+    const String &needle, uint32_t fromLine, bool ignoreCase,
+    const std::function<bool(uint32_t offset)> &progress
+) {
+    uint32_t offset;
+    if (needle.isEmpty() || !lineOffset(fromLine, offset)) return -1;
+
+    int32_t found;
+    while ((found = findStep(needle, fromLine, offset, 65536, ignoreCase)) == FILE_PAGER_FIND_MORE) {
+        if (progress && !progress(offset)) return -1;
+    }
+    return found;
+}
+
+int32_t FilePager::findStep(
+    const String &needle, uint32_t &line, uint32_t &offset, size_t budget, bool ignoreCase
+) {
+    if (needle.isEmpty() || !_file) return -1;
+
+    String pattern = needle;
+    if (ignoreCase) pattern.toLowerCase();
+    Reader reader(_file, offset);
+    String text;
+    uint32_t stop = offset + budget;
+    uint32_t start = offset;
+    while (readLine(reader, text, FILE_PAGER_MAX_LINE)) {
+        if (start <= _scanPos && reader.pos > _scanPos) {
+            // this line ends past the index, which can take it from here
+            if (reader.pos < _size) addLine(reader.pos);
+            _scanPos = reader.pos;
+            _complete = _scanPos >= _size;
+        }
+        if (ignoreCase) text.toLowerCase();
+        if (text.indexOf(pattern) >= 0) return line;
+        line++;
+        offset = start = reader.pos;
+        if (offset >= stop && offset < _size) return FILE_PAGER_FIND_MORE;
+    }
+    return -1;
+}
+
+size_t FilePager::read(uint32_t offset, uint8_t *buf, size_t len) {
+    if (!_file || offset >= _size) return 0;
+    len = min<size_t>(len, _size - offset);
+    if (!_file.seek(offset)) return 0;
+    size_t n = _file.read(buf, len);
+    return n > len ? 0 : n;
+}
+
+size_t FilePager::hexWidth(size_t columns) {
+    // offset, then per 4 bytes 9 characters of hex and 4 of text
+    size_t width = columns > 9 ? (columns - 9) * 4 / 13 / 4 * 4 : 0;
+    return width < 4 ? 4 : width > 16 ? 16 : width;
+}
+
+String FilePager::hexRow(uint32_t offset, const uint8_t *data, size_t len, size_t width) {
+    static const char digits[] = "0123456789abcdef";
+    char row[8 + 16 / 4 * 9 + 1 + 16 + 1];
+    if (width > 16) width = 16;
+    size_t at = snprintf(row, sizeof(row), "%08x", (unsigned)offset);
+    for (size_t i = 0; i < width; i++) {
+        if (i % 4 == 0) row[at++] = ' ';
+        row[at++] = i < len ? digits[data[i] >> 4] : ' ';
+        row[at++] = i < len ? digits[data[i] & 0xF] : ' ';
+    }
+    row[at++] = ' ';
+    for (size_t i = 0; i < len && i < width; i++) row[at++] = isprint(data[i]) ? data[i] : '.';
+    row[at] = '\0';
+    return String(row);
+}
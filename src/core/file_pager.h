@@ -0,0 +1,109 @@
+#ifndef __FILE_PAGER_H__
+#define __FILE_PAGER_H__
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <vector>
+
+// Random access to the lines of a file of any size.
+//
+// The line index is sparse: the offset of one line every `stride` lines, built a few KB at a time by
+// indexStep() (call it while the UI is idle) or on demand when a line past the indexed part is asked.
+// When it reaches FILE_PAGER_MAX_CHECKPOINTS the stride doubles, so RAM stays bounded (16KB).
+// Only a window of decoded lines around the last one read is kept in memory.
+
+#define FILE_PAGER_STRIDE 32
+#define FILE_PAGER_MAX_CHECKPOINTS 4096
+#define FILE_PAGER_MAX_LINE 1024 // longer lines are cut when decoded
+#define FILE_PAGER_WINDOW 64     // decoded lines kept, a page plus the prefetch margins
+#define FILE_PAGER_FIND_MORE -2  // findStep() ran out of budget
+
+class FilePager {
+public:
+    ~FilePager() { close(); }
+
+    bool open(FS &fs, const String &path);
+    void close();
+    bool isOpen() const { return _file; }
+    uint32_t size() const { return _size; }
+
+    // Indexes up to `budget` more bytes. Returns true once the whole file is indexed.
+    bool indexStep(size_t budget = 4096);
+    bool indexed() const { return _complete; }
+    // Lines found so far, the total once indexed()
+    uint32_t lineCount() const { return _lines; }
+    // Bytes indexed so far
+    uint32_t indexedBytes() const { return _scanPos; }
+
+    // Offset of `line`, indexing as far as needed. False past the last line.
+    bool lineOffset(uint32_t line, uint32_t &offset);
+    // Line holding the byte at `offset`
+    uint32_t lineAt(uint32_t offset);
+
+    // Line `n` without its line ending, nullptr past the last line.
+    // The pointer is valid until the next call that moves the window.
+    const String *line(uint32_t n);
+    // Makes sure lines [first, first + count) are decoded, with some margin on both sides
+    void prefetch(uint32_t first, uint32_t count);
+
+    // First line from `fromLine` containing `needle`, -1 when none or when `progress` (called
+    // about every 64KB with the current offset) returns false. Only the decoded part of long lines is
+    // searched.
+    int32_t find(
+        const String &needle, uint32_t fromLine, bool ignoreCase = true,
+        const std::function<bool(uint32_t offset)> &progress = nullptr
+    );
+    // find() in slices, from `line` which starts at byte `offset`. Reads about `budget` bytes, then
+    // returns FILE_PAGER_FIND_MORE with `line` and `offset` moved to where the next call resumes.
+    // Lines read past the indexed part are added to the index.
+    int32_t findStep(
+        const String &needle, uint32_t &line, uint32_t &offset, size_t budget, bool ignoreCase = true
+    );
+
+    // Raw bytes, for hex views
+    size_t read(uint32_t offset, uint8_t *buf, size_t len);
+
+    // "0000a0f0 48656c6c 6f20776f Hello wo"
+    static String hexRow(uint32_t offset, const uint8_t *data, size_t len, size_t width);
+    // Bytes per hex row fitting `columns` characters, a multiple of 4
+    static size_t hexWidth(size_t columns);
+
+private:
+    // Sequential reader on _file, refills a small buffer
+    struct Reader {
+        File &file;
+        uint32_t pos;
+        uint8_t buf[512];
+        size_t len = 0, at = 0;
+        Reader(File &f, uint32_t offset) : file(f), pos(offset) { file.seek(offset); }
+        int next() {
+            if (at == len) {
+                len = file.read(buf, sizeof(buf));
+                at = 0;
+                if (len == 0 || len > sizeof(buf)) {
+                    len = 0;
+                    return -1;
+                }
+            }
+            pos++;
+            return buf[at++];
+        }
+    };
+
+    void addLine(uint32_t offset);
+    bool readLine(Reader &reader, String &out, size_t maxLen);
+    void loadWindow(uint32_t first);
+
+    File _file;
+    uint32_t _size = 0;
+    std::vector<uint32_t> _checkpoints; // offset of line i * _stride
+    uint32_t _stride = FILE_PAGER_STRIDE;
+    uint32_t _lines = 0;
+    uint32_t _scanPos = 0;
+    bool _complete = false;
+    std::vector<String> _window;
+    uint32_t _windowFirst = 0;
+    bool _windowEof = false; // the window reaches the end of the file
+};
+
+#endif
@@ -0,0 +1,220 @@
+#include "file_viewer.h"
+#include "display.h"
+#include "mykeyboard.h"
+#include <globals.h>
+
+bool FileViewer::open(FS &fs, const String &path) {
+    if (!_pager.open(fs, path)) return false;
+    _title = path.substring(path.lastIndexOf('/') + 1);
+    return true;
+}
+
+void FileViewer::setup() {
+    drawMainBorder();
+    printTitle(_title);
+    tft.setTextSize(FP);
+    _y = tft.getCursorY();
+    _pixelsPerLine = tft.fontHeight() + 2;
+    _height = tftHeight - BORDER_PAD_X - _y - _pixelsPerLine; // last row is the status line
+    _rows = max<int32_t>(1, _height / _pixelsPerLine);
+    _columns = max<int32_t>(8, (tftWidth - 2 * BORDER_PAD_X) / tft.textWidth("w", FP));
+    _hexWidth = FilePager::hexWidth(_columns);
+}
+
+size_t FileViewer::rowsOf(const String &text) const {
+    return text.length() ? (text.length() + _columns - 1) / _columns : 1;
+}
+
+void FileViewer::draw() {
+    tft.fillRect(BORDER_PAD_X, _y, tftWidth - 2 * BORDER_PAD_X, _rows * _pixelsPerLine, bruceConfig.bgColor);
+    tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor);
+    tft.setTextSize(FP);
+
+    int32_t y = _y;
+    if (_hex) {
+        uint8_t buf[16];
+        for (size_t row = 0; row < _rows; row++) {
+            uint32_t offset = (_hexRow + row) * _hexWidth;
+            size_t n = _pager.read(offset, buf, _hexWidth);
+            if (!n) break;
+            tft.drawString(FilePager::hexRow(offset, buf, n, _hexWidth), BORDER_PAD_X, y);
+            y += _pixelsPerLine;
+        }
+    } else {
+        _pager.prefetch(_line, _rows);
+        uint32_t line = _line;
+        size_t sub = _sub, drawn = 0;
+        while (drawn < _rows) {
+            const String *text = _pager.line(line);
+            if (!text) break;
+            for (size_t r = sub; r < rowsOf(*text) && drawn < _rows; r++, drawn++) {
+                tft.drawString(text->substring(r * _columns, (r + 1) * _columns), BORDER_PAD_X, y);
+                y += _pixelsPerLine;
+            }
+            line++;
+            sub = 0;
+        }
+    }
+    drawStatus();
+}
+
+void FileViewer::drawStatus() {
+    String status;
+    if (_hex) {
+        status = "0x" + String(_hexRow * _hexWidth, HEX) + "/0x" + String(_pager.size(), HEX);
+    } else {
+        status = "L" + String(_line + 1) + "/" + String(_pager.lineCount());
+        if (!_pager.indexed())
+            status += "+ " + String((uint64_t)_pager.indexedBytes() * 100 / _pager.size()) + "%";
+    }
+    int32_t y = _y + _rows * _pixelsPerLine;
+    tft.fillRect(BORDER_PAD_X, y, tftWidth - 2 * BORDER_PAD_X, _pixelsPerLine, bruceConfig.bgColor);
+    tft.setTextColor(bruceConfig.secColor, bruceConfig.bgColor);
+    tft.drawRightString(status, tftWidth - BORDER_PAD_X, y, 1);
+    tft.setTextColor(bruceConfig.priColor, bruceConfig.bgColor);
+    _lastStatus = millis();
+}
+
+bool FileViewer::scrollUp() {
+    if (_hex) {
+        if (!_hexRow) return false;
+        _hexRow--;
+    } else if (_sub) {
+        _sub--;
+    } else {
+        if (!_line) return false;
+        const String *text = _pager.line(--_line);
+        _sub = text ? rowsOf(*text) - 1 : 0;
+    }
+    return true;
+}
+
+bool FileViewer::scrollDown() {
+    if (_hex) {
+        if ((uint64_t)(_hexRow + 1) * _hexWidth >= _pager.size()) return false;
+        _hexRow++;
+        return true;
+    }
+    const String *text = _pager.line(_line);
+    if (text && _sub + 1 < rowsOf(*text)) {
+        _sub++;
+        return true;
+    }
+    if (!_pager.line(_line + 1)) return false;
+    _line++;
+    _sub = 0;
+    return true;
+}
+
+void FileViewer::page(bool down) {
+    for (size_t i = 1; i < _rows; i++) {
+        if (!(down ? scrollDown() : scrollUp())) break;
+    }
+}
+
+void FileViewer::setHex(bool hex) {
+    if (hex == _hex) return;
+    uint32_t offset = 0;
+    if (hex) {
+        _pager.lineOffset(_line, offset);
+        _hexRow = (offset + _sub * _columns) / _hexWidth;
+    } else {
+        _line = _pager.lineAt(_hexRow * _hexWidth);
+        _sub = 0;
+    }
+    _hex = hex;
+}
+
+void FileViewer::gotoLine() {
+    if (_hex) {
+        String hex = keyboard(String(_hexRow * _hexWidth, HEX), 8, "Go to offset (hex):");
+        if (hex == "\x1B" || hex.isEmpty()) return;
+        uint32_t offset = strtoul(hex.c_str(), nullptr, 16);
+        if (offset >= _pager.size()) offset = _pager.size() ? _pager.size() - 1 : 0;
+        _hexRow = offset / _hexWidth;
+        return;
+    }
+    String number = num_keyboard(String(_line + 1), 10, "Go to line:");
+    if (number == "\x1B" || number.isEmpty()) return;
+    uint32_t line = number.toInt();
+    if (line) line--;
+    displayTextLine("Indexing...");
+    uint32_t offset;
+    if (!_pager.lineOffset(line, offset)) line = _pager.lineCount() ? _pager.lineCount() - 1 : 0;
+    _line = line;
+    _sub = 0;
+}
+
+void FileViewer::find(bool next) {
+    if (!next || _query.isEmpty()) {
+        String query = keyboard(_query, 64, "Find:");
+        if (query == "\x1B" || query.isEmpty()) return;
+        _query = query;
+    }
+    if (_hex) setHex(false);
+
+    uint32_t from = next ? _line + 1 : _line;
+    uint32_t size = _pager.size();
+    displayTextLine("Searching...");
+    auto progress = [size](uint32_t offset) {
+        progressHandler(offset, size, "Searching...");
+        return !check(EscPress);
+    };
+    int32_t found = _pager.find(_query, from, true, progress);
+    if (found < 0 && from) found = _pager.find(_query, 0, true, progress); // wrap around
+    if (found < 0) {
+        displayInfo("Not found: " + _query, true);
+        return;
+    }
+    _line = found;
+    _sub = 0;
+}
+
+bool FileViewer::menu() {
+    bool keep = true;
+    std::vector<Option> options = {
+        {_hex ? "Go to offset" : "Go to line", [this]() { gotoLine(); }       },
+        {"Find",                               [this]() { find(false); }      },
+    };
+    if (!_query.isEmpty()) options.push_back({"Find next", [this]() { find(true); }});
+    options.push_back({_hex ? "Text view" : "Hex view", [this]() { setHex(!_hex); }});
+    options.push_back({"Close Menu", [this]() { yield(); }});
+    options.push_back({"Exit", [&keep]() { keep = false; }});
+    loopOptions(options);
+    return keep;
+}
+
+void FileViewer::show() {
+    setup();
+    draw();
+    while (check(SelPress)) yield(); // the press that opened the viewer
+
+    for (;;) {
+        bool redraw = false;
+        if (check(EscPress)) break;
+        if (check(SelPress)) {
+            if (!menu()) break;
+            setup();
+            redraw = true;
+        } else if (check(PrevPress) || check(UpPress)) {
+            redraw = scrollUp();
+        } else if (check(NextPress) || check(DownPress)) {
+            redraw = scrollDown();
+        } else if (check(PrevPagePress)) {
+            page(false);
+            redraw = true;
+        } else if (check(NextPagePress)) {
+            page(true);
+            redraw = true;
+        } else if (!_pager.indexed()) {
+            // nothing to do, keep indexing in small steps so keys stay responsive
+            _pager.indexStep(2048);
+            if (millis() - _lastStatus > 300 || _pager.indexed()) drawStatus();
+            continue;
+        } else {
+            vTaskDelay(10 / portTICK_PERIOD_MS);
+        }
+        if (redraw) draw();
+    }
+    _pager.close();
+}
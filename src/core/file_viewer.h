@@ -0,0 +1,39 @@
+#ifndef __FILE_VIEWER_H__
+#define __FILE_VIEWER_H__
+#include "file_pager.h"
+
+// Paged text/hex viewer for files of any size. Only the visible page (plus the FilePager window)
+// is decoded, the line index grows while no key is pressed.
+// Up/Down scroll, Prev/Next page jump, Sel opens the menu (go to line, find, hex), Esc leaves.
+class FileViewer {
+public:
+    bool open(FS &fs, const String &path);
+    void show();
+
+private:
+    FilePager _pager;
+    String _title;
+    String _query;
+    bool _hex = false;
+    uint32_t _line = 0; // text: first row is wrapped row _sub of line _line
+    uint16_t _sub = 0;
+    uint32_t _hexRow = 0; // hex: first row
+    int32_t _y = 0, _height = 0;
+    int32_t _pixelsPerLine = 0;
+    size_t _rows = 0, _columns = 0, _hexWidth = 0;
+    uint32_t _lastStatus = 0;
+
+    void setup();
+    void draw();
+    void drawStatus();
+    size_t rowsOf(const String &text) const;
+    bool scrollUp();
+    bool scrollDown();
+    void page(bool down);
+    void setHex(bool hex);
+    void gotoLine();
+    void find(bool next);
+    bool menu();
+};
+
+#endif
@@ -0,0 +1,235 @@
+#include "gzip_writer.h"
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+
+namespace {
+const size_t WINDOW = GZIP_WRITER_WINDOW;
+const size_t HASH_SIZE = 1 << GZIP_WRITER_HASH_BITS;
+
+// RFC 1951 3.2.5, length codes 257..285 and distance codes 0..29
+const uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                  31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                  2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const uint16_t DIST_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+} // namespace
+
+bool GzipWriter::begin(Print &out) {
+    end();
+    size_t size = 2 * WINDOW + (HASH_SIZE + WINDOW) * sizeof(uint16_t);
+    _mem = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    if (!_mem) _mem = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    if (!_mem) return false;
+    _win = _mem;
+    _head = (uint16_t *)(_mem + 2 * WINDOW);
+    _prev = _head + HASH_SIZE;
+    memset(_head, 0xFF, (HASH_SIZE + WINDOW) * sizeof(uint16_t)); // all NIL
+
+    _out = &out;
+    _fill = _pos = 0;
+    _blockOpen = false;
+    _bits = _bitCount = 0;
+    _outLen = 0;
+    _crc = _isize = _written = 0;
+    _ok = true;
+
+    // magic, deflate, no flags, no mtime, no extra flags, unknown OS
+    static const uint8_t header[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+    for (uint8_t b : header) putByte(b);
+    drain();
+    return _ok;
+}
+
+void GzipWriter::end() {
+    if (_mem) heap_caps_free(_mem);
+    _mem = _win = nullptr;
+    _head = _prev = nullptr;
+    _out = nullptr;
+}
+
+size_t GzipWriter::write(const uint8_t *data, size_t len) {
+    if (!_win) return 0;
+    _crc = esp_rom_crc32_le(_crc, data, len);
+    _isize += len;
+    size_t done = 0;
+    while (done < len) {
+        if (_fill == 2 * WINDOW) {
+            compress(false);
+            slide();
+        }
+        size_t n = min(len - done, 2 * WINDOW - _fill);
+        memcpy(_win + _fill, data + done, n);
+        _fill += n;
+        done += n;
+    }
+    return len;
+}
+
+bool GzipWriter::flush() {
+    if (!_win) return false;
+    compress(true);
+    if (_blockOpen) {
+        closeBlock();
+        // empty stored block: byte aligns the stream (a zlib Z_SYNC_FLUSH)
+        putBits(0, 3);
+        alignBits();
+        putByte(0x00);
+        putByte(0x00);
+        putByte(0xFF);
+        putByte(0xFF);
+    }
+    drain();
+    return _ok;
+}
+
+bool GzipWriter::finish() {
+    if (!_win) return false;
+    compress(true);
+    closeBlock();
+    openBlock(true);
+    closeBlock();
+    alignBits();
+    for (int i = 0; i < 32; i += 8) putByte(_crc >> i);
+    for (int i = 0; i < 32; i += 8) putByte(_isize >> i);
+    drain();
+    bool ok = _ok;
+    end();
+    return ok;
+}
+
+uint32_t GzipWriter::hash(const uint8_t *p) {
+    uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+    return (v * 2654435761u) >> (32 - GZIP_WRITER_HASH_BITS);
+}
+
+void GzipWriter::insert(size_t pos) {
+    if (pos + MIN_MATCH > _fill) return;
+    uint32_t h = hash(_win + pos);
+    _prev[pos & (WINDOW - 1)] = _head[h];
+    _head[h] = pos;
+}
+
+size_t GzipWriter::longestMatch(size_t pos, size_t &distance) {
+    size_t maxLen = min(MAX_MATCH, _fill - pos);
+    size_t best = 0;
+    int chain = GZIP_WRITER_MAX_CHAIN;
+    const uint8_t *b = _win + pos;
+    // _prev[cur] stays valid while cur is less than a window behind: nothing newer reused its slot
+    for (uint16_t cur = _head[hash(b)]; cur != NIL && cur < pos && pos - cur < WINDOW && chain--;) {
+        const uint8_t *a = _win + cur;
+        if (a[best] == b[best] && a[0] == b[0]) {
+            size_t n = 0;
+            while (n < maxLen && a[n] == b[n]) n++;
+            if (n > best) {
+                best = n;
+                distance = pos - cur;
+                if (n == maxLen) break;
+            }
+        }
+        uint16_t next = _prev[cur & (WINDOW - 1)];
+        if (next >= cur) break;
+        cur = next;
+    }
+    return best;
+}
+
+// Encodes the buffered bytes, keeping LOOKAHEAD of them back unless `all`
+void GzipWriter::compress(bool all) {
+    while (_pos < _fill && (all || _fill - _pos >= LOOKAHEAD)) {
+        if (!_blockOpen) openBlock(false);
+        size_t distance = 0;
+        size_t length = _fill - _pos >= MIN_MATCH ? longestMatch(_pos, distance) : 0;
+        if (length >= MIN_MATCH) {
+            putMatch(length, distance);
+            for (size_t i = 0; i < length; i++) insert(_pos + i);
+            _pos += length;
+        } else {
+            insert(_pos);
+            putLiteral(_win[_pos++]);
+        }
+    }
+}
+
+// Drops the oldest window, the buffer keeps one window of history
+void GzipWriter::slide() {
+    memmove(_win, _win + WINDOW, _fill - WINDOW);
+    _fill -= WINDOW;
+    _pos -= WINDOW;
+    for (size_t i = 0; i < HASH_SIZE + WINDOW; i++) {
+        uint16_t &v = _head[i]; // _prev follows _head
+        v = (v != NIL && v >= WINDOW) ? v - WINDOW : NIL;
+    }
+}
+
+void GzipWriter::putBits(uint32_t value, uint8_t count) {
+    _bits |= value << _bitCount;
+    _bitCount += count;
+    while (_bitCount >= 8) {
+        putByte(_bits);
+        _bits >>= 8;
+        _bitCount -= 8;
+    }
+}
+
+void GzipWriter::putCode(uint16_t code, uint8_t length) {
+    uint16_t reversed = 0;
+    for (uint8_t i = 0; i < length; i++) reversed |= ((code >> i) & 1) << (length - 1 - i);
+    putBits(reversed, length);
+}
+
+// Fixed Huffman table, RFC 1951 3.2.6
+void GzipWriter::putLiteral(uint8_t c) {
+    if (c < 144) putCode(0x30 + c, 8);
+    else putCode(0x190 + c - 144, 9);
+}
+
+void GzipWriter::putSymbol(uint16_t symbol) {
+    if (symbol < 280) putCode(symbol - 256, 7);
+    else putCode(0xC0 + symbol - 280, 8);
+}
+
+void GzipWriter::putMatch(size_t length, size_t distance) {
+    int i = 28;
+    while (LENGTH_BASE[i] > length) i--;
+    putSymbol(257 + i);
+    if (LENGTH_EXTRA[i]) putBits(length - LENGTH_BASE[i], LENGTH_EXTRA[i]);
+
+    int d = 29;
+    while (DIST_BASE[d] > distance) d--;
+    putCode(d, 5);
+    if (DIST_EXTRA[d]) putBits(distance - DIST_BASE[d], DIST_EXTRA[d]);
+}
+
+void GzipWriter::openBlock(bool last) {
+    putBits(last ? 1 : 0, 1);
+    putBits(1, 2); // fixed Huffman codes
+    _blockOpen = true;
+}
+
+void GzipWriter::closeBlock() {
+    if (!_blockOpen) return;
+    putSymbol(256);
+    _blockOpen = false;
+}
+
+void GzipWriter::alignBits() {
+    if (_bitCount) putByte(_bits);
+    _bits = _bitCount = 0;
+}
+
+void GzipWriter::putByte(uint8_t b) {
+    _outBuf[_outLen++] = b;
+    if (_outLen == sizeof(_outBuf)) drain();
+}
+
+void GzipWriter::drain() {
+    if (_outLen && _ok) {
+        if (_out->write(_outBuf, _outLen) != _outLen) _ok = false;
+        else _written += _outLen;
+    }
+    _outLen = 0;
+}
@@ -0,0 +1,79 @@
+#ifndef __GZIP_WRITER_H__
+#define __GZIP_WRITER_H__
+#include <Arduino.h>
+
+#define GZIP_WRITER_WINDOW 4096 // LZ77 window, power of two
+#define GZIP_WRITER_HASH_BITS 12
+#define GZIP_WRITER_MAX_CHAIN 32 // candidates looked at per position
+
+// Streaming gzip (RFC 1952) compressor writing to any Print, usually an open File.
+// Deflate with greedy LZ77 matching and the fixed Huffman table: no per block code tables to
+// build, ~24KB of state (PSRAM first) and still about 3x smaller output on CSV logs.
+// flush() ends the current block with a sync marker, so everything written until then can be
+// decompressed even if the trailer never makes it to the card.
+class GzipWriter {
+public:
+    GzipWriter() = default;
+    ~GzipWriter() { end(); }
+    GzipWriter(const GzipWriter &) = delete;
+    GzipWriter &operator=(const GzipWriter &) = delete;
+
+    // Allocates the window and writes the gzip header. False if no memory was found.
+    bool begin(Print &out);
+    size_t write(const uint8_t *data, size_t len);
+    size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    bool flush();
+    // Writes the last block and the trailer, then releases the memory
+    bool finish();
+    // Releases the memory without finishing the stream
+    void end();
+
+    bool ready() const { return _win != nullptr; }
+    bool ok() const { return _ok; }
+    uint32_t bytesIn() const { return _isize; }
+    uint32_t bytesOut() const { return _written; }
+
+private:
+    static constexpr uint16_t NIL = 0xFFFF;
+    static constexpr size_t MIN_MATCH = 3;
+    static constexpr size_t MAX_MATCH = 258;
+    static constexpr size_t LOOKAHEAD = MAX_MATCH + MIN_MATCH + 1;
+
+    Print *_out = nullptr;
+    uint8_t *_mem = nullptr;
+    uint8_t *_win = nullptr; // 2 windows: history and the bytes still to encode
+    uint16_t *_head = nullptr;
+    uint16_t *_prev = nullptr;
+    size_t _fill = 0; // bytes in _win
+    size_t _pos = 0;  // next byte to encode
+    bool _blockOpen = false;
+
+    uint32_t _bits = 0;
+    uint8_t _bitCount = 0;
+    uint8_t _outBuf[256];
+    size_t _outLen = 0;
+
+    uint32_t _crc = 0;
+    uint32_t _isize = 0;
+    uint32_t _written = 0;
+    bool _ok = true;
+
+    static uint32_t hash(const uint8_t *p);
+    void insert(size_t pos);
+    size_t longestMatch(size_t pos, size_t &distance);
+    void compress(bool all);
+    void slide();
+
+    void putBits(uint32_t value, uint8_t count);
+    void putCode(uint16_t code, uint8_t length); // Huffman codes go most significant bit first
+    void putLiteral(uint8_t c);
+    void putSymbol(uint16_t symbol);
+    void putMatch(size_t length, size_t distance);
+    void openBlock(bool last);
+    void closeBlock();
+    void alignBits();
+    void putByte(uint8_t b);
+    void drain();
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "icon_cache.h"
+#include <SD.h>
+#include <globals.h>
+
+IconCache iconCache;
+
+// GIF icons stay animated, drawImg() plays them
+static bool cacheable(const String &path) {
+    String lower = path;
+    lower.toLowerCase();
+    return isDecodableImage(path) && !lower.endsWith(".gif");
+}
+
+bool IconCache::begin() {
+    if (!psramFound()) return false;
+    if (!_lock) _lock = xSemaphoreCreateMutexStatic(&_lockBuffer);
+    return true;
+}
+
+bool IconCache::draw(FS &fs, const String &path, int x, int y, bool center) {
+    if (!begin() || !cacheable(path)) return false;
+    _lastDraw = millis();
+    if (!load(fs, path, true, x, y, center)) return false;
+    tft.imageToBin(&fs == &SD ? 0 : 2, path, x, y, center, 0); // same as drawImg() for the remote screen
+    _lastDraw = millis();
+    return true;
+}
+
+void IconCache::prefetch(FS &fs, const String &path) {
+    if (!begin() || !cacheable(path)) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool wanted = !find(fs, path);
+    for (auto &r : _queue) wanted = wanted && !(r.fs == &fs && r.path == path);
+    if (wanted) {
+        if (_queue.size() >= ICON_CACHE_MAX_QUEUE) _queue.erase(_queue.begin()); // oldest guess
+        _queue.push_back({&fs, path});
+    }
+    xSemaphoreGive(_lock);
+    if (!wanted) return;
+
+    if (!_task && xTaskCreate(prefetchTask, "icon_cache", 8192, this, 1, &_task) != pdPASS) _task = nullptr;
+    if (_task) xTaskNotifyGive(_task);
+}
+
+void IconCache::clear() {
+    if (!_lock) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    for (auto &e : _entries) e.image.release();
+    _entries.clear();
+    _queue.clear();
+    _bytes = 0;
+    xSemaphoreGive(_lock);
+}
+
+size_t IconCache::bytes() {
+    if (!_lock) return 0;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    size_t n = _bytes;
+    xSemaphoreGive(_lock);
+    return n;
+}
+
+bool IconCache::stat(FS &fs, const String &path, size_t &size, time_t &mtime) {
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) return false;
+    size = file.size();
+    mtime = file.getLastWrite();
+    file.close();
+    return true;
+}
+
+IconCache::Entry *IconCache::find(FS &fs, const String &path) {
+    for (auto &e : _entries) {
+        if (e.fs == &fs && e.path == path) return &e;
+    }
+    return nullptr;
+}
+
+void IconCache::remove(Entry *entry) {
+    _bytes -= entry->image.bytes();
+    entry->image.release();
+    _entries.erase(_entries.begin() + (entry - _entries.data()));
+}
+
+// Makes sure `path` is cached (drawing it when `draw`), decoding it on a miss
+bool IconCache::load(FS &fs, const String &path, bool draw, int x, int y, bool center) {
+    size_t size;
+    time_t mtime;
+    if (!stat(fs, path, size, mtime)) return false;
+    uint16_t background = bruceConfig.bgColor; // transparent PNG pixels are baked in
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Entry *entry = find(fs, path);
+    if (entry && entry->size == size && entry->mtime == mtime && entry->background == background) {
+        entry->lastUse = millis();
+        if (draw) {
+            push(entry->image, x, y, center);
+            _hits++;
+        }
+        xSemaphoreGive(_lock);
+        return true;
+    }
+    if (entry) remove(entry); // edited since it was decoded
+    if (draw) _misses++;
+    xSemaphoreGive(_lock);
+
+    DecodedImage image;
+    if (!decodeImage(fs, path, image, background)) return false;
+    if (draw) push(image, x, y, center);
+    if (image.bytes() > ICON_CACHE_BUDGET / 2) {
+        image.release(); // would push everything else out
+        return true;
+    }
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if ((entry = find(fs, path))) remove(entry); // decoded by both tasks at once
+    while (_bytes + image.bytes() > ICON_CACHE_BUDGET && !_entries.empty()) {
+        Entry *oldest = &_entries[0];
+        for (auto &e : _entries) {
+            if ((int32_t)(e.lastUse - oldest->lastUse) < 0) oldest = &e;
+        }
+        remove(oldest);
+    }
+    _entries.push_back({&fs, path, size, mtime, background, millis(), image});
+    _bytes += image.bytes();
+    xSemaphoreGive(_lock);
+    return true;
+}
+
+void IconCache::push(const DecodedImage &image, int x, int y, bool center) {
+    if (center) {
+        x = x + (tftWidth - image.width) / 2;
+        y = y + (tftHeight - image.height) / 2;
+    }
+    bool swapBytes = tft.getSwapBytes();
+    tft.setSwapBytes(true);
+    tft.pushImage(x, y, image.width, image.height, image.pixels);
+    tft.setSwapBytes(swapBytes);
+}
+
+void IconCache::prefetchTask(void *arg) {
+    IconCache *cache = (IconCache *)arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (;;) {
+            // stay out of the way while the user is scrolling
+            uint32_t still = millis() - cache->_lastDraw;
+            if (still < ICON_CACHE_IDLE_MS) {
+                vTaskDelay(pdMS_TO_TICKS(ICON_CACHE_IDLE_MS - still));
+                continue;
+            }
+            xSemaphoreTake(cache->_lock, portMAX_DELAY);
+            if (cache->_queue.empty()) {
+                xSemaphoreGive(cache->_lock);
+                break;
+            }
+            Request next = cache->_queue.front();
+            cache->_queue.erase(cache->_queue.begin());
+            xSemaphoreGive(cache->_lock);
+            cache->load(*next.fs, next.path, false, 0, 0, false);
+        }
+    }
+}
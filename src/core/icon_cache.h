@@ -0,0 +1,66 @@
+#ifndef __ICON_CACHE_H__
+#define __ICON_CACHE_H__
+#include "image_decode.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <vector>
+
+#define ICON_CACHE_BUDGET (768 * 1024) // bytes of decoded pixels kept, PSRAM only
+#define ICON_CACHE_IDLE_MS 300         // the menu must be still this long before prefetching
+#define ICON_CACHE_MAX_QUEUE 4
+
+// Decoded theme images kept in PSRAM, least recently used dropped first.
+// Entries are keyed by path and the file's size and mtime, so an edited image is decoded again.
+// A hit is one pushImage() from RAM; prefetch() lets a low priority task decode the images the
+// user is likely to scroll to next while the menu is idle. Without PSRAM nothing is cached.
+class IconCache {
+public:
+    // Draws like drawImg(). False when the image can't be cached (GIF, no PSRAM, decode error),
+    // the caller then falls back to drawImg().
+    bool draw(FS &fs, const String &path, int x, int y, bool center);
+    // Decodes `path` in the background unless it is cached already
+    void prefetch(FS &fs, const String &path);
+    void clear();
+
+    size_t bytes();
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+
+private:
+    struct Entry {
+        FS *fs;
+        String path;
+        size_t size;
+        time_t mtime;
+        uint16_t background;
+        uint32_t lastUse;
+        DecodedImage image;
+    };
+    struct Request {
+        FS *fs;
+        String path;
+    };
+
+    std::vector<Entry> _entries;
+    std::vector<Request> _queue;
+    size_t _bytes = 0;
+    SemaphoreHandle_t _lock = nullptr;
+    StaticSemaphore_t _lockBuffer;
+    TaskHandle_t _task = nullptr;
+    volatile uint32_t _lastDraw = 0;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+
+    bool begin();
+    static bool stat(FS &fs, const String &path, size_t &size, time_t &mtime);
+    Entry *find(FS &fs, const String &path); // with _lock held
+    void remove(Entry *entry);               // with _lock held
+    bool load(FS &fs, const String &path, bool draw, int x, int y, bool center);
+    static void push(const DecodedImage &image, int x, int y, bool center);
+    static void prefetchTask(void *arg);
+};
+
+extern IconCache iconCache;
+
+#endif
@@ -0,0 +1,189 @@
+#include "image_cache.h"
+#include <esp_heap_caps.h>
+
+static void *cacheAlloc(size_t bytes) {
+    void *p = heap_caps_malloc(bytes, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    return p ? p : heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+}
+
+String imageCachePath(const String &imagePath) {
+    int slash = imagePath.lastIndexOf('/');
+    String dir = slash >= 0 ? imagePath.substring(0, slash) : "";
+    if (!dir.startsWith("/")) dir = "/" + dir;
+    if (!dir.endsWith("/")) dir += "/";
+    return dir + "tmp/" + imagePath.substring(slash + 1) + IMAGE_CACHE_EXT;
+}
+
+bool imageCacheSource(FS &fs, const String &imagePath, uint16_t background, ImageCacheSource &source) {
+    File file = fs.open(imagePath, FILE_READ);
+    if (!file || file.isDirectory()) return false;
+    source.size = file.size();
+    source.mtime = (uint32_t)file.getLastWrite();
+    source.background = background;
+    file.close();
+    return true;
+}
+
+bool writeImageCache(
+    FS &fs, const String &cachePath, const uint16_t *pixels, uint16_t width, uint16_t height,
+    const ImageCacheSource &source
+) {
+    if (!pixels || !width || !height) return false;
+    const uint16_t rows = IMAGE_CACHE_BAND_ROWS;
+    const uint16_t bands = (height + rows - 1) / rows;
+
+    ImageCacheHeader header = {};
+    memcpy(header.magic, IMAGE_CACHE_MAGIC, sizeof(header.magic));
+    header.version = IMAGE_CACHE_VERSION;
+    header.bandRows = rows;
+    header.width = width;
+    header.height = height;
+    header.bands = bands;
+    header.background = source.background;
+    header.sourceSize = source.size;
+    header.sourceMtime = source.mtime;
+
+    uint32_t *index = (uint32_t *)cacheAlloc((bands + 1) * sizeof(uint32_t));
+    uint8_t *buf = (uint8_t *)cacheAlloc(ImageCacheReader::encodedBound((size_t)rows * width));
+    bool ok = index && buf;
+    if (ok) {
+        // sizes first, the index goes before the data
+        uint32_t offset = 0;
+        for (uint16_t b = 0; b < bands; b++) {
+            index[b] = offset;
+            size_t count = (size_t)min<uint16_t>(rows, height - b * rows) * width;
+            offset += ImageCacheReader::encode(pixels + (size_t)b * rows * width, count, nullptr);
+        }
+        index[bands] = header.dataSize = offset;
+    }
+
+    int slash = cachePath.lastIndexOf('/');
+    if (ok && slash > 0 && !fs.exists(cachePath.substring(0, slash))) fs.mkdir(cachePath.substring(0, slash));
+    File file;
+    if (ok) file = fs.open(cachePath, FILE_WRITE);
+    ok = ok && file;
+    ok = ok && file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+    size_t indexBytes = (bands + 1) * sizeof(uint32_t);
+    ok = ok && file.write((const uint8_t *)index, indexBytes) == indexBytes;
+    for (uint16_t b = 0; ok && b < bands; b++) {
+        size_t count = (size_t)min<uint16_t>(rows, height - b * rows) * width;
+        size_t len = ImageCacheReader::encode(pixels + (size_t)b * rows * width, count, buf);
+        ok = file.write(buf, len) == len;
+    }
+    if (file) file.close();
+    if (!ok && file) fs.remove(cachePath);
+    if (index) heap_caps_free(index);
+    if (buf) heap_caps_free(buf);
+    return ok;
+}
+
+size_t ImageCacheReader::encode(const uint16_t *pixels, size_t count, uint8_t *out) {
+    size_t at = 0;
+    auto put = [&](uint16_t v) {
+        if (out) {
+            out[at] = v;
+            out[at + 1] = v >> 8;
+        }
+        at += 2;
+    };
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && run < 32768 && pixels[i + run] == pixels[i]) run++;
+        if (run >= 3) {
+            put(0x8000 | (run - 1));
+            put(pixels[i]);
+            i += run;
+            continue;
+        }
+        // literals until the next run of 3 or more
+        size_t start = i;
+        while (i < count && i - start < 32768) {
+            if (i + 2 < count && pixels[i] == pixels[i + 1] && pixels[i] == pixels[i + 2]) break;
+            i++;
+        }
+        put(i - start - 1);
+        for (size_t k = start; k < i; k++) put(pixels[k]);
+    }
+    return at;
+}
+
+bool ImageCacheReader::decode(const uint8_t *in, size_t len, uint16_t *pixels, size_t count) {
+    size_t at = 0, px = 0;
+    while (px < count) {
+        if (at + 2 > len) return false;
+        uint16_t word = in[at] | (in[at + 1] << 8);
+        at += 2;
+        size_t n = (word & 0x7FFF) + 1;
+        size_t payload = (word & 0x8000) ? 2 : 2 * n;
+        if (px + n > count || at + payload > len) return false;
+        if (word & 0x8000) {
+            uint16_t value = in[at] | (in[at + 1] << 8);
+            for (size_t k = 0; k < n; k++) pixels[px++] = value;
+        } else {
+            for (size_t k = 0; k < n; k++) pixels[px++] = in[at + 2 * k] | (in[at + 2 * k + 1] << 8);
+        }
+        at += payload;
+    }
+    return at == len;
+}
+
+bool ImageCacheReader::open(FS &fs, const String &cachePath, const ImageCacheSource &source) {
+    close();
+    _file = fs.open(cachePath, FILE_READ);
+    if (!_file) return false;
+
+    ImageCacheHeader &h = _header;
+    bool ok = _file.read((uint8_t *)&h, sizeof(h)) == sizeof(h) &&
+              memcmp(h.magic, IMAGE_CACHE_MAGIC, sizeof(h.magic)) == 0 && h.version == IMAGE_CACHE_VERSION;
+    ok = ok && h.bandRows && h.width && h.height && h.bands == (h.height + h.bandRows - 1) / h.bandRows;
+    ok = ok && h.sourceSize == source.size && h.sourceMtime == source.mtime;
+    ok = ok && h.background == source.background;
+    size_t indexBytes = (h.bands + 1) * sizeof(uint32_t);
+    ok = ok && _file.size() == sizeof(h) + indexBytes + h.dataSize;
+    if (ok) _index = (uint32_t *)cacheAlloc(indexBytes);
+    ok = ok && _index && _file.read((uint8_t *)_index, indexBytes) == indexBytes;
+
+    uint32_t longest = 0;
+    for (uint16_t b = 0; ok && b < h.bands; b++) {
+        ok = _index[b] <= _index[b + 1];
+        longest = max(longest, _index[b + 1] - _index[b]);
+    }
+    ok = ok && _index[0] == 0 && _index[h.bands] == h.dataSize &&
+         longest <= encodedBound((size_t)h.bandRows * h.width);
+    if (ok) _buf = (uint8_t *)cacheAlloc(longest ? longest : 1);
+    if (!ok || !_buf) {
+        close();
+        return false;
+    }
+    _dataStart = sizeof(h) + indexBytes;
+    _nextOffset = 0;
+    return true;
+}
+
+void ImageCacheReader::close() {
+    if (_file) _file.close();
+    if (_index) heap_caps_free(_index);
+    if (_buf) heap_caps_free(_buf);
+    _index = nullptr;
+    _buf = nullptr;
+    _header = {};
+    _nextOffset = 0xFFFFFFFF;
+}
+
+uint16_t ImageCacheReader::rowsIn(uint16_t band) const {
+    if (band >= _header.bands) return 0;
+    return min<uint16_t>(_header.bandRows, _header.height - band * _header.bandRows);
+}
+
+uint16_t ImageCacheReader::readBand(uint16_t band, uint16_t *pixels) {
+    if (!_index || band >= _header.bands) return 0;
+    uint32_t offset = _index[band];
+    uint32_t len = _index[band + 1] - offset;
+    if (offset != _nextOffset && !_file.seek(_dataStart + offset)) return 0;
+    _nextOffset = 0xFFFFFFFF;
+    if (_file.read(_buf, len) != len) return 0;
+    _nextOffset = offset + len; // bands read in order need no seek
+    uint16_t rows = rowsIn(band);
+    return decode(_buf, len, pixels, (size_t)rows * _header.width) ? rows : 0;
+}
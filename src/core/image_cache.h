@@ -0,0 +1,87 @@
+#ifndef __IMAGE_CACHE_H__
+#define __IMAGE_CACHE_H__
+#include <Arduino.h>
+#include <FS.h>
+
+// Decoded image cache file, one format for every source type (JPEG, PNG, BMP, GIF first frame).
+// Lives next to the source as <dir>/tmp/<file name>.bic:
+//
+//   header    32 bytes, see ImageCacheHeader
+//   index     uint32 offset of each band in the data, plus the end offset
+//   data      bands of bandRows full-width rows, RGB565 (native order) run-length encoded:
+//             uint16 n < 0x8000: n + 1 literal pixels follow
+//             uint16 n >= 0x8000: the next pixel repeats (n & 0x7FFF) + 1 times
+//
+// The header keeps the source's size and mtime, and the colour transparent pixels were filled
+// with, so a cache made from an older version of the image or for another theme is not used.
+#define IMAGE_CACHE_MAGIC "BIMG"
+#define IMAGE_CACHE_VERSION 1
+#define IMAGE_CACHE_BAND_ROWS 16
+#define IMAGE_CACHE_EXT ".bic"
+
+struct __attribute__((packed)) ImageCacheHeader {
+    char magic[4];
+    uint8_t version;
+    uint8_t flags; // reserved
+    uint16_t bandRows;
+    uint16_t width;
+    uint16_t height;
+    uint16_t bands;
+    uint16_t background;
+    uint32_t sourceSize;
+    uint32_t sourceMtime;
+    uint32_t dataSize;
+    uint32_t reserved;
+};
+
+// What a cache must match to be used
+struct ImageCacheSource {
+    uint32_t size = 0;
+    uint32_t mtime = 0;
+    uint16_t background = 0;
+};
+
+String imageCachePath(const String &imagePath);
+// Fills `source` from the image file. False if it doesn't exist.
+bool imageCacheSource(FS &fs, const String &imagePath, uint16_t background, ImageCacheSource &source);
+// Writes `width` x `height` pixels to `cachePath` (creating its folder)
+bool writeImageCache(
+    FS &fs, const String &cachePath, const uint16_t *pixels, uint16_t width, uint16_t height,
+    const ImageCacheSource &source
+);
+
+class ImageCacheReader {
+public:
+    ImageCacheReader() = default;
+    ~ImageCacheReader() { close(); }
+    ImageCacheReader(const ImageCacheReader &) = delete;
+    ImageCacheReader &operator=(const ImageCacheReader &) = delete;
+
+    // False when the cache is missing, damaged or was made from something else than `source`
+    bool open(FS &fs, const String &cachePath, const ImageCacheSource &source);
+    void close();
+
+    uint16_t width() const { return _header.width; }
+    uint16_t height() const { return _header.height; }
+    uint16_t bandRows() const { return _header.bandRows; }
+    uint16_t bands() const { return _header.bands; }
+    uint16_t rowsIn(uint16_t band) const;
+
+    // Decodes `band` into `pixels` (room for bandRows() * width()). Returns its rows, 0 on error.
+    uint16_t readBand(uint16_t band, uint16_t *pixels);
+
+    static size_t encode(const uint16_t *pixels, size_t count, uint8_t *out);
+    static bool decode(const uint8_t *in, size_t len, uint16_t *pixels, size_t count);
+    // Worst case encode() output for `count` pixels
+    static size_t encodedBound(size_t count) { return (count + count / 32768 + 2) * sizeof(uint16_t); }
+
+private:
+    File _file;
+    ImageCacheHeader _header = {};
+    uint32_t *_index = nullptr;
+    uint8_t *_buf = nullptr;
+    uint32_t _dataStart = 0;
+    uint32_t _nextOffset = 0xFFFFFFFF; // where the file position is, in data offsets
+};
+
+#endif
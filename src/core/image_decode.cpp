@@ -0,0 +1,210 @@
+#include "image_decode.h"
+#include <JPEGDecoder.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#if !defined(LITE_VERSION)
+#include <AnimatedGIF.h>
+#include <PNGdec.h>
+#endif
+
+static StaticSemaphore_t jpegLockBuffer;
+static SemaphoreHandle_t jpegLock = xSemaphoreCreateRecursiveMutexStatic(&jpegLockBuffer);
+
+void takeJpegDecoder() { xSemaphoreTakeRecursive(jpegLock, portMAX_DELAY); }
+void giveJpegDecoder() { xSemaphoreGiveRecursive(jpegLock); }
+
+static void *allocPixels(size_t bytes) {
+    void *p = heap_caps_malloc(bytes, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    return p ? p : heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+}
+
+void DecodedImage::release() {
+    if (pixels) heap_caps_free(pixels);
+    pixels = nullptr;
+    width = height = 0;
+}
+
+static bool allocImage(DecodedImage &out, uint32_t w, uint32_t h, uint16_t maxW, uint16_t maxH) {
+    if (!w || !h || w > maxW || h > maxH) return false;
+    out.pixels = (uint16_t *)allocPixels(w * h * sizeof(uint16_t));
+    if (!out.pixels) return false;
+    out.width = w;
+    out.height = h;
+    return true;
+}
+
+static uint8_t *readAll(FS &fs, const String &path, size_t &size) {
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) return nullptr;
+    size = file.size();
+    uint8_t *data = size ? (uint8_t *)allocPixels(size) : nullptr;
+    if (data && file.read(data, size) != size) {
+        heap_caps_free(data);
+        data = nullptr;
+    }
+    file.close();
+    return data;
+}
+
+static bool decodeJpeg(const uint8_t *data, size_t size, DecodedImage &out, uint16_t maxW, uint16_t maxH) {
+    takeJpegDecoder();
+    bool ok = JpegDec.decodeArray(data, size) == 1;
+    if (ok && !allocImage(out, JpegDec.width, JpegDec.height, maxW, maxH)) {
+        JpegDec.abort();
+        ok = false;
+    }
+    if (ok) {
+        const uint32_t mcuW = JpegDec.MCUWidth, mcuH = JpegDec.MCUHeight;
+        while (JpegDec.read()) {
+            uint32_t x0 = JpegDec.MCUx * mcuW, y0 = JpegDec.MCUy * mcuH;
+            if (x0 >= out.width || y0 >= out.height) continue;
+            // MCUs on the right and bottom edges are cropped
+            uint32_t w = min(mcuW, out.width - x0), h = min(mcuH, out.height - y0);
+            for (uint32_t row = 0; row < h; row++)
+                memcpy(out.pixels + (y0 + row) * out.width + x0, JpegDec.pImage + row * mcuW, w * 2);
+        }
+    }
+    giveJpegDecoder();
+    return ok;
+}
+
+static uint16_t le16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t le32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+
+// Uncompressed 24-bit only, like drawBmp()
+static bool decodeBmp(const uint8_t *data, size_t size, DecodedImage &out, uint16_t maxW, uint16_t maxH) {
+    if (size < 54 || le16(data) != 0x4D42) return false;
+    uint32_t offset = le32(data + 10);
+    int32_t w = (int32_t)le32(data + 18), h = (int32_t)le32(data + 22);
+    if (le16(data + 26) != 1 || le16(data + 28) != 24 || le32(data + 30) != 0) return false;
+    bool bottomUp = h > 0;
+    if (!bottomUp) h = -h;
+    if (w <= 0 || h <= 0) return false;
+    uint32_t stride = (w * 3 + 3) & ~3u;
+    if (offset + stride * (uint64_t)h > size || !allocImage(out, w, h, maxW, maxH)) return false;
+
+    for (int32_t row = 0; row < h; row++) {
+        const uint8_t *src = data + offset + stride * (bottomUp ? h - 1 - row : row);
+        uint16_t *dst = out.pixels + row * w;
+        for (int32_t col = 0; col < w; col++, src += 3)
+            dst[col] = ((src[2] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[0] >> 3);
+    }
+    return true;
+}
+
+#if !defined(LITE_VERSION)
+namespace {
+struct PngTarget {
+    PNG *png;
+    DecodedImage *image;
+    uint32_t background;
+};
+
+int pngToBuffer(PNGDRAW *pDraw) {
+    PngTarget *target = (PngTarget *)pDraw->pUser;
+    if (pDraw->y >= target->image->height) return 0;
+    uint16_t *row = target->image->pixels + pDraw->y * target->image->width;
+    target->png->getLineAsRGB565(pDraw, row, PNG_RGB565_LITTLE_ENDIAN, target->background);
+    return 1;
+}
+} // namespace
+
+static bool decodePng(
+    uint8_t *data, size_t size, DecodedImage &out, uint16_t background, uint16_t maxW, uint16_t maxH
+) {
+    // the decoder is ~48KB, its own instance keeps this independent of drawPNG()
+    void *mem = allocPixels(sizeof(PNG));
+    if (!mem) return false;
+    PNG *png = new (mem) PNG();
+    bool ok = png->openRAM(data, size, pngToBuffer) == PNG_SUCCESS &&
+              allocImage(out, png->getWidth(), png->getHeight(), maxW, maxH);
+    if (ok) {
+        // 0x00BBGGRR, what getLineAsRGB565() expects for the background
+        uint32_t r = (background & 0xF800) >> 8, g = (background & 0x07E0) >> 3, b = (background & 0x1F) << 3;
+        PngTarget target = {png, &out, b << 16 | g << 8 | r};
+        ok = png->decode(&target, 0) == PNG_SUCCESS;
+    }
+    png->close();
+    png->~PNG();
+    heap_caps_free(mem);
+    return ok;
+}
+
+namespace {
+struct GifTarget {
+    DecodedImage *image;
+};
+
+void gifToBuffer(GIFDRAW *pDraw) {
+    DecodedImage *image = ((GifTarget *)pDraw->pUser)->image;
+    int y = pDraw->iY + pDraw->y;
+    if (y >= image->height || pDraw->iX >= image->width) return;
+    int width = min(pDraw->iWidth, image->width - pDraw->iX);
+    uint16_t *row = image->pixels + y * image->width + pDraw->iX;
+    const uint8_t *s = pDraw->pPixels;
+    for (int x = 0; x < width; x++) {
+        // transparent pixels keep the background the canvas was filled with
+        if (!pDraw->ucHasTransparency || s[x] != pDraw->ucTransparent) row[x] = pDraw->pPalette[s[x]];
+    }
+}
+} // namespace
+
+// Only the first frame, on a canvas filled with `background`
+static bool decodeGif(
+    uint8_t *data, size_t size, DecodedImage &out, uint16_t background, uint16_t maxW, uint16_t maxH
+) {
+    void *mem = allocPixels(sizeof(AnimatedGIF));
+    if (!mem) return false;
+    AnimatedGIF *gif = new (mem) AnimatedGIF();
+    gif->begin(LITTLE_ENDIAN_PIXELS);
+    bool ok = gif->open(data, size, gifToBuffer) &&
+              allocImage(out, gif->getCanvasWidth(), gif->getCanvasHeight(), maxW, maxH);
+    if (ok) {
+        for (size_t i = 0; i < (size_t)out.width * out.height; i++) out.pixels[i] = background;
+        GifTarget target = {&out};
+        ok = gif->playFrame(false, nullptr, &target) >= 0;
+    }
+    gif->close();
+    gif->~AnimatedGIF();
+    heap_caps_free(mem);
+    return ok;
+}
+#endif
+
+static String extensionOf(const String &path) {
+    String ext = path.substring(path.lastIndexOf('.') + 1);
+    ext.toLowerCase();
+    return ext;
+}
+
+bool isDecodableImage(const String &path) {
+    String ext = extensionOf(path);
+#if !defined(LITE_VERSION)
+    if (ext == "png" || ext == "gif") return true;
+#endif
+    return ext == "jpg" || ext == "jpeg" || ext == "bmp";
+}
+
+bool decodeImage(
+    FS &fs, const String &path, DecodedImage &out, uint16_t background, uint16_t maxWidth, uint16_t maxHeight
+) {
+    out.release();
+    if (!isDecodableImage(path)) return false;
+    size_t size = 0;
+    uint8_t *data = readAll(fs, path, size);
+    if (!data) return false;
+
+    String ext = extensionOf(path);
+    bool ok = false;
+    if (ext == "bmp") ok = decodeBmp(data, size, out, maxWidth, maxHeight);
+#if !defined(LITE_VERSION)
+    else if (ext == "png") ok = decodePng(data, size, out, background, maxWidth, maxHeight);
+    else if (ext == "gif") ok = decodeGif(data, size, out, background, maxWidth, maxHeight);
+#endif
+    else ok = decodeJpeg(data, size, out, maxWidth, maxHeight);
+
+    heap_caps_free(data);
+    if (!ok) out.release();
+    return ok;
+}
@@ -0,0 +1,30 @@
+#ifndef __IMAGE_DECODE_H__
+#define __IMAGE_DECODE_H__
+#include <Arduino.h>
+#include <FS.h>
+
+// RGB565 pixels in native byte order (push with setSwapBytes(true)), row after row
+struct DecodedImage {
+    uint16_t *pixels = nullptr;
+    uint16_t width = 0;
+    uint16_t height = 0;
+
+    size_t bytes() const { return (size_t)width * height * sizeof(uint16_t); }
+    void release();
+};
+
+// Decodes a JPEG, PNG, 24-bit BMP or the first frame of a GIF into PSRAM (internal RAM when there
+// is none). Transparent PNG and GIF pixels take `background`. Nothing is drawn, so it can run in a background task.
+// Images larger than maxWidth x maxHeight are refused.
+bool decodeImage(
+    FS &fs, const String &path, DecodedImage &out, uint16_t background, uint16_t maxWidth = 480,
+    uint16_t maxHeight = 480
+);
+// True for the extensions decodeImage() understands
+bool isDecodableImage(const String &path);
+
+// JpegDec is one global decoder, everything using it holds this (recursive) lock
+void takeJpegDecoder();
+void giveJpegDecoder();
+
+#endif
@@ -43,10 +43,12 @@ void MainMenu::begin(void) {
     returnToMenu = false;
     options = {};
 
+    _shownItems.clear();
     std::vector<String> l = bruceConfig.disabledMenus;
     for (int i = 0; i < _totalItems; i++) {
         String itemName = _menuItems[i]->getName();
         if (find(l.begin(), l.end(), itemName) == l.end()) { // If menu item is not disabled
+            _shownItems.push_back(_menuItems[i]);
             options.push_back(
                 {// selected lambda
                  _menuItems[i]->getName(),
@@ -60,6 +62,7 @@ void MainMenu::begin(void) {
                      float scale = float((float)tftWidth / (float)240);
                      if (bruceConfigPins.rotation & 0b01) scale = float((float)tftHeight / (float)135);
                      obj->draw(scale);
+                     mainMenu.prefetchIcons(obj);
 #if defined(HAS_TOUCH)
                      TouchFooter();
 #endif
@@ -73,6 +76,20 @@ void MainMenu::begin(void) {
     _currentIndex = loopOptions(options, MENU_TYPE_MAIN, "Main Menu", _currentIndex);
 };
 
+/*********************************************************************
+**  Function: prefetchIcons
+**  Decodes the theme images of the items next to `current` while idle
+**********************************************************************/
+void MainMenu::prefetchIcons(MenuItemInterface *current) {
+    size_t n = _shownItems.size();
+    for (size_t i = 0; i < n; i++) {
+        if (_shownItems[i] != current) continue;
+        _shownItems[(i + 1) % n]->prefetchIconImg();
+        _shownItems[(i + n - 1) % n]->prefetchIconImg();
+        break;
+    }
+}
+
 /*********************************************************************
 **  Function: hideAppsMenu
 **  Menu to Hide or show menus
@@ -48,11 +48,13 @@ public:
     void begin(void);
     std::vector<MenuItemInterface *> getItems(void) { return _menuItems; }
     void hideAppsMenu();
+    void prefetchIcons(MenuItemInterface *current);
 
 private:
     int _currentIndex = 0;
     int _totalItems = 0;
     std::vector<MenuItemInterface *> _menuItems;
+    std::vector<MenuItemInterface *> _shownItems; // not disabled, in menu order
 };
 extern MainMenu mainMenu;
 
@@ -233,14 +233,18 @@ void ConfigMenu::powerMenu() {
         std::vector<Option> localOptions = {
             {"Deep Sleep", goToDeepSleep          },
             {"Sleep",      setSleepMode           },
-            {"Restart",    []() { ESP.restart(); }},
+            {"Restart",
+             []() {
+                 bruceConfig.commit();
+                 ESP.restart();
+             }                                    },
             {"Power Off",
              []() {
                  // Confirmation dialog for power off
                  drawMainBorder(true);
                  int8_t choice = displayMessage("Power Off Device?", "No", nullptr, "Yes", TFT_RED);
 
-                 if (choice == 1) { powerOff(); }
+                 if (choice == 1) powerOff();
              }                                    },
             {"Back",       []() {}                },
         };
@@ -34,6 +34,11 @@ void GpsMenu::configMenu() {
     options = {
         {"Baudrate", setGpsBaudrateMenu                                 },
         {"GPS Pins", [=]() { setUARTPinsMenu(bruceConfigPins.gps_bus); }},
+        {String("Gzip Logs: ") + (bruceConfig.wardrivingGzip ? "ON" : "OFF"),
+         [this]() {
+             bruceConfig.setWardrivingGzip(!bruceConfig.wardrivingGzip);
+             configMenu();
+         }},
         {"Back",     [this]() { optionsMenu(); }                        },
     };
 
@@ -1266,6 +1266,7 @@ String num_keyboard(String current_text, int max_size, String textbox_title, boo
 void powerOff() { displayWarning("Not available", true); }
 void goToDeepSleep() {
 #if DEEPSLEEP_WAKEUP_PIN >= 0
+    beforePowerDown();
 
 #if SOC_PM_SUPPORT_EXT0_WAKEUP
     esp_sleep_enable_ext0_wakeup((gpio_num_t)DEEPSLEEP_WAKEUP_PIN, DEEPSLEEP_PIN_ACT);
@@ -1,4 +1,6 @@
 #include "net_utils.h"
+#include "core/oui_database.h"
+#include "core/sd_functions.h"
 #include <HTTPClient.h>
 #include <WiFi.h>
 #include <sstream>
@@ -14,12 +16,34 @@ bool internetConnection() {
     } else return false;
 }
 
+namespace {
+OuiDatabase ouiDb;
+uint32_t ouiDbLastTry = 0;
+
+// SD card first, then LittleFS. Retried every few seconds, so a card inserted later is picked up.
+bool openOuiDatabase() {
+    if (ouiDb.isOpen()) return true;
+    if (ouiDbLastTry && millis() - ouiDbLastTry < 5000) return false;
+    ouiDbLastTry = millis();
+    if (setupSdCard() && ouiDb.open(SD)) return true;
+    return ouiDb.open(LittleFS);
+}
+} // namespace
+
 String getManufacturer(const String &mac) {
+    uint32_t oui;
+    bool parsed = OuiDatabase::parseOui(mac, oui);
+    if (parsed && OuiDatabase::isLocal(oui)) return "RANDOMIZED";
+    if (parsed && openOuiDatabase()) {
+        String vendor = ouiDb.lookup(oui);
+        if (!vendor.isEmpty()) return vendor;
+        if (ouiDb.isOpen()) return "UNKNOWN";
+    }
+
+    // no offline table (see gen_oui_database.py), ask the online API
     if (!internetConnection()) { return "NO_INTERNET_ACCESS"; }
 
-    // there is an official(IEEE) doc that contains all registered mac prefixes
-    // but it is around 700kb and i don't know a way to get specific part
-    // without downloading the whole txt
+    // the API serves the same IEEE registry one prefix at a time
     HTTPClient http;
     http.begin("http://api.maclookup.app/v2/macs/" + mac);
     int httpCode = http.GET(); // Send the request
@@ -0,0 +1,158 @@
+#include "oui_database.h"
+#include <ctype.h>
+#include <string.h>
+
+namespace {
+const char OUIDB_MAGIC[4] = {'B', 'O', 'U', 'I'};
+const uint16_t OUIDB_VERSION = 1;
+const size_t OUIDB_RECORD_SIZE = 6;
+const uint16_t OUIDB_MAX_BLOCK = 128; // one block is read on the stack
+
+struct __attribute__((packed)) OuiDbFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t blockSize; // records per index entry
+    uint32_t count;
+    uint32_t indexOffset;
+    uint32_t recordsOffset;
+    uint32_t poolOffset;
+    uint32_t poolSize;
+};
+
+uint32_t recordPrefix(const uint8_t *r) { return ((uint32_t)r[0] << 16) | ((uint32_t)r[1] << 8) | r[2]; }
+uint32_t recordOffset(const uint8_t *r) { return r[3] | ((uint32_t)r[4] << 8) | ((uint32_t)r[5] << 16); }
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+} // namespace
+
+bool OuiDatabase::open(FS &fs, const String &path) {
+    close();
+    _file = fs.open(path, "r");
+    if (!_file) return false;
+
+    OuiDbFileHeader hdr;
+    bool ok = _file.read((uint8_t *)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+              memcmp(hdr.magic, OUIDB_MAGIC, sizeof(OUIDB_MAGIC)) == 0 && hdr.version == OUIDB_VERSION &&
+              hdr.blockSize > 0 && hdr.blockSize <= OUIDB_MAX_BLOCK &&
+              hdr.recordsOffset + (uint64_t)hdr.count * OUIDB_RECORD_SIZE <= hdr.poolOffset &&
+              hdr.poolOffset + (uint64_t)hdr.poolSize <= _file.size();
+    if (ok) {
+        _index.resize((hdr.count + hdr.blockSize - 1) / hdr.blockSize);
+        size_t bytes = _index.size() * sizeof(uint32_t);
+        ok = _file.seek(hdr.indexOffset) && _file.read((uint8_t *)_index.data(), bytes) == bytes;
+    }
+    if (!ok) {
+        close();
+        return false;
+    }
+    _count = hdr.count;
+    _blockSize = hdr.blockSize;
+    _recordsOffset = hdr.recordsOffset;
+    _poolOffset = hdr.poolOffset;
+    _poolSize = hdr.poolSize;
+    return true;
+}
+
+void OuiDatabase::close() {
+    if (_file) _file.close();
+    _index.clear();
+    _index.shrink_to_fit();
+    _count = 0;
+    for (auto &entry : _cache) {
+        entry.oui = 0xFFFFFFFF;
+        entry.name = "";
+    }
+}
+
+bool OuiDatabase::parseOui(const String &mac, uint32_t &oui) {
+    oui = 0;
+    int digits = 0;
+    for (size_t i = 0; i < mac.length() && digits < 6; i++) {
+        int v = hexValue(mac[i]);
+        if (v < 0) {
+            // separators only between octets
+            if ((mac[i] == ':' || mac[i] == '-' || mac[i] == '.') && digits % 2 == 0 && digits) continue;
+            return false;
+        }
+        oui = (oui << 4) | v;
+        digits++;
+    }
+    return digits == 6;
+}
+
+String OuiDatabase::lookup(uint32_t oui) {
+    if (!_file) return String();
+    oui &= 0xFFFFFF;
+
+    CacheEntry *victim = &_cache[0];
+    for (auto &entry : _cache) {
+        if (entry.oui == oui) {
+            entry.used = ++_clock;
+            _hits++;
+            return entry.name;
+        }
+        if (entry.used < victim->used) victim = &entry;
+    }
+    _misses++;
+
+    String name;
+    uint32_t offset;
+    if (find(oui, offset) && !readName(offset, name)) close();
+    if (!_file) return String(); // card removed or damaged file, the caller may open it again
+    victim->oui = oui;
+    victim->used = ++_clock;
+    victim->name = name;
+    return name;
+}
+
+bool OuiDatabase::find(uint32_t oui, uint32_t &nameOffset) {
+    if (_index.empty() || oui < _index[0]) return false;
+
+    // last block whose first prefix is <= oui
+    size_t lo = 0, hi = _index.size();
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (_index[mid] <= oui) lo = mid;
+        else hi = mid;
+    }
+
+    uint32_t first = lo * _blockSize;
+    uint32_t n = min<uint32_t>(_blockSize, _count - first);
+    uint8_t block[OUIDB_MAX_BLOCK * OUIDB_RECORD_SIZE];
+    size_t bytes = n * OUIDB_RECORD_SIZE;
+    if (!_file.seek(_recordsOffset + first * OUIDB_RECORD_SIZE) || _file.read(block, bytes) != bytes) {
+        close();
+        return false;
+    }
+
+    int l = 0, r = (int)n - 1;
+    while (l <= r) {
+        int mid = (l + r) / 2;
+        const uint8_t *rec = block + mid * OUIDB_RECORD_SIZE;
+        uint32_t prefix = recordPrefix(rec);
+        if (prefix == oui) {
+            nameOffset = recordOffset(rec);
+            return true;
+        }
+        if (prefix < oui) l = mid + 1;
+        else r = mid - 1;
+    }
+    return false;
+}
+
+bool OuiDatabase::readName(uint32_t offset, String &name) {
+    if (offset >= _poolSize) return false;
+    char buf[OUI_DB_MAX_NAME + 1];
+    size_t want = min<uint32_t>(OUI_DB_MAX_NAME, _poolSize - offset);
+    if (!_file.seek(_poolOffset + offset)) return false;
+    size_t got = _file.read((uint8_t *)buf, want);
+    if (got == 0) return false;
+    buf[got] = '\0';
+    name = buf; // stops at the NUL
+    return true;
+}
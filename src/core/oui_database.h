@@ -0,0 +1,68 @@
+#ifndef __OUI_DATABASE_H__
+#define __OUI_DATABASE_H__
+#include <Arduino.h>
+#include <FS.h>
+#include <vector>
+
+// Offline IEEE OUI (MA-L) vendor table, built by gen_oui_database.py from the IEEE oui.csv.
+//
+// File layout, integers little endian:
+//   header      OuiDbFileHeader
+//   index       uint32 first prefix of every `blockSize` records (kept in RAM, ~2.5KB)
+//   records     `count` x 6 bytes sorted by prefix: 24 bit prefix (big endian), 24 bit pool offset
+//   pool        deduplicated NUL terminated vendor names
+// A lookup bisects the index in RAM, reads one block of records, bisects it, then reads the name:
+// two small reads whatever the table size. Recent answers (misses too) are kept in an LRU cache.
+
+#define OUI_DB_PATH "/BruceOUI/oui.bin"
+#define OUI_DB_CACHE_SIZE 32
+#define OUI_DB_MAX_NAME 96
+
+class OuiDatabase {
+public:
+    ~OuiDatabase() { close(); }
+
+    bool open(FS &fs, const String &path = OUI_DB_PATH);
+    void close();
+    bool isOpen() const { return _file; }
+    uint32_t count() const { return _count; }
+
+    // Vendor name, empty when the prefix is not registered or on read errors
+    String lookup(uint32_t oui);
+    String lookup(const String &mac) {
+        uint32_t oui;
+        return parseOui(mac, oui) ? lookup(oui) : String();
+    }
+
+    // First three octets of "aa:bb:cc:..", "AA-BB-CC..." or "aabbcc..."
+    static bool parseOui(const String &mac, uint32_t &oui);
+    // Locally administered bit: randomized client MACs, never in the IEEE registry
+    static bool isLocal(uint32_t oui) { return oui & 0x020000; }
+
+    uint32_t cacheHits() const { return _hits; }
+    uint32_t cacheMisses() const { return _misses; }
+
+private:
+    struct CacheEntry {
+        uint32_t oui = 0xFFFFFFFF; // never a 24 bit prefix
+        uint32_t used = 0;
+        String name;
+    };
+
+    bool find(uint32_t oui, uint32_t &nameOffset);
+    bool readName(uint32_t offset, String &name);
+
+    File _file;
+    uint32_t _count = 0;
+    uint16_t _blockSize = 0;
+    uint32_t _recordsOffset = 0;
+    uint32_t _poolOffset = 0;
+    uint32_t _poolSize = 0;
+    std::vector<uint32_t> _index;
+    CacheEntry _cache[OUI_DB_CACHE_SIZE];
+    uint32_t _clock = 0;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+};
+
+#endif
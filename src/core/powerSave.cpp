@@ -62,3 +62,5 @@ void sleepModeOff() {
     feedLoopWDT();
     delay(200);
 }
+
+void beforePowerDown() { bruceConfig.commit(); }
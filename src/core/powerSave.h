@@ -8,3 +8,7 @@ void sleepModeOn();
 void sleepModeOff();
 
 void fadeOutScreen(int startValue);
+
+// Flushes what must survive the power going away (pending config writes).
+// Every powerOff() and goToDeepSleep() calls it first, callers don't need to.
+void beforePowerDown();
@@ -1,6 +1,9 @@
 #include "sd_functions.h"
 #include "display.h" // using displayRedStripe as error msg
+#include "file_hash.h"
+#include "file_viewer.h"
 #include "modules/badusb_ble/ducky_typer.h"
+#include "modules/bjs_interpreter/bytecode_js.h"
 #include "modules/bjs_interpreter/interpreter.h"
 #include "modules/gps/wigle.h"
 #include "modules/ir/TV-B-Gone.h"
@@ -13,16 +16,10 @@
 #include "modules/rf/rf_send.h"
 #include "mykeyboard.h" // using keyboard when calling rename
 #include "passwords.h"
-#include "scrollableTextArea.h"
 #include <globals.h>
 
-#include <MD5Builder.h>
-#include <algorithm> // for std::sort
-#include <esp_rom_crc.h>
-
 // SPIClass sdcardSPI;
 String fileToCopy;
-std::vector<FileList> fileList;
 
 /***************************************************************************************
 ** Function name: setupSdCard
@@ -423,119 +420,46 @@ size_t getFileSize(FS &fs, String filepath) {
     return fileSize;
 }
 
-String md5File(FS &fs, String filepath) {
-    if (!fs.exists(filepath)) return "";
-    String txt = readSmallFile(fs, filepath);
-    MD5Builder md5;
-    md5.begin();
-    md5.add(txt);
-    md5.calculate();
-    return (md5.toString());
-}
+String md5File(FS &fs, String filepath) { return hashFile(fs, filepath, HASH_MD5); }
 
-String crc32File(FS &fs, String filepath) {
-    if (!fs.exists(filepath)) return "";
-    String txt = readSmallFile(fs, filepath);
-    // derived from
-    // https://techoverflow.net/2022/08/05/how-to-compute-crc32-with-ethernet-polynomial-0x04c11db7-on-esp32-crc-h/
-    uint32_t romCRC =
-        (~esp_rom_crc32_le((uint32_t)~(0xffffffff), (const uint8_t *)txt.c_str(), txt.length())) ^ 0xffffffff;
-
-    char s[18] = {0};
-    char crcBytes[4] = {0};
-    memcpy(crcBytes, &romCRC, sizeof(uint32_t));
-    snprintf(s, sizeof(s), "%02X%02X%02X%02X\n", crcBytes[3], crcBytes[2], crcBytes[1], crcBytes[0]);
-    return (String(s));
-}
+String crc32File(FS &fs, String filepath) { return hashFile(fs, filepath, HASH_CRC32); }
 
-/***************************************************************************************
-** Function name: sortList
-** Description:   sort files/folders by name
-***************************************************************************************/
-bool sortList(const FileList &a, const FileList &b) {
-    if (a.folder != b.folder) {
-        return a.folder > b.folder; // true if a is a folder and b is not
-    }
-    // Order items alphabetically
-    String fa = a.filename.c_str();
-    fa.toUpperCase();
-    String fb = b.filename.c_str();
-    fb.toUpperCase();
-    return fa < fb;
-}
+String sha256File(FS &fs, String filepath) { return hashFile(fs, filepath, HASH_SHA256); }
 
 /***************************************************************************************
-** Function name: checkExt
-** Description:   check file extension
+** Function name: showFileHashes
+** Description:   hash a file with a progress bar and show the digests until a key press
 ***************************************************************************************/
-bool checkExt(String ext, String pattern) {
-    ext.toUpperCase();
-    pattern.toUpperCase();
-    if (ext == pattern) return true;
-
-    // If the pattern is a list of extensions (e.g., "TXT|JPG|PNG"), split and check
-    int start = 0;
-    int end = pattern.indexOf('|');
-    while (end != -1) {
-        String currentExt = pattern.substring(start, end);
-        if (ext == currentExt) { return true; }
-        start = end + 1;
-        end = pattern.indexOf('|', start);
-    }
-
-    // Check the last extension in the list
-    String lastExt = pattern.substring(start);
-    return ext == lastExt;
-}
-
-/***************************************************************************************
-** Function name: readFs
-** Description:   read files/folders from a folder
-***************************************************************************************/
-void readFs(FS fs, String folder, String allowed_ext) {
-    int allFilesCount = 0;
-    fileList.clear();
-    FileList object;
-
-    File root = fs.open(folder);
-    if (!root || !root.isDirectory()) { return; }
-
-    while (true) {
-        bool isDir;
-        String fullPath = root.getNextFileName(&isDir);
-        String nameOnly = fullPath.substring(fullPath.lastIndexOf("/") + 1);
-        if (fullPath == "") { break; }
-        // Serial.printf("Path: %s (isDir: %d)\n", fullPath.c_str(), isDir);
-
-        if (isDir) {
-            object.filename = nameOnly;
-            object.folder = true;
-            object.operation = false;
-            fileList.push_back(object);
-        } else {
-            int dotIndex = nameOnly.lastIndexOf(".");
-            String ext = dotIndex >= 0 ? nameOnly.substring(dotIndex + 1) : "";
-            if (allowed_ext == "*" || checkExt(ext, allowed_ext)) {
-                object.filename = nameOnly;
-                object.folder = false;
-                object.operation = false;
-                fileList.push_back(object);
-            }
-        }
-    }
-    root.close();
-
-    // Sort folders/files
-    std::sort(fileList.begin(), fileList.end(), sortList);
-
-    Serial.println("Files listed with: " + String(fileList.size()) + " files/folders found");
-
-    // Adds Operational btn at the botton
-    object.filename = "> Back";
-    object.folder = false;
-    object.operation = true;
-
-    fileList.push_back(object);
+void showFileHashes(FS &fs, String filepath, uint8_t algos) {
+    FileHashes hashes;
+    bool ok = hashFile(fs, filepath, algos, hashes, [](size_t done, size_t total) {
+        // in kB, map() would overflow with multi MB files
+        progressHandler(done >> 10, (total >> 10) + 1, "Hashing file");
+    });
+    if (!ok) {
+        displayError("Hashing failed", true);
+        return;
+    }
+
+    drawMainBorderWithTitle("CHECKSUM");
+    padprintln("");
+    padprintln(filepath.substring(filepath.lastIndexOf('/') + 1));
+    if (algos & HASH_CRC32) {
+        padprintln("");
+        padprintln("CRC32: " + hashes.crc32);
+    }
+    if (algos & HASH_MD5) {
+        padprintln("");
+        padprintln("MD5: " + hashes.md5);
+    }
+    if (algos & HASH_SHA256) {
+        padprintln("");
+        padprintln("SHA256: " + hashes.sha256);
+    }
+    Serial.printf("%s\n crc32: %s\n md5: %s\n sha256: %s\n", filepath.c_str(), hashes.crc32.c_str(),
+                  hashes.md5.c_str(), hashes.sha256.c_str());
+    delay(200);
+    while (!check(EscPress) && !check(SelPress)) { delay(100); }
 }
 
 /*********************************************************************
@@ -761,7 +685,7 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                                                              if (readSubFile(&fs, filepath, data))
                                                                 txSubFile(data);
                                                          }});
-                    if (filepath.endsWith(".csv")) {
+                    if (filepath.endsWith(".csv") || filepath.endsWith(".csv.gz")) {
                         options.insert(options.begin(), {"Wigle Upload", [&]() {
                                                              delay(200);
                                                              Wigle wigle;
@@ -775,6 +699,18 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                     }
 #if !defined(LITE_VERSION) && !defined(DISABLE_INTERPRETER)
                     if (filepath.endsWith(".bjs") || filepath.endsWith(".js")) {
+                        options.insert(options.begin(), {"JS Compile", [&]() {
+                                                             String out = js_compiled_path(filepath);
+                                                             displayTextLine("Compiling...");
+                                                             if (js_compile_file(fs, filepath, out)) {
+                                                                 displaySuccess("Saved " + out, true);
+                                                             } else {
+                                                                 displayError("Compile failed", true);
+                                                             }
+                                                         }});
+                    }
+                    if (filepath.endsWith(".bjs") || filepath.endsWith(".js") ||
+                        filepath.endsWith(JS_BYTECODE_EXT)) {
                         options.insert(options.begin(), {"JS Script Run", [&]() {
                                                              delay(200);
                                                              run_bjs_script_headless(fs, filepath);
@@ -844,15 +780,20 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
                                                delay(200);
                                                qrcode_display(readSmallFile(fs, filepath));
                                            }});
-                        options.push_back({"CRC32", [&]() {
-                                               delay(200);
-                                               displaySuccess(crc32File(fs, filepath), true);
-                                           }});
-                        options.push_back({"MD5", [&]() {
-                                               delay(200);
-                                               displaySuccess(md5File(fs, filepath), true);
-                                           }});
                     }
+                    // checksums are streamed, any size works
+                    options.push_back({"CRC32", [&]() {
+                                           delay(200);
+                                           showFileHashes(fs, filepath, HASH_CRC32);
+                                       }});
+                    options.push_back({"MD5", [&]() {
+                                           delay(200);
+                                           showFileHashes(fs, filepath, HASH_MD5);
+                                       }});
+                    options.push_back({"SHA256", [&]() {
+                                           delay(200);
+                                           showFileHashes(fs, filepath, HASH_SHA256);
+                                       }});
                     options.push_back({"Close Menu", [&]() { yield(); }});
                     options.push_back({"Main Menu", [&]() { exit = true; }});
                     if (!filePicker) {
@@ -891,15 +832,9 @@ String loopSD(FS &fs, bool filePicker, String allowed_ext, String rootPath) {
 **  Display file content
 **********************************************************************/
 void viewFile(FS fs, String filepath) {
-    File file = fs.open(filepath, FILE_READ);
-    if (!file) return;
-
-    ScrollableTextArea area = ScrollableTextArea("VIEW FILE");
-    area.fromFile(file);
-
-    file.close();
-
-    area.show();
+    FileViewer viewer;
+    if (!viewer.open(fs, filepath)) return;
+    viewer.show();
 }
 
 /*********************************************************************
@@ -964,11 +899,19 @@ void fileInfo(FS fs, String filepath) {
     padprintf("Size: %.02f %s\n", filesize, unit.c_str());
     padprintln("");
     padprintf("Modified: %s\n", ctime(&modifiedTime));
+    padprintln("");
+    padprintln("[SEL] Checksums");
 
     file.close();
     delay(100);
 
-    while (!check(EscPress) && !check(SelPress)) { delay(100); }
+    while (!check(EscPress)) {
+        if (check(SelPress)) {
+            showFileHashes(fs, filepath, HASH_ALL);
+            break;
+        }
+        delay(100);
+    }
 
     return;
 }
@@ -1,17 +1,12 @@
 #ifndef __SD_FUNCTIONS_H__
 #define __SD_FUNCTIONS_H__
 
+#include "file_list.h"
 #include <FS.h>
 #include <LittleFS.h>
 #include <SD.h>
 #include <SPI.h>
 
-struct FileList {
-    String filename;
-    bool folder;
-    bool operation;
-};
-
 // extern SPIClass sdcardSPI;
 
 bool setupSdCard();
@@ -42,9 +37,9 @@ String md5File(FS &fs, String filepath);
 
 String crc32File(FS &fs, String filepath);
 
-void readFs(FS fs, String folder, String allowed_ext = "*");
+String sha256File(FS &fs, String filepath);
 
-bool sortList(const FileList &a, const FileList &b);
+void showFileHashes(FS &fs, String filepath, uint8_t algos);
 
 String loopSD(FS &fs, bool filePicker = false, String allowed_ext = "*", String rootPath = "/");
 
@@ -16,6 +16,7 @@ static uint32_t jsCallback(cmd *c) {
 
     if (first == "exit") {
         interpreter_state = -1;
+        interpreterWake();
         return true;
     }
 
@@ -1,14 +1,17 @@
 #include "power_commands.h"
+#include "core/powerSave.h"
 #include "core/settings.h"
 #include <globals.h>
 
 uint32_t poweroffCallback(cmd *c) {
     powerOff();
+    beforePowerDown();      // boards without a powerOff() end up here
     esp_deep_sleep_start(); // only wake up via hardware reset
     return true;
 }
 
 uint32_t rebootCallback(cmd *c) {
+    bruceConfig.commit();
     ESP.restart();
     return true;
 }
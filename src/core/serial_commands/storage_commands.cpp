@@ -1,4 +1,6 @@
 #include "storage_commands.h"
+#include "core/file_hash.h"
+#include "core/file_pager.h"
 #include "core/sd_functions.h"
 #include "helpers.h"
 #include <globals.h>
@@ -63,11 +65,41 @@ uint32_t readCallback(cmd *c) {
     FS *fs;
     if (!getFsStorage(fs) || !(*fs).exists(filepath)) return false;
 
-    serialDevice->println(readSmallFile(*fs, filepath));
+    // cat <file> [first] [count] [-hex]: first is a line (from 1) or a byte offset with -hex,
+    // count is lines or 16 byte rows, 0 for the rest of the file
+    bool hex = cmd.getArgument("hex").isSet();
+    uint32_t first = strtoul(cmd.getArgument("first").getValue().c_str(), nullptr, 0);
+    uint32_t count = strtoul(cmd.getArgument("count").getValue().c_str(), nullptr, 0);
+
+    FilePager pager;
+    if (!pager.open(*fs, filepath)) return false;
+
+    if (hex) {
+        uint8_t buf[16];
+        size_t n;
+        for (uint32_t row = 0; (!count || row < count) && (n = pager.read(first, buf, sizeof(buf))); row++) {
+            serialDevice->println(FilePager::hexRow(first, buf, n, sizeof(buf)));
+            first += n;
+        }
+    } else if (first <= 1 && !count) {
+        // whole file, as is
+        uint8_t buf[512];
+        size_t n;
+        for (uint32_t offset = 0; (n = pager.read(offset, buf, sizeof(buf))); offset += n)
+            serialDevice->write(buf, n);
+        serialDevice->println();
+    } else {
+        uint32_t line = first ? first - 1 : 0;
+        for (uint32_t i = 0; !count || i < count; i++) {
+            const String *text = pager.line(line + i);
+            if (!text) break;
+            serialDevice->println(*text);
+        }
+    }
     return true;
 }
 
-uint32_t md5Callback(cmd *c) {
+uint32_t hashCallback(cmd *c, FileHashAlgo algo) {
     Command cmd(c);
 
     Argument arg = cmd.getArgument("filepath");
@@ -81,27 +113,28 @@ uint32_t md5Callback(cmd *c) {
     FS *fs;
     if (!getFsStorage(fs) || !(*fs).exists(filepath)) return false;
 
-    serialDevice->println(md5File(*fs, filepath));
+    // big files (firmware images, captures) take a few seconds, report every 10%
+    int lastStep = 0;
+    String hash = hashFile(*fs, filepath, algo, [&lastStep](size_t done, size_t total) {
+        if (total < 1024 * 1024 || done >= total) return;
+        int step = (uint64_t)done * 10 / total;
+        if (step == lastStep) return;
+        lastStep = step;
+        serialDevice->printf("hashing... %d%%\n", step * 10);
+    });
+    if (hash == "") {
+        serialDevice->println("Failed to hash file");
+        return false;
+    }
+    serialDevice->println(hash);
     return true;
 }
 
-uint32_t crc32Callback(cmd *c) {
-    Command cmd(c);
+uint32_t md5Callback(cmd *c) { return hashCallback(c, HASH_MD5); }
 
-    Argument arg = cmd.getArgument("filepath");
-    String filepath = arg.getValue();
-    filepath.trim();
+uint32_t crc32Callback(cmd *c) { return hashCallback(c, HASH_CRC32); }
 
-    if (filepath.length() == 0) return false;
-
-    if (!filepath.startsWith("/")) filepath = "/" + filepath;
-
-    FS *fs;
-    if (!getFsStorage(fs) || !(*fs).exists(filepath)) return false;
-
-    serialDevice->println(crc32File(*fs, filepath));
-    return true;
-}
+uint32_t sha256Callback(cmd *c) { return hashCallback(c, HASH_SHA256); }
 
 uint32_t removeCallback(cmd *c) {
     Command cmd(c);
@@ -359,6 +392,9 @@ void createListCommand(SimpleCLI *cli) {
 void createReadCommand(SimpleCLI *cli) {
     Command cmd = cli->addCommand("cat,type", readCallback);
     cmd.addPosArg("filepath");
+    cmd.addPosArg("first", "0");
+    cmd.addPosArg("count", "0");
+    cmd.addFlagArg("hex");
 }
 
 void createMd5Command(SimpleCLI *cli) {
@@ -372,6 +408,11 @@ void createCrc32Command(SimpleCLI *cli) {
     cmd.addPosArg("filepath");
 }
 
+void createSha256Command(SimpleCLI *cli) {
+    Command cmd = cli->addCommand("sha256", sha256Callback);
+    cmd.addPosArg("filepath");
+}
+
 void createRemoveCommand(SimpleCLI *cli) {
     Command cmd = cli->addCommand("rm,del", removeCallback);
     cmd.addPosArg("filepath");
@@ -395,6 +436,9 @@ void createStorageCommand(SimpleCLI *cli) {
 
     Command cmdRead = cmd.addCommand("read", readCallback);
     cmdRead.addPosArg("filepath");
+    cmdRead.addPosArg("first", "0");
+    cmdRead.addPosArg("count", "0");
+    cmdRead.addFlagArg("hex");
 
     Command cmdRemove = cmd.addCommand("remove", removeCallback);
     cmdRemove.addPosArg("filepath");
@@ -424,6 +468,9 @@ void createStorageCommand(SimpleCLI *cli) {
     Command cmdCrc32 = cmd.addCommand("crc32", crc32Callback);
     cmdCrc32.addPosArg("filepath");
 
+    Command cmdSha256 = cmd.addCommand("sha256", sha256Callback);
+    cmdSha256.addPosArg("filepath");
+
     Command cmdStat = cmd.addCommand("stat", statCallback);
     cmdStat.addPosArg("filepath");
 
@@ -441,6 +488,7 @@ void createStorageCommands(SimpleCLI *cli) {
 
     createMd5Command(cli);
     createCrc32Command(cli);
+    createSha256Command(cli);
 
     createStorageCommand(cli);
 }
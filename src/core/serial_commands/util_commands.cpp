@@ -195,7 +195,7 @@ uint32_t helpCallback(cmd *c) {
     serialDevice->println("\nI2C and Storage:");
     serialDevice->println("  i2c scan                - Scan for modules connected to the I2C bus.");
     serialDevice->println(
-        "  storage <list/remove/mkdir/rename/read/write/copy/md5/crc32> <file path>  - Common file "
+        "  storage <list/remove/mkdir/rename/read/write/copy/md5/crc32/sha256> <file path>  - Common file "
         "management commands."
     );
     serialDevice->println("  ls - Same as storage list");
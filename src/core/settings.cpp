@@ -1617,6 +1617,16 @@ void setTheme() {
     if (setupSdCard()) {
         options.insert(options.begin(), {"SD Card", [&]() { fs = &SD; }});
     }
+    if (bruceConfig.themePath != "") {
+        options.insert(options.end() - 1, {"Pre-warm Cache", [&]() {
+                           String folder = bruceConfig.themePath.substring(
+                               0, bruceConfig.themePath.lastIndexOf('/')
+                           );
+                           int built = warmImageCaches(*bruceConfig.themeFS(), folder);
+                           displaySuccess(String(built) + " images cached", true);
+                           fs = nullptr;
+                       }});
+    }
     loopOptions(options);
     if (fs == nullptr) return;
 
@@ -0,0 +1,132 @@
+#include "draw_log.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+namespace {
+const size_t NONE = (size_t)-1;
+}
+
+bool DrawLog::begin(size_t entries, size_t entrySize) {
+    end();
+    if (entries == 0 || entries >= EMPTY || entrySize < 3 || entrySize > 255) return false;
+    size_t slots = 16;
+    while (slots < entries * 2) slots *= 2;
+
+    // one block: sequences, hashes, index, packets
+    size_t size = entries * 2 * sizeof(uint32_t) + slots * sizeof(uint16_t) + entries * entrySize;
+    uint8_t *mem = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    if (!mem) mem = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    if (!mem) return false;
+    _seq = (uint32_t *)mem;
+    _hash = _seq + entries;
+    _index = (uint16_t *)(_hash + entries);
+    _data = (uint8_t *)(_index + slots);
+    _indexMask = slots - 1;
+    _capacity = entries;
+    _entrySize = entrySize;
+    clear();
+    return true;
+}
+
+void DrawLog::end() {
+    if (_seq) heap_caps_free(_seq); // owns the whole block
+    _seq = _hash = nullptr;
+    _index = nullptr;
+    _data = nullptr;
+    _capacity = _count = _dead = 0;
+}
+
+void DrawLog::clear() {
+    _count = _dead = 0;
+    _evictedSeq = _lastSeq; // viewers older than this can't be brought up to date by replaying
+    if (_index) memset(_index, 0xFF, (_indexMask + 1) * sizeof(uint16_t));
+}
+
+// FNV-1a
+uint32_t DrawLog::hashOf(const uint8_t *packet) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < packet[1]; i++) h = (h ^ packet[i]) * 16777619u;
+    return h;
+}
+
+size_t DrawLog::find(const uint8_t *packet, uint32_t hash) const {
+    for (size_t p = hash & _indexMask; _index[p] != EMPTY; p = (p + 1) & _indexMask) {
+        size_t i = _index[p];
+        const uint8_t *e = entry(i);
+        if (_hash[i] == hash && e[1] == packet[1] && memcmp(e, packet, packet[1]) == 0) return i;
+    }
+    return NONE;
+}
+
+void DrawLog::indexInsert(size_t i) {
+    size_t p = _hash[i] & _indexMask;
+    while (_index[p] != EMPTY) p = (p + 1) & _indexMask;
+    _index[p] = i;
+}
+
+// Backward shift deletion, keeps every probe chain unbroken without tombstones
+void DrawLog::indexRemove(size_t i) {
+    size_t hole = _hash[i] & _indexMask;
+    while (_index[hole] != i) hole = (hole + 1) & _indexMask;
+    for (size_t q = (hole + 1) & _indexMask; _index[q] != EMPTY; q = (q + 1) & _indexMask) {
+        size_t home = _hash[_index[q]] & _indexMask;
+        if (((q - home) & _indexMask) >= ((q - hole) & _indexMask)) {
+            _index[hole] = _index[q];
+            hole = q;
+        }
+    }
+    _index[hole] = EMPTY;
+}
+
+void DrawLog::kill(size_t i) {
+    indexRemove(i);
+    _seq[i] = DEAD;
+    _dead++;
+}
+
+// Slides the live entries down over the removed ones, order is kept
+void DrawLog::compact() {
+    size_t w = 0;
+    for (size_t r = 0; r < _count; r++) {
+        if (_seq[r] == DEAD) continue;
+        if (w != r) {
+            memcpy(_data + w * _entrySize, entry(r), entry(r)[1]);
+            _seq[w] = _seq[r];
+            _hash[w] = _hash[r];
+        }
+        w++;
+    }
+    _count = w;
+    _dead = 0;
+    memset(_index, 0xFF, (_indexMask + 1) * sizeof(uint16_t));
+    for (size_t i = 0; i < _count; i++) indexInsert(i);
+    _compactions++;
+}
+
+bool DrawLog::push(const uint8_t *packet) {
+    size_t size = packet[1];
+    if (!_data || size < 3 || size > _entrySize) return false;
+    uint32_t hash = hashOf(packet);
+    if (find(packet, hash) != NONE) {
+        _duplicates++;
+        return false;
+    }
+
+    if (_count == _capacity) {
+        if (_dead == 0) {
+            // full of live entries: drop the oldest eighth at once, so compacting stays rare
+            size_t batch = _capacity > 8 ? _capacity / 8 : 1;
+            if (_seq[batch - 1] > _evictedSeq) _evictedSeq = _seq[batch - 1];
+            for (size_t i = 0; i < batch; i++) kill(i);
+            _evicted += batch;
+        }
+        compact();
+    }
+
+    size_t i = _count++;
+    memcpy(_data + i * _entrySize, packet, size);
+    _seq[i] = ++_lastSeq;
+    _hash[i] = hash;
+    indexInsert(i);
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef __DRAW_LOG_H__
+#define __DRAW_LOG_H__
+#include <stddef.h>
+#include <stdint.h>
+
+// Log of the draw operations currently making up the screen, used to mirror it remotely.
+// Entries are packets (header, size, function, arguments) kept in the order they were drawn, each
+// one numbered by a sequence that never goes back, even when the log is cleared, so a viewer
+// can ask for "everything after N". A hash index skips redraws of an entry that is already
+// there. Removed entries (painted over) are compacted away when space is needed; when the log
+// is full of live entries the oldest ones are evicted and a viewer that had not seen them must resync.
+class DrawLog {
+public:
+    DrawLog() = default;
+    ~DrawLog() { end(); }
+    DrawLog(const DrawLog &) = delete;
+    DrawLog &operator=(const DrawLog &) = delete;
+
+    // `entries` packets of at most `entrySize` bytes, PSRAM first
+    bool begin(size_t entries, size_t entrySize);
+    void end();
+    bool ready() const { return _data != nullptr; }
+    // Drops every entry, the sequence keeps counting
+    void clear();
+
+    // Appends `packet` (size at byte 1). False if the same packet is already in the log.
+    bool push(const uint8_t *packet);
+    // Removes the live entries for which `match(packet)` is true, returns how many
+    template <typename F> size_t removeIf(F match) {
+        size_t removed = 0;
+        for (size_t i = 0; i < _count; i++) {
+            if (_seq[i] != DEAD && match(entry(i))) {
+                kill(i);
+                removed++;
+            }
+        }
+        return removed;
+    }
+    // Calls `fn(packet, seq)` for the live entries newer than `after`, oldest first
+    template <typename F> void forEach(uint32_t after, F fn) const {
+        for (size_t i = 0; i < _count; i++) {
+            if (_seq[i] != DEAD && _seq[i] > after) fn(entry(i), _seq[i]);
+        }
+    }
+
+    uint32_t seq() const { return _lastSeq; } // last sequence handed out
+    // True if entries newer than `after` were evicted: replaying forEach(after) would miss them
+    bool lost(uint32_t after) const { return _evictedSeq > after; }
+    size_t size() const { return _count - _dead; }
+    size_t capacity() const { return _capacity; }
+    uint32_t duplicates() const { return _duplicates; }
+    uint32_t compactions() const { return _compactions; }
+    uint32_t evicted() const { return _evicted; }
+
+private:
+    static const uint32_t DEAD = 0;
+    static const uint16_t EMPTY = 0xFFFF;
+
+    uint8_t *_data = nullptr; // _capacity packets of _entrySize bytes
+    uint32_t *_seq = nullptr; // per entry, DEAD once removed
+    uint32_t *_hash = nullptr;
+    uint16_t *_index = nullptr; // open addressing, entry positions or EMPTY
+    size_t _indexMask = 0;
+    size_t _capacity = 0;
+    size_t _entrySize = 0;
+    size_t _count = 0; // entries in use, live or dead
+    size_t _dead = 0;
+    uint32_t _lastSeq = 0;
+    uint32_t _evictedSeq = 0;
+    uint32_t _duplicates = 0;
+    uint32_t _compactions = 0;
+    uint32_t _evicted = 0;
+
+    const uint8_t *entry(size_t i) const { return _data + i * _entrySize; }
+    static uint32_t hashOf(const uint8_t *packet);
+    size_t find(const uint8_t *packet, uint32_t hash) const;
+    void indexInsert(size_t i);
+    void indexRemove(size_t i);
+    void kill(size_t i);
+    void compact();
+};
+
+#endif
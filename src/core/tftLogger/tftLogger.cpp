@@ -11,24 +11,26 @@ AUXILIARY FUNCTIONS TO CREATE THE JSONS
 tft_logger::tft_logger(int16_t w, int16_t h) : BRUCE_TFT_DRIVER(w, h) {}
 tft_logger::~tft_logger() {
     clearLog();
-    if (log) free(log);
+    log.end();
     if (images) free(images);
-    log = nullptr;
     images = nullptr;
+    if (logLock) vSemaphoreDelete(logLock);
+    logLock = NULL;
 }
 
-void tft_logger::clearLog() {
-    if (log) memset(log, 0, sizeof(tftLog) * MAX_LOG_ENTRIES);
-    if (images) memset(images, 0, MAX_LOG_IMAGES * MAX_LOG_IMG_PATH);
-    logWriteIndex = 0;
-    logCount = 0;
+void tft_logger::lockLog() {
+    if (logLock) xSemaphoreTake(logLock, portMAX_DELAY);
+}
+
+void tft_logger::unlockLog() {
+    if (logLock) xSemaphoreGive(logLock);
 }
 
-void tft_logger::addLogEntry(const uint8_t *buffer, uint8_t size) {
-    if (!log) return;
-    memcpy(log[logWriteIndex].data, buffer, size);
-    logWriteIndex = (logWriteIndex + 1) % MAX_LOG_ENTRIES;
-    if (logCount < MAX_LOG_ENTRIES) ++logCount;
+void tft_logger::clearLog() {
+    lockLog();
+    log.clear();
+    if (images) memset(images, 0, MAX_LOG_IMAGES * MAX_LOG_IMG_PATH);
+    unlockLog();
 }
 
 void tft_logger::logWriteHeader(uint8_t *buffer, uint8_t &pos, tftFuncs fn) {
@@ -43,23 +45,18 @@ void tft_logger::writeUint16(uint8_t *buffer, uint8_t &pos, uint16_t value) {
 }
 
 void tft_logger::setLogging(bool _log) {
+    if (!logLock) logLock = xSemaphoreCreateMutex();
     clearLog();
+    lockLog();
     if (_log) {
-        size_t logBytes = sizeof(tftLog) * MAX_LOG_ENTRIES;
         size_t imageBytes = MAX_LOG_IMAGES * MAX_LOG_IMG_PATH;
-        if (psramFound()) {
-            log = static_cast<tftLog *>(ps_malloc(logBytes));
-            images = static_cast<char (*)[MAX_LOG_IMG_PATH]>(ps_malloc(imageBytes));
-        }
-        if (!log) log = static_cast<tftLog *>(malloc(logBytes));
+        if (!images && psramFound()) images = static_cast<char (*)[MAX_LOG_IMG_PATH]>(ps_malloc(imageBytes));
         if (!images) images = static_cast<char (*)[MAX_LOG_IMG_PATH]>(malloc(imageBytes));
-        if (!log) log_e("tft_logger: failed to allocate log buffer (%u bytes)", (unsigned)logBytes);
+        if (!log.ready() && !log.begin(MAX_LOG_ENTRIES, MAX_LOG_SIZE))
+            log_e("tft_logger: failed to allocate log buffer");
         if (!images) log_e("tft_logger: failed to allocate image buffer (%u bytes)", (unsigned)imageBytes);
-        if (!log || !images) {
-            if (log) {
-                free(log);
-                log = nullptr;
-            }
+        if (!log.ready() || !images) {
+            log.end();
             if (images) {
                 free(images);
                 images = nullptr;
@@ -67,44 +64,22 @@ void tft_logger::setLogging(bool _log) {
             _log = false;
             log_e("tft_logger: failed to start logging screen data due to insufficient memory");
         }
+        if (images) memset(images, 0, imageBytes);
     } else {
-        if (log) free(log);
+        log.end();
         if (images) free(images);
-        log = nullptr;
         images = nullptr;
     }
     logging = _logging = _log;
-    logWriteIndex = 0;
-    if (log) memset(log, 0, sizeof(tftLog) * MAX_LOG_ENTRIES);
-    logCount = 0;
+    unlockLog();
 };
 void tft_logger::asyncSerialTaskFunc(void *pv) {
     tft_logger *logger = static_cast<tft_logger *>(pv);
     tftLog item;
+    uint8_t packet[MAX_LOG_SIZE];
     while (logger->async_serial || uxQueueMessagesWaiting(logger->asyncSerialQueue) > 0) {
         if (xQueueReceive(logger->asyncSerialQueue, &item, pdMS_TO_TICKS(100))) {
-            uint8_t *entry = item.data;
-            uint8_t fn = entry[2];
-            if (fn == DRAWIMAGE) {
-                if (!logger->images) {
-                    uint8_t size = entry[1];
-                    serialDevice->write(entry, size);
-                    continue;
-                }
-                uint8_t imageSlot = entry[12];
-                const char *imgPath = logger->images[imageSlot];
-                size_t baseLen = 12; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS
-                size_t imgLen = strlen(imgPath);
-                uint8_t packet[MAX_LOG_SIZE];
-                memcpy(packet, entry, baseLen);
-                if (imgLen > MAX_LOG_SIZE - baseLen) imgLen = MAX_LOG_SIZE - baseLen;
-                memcpy(packet + baseLen, imgPath, imgLen);
-                packet[1] = baseLen + imgLen;
-                serialDevice->write(packet, baseLen + imgLen);
-            } else {
-                uint8_t size = entry[1];
-                serialDevice->write(entry, size);
-            }
+            serialDevice->write(packet, logger->writeLogEntry(item.data, packet));
         }
     }
     logger->asyncSerialTask = NULL;
@@ -131,8 +106,8 @@ void tft_logger::stopAsyncSerial() {
     setLogging(false);
     // task will exit on its own and clear handle
 }
-void tft_logger::getTftInfo() {
-    uint8_t buffer[16];
+
+size_t tft_logger::writeScreenInfo(uint8_t *buffer) {
     uint8_t pos = 0;
     logWriteHeader(buffer, pos, SCREEN_INFO);
     writeUint16(buffer, pos, width());
@@ -143,118 +118,114 @@ void tft_logger::getTftInfo() {
 #endif
     buffer[pos++] = rot;
     buffer[1] = pos;
+    return pos;
+}
+
+// Copies a log entry to `out` as it goes on the wire, images carry their path instead of the slot.
+// `out` must hold MAX_LOG_SIZE bytes.
+size_t tft_logger::writeLogEntry(const uint8_t *entry, uint8_t *out) {
+    uint8_t size = entry[1];
+    if (entry[2] != DRAWIMAGE || !images) {
+        memcpy(out, entry, size);
+        return size;
+    }
+    uint8_t imageSlot = entry[12]; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS SLOT
+                                   // 0  1  2  3  4  5  6  7  8  9  10 11 12
+    const char *imgPath = images[imageSlot];
+    size_t baseLen = 12; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS + PATH
+    size_t imgLen = strlen(imgPath);
+    if (imgLen > MAX_LOG_SIZE - baseLen) imgLen = MAX_LOG_SIZE - baseLen;
+    memcpy(out, entry, baseLen);
+    memcpy(out + baseLen, imgPath, imgLen);
+    out[1] = baseLen + imgLen; // update packet size
+    return baseLen + imgLen;
+}
+
+void tft_logger::getTftInfo() {
     tftLog l;
-    memcpy(l.data, buffer, pos);
+    writeScreenInfo(l.data);
     pushLogIfUnique(l);
 }
-void tft_logger::getBinLog(uint8_t *outBuffer, size_t &outSize) {
-    outSize = 0;
+
+void tft_logger::getBinLog(uint8_t *outBuffer, size_t &outSize, uint32_t *lastSeq) {
     // add Screen Info at the beginning of the Bin packet
-    uint8_t buffer[16];
-    uint8_t pos = 0;
-    logWriteHeader(buffer, pos, SCREEN_INFO);
-    writeUint16(buffer, pos, width());
-    writeUint16(buffer, pos, height());
-    uint8_t rot = 0;
-#if defined(HAS_SCREEN)
-    rot = getRotation();
-#endif
-    buffer[pos++] = rot;
-    buffer[1] = pos;
+    outSize = writeScreenInfo(outBuffer);
 
-    memcpy(outBuffer + outSize, buffer, pos);
-    outSize += pos;
-
-    if (!log) return;
-    for (int i = 0; i < logCount; i++) {
-        if (log[i].data[0] != LOG_PACKET_HEADER) continue;
-        uint8_t *entry = log[i].data;
-        uint8_t fn = entry[2];
-
-        if (fn == DRAWIMAGE) {
-            if (!images) continue;
-            uint8_t imageSlot = entry[12]; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS SLOT
-                                           // 0  1  2  3  4  5  6  7  8  9  10 11 12
-            const char *imgPath = images[imageSlot];
-            size_t baseLen = 12; // AA SS FN XX XX YY YY Ce Ce Ms Ms FS + PATH
-            size_t imgLen = strlen(imgPath);
-            if (outSize + baseLen + imgLen > MAX_LOG_SIZE * MAX_LOG_ENTRIES) continue;
-
-            memcpy(outBuffer + outSize, entry, baseLen);
-            outSize += baseLen;
-            memcpy(outBuffer + outSize, imgPath, imgLen);
-            outSize += imgLen;
-
-            outBuffer[outSize - imgLen - baseLen + 1] = baseLen + imgLen; // update packet size
-        } else {
-            uint8_t size = entry[1];
-            if (outSize + size > MAX_LOG_SIZE * MAX_LOG_ENTRIES) continue;
-            memcpy(outBuffer + outSize, entry, size);
-            outSize += size;
-        }
+    lockLog();
+    if (lastSeq) *lastSeq = log.seq();
+    log.forEach(0, [&](const uint8_t *entry, uint32_t) {
+        uint8_t packet[MAX_LOG_SIZE];
+        size_t size = writeLogEntry(entry, packet);
+        if (outSize + size > MAX_LOG_SIZE * MAX_LOG_ENTRIES) return;
+        memcpy(outBuffer + outSize, packet, size);
+        outSize += size;
+    });
+    unlockLog();
+}
+
+bool tft_logger::getBinLogSince(uint32_t &afterSeq, uint8_t *outBuffer, size_t maxSize, size_t &outSize) {
+    outSize = 0;
+    lockLog();
+    if (log.lost(afterSeq)) {
+        unlockLog();
+        return false;
     }
+    bool full = false;
+    log.forEach(afterSeq, [&](const uint8_t *entry, uint32_t seq) {
+        if (full) return;
+        uint8_t packet[MAX_LOG_SIZE];
+        size_t size = writeLogEntry(entry, packet);
+        if (outSize + size > maxSize) {
+            full = true; // the rest goes in the next call
+            return;
+        }
+        memcpy(outBuffer + outSize, packet, size);
+        outSize += size;
+        afterSeq = seq;
+    });
+    if (!full) afterSeq = log.seq(); // skip the sequences of entries already removed
+    unlockLog();
+    return true;
 }
 
 void tft_logger::restoreLogger() {
     if (_logging) logging = true;
 }
 
-bool tft_logger::isLogEqual(const tftLog &a, const tftLog &b) {
-    uint8_t sizeA = a.data[1];
-    uint8_t sizeB = b.data[1];
-    if (sizeA != sizeB) return false;
-    return memcmp(a.data, b.data, sizeA) == 0;
-}
-
 void tft_logger::pushLogIfUnique(const tftLog &l) {
-    if (!log) return;
-    for (int i = 0; i < logCount; i++) {
-        if (isLogEqual(log[i], l)) {
-            return; // Entry already exists
-        }
-    }
-    memcpy(log[logWriteIndex].data, l.data, l.data[1]);
-    logWriteIndex = (logWriteIndex + 1) % MAX_LOG_ENTRIES;
-    if (logCount < MAX_LOG_ENTRIES) ++logCount;
-    if (async_serial && asyncSerialQueue) { xQueueSend(asyncSerialQueue, &l, 0); }
+    lockLog();
+    bool added = log.push(l.data);
+    unlockLog();
+    if (added && async_serial && asyncSerialQueue) { xQueueSend(asyncSerialQueue, &l, 0); }
 }
 
 bool tft_logger::removeLogEntriesInsideRect(int rx, int ry, int rw, int rh) {
-    bool r = false;
     int rx1 = rx;
     int ry1 = ry;
     int rx2 = rx + rw;
     int ry2 = ry + rh;
 
-    if (!log) return false;
-    for (int i = 0; i < logCount; i++) {
-        uint8_t *data = log[i].data;
-        if (data[0] != LOG_PACKET_HEADER) continue;
+    lockLog();
+    size_t removed = log.removeIf([&](const uint8_t *data) {
         int px = (data[3] << 8) | data[4];
         int py = (data[5] << 8) | data[6];
-        if (px >= rx1 && px < rx2 && py >= ry1 && py < ry2) {
-            data[0] = 0; // Mark as deleted
-            r = true;
-        }
-    }
-    return r;
+        return px >= rx1 && px < rx2 && py >= ry1 && py < ry2;
+    });
+    unlockLog();
+    return removed > 0;
 }
 
 void tft_logger::removeOverlappedImages(int x, int y, int center, int ms) {
-    if (!log) return;
-    for (int i = 0; i < logCount; i++) {
-        uint8_t *data = log[i].data;
-        if (data[0] != LOG_PACKET_HEADER) continue;
-        uint8_t fn = data[2];
-        if (fn != DRAWIMAGE) continue;
+    lockLog();
+    log.removeIf([&](const uint8_t *data) {
+        if (data[2] != DRAWIMAGE) return false;
         int px = (data[3] << 8) | data[4];
         int py = (data[5] << 8) | data[6];
         int pcenter = (data[7] << 8) | data[8];
         int pms = (data[9] << 8) | data[10];
-        if (px == x && py == y && pcenter == center && pms == ms) {
-            data[0] = 0; // Mark as deleted
-        }
-    }
+        return px == x && py == y && pcenter == center && pms == ms;
+    });
+    unlockLog();
 }
 
 void tft_logger::fillScreen(int32_t color) {
@@ -268,7 +239,7 @@ void tft_logger::fillScreen(int32_t color) {
 
 void tft_logger::imageToBin(uint8_t fs, String file, int x, int y, bool center, int Ms) {
     if (!logging) return;
-    if (!log || !images) return;
+    if (!log.ready() || !images) return;
 
     removeOverlappedImages(x, y, center, Ms);
 
@@ -444,7 +415,7 @@ void tft_logger::drawFastHLine(int32_t x, int32_t y, int32_t w, int32_t fg) {
 
 void tft_logger::log_drawString(String s, tftFuncs fn, int32_t x, int32_t y) {
     if (!logging) return;
-    if (!log) return;
+    if (!log.ready()) return;
     if (removeLogEntriesInsideRect(x, y, s.length() * LW * currentTextSize(), s.length() * LH * currentTextSize())) {
         // debug purpose
         // Serial.printf("Something was removed while processing: %s\n", s.c_str());
@@ -503,7 +474,7 @@ int16_t tft_logger::drawRightString(const String &string, int32_t x, int32_t y,
 
 void tft_logger::log_print(String s) {
     if (!logging) return;
-    if (!log) return;
+    if (!log.ready()) return;
 
     removeLogEntriesInsideRect(
         getCursorX() - 1, getCursorY() - 1, s.length() * LW * currentTextSize() + 2,
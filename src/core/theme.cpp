@@ -1,6 +1,7 @@
 #include "theme.h"
 #include "core/led_control.h"
 #include "display.h"
+#include "icon_cache.h"
 
 struct ThemeEntry {
     const char *key;
@@ -11,6 +12,7 @@ struct ThemeEntry {
 void BruceTheme::removeTheme(void) {
     themeInfo t;
     theme = t;
+    iconCache.clear();
 }
 FS *BruceTheme::themeFS(void) {
     if (theme.fs == 1) return &LittleFS;
@@ -38,6 +40,7 @@ bool BruceTheme::openThemeFile(FS *fs, String filepath, bool overwriteConfigSett
         return false;
     }
     themePath = filepath;
+    iconCache.clear();
     String baseThemePath = themePath.substring(0, themePath.lastIndexOf('/')) + "/";
 
     ThemeEntry entries[] = {
@@ -68,8 +71,8 @@ bool BruceTheme::openThemeFile(FS *fs, String filepath, bool overwriteConfigSett
             if (fs->exists(path)) {
                 *entry.flag = true;
                 entry.path = _th[entry.key].as<String>();
-                // Pre-cache PNGs into BIN files to avoid runtime decoding and allocations
-                if (path.endsWith(".png") || path.endsWith(".PNG")) { preparePngBin(*fs, path); }
+                // Pre-decode PNGs to avoid runtime decoding and allocations
+                if (path.endsWith(".png") || path.endsWith(".PNG")) { buildImageCache(*fs, path); }
             } else {
                 log_w("THEME: file not found: %s", entry.key);
             }
@@ -1,5 +1,8 @@
 #include "webInterface.h"
 #include "core/display.h"    // using displayRedStripe as error msg
+#include "core/file_edit.h"
+#include "core/file_hash.h"
+#include "core/file_pager.h"
 #include "core/mykeyboard.h" // using keyboard when calling rename
 #include "core/passwords.h"
 #include "core/sd_functions.h" // using sd functions called to rename and manage sd files
@@ -10,10 +13,13 @@
 #include "esp_task_wdt.h"
 #include "webFiles.h"
 #include <MD5Builder.h>
+#include <atomic>
 #include <cstddef>
 #include <esp32-hal-psram.h>
 #include <esp_heap_caps.h>
 #include <globals.h>
+#include <map>
+#include <memory>
 
 File uploadFile;
 FS _webFS = LittleFS;
@@ -27,6 +33,41 @@ AsyncWebServer *server = nullptr; // initialise webserver
 const char *host = "bruce";
 String uploadFolder = "";
 static bool mdnsRunning = false;
+static FilePager webPager; // file shown by the viewer, kept open between pages
+static String webPagerKey = "";
+#define WEB_PAGER_BUDGET (32 * 1024) // bytes indexed or searched per viewer request
+
+#define SCREEN_VIEWERS 4
+#define SCREEN_PUSH_MS 50
+#define SCREEN_FRAME_HEADER 9 // type, fromSeq, toSeq
+
+struct ScreenViewer {
+    uint32_t id;  // websocket client, 0 when the slot is free
+    uint32_t seq; // last draw op it was sent
+    bool sync;    // next frame must be a snapshot
+    uint32_t frames;
+    uint32_t bytes;
+};
+static AsyncWebSocket *screenSocket = nullptr; // owned by the server once added
+static ScreenViewer screenViewers[SCREEN_VIEWERS] = {};
+static portMUX_TYPE screenViewersMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t screenPushTask = NULL;
+static volatile bool screenPushRunning = false;
+
+// Checksums run one at a time in their own task, the WebUI starts the job and polls /hash?id=
+enum HashJobState : uint8_t { HASH_JOB_IDLE, HASH_JOB_RUNNING, HASH_JOB_DONE, HASH_JOB_FAILED };
+struct HashJob {
+    uint32_t id;
+    FS *fs;
+    String path;
+    uint8_t algos;
+    volatile size_t done;
+    volatile size_t total;
+    FileHashes result;
+    // written last by the task (release), `result` is only read once it left RUNNING (acquire)
+    std::atomic<uint8_t> state;
+};
+static HashJob hashJob = {};
 
 // Generate random token
 String generateToken(int length = 24) {
@@ -36,11 +77,14 @@ String generateToken(int length = 24) {
     return token;
 }
 
+static void stopScreenSocket();
+
 /**********************************************************************
 **  Function: stopWebUi
 **  Turn off the WebUI
 **********************************************************************/
 void stopWebUi() {
+    stopScreenSocket();
     tft.setLogging(false);
     isWebUIActive = false;
     server->end();
@@ -51,6 +95,7 @@ void stopWebUi() {
         MDNS.end();
         mdnsRunning = false;
     }
+    closeFilePage();
 }
 
 /**********************************************************************
@@ -121,47 +166,319 @@ String humanReadableSize(uint64_t bytes) {
     else return String(bytes / 1024.0 / 1024.0 / 1024.0) + " GB";
 }
 
+// `s` as a quoted JSON string
+static String jsonString(const String &s) {
+    JsonDocument doc;
+    doc.set(s);
+    String out;
+    serializeJson(doc, out);
+    return out;
+}
+
 /**********************************************************************
-**  Function: listFiles
-**  list all of the files, if ishtml=true, return html rather than simple text
+**  Function: sendFileList
+**  Streams the content of a folder as chunked JSON, one directory entry at a time:
+**  {"path":"/dir","files":[{"name":"a.txt","size":12},{"name":"sub","dir":true}]}
 **********************************************************************/
-String listFiles(FS &fs, String folder) {
-    // log_i("Listfiles Start");
-    String returnText = "pa:" + folder + ":0\n";
-    // Serial.println("Listing files stored on SD");
+struct FileListState {
+    File dir;
+    String pending; // JSON not sent yet
+    size_t sent = 0;
+    bool first = true;
+    bool done = false;
+};
+
+static void nextFileListEntry(FileListState &state) {
+    File entry = state.dir ? state.dir.openNextFile() : File();
+    if (!entry) {
+        state.dir.close();
+        state.pending = "]}";
+        state.done = true;
+        return;
+    }
+    state.pending = state.first ? "{\"name\":" : ",{\"name\":";
+    state.pending += jsonString(entry.name());
+    if (entry.isDirectory()) state.pending += ",\"dir\":true}";
+    else state.pending += ",\"size\":" + String(entry.size()) + "}";
+    entry.close();
+    state.first = false;
+}
 
+void sendFileList(AsyncWebServerRequest *request, FS &fs, const String &folder) {
     _webFS = fs;
-
-    File root = fs.open(folder);
     uploadFolder = folder;
 
-    while (true) {
-        bool isDir;
-        String fullPath = root.getNextFileName(&isDir);
-        String nameOnly = fullPath.substring(fullPath.lastIndexOf("/") + 1);
-        if (fullPath == "") { break; }
-        // Serial.printf("Path: %s (isDir: %d)\n", fullPath.c_str(), isDir);
-
-        if (esp_get_free_heap_size() > (String("Fo:" + nameOnly + ":0\n").length()) + 1024) {
-            if (isDir) {
-                // Serial.printf("Directory: %s\n", fullPath.c_str());
-                returnText += "Fo:" + nameOnly + ":0\n";
-            } else {
-                // For files, we need to get the size, so we open the file briefly
-                // Serial.printf("Opening file for size check: %s\n", fullPath.c_str());
-                File file = fs.open(fullPath);
-                // Serial.printf("File size: %llu bytes\n", file.size());
-                if (file) {
-                    returnText += "Fi:" + nameOnly + ":" + humanReadableSize(file.size()) + "\n";
-                    file.close();
+    std::shared_ptr<FileListState> state = std::make_shared<FileListState>();
+    state->dir = fs.open(folder);
+    if (state->dir && !state->dir.isDirectory()) state->dir.close();
+    state->pending = "{\"path\":" + jsonString(folder) + ",\"files\":[";
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "application/json",
+        [state](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+            size_t written = 0;
+            while (written < maxLen) {
+                if (state->sent == state->pending.length()) {
+                    if (state->done) break;
+                    nextFileListEntry(*state);
+                    state->sent = 0;
                 }
+                size_t n = min(maxLen - written, state->pending.length() - state->sent);
+                memcpy(buffer + written, state->pending.c_str() + state->sent, n);
+                state->sent += n;
+                written += n;
             }
-        } else break;
-        esp_task_wdt_reset();
+            return written;
+        }
+    );
+    request->send(response);
+}
+
+/**********************************************************************
+**  Function: parseByteRange
+**  Reads a single "Range: bytes=first-last" (or "first-", "-suffix") for a
+**  file of `total` bytes. Returns 206 with start/end set, 416 when the range
+**  lies past the end, 0 when the header is not usable and the whole file is sent.
+**********************************************************************/
+static int parseByteRange(const String &header, size_t total, size_t &start, size_t &end) {
+    if (!header.startsWith("bytes=") || header.indexOf(',') >= 0) return 0;
+    int dash = header.indexOf('-');
+    if (dash < 0) return 0;
+    String first = header.substring(6, dash);
+    String last = header.substring(dash + 1);
+    first.trim();
+    last.trim();
+    if (first.isEmpty() && last.isEmpty()) return 0;
+
+    if (first.isEmpty()) {
+        size_t suffix = strtoul(last.c_str(), nullptr, 10);
+        if (suffix == 0 || total == 0) return 416;
+        start = suffix >= total ? 0 : total - suffix;
+        end = total - 1;
+        return 206;
+    }
+    start = strtoul(first.c_str(), nullptr, 10);
+    end = last.isEmpty() ? SIZE_MAX : strtoul(last.c_str(), nullptr, 10);
+    if (end < start) return 0;
+    if (start >= total) return 416;
+    if (end >= total) end = total - 1;
+    return 206;
+}
+
+/**********************************************************************
+**  Function: sendFileDownload
+**  Streams a file as an attachment, honouring a Range header so that
+**  interrupted downloads can resume
+**********************************************************************/
+void sendFileDownload(AsyncWebServerRequest *request, FS &fs, const String &fileName) {
+    File file = fs.open(fileName, FILE_READ);
+    if (!file || file.isDirectory()) {
+        request->send(500, "text/plain", "Failed to open file for reading");
+        return;
+    }
+    size_t total = file.size();
+    size_t start = 0;
+    size_t end = total - 1;
+    int code = 200;
+    if (request->hasHeader("Range")) {
+        code = parseByteRange(request->getHeader("Range")->value(), total, start, end);
+        if (code == 416) {
+            AsyncWebServerResponse *response =
+                request->beginResponse(416, "text/plain", "Range not satisfiable");
+            response->addHeader("Content-Range", "bytes */" + String(total));
+            request->send(response);
+            return;
+        }
+        if (code == 0) {
+            code = 200;
+            start = 0;
+            end = total - 1;
+        }
+    }
+    size_t length = total ? end - start + 1 : 0;
+    if (start) file.seek(start);
+
+    AsyncWebServerResponse *response = request->beginResponse(
+        "application/octet-stream",
+        length,
+        [file, length](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+            if (index >= length) return 0;
+            return file.read(buffer, min(maxLen, length - index));
+        }
+    );
+    response->setCode(code);
+    response->addHeader("Accept-Ranges", "bytes");
+    if (code == 206) {
+        response->addHeader(
+            "Content-Range", "bytes " + String(start) + "-" + String(end) + "/" + String(total)
+        );
+    }
+    String name = fileName.substring(fileName.lastIndexOf('/') + 1);
+    response->addHeader("Content-Disposition", "attachment; filename=\"" + name + "\"");
+    request->send(response);
+}
+
+/**********************************************************************
+**  Function: sendFilePage
+**  One page of a file for the viewer, text lines or hex rows.
+**  Args: first (line from 0, or byte offset with hex=1), count, find, at, reload.
+**  The reply starts with "<first> <lines indexed> <1 when indexing is done> <size>\n"
+**  Runs in async_tcp, so the index and a search only advance WEB_PAGER_BUDGET bytes per request:
+**  "index <bytes indexed> <size>\n" asks to repeat the request, "more <line> <offset> <size>\n"
+**  to repeat a search with first=<line>&at=<offset>.
+**********************************************************************/
+void sendFilePage(AsyncWebServerRequest *request, FS &fs, const String &fileName) {
+    String key = String(&fs == &SD ? "SD:" : "LittleFS:") + fileName;
+    if (key != webPagerKey || request->hasArg("reload") || !webPager.isOpen()) {
+        webPagerKey = "";
+        if (!webPager.open(fs, fileName)) {
+            request->send(500, "text/plain", "Failed to open file for reading");
+            return;
+        }
+        webPagerKey = key;
+    }
+    // the index grows a little on every page
+    webPager.indexStep(WEB_PAGER_BUDGET);
+
+    bool hex = request->arg("hex") == "1";
+    uint32_t first = strtoul(request->arg("first").c_str(), nullptr, 10);
+    uint32_t count = request->hasArg("count") ? request->arg("count").toInt() : 100;
+    count = constrain(count, 1, 256);
+    bool resume = request->hasArg("at");
+    uint32_t at = strtoul(request->arg("at").c_str(), nullptr, 10);
+
+    bool pastIndex = resume ? at > webPager.indexedBytes() : first >= webPager.lineCount();
+    if (!hex && !webPager.indexed() && pastIndex) {
+        // past the indexed part, finding the line would mean scanning up to it now
+        String reply = "index " + String(webPager.indexedBytes()) + " " + String(webPager.size()) + "\n";
+        request->send(200, "text/plain", reply);
+        return;
+    }
+
+    if (!hex && request->hasArg("find")) {
+        if (!resume && !webPager.lineOffset(first, at)) at = webPager.size();
+        int32_t found = webPager.findStep(request->arg("find"), first, at, WEB_PAGER_BUDGET);
+        if (found == FILE_PAGER_FIND_MORE) {
+            String reply = "more " + String(first) + " " + String(at) + " " + String(webPager.size()) + "\n";
+            request->send(200, "text/plain", reply);
+            return;
+        }
+        if (found < 0) {
+            request->send(404, "text/plain", "Not found");
+            return;
+        }
+        first = found;
+    }
+
+    String body;
+    body.reserve(4096);
+    if (hex) {
+        uint8_t buf[16];
+        size_t n;
+        for (uint32_t row = 0; row < count && (n = webPager.read(first + row * 16, buf, sizeof(buf))); row++)
+            body += FilePager::hexRow(first + row * 16, buf, n, sizeof(buf)) + "\n";
+    } else {
+        webPager.prefetch(first, count);
+        for (uint32_t i = 0; i < count && body.length() < 32 * 1024; i++) {
+            const String *text = webPager.line(first + i);
+            if (!text) break;
+            body += *text + "\n";
+        }
     }
-    root.close();
-    // log_i("ListFiles End");
-    return returnText;
+    String head = String(first) + " " + String(webPager.lineCount()) + " " + String(webPager.indexed());
+    head += " " + String(webPager.size()) + "\n";
+    request->send(200, "text/plain", head + body);
+}
+
+void closeFilePage() {
+    webPager.close();
+    webPagerKey = "";
+}
+
+static void hashJobProgress(size_t done, size_t total) {
+    hashJob.done = done;
+    hashJob.total = total;
+}
+
+static void hashJobLoop(void *) {
+    bool ok = hashFile(*hashJob.fs, hashJob.path, hashJob.algos, hashJob.result, hashJobProgress);
+    hashJob.state.store(ok ? HASH_JOB_DONE : HASH_JOB_FAILED, std::memory_order_release);
+    vTaskDelete(NULL);
+}
+
+/**********************************************************************
+**  Function: startHashJob
+**  Starts hashing a file in the background, replies 202 with the job id
+**********************************************************************/
+static void startHashJob(AsyncWebServerRequest *request, FS &fs, const String &fileName) {
+    // algo=md5|crc32|sha256, all of them in one pass when missing
+    uint8_t algos = HASH_ALL;
+    if (request->hasArg("algo")) algos = hashAlgoFromString(request->arg("algo"));
+    if (!algos) {
+        request->send(400, "text/plain", "ERROR: algo must be md5, crc32 or sha256");
+        return;
+    }
+    if (hashJob.state.load(std::memory_order_acquire) == HASH_JOB_RUNNING) {
+        request->send(409, "text/plain", "ERROR: another checksum is running");
+        return;
+    }
+    hashJob.id++;
+    hashJob.fs = &fs;
+    hashJob.path = fileName;
+    hashJob.algos = algos;
+    hashJob.done = 0;
+    hashJob.total = 0;
+    hashJob.result = FileHashes();
+    hashJob.state.store(HASH_JOB_RUNNING, std::memory_order_release);
+    if (xTaskCreate(hashJobLoop, "web_hash", 6144, NULL, 1, NULL) != pdPASS) {
+        hashJob.state.store(HASH_JOB_IDLE);
+        request->send(500, "text/plain", "FAIL hashing: no memory");
+        return;
+    }
+    request->send(202, "text/plain", String(hashJob.id));
+}
+
+/**********************************************************************
+**  Function: sendHashJob
+**  State of checksum job `id`: "running <done> <total>", "done" followed by
+**  one "<ALGO>: <hex>" line per digest, or "failed"
+**********************************************************************/
+static void sendHashJob(AsyncWebServerRequest *request) {
+    uint32_t id = strtoul(request->arg("id").c_str(), nullptr, 10);
+    if (id == 0 || id != hashJob.id) {
+        request->send(404, "text/plain", "ERROR: unknown job");
+        return;
+    }
+    uint8_t state = hashJob.state.load(std::memory_order_acquire);
+    if (state == HASH_JOB_RUNNING) {
+        request->send(200, "text/plain", "running " + String(hashJob.done) + " " + String(hashJob.total));
+        return;
+    }
+    if (state != HASH_JOB_DONE) {
+        request->send(200, "text/plain", "failed");
+        return;
+    }
+    String res = "done\n";
+    if (hashJob.algos & HASH_MD5) res += "MD5: " + hashJob.result.md5 + "\n";
+    if (hashJob.algos & HASH_CRC32) res += "CRC32: " + hashJob.result.crc32 + "\n";
+    if (hashJob.algos & HASH_SHA256) res += "SHA256: " + hashJob.result.sha256 + "\n";
+    request->send(200, "text/plain", res);
+}
+
+/**********************************************************************
+**  Function: hasValidSession
+** true if the request carries the cookie of a logged in WebUI session
+**********************************************************************/
+static bool hasValidSession(AsyncWebServerRequest *request) {
+    if (!request->hasHeader("Cookie")) return false;
+    const AsyncWebHeader *cookie = request->getHeader("Cookie");
+    String c = cookie->value();
+    int idx = c.indexOf("BRUCESESSION=");
+    if (idx == -1) return false;
+    int start = idx + 13;
+    int end = c.indexOf(';', start);
+    if (end == -1) end = c.length();
+    return bruceConfig.isValidWebUISession(c.substring(start, end));
 }
 
 /**********************************************************************
@@ -170,18 +487,7 @@ String listFiles(FS &fs, String folder) {
 ** httpapitoken OR is authenticated by username and password
 **********************************************************************/
 bool checkUserWebAuth(AsyncWebServerRequest *request, bool onFailureReturnLoginPage = false) {
-    if (request->hasHeader("Cookie")) {
-        const AsyncWebHeader *cookie = request->getHeader("Cookie");
-        String c = cookie->value();
-        int idx = c.indexOf("BRUCESESSION=");
-        if (idx != -1) {
-            int start = idx + 13;
-            int end = c.indexOf(';', start);
-            if (end == -1) end = c.length();
-            String token = c.substring(start, end);
-            if (bruceConfig.isValidWebUISession(token)) { return true; }
-        }
-    }
+    if (hasValidSession(request)) return true;
     if (onFailureReturnLoginPage) {
         serveWebUIFile(request, "login.html", "text/html", true, login_html, login_html_size);
     } else {
@@ -190,6 +496,141 @@ bool checkUserWebAuth(AsyncWebServerRequest *request, bool onFailureReturnLoginP
     return false;
 }
 
+/**********************************************************************
+**  Screen mirroring: the draw ops logged by tft are pushed to every
+**  viewer on /ws/screen as binary frames
+**  [type][fromSeq][toSeq] (big endian uint32) + log packets
+**  type 'S' is a snapshot that starts with SCREEN_INFO, type 'D' holds
+**  only the ops logged after fromSeq. A viewer that gets out of step
+**  sends "sync" and receives a snapshot.
+**********************************************************************/
+static void writeBE32(uint8_t *out, uint32_t value) {
+    out[0] = value >> 24;
+    out[1] = value >> 16;
+    out[2] = value >> 8;
+    out[3] = value;
+}
+
+static void screenSocketEvent(
+    AsyncWebSocket *ws, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len
+) {
+    if (type == WS_EVT_CONNECT) {
+        bool added = false;
+        portENTER_CRITICAL(&screenViewersMux);
+        for (ScreenViewer &viewer : screenViewers) {
+            if (viewer.id) continue;
+            viewer = {client->id(), 0, true, 0, 0};
+            added = true;
+            break;
+        }
+        portEXIT_CRITICAL(&screenViewersMux);
+        if (!added) client->close(1013, "Too many viewers");
+    } else if (type == WS_EVT_DISCONNECT) {
+        ScreenViewer gone = {};
+        portENTER_CRITICAL(&screenViewersMux);
+        for (ScreenViewer &viewer : screenViewers) {
+            if (viewer.id != client->id()) continue;
+            gone = viewer;
+            viewer = {};
+        }
+        portEXIT_CRITICAL(&screenViewersMux);
+        if (gone.frames) {
+            log_d(
+                "screen viewer %u: %u frames, %u bytes, %u bytes/frame",
+                (unsigned)gone.id,
+                (unsigned)gone.frames,
+                (unsigned)gone.bytes,
+                (unsigned)(gone.bytes / gone.frames)
+            );
+        }
+    } else if (type == WS_EVT_DATA) {
+        AwsFrameInfo *info = (AwsFrameInfo *)arg;
+        if (info->opcode != WS_TEXT || len != 4 || memcmp(data, "sync", 4) != 0) return;
+        portENTER_CRITICAL(&screenViewersMux);
+        for (ScreenViewer &viewer : screenViewers) {
+            if (viewer.id == client->id()) viewer.sync = true;
+        }
+        portEXIT_CRITICAL(&screenViewersMux);
+    }
+}
+
+// Sends each viewer what was drawn since its last frame
+static void screenPushLoop(void *) {
+    size_t capacity = MAX_LOG_ENTRIES * MAX_LOG_SIZE;
+    size_t frameSize = SCREEN_FRAME_HEADER + capacity;
+    uint8_t *frame = (uint8_t *)heap_caps_malloc(frameSize, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    if (!frame) frame = (uint8_t *)heap_caps_malloc(frameSize, MALLOC_CAP_8BIT);
+    uint8_t *body = frame + SCREEN_FRAME_HEADER;
+
+    while (screenPushRunning && frame) {
+        vTaskDelay(pdMS_TO_TICKS(SCREEN_PUSH_MS));
+        if (screenSocket->count() == 0) continue;
+        uint32_t last = tft.getLogSeq();
+        for (size_t i = 0; i < SCREEN_VIEWERS; i++) {
+            portENTER_CRITICAL(&screenViewersMux);
+            ScreenViewer viewer = screenViewers[i];
+            portEXIT_CRITICAL(&screenViewersMux);
+            if (!viewer.id || (!viewer.sync && viewer.seq == last)) continue;
+            // a viewer still busy with older frames is left behind, the next delta covers the gap
+            if (!screenSocket->availableForWrite(viewer.id)) continue;
+
+            char type = 'D';
+            uint32_t from = viewer.seq;
+            uint32_t to = viewer.seq;
+            size_t size = 0;
+            if (viewer.sync || !tft.getBinLogSince(to, body, capacity, size)) {
+                type = 'S';
+                from = 0;
+                tft.getBinLog(body, size, &to);
+            }
+            // a delta whose ops were all painted over is still sent, header only: the viewer has to
+            // move to `to` or the next delta won't chain on its sequence and forces a resync
+            if (size > 0 || to != from) {
+                frame[0] = type;
+                writeBE32(frame + 1, from);
+                writeBE32(frame + 5, to);
+                screenSocket->binary(viewer.id, frame, SCREEN_FRAME_HEADER + size);
+            }
+
+            portENTER_CRITICAL(&screenViewersMux);
+            ScreenViewer &slot = screenViewers[i];
+            if (slot.id == viewer.id) {
+                slot.seq = to;
+                if (type == 'S') slot.sync = false;
+                if (size > 0 || to != from) {
+                    slot.frames++;
+                    slot.bytes += SCREEN_FRAME_HEADER + size;
+                }
+            }
+            portEXIT_CRITICAL(&screenViewersMux);
+        }
+        screenSocket->cleanupClients(SCREEN_VIEWERS);
+    }
+    if (frame) free(frame);
+    screenPushTask = NULL;
+    vTaskDelete(NULL);
+}
+
+static void startScreenSocket() {
+    screenSocket = new AsyncWebSocket("/ws/screen");
+    screenSocket->setFilter(hasValidSession);
+    screenSocket->onEvent(screenSocketEvent);
+    server->addHandler(screenSocket);
+    screenPushRunning = true;
+    xTaskCreate(screenPushLoop, "screen_push", 4096, NULL, 1, &screenPushTask);
+}
+
+static void stopScreenSocket() {
+    if (!screenSocket) return;
+    screenPushRunning = false;
+    while (screenPushTask) vTaskDelay(pdMS_TO_TICKS(10));
+    screenSocket->closeAll();
+    screenSocket = nullptr;
+    portENTER_CRITICAL(&screenViewersMux);
+    memset(screenViewers, 0, sizeof(screenViewers));
+    portEXIT_CRITICAL(&screenViewersMux);
+}
+
 /**********************************************************************
 **  Function: createDirRecursive
 ** Create folders recursivelly
@@ -267,6 +708,28 @@ void handleUpload(
     }
 }
 
+/**********************************************************************
+**  Function: handleEditBody
+** writes the body of /edit, as it arrives, to a temp file of its own next
+** to the edited one. Nothing is replaced until the whole body was written.
+** The temp file goes away with the request unless the edit went through.
+**********************************************************************/
+static std::map<AsyncWebServerRequest *, std::unique_ptr<FileEdit>> fileEdits; // async_tcp task only
+
+void handleEditBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    if (!hasValidSession(request) || !request->hasArg("name")) return;
+    if (index == 0) {
+        bool useSD = strcmp(request->arg("fs").c_str(), "SD") == 0;
+        if (useSD && !setupSdCard()) return;
+        std::unique_ptr<FileEdit> edit(new FileEdit());
+        if (!edit->begin(useSD ? (fs::FS &)SD : (fs::FS &)LittleFS, request->arg("name"))) return;
+        fileEdits[request] = std::move(edit);
+        request->onDisconnect([request]() { fileEdits.erase(request); });
+    }
+    auto it = fileEdits.find(request);
+    if (it != fileEdits.end()) it->second->write(data, len); // a short write fails the commit
+}
+
 void notFound(AsyncWebServerRequest *request) { request->send(404, "text/plain", "Nothing in here Sharky"); }
 
 /**********************************************************************
@@ -523,6 +986,7 @@ void configureWebServer() {
                 String fileName = request->arg("fileName").c_str();
                 String filePath = request->arg("filePath").c_str();
                 String filePath2 = filePath.substring(0, filePath.lastIndexOf('/') + 1) + fileName;
+                closeFilePage();
                 // Rename the file of folder
                 if (fs == "SD") {
                     if (SD.rename(filePath, filePath2))
@@ -575,9 +1039,16 @@ void configureWebServer() {
         }
     });
 
+    // State of a checksum job
+    server->on("/hash", HTTP_GET, [](AsyncWebServerRequest *request) {
+        if (checkUserWebAuth(request)) sendHashJob(request);
+    });
+
     // Reboot device
     server->on("/reboot", HTTP_GET, [](AsyncWebServerRequest *request) {
-        if (checkUserWebAuth(request)) { ESP.restart(); }
+        if (!checkUserWebAuth(request)) return;
+        bruceConfig.commit();
+        ESP.restart();
     });
 
     // List files
@@ -586,9 +1057,9 @@ void configureWebServer() {
             String folder = "/";
             if (request->hasArg("folder")) { folder = request->arg("folder"); }
             if (strcmp(request->arg("fs").c_str(), "SD") == 0) {
-                request->send(200, "text/plain", listFiles(SD, folder));
+                sendFileList(request, SD, folder);
             } else {
-                request->send(200, "text/plain", listFiles(LittleFS, folder));
+                sendFileList(request, LittleFS, folder);
             }
         }
     });
@@ -630,13 +1101,18 @@ void configureWebServer() {
 
                 } else {
                     if (strcmp(fileAction.c_str(), "download") == 0) {
-                        request->send(*fs, fileName, "application/octet-stream", true);
+                        sendFileDownload(request, *fs, fileName);
+                    } else if (strcmp(fileAction.c_str(), "hash") == 0) {
+                        startHashJob(request, *fs, fileName);
+                    } else if (strcmp(fileAction.c_str(), "view") == 0) {
+                        sendFilePage(request, *fs, fileName);
                     } else if (strcmp(fileAction.c_str(), "image") == 0) {
                         String extension = fileName.substring(fileName.lastIndexOf('.') + 1);
                         // https://www.iana.org/assignments/media-types/media-types.xhtml#image
                         if (extension == "jpg") extension = "jpeg"; // www.rfc-editor.org/rfc/rfc2046.html
                         request->send(*fs, fileName, "image/" + extension);
                     } else if (strcmp(fileAction.c_str(), "delete") == 0) {
+                        closeFilePage();
                         if (deleteFromSd(*fs, fileName)) {
                             request->send(200, "text/plain", "Deleted : " + String(fileName));
                         } else {
@@ -658,14 +1134,8 @@ void configureWebServer() {
                         }
 
                     } else if (strcmp(fileAction.c_str(), "edit") == 0) {
-                        File editFile = fs->open(fileName, FILE_READ);
-                        if (editFile) {
-                            String fileContent = editFile.readString();
-                            request->send(200, "text/plain", fileContent);
-                            editFile.close();
-                        } else {
-                            request->send(500, "text/plain", "Failed to open file for reading");
-                        }
+                        // streamed from the file, never held in RAM as a whole
+                        request->send(*fs, fileName, "text/plain");
 
                     } else {
                         request->send(400, "text/plain", "ERROR: invalid action param supplied");
@@ -677,43 +1147,51 @@ void configureWebServer() {
         }
     });
 
-    // Edit file
-    server->on("/edit", HTTP_POST, [](AsyncWebServerRequest *request) {
-        if (checkUserWebAuth(request)) {
-            if (request->hasArg("name") && request->hasArg("content") && request->hasArg("fs")) {
-                String fileName = request->arg("name");
-                String fileContent = request->arg("content");
-                bool useSD = false;
-
-                if (strcmp(request->arg("fs").c_str(), "SD") == 0) { useSD = true; }
-
-                fs::FS *fs = useSD ? (fs::FS *)&SD : (fs::FS *)&LittleFS;
-                String fsType = useSD ? "SD" : "LittleFS";
+    // Edit file, the new content is the raw request body
+    server->on(
+        "/edit",
+        HTTP_POST,
+        [](AsyncWebServerRequest *request) {
+            if (!checkUserWebAuth(request)) return;
+            if (!request->hasArg("name") || !request->hasArg("fs")) {
+                request->send(400, "text/plain", "ERROR: name and fs parameters required");
+                return;
+            }
+            String fileName = request->arg("name");
+            bool useSD = strcmp(request->arg("fs").c_str(), "SD") == 0;
+            fs::FS *fs = useSD ? (fs::FS *)&SD : (fs::FS *)&LittleFS;
+            String fsType = useSD ? "SD" : "LittleFS";
 
-                if (useSD) {              // LittleFS is already mounted
-                    if (!setupSdCard()) { // only tries to mount SD if editting on SD
-                        request->send(500, "text/plain", "Failed to initialize file system: " + fsType);
-                        return;
-                    }
-                }
+            if (useSD && !setupSdCard()) { // only tries to mount SD if editting on SD
+                request->send(500, "text/plain", "Failed to initialize file system: " + fsType);
+                return;
+            }
 
-                File editFile = fs->open(fileName, FILE_WRITE);
-                if (editFile) {
-                    if (editFile.write((const uint8_t *)fileContent.c_str(), fileContent.length())) {
-                        request->send(200, "text/plain", "File edited: " + fileName);
-                    } else {
-                        request->send(500, "text/plain", "Failed to write to file: " + fileName);
-                    }
-                    editFile.close();
-                } else {
-                    request->send(500, "text/plain", "Failed to open file for writing: " + fileName);
-                }
+            // a form-like text body would be taken apart as parameters, the WebUI sends raw bytes
+            if (request->contentLength() && !request->contentType().startsWith("application/octet-stream")) {
+                request->send(415, "text/plain", "ERROR: body must be application/octet-stream");
+                return;
+            }
 
+            closeFilePage();
+            bool edited;
+            auto it = fileEdits.find(request);
+            if (request->contentLength() == 0) { // empty body, the file is just truncated
+                File file = fs->open(fileName, FILE_WRITE);
+                edited = (bool)file;
+                if (file) file.close();
             } else {
-                request->send(400, "text/plain", "ERROR: name, content, and fs parameters required");
+                edited = it != fileEdits.end() && it->second->commit(request->contentLength());
             }
-        }
-    });
+            if (edited) {
+                request->send(200, "text/plain", "File edited: " + fileName);
+            } else {
+                request->send(500, "text/plain", "Failed to write to file: " + fileName);
+            }
+        },
+        nullptr,
+        handleEditBody
+    );
 
     // File upload
     server->on(
@@ -736,6 +1214,7 @@ void configureWebServer() {
             }
         }
     });
+    startScreenSocket();
     server->begin();
     Serial.println("Webserver started");
 }
@@ -11,7 +11,10 @@ extern AsyncWebServer *server; // used to check if the webserver is running
 
 // function defaults
 String humanReadableSize(uint64_t bytes);
-String listFiles(FS &fs, String folder);
+void sendFileList(AsyncWebServerRequest *request, FS &fs, const String &folder);
+void sendFileDownload(AsyncWebServerRequest *request, FS &fs, const String &fileName);
+void sendFilePage(AsyncWebServerRequest *request, FS &fs, const String &fileName);
+void closeFilePage();
 String readLineFromFile(File myFile);
 
 void loopOptionsWebUi();
@@ -516,6 +516,7 @@ void loop() {
     if (interpreter_state > 0) {
         vTaskDelay(pdMS_TO_TICKS(10));
         interpreter_state = 2;
+        interpreterWake();
         Serial.println("Entering interpreter...");
         while (interpreter_state > 0) { vTaskDelay(pdMS_TO_TICKS(500)); }
         if (interpreter_state == 0) {
@@ -0,0 +1,96 @@
+/*
+ * Host side .bjsc compiler, built by gen_mqjs_headers.py as a 32 bit executable.
+ *
+ * Compiles a script against the same stdlib as the firmware (Bruce natives are
+ * NULL in mqjs_stdlib_host.h: nothing runs here, only the ROM layout matters)
+ * and writes the image the way `mqjs -o` does: JSBytecodeHeader + data.
+ *
+ * usage: bjsc script.js [script.bjsc]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mquickjs.h"
+
+#include "mqjs_stdlib_host.h"
+
+#define BJSC_MEM_SIZE (16 * 1024 * 1024)
+
+static void js_log_func(void *opaque, const void *buf, size_t buf_len) { fwrite(buf, 1, buf_len, stderr); }
+
+static char *load_file(const char *filename, size_t *len) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = size >= 0 ? malloc(size + 1) : NULL;
+    if (buf && fread(buf, 1, size, f) != (size_t)size) {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(f);
+    if (!buf) return NULL;
+    buf[size] = '\0';
+    *len = size;
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s script.js [script.bjsc]\n", argv[0]);
+        return 2;
+    }
+    const char *filename = argv[1];
+    char out_name[1024];
+    if (argc == 3) {
+        snprintf(out_name, sizeof(out_name), "%s", argv[2]);
+    } else {
+        const char *dot = strrchr(filename, '.');
+        const char *slash = strrchr(filename, '/');
+        int base_len = (dot && (!slash || dot > slash)) ? (int)(dot - filename) : (int)strlen(filename);
+        snprintf(out_name, sizeof(out_name), "%.*s.bjsc", base_len, filename);
+    }
+
+    size_t source_len;
+    char *source = load_file(filename, &source_len);
+    if (!source) {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], filename);
+        return 1;
+    }
+
+    void *mem_buf = malloc(BJSC_MEM_SIZE);
+    JSContext *ctx = mem_buf ? JS_NewContext2(mem_buf, BJSC_MEM_SIZE, &js_stdlib, TRUE) : NULL;
+    if (!ctx) {
+        fprintf(stderr, "%s: cannot create the JS context\n", argv[0]);
+        return 1;
+    }
+    JS_SetLogFunc(ctx, js_log_func);
+
+    JSValue val = JS_Parse(ctx, source, source_len, filename, 0);
+    free(source);
+    if (JS_IsException(val)) {
+        JS_PrintValueF(ctx, JS_GetException(ctx), JS_DUMP_LONG);
+        fprintf(stderr, "\n");
+        return 1;
+    }
+
+    JSBytecodeHeader hdr;
+    const uint8_t *data_buf;
+    uint32_t data_len;
+    JS_PrepareBytecode(ctx, &hdr, &data_buf, &data_len, val);
+
+    FILE *f = fopen(out_name, "wb");
+    if (!f || fwrite(&hdr, 1, sizeof(hdr), f) != sizeof(hdr) || fwrite(data_buf, 1, data_len, f) != data_len) {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], out_name);
+        if (f) fclose(f);
+        return 1;
+    }
+    fclose(f);
+    printf("%s -> %s (%u bytes)\n", filename, out_name, (unsigned)(sizeof(hdr) + data_len));
+
+    JS_FreeContext(ctx);
+    free(mem_buf);
+    return 0;
+}
@@ -0,0 +1,163 @@
+#if !defined(LITE_VERSION) && !defined(DISABLE_INTERPRETER)
+#include "bytecode_js.h"
+#include "core/file_hash.h"
+#include "core/sd_functions.h"
+
+#include <esp_app_desc.h>
+#include <vector>
+
+// Images handed to JS_LoadBytecode() are referenced by the context until it is freed
+static std::vector<uint8_t *> loaded_images;
+
+static uint8_t *alloc_image(size_t len) {
+    return (uint8_t *)(psramFound() ? ps_malloc(len) : malloc(len));
+}
+
+bool js_compile_to_file(
+    const char *source, size_t source_len, const char *filename, int eval_flags, File &out
+) {
+    if (!out || !source) return false;
+
+    // Parser, atoms and the bytecode itself: a few times the source, same budget as mqjs -o
+    size_t mem_size = 32768 + source_len * 6;
+    size_t max_alloc = psramFound() ? ESP.getMaxAllocPsram() : ESP.getMaxAllocHeap();
+    if (max_alloc < 16384 || mem_size > max_alloc - 8192) {
+        log_w("Not enough memory to compile %s (%zu bytes)", filename, mem_size);
+        return false;
+    }
+    uint8_t *mem_buf = alloc_image(mem_size);
+    if (!mem_buf) return false;
+
+    bool ok = false;
+    JSContext *ctx = js_new_compile_context(mem_buf, mem_size);
+    if (ctx) {
+        JSValue func = JS_Parse(ctx, source, source_len, filename, eval_flags);
+        if (JS_IsException(func)) {
+            JSValue obj = JS_GetException(ctx);
+            JS_PrintValueF(ctx, obj, JS_DUMP_LONG);
+        } else {
+            JSBytecodeHeader hdr;
+            const uint8_t *data_buf;
+            uint32_t data_len;
+            JS_PrepareBytecode(ctx, &hdr, &data_buf, &data_len, func);
+            ok = out.write((const uint8_t *)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+                 out.write(data_buf, data_len) == data_len;
+        }
+        JS_FreeContext(ctx);
+    }
+    free(mem_buf);
+    return ok;
+}
+
+bool js_compile_to_path(
+    const char *source, size_t source_len, const char *filename, int eval_flags, FS &fs, const String &path
+) {
+    String dir = path.substring(0, path.lastIndexOf('/'));
+    if (dir != "" && !fs.exists(dir)) {
+        // mkdir is not recursive on LittleFS
+        for (int i = dir.indexOf('/', 1); i > 0; i = dir.indexOf('/', i + 1)) {
+            String parent = dir.substring(0, i);
+            if (!fs.exists(parent)) fs.mkdir(parent);
+        }
+        fs.mkdir(dir);
+    }
+
+    String tmp = path + ".tmp";
+    File out = fs.open(tmp, FILE_WRITE);
+    bool ok = out && js_compile_to_file(source, source_len, filename, eval_flags, out);
+    if (out) out.close();
+    if (ok) {
+        fs.remove(path);
+        ok = fs.rename(tmp, path);
+    } else {
+        fs.remove(tmp);
+    }
+    return ok;
+}
+
+bool js_compile_file(FS &fs, const String &source_path, const String &out_path, int eval_flags) {
+    size_t source_len = 0;
+    char *source = readBigFile(&fs, source_path, false, &source_len);
+    if (!source) return false;
+    bool ok = js_compile_to_path(source, source_len, source_path.c_str(), eval_flags, fs, out_path);
+    free(source);
+    return ok;
+}
+
+String js_compiled_path(const String &source_path) {
+    int dot = source_path.lastIndexOf('.');
+    if (dot < source_path.lastIndexOf('/')) dot = -1;
+    return (dot < 0 ? source_path : source_path.substring(0, dot)) + JS_BYTECODE_EXT;
+}
+
+bool js_is_bytecode_file(FS &fs, const String &path) {
+    File file = fs.open(path, FILE_READ);
+    if (!file) return false;
+    JSBytecodeHeader hdr;
+    bool ok = file.read((uint8_t *)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+              JS_IsBytecode((const uint8_t *)&hdr, sizeof(hdr));
+    file.close();
+    return ok;
+}
+
+JSValue js_load_bytecode(JSContext *ctx, FS &fs, const String &path) {
+    File file = fs.open(path, FILE_READ);
+    if (!file) return JS_ThrowTypeError(ctx, "cannot open %s", path.c_str());
+
+    size_t len = file.size();
+    uint8_t *buf = len >= sizeof(JSBytecodeHeader) ? alloc_image(len) : NULL;
+    if (!buf) {
+        file.close();
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    size_t got = 0;
+    while (got < len) {
+        int n = file.read(buf + got, len - got);
+        if (n <= 0) break;
+        got += n;
+    }
+    file.close();
+
+    if (got != len) {
+        free(buf);
+        return JS_ThrowTypeError(ctx, "cannot read %s", path.c_str());
+    }
+    return js_load_bytecode_image(ctx, buf, len);
+}
+
+JSValue js_load_bytecode_image(JSContext *ctx, uint8_t *buf, size_t len) {
+    if (!JS_IsBytecode(buf, len) || JS_RelocateBytecode(ctx, buf, len)) {
+        free(buf);
+        return JS_ThrowTypeError(ctx, "invalid bytecode (built for another firmware?)");
+    }
+    loaded_images.push_back(buf);
+    return JS_LoadBytecode(ctx, buf);
+}
+
+void js_bytecode_release_all() {
+    for (uint8_t *buf : loaded_images) free(buf);
+    loaded_images.clear();
+    loaded_images.shrink_to_fit();
+}
+
+String js_bytecode_cache_path(FS &fs, const String &source_path, int eval_flags) {
+    String sourceHash = hashFile(fs, source_path, HASH_SHA256);
+    if (sourceHash == "") return "";
+
+    // The image points into this firmware's stdlib, so the build is part of the key
+    const uint8_t *build = esp_app_get_description()->app_elf_sha256;
+    uint64_t key = 14695981039346656037ull;
+    auto mix = [&key](uint8_t b) {
+        key ^= b;
+        key *= 1099511628211ull;
+    };
+    for (size_t i = 0; i < sourceHash.length(); i++) mix(sourceHash[i]);
+    mix(eval_flags);
+    for (size_t i = 0; i < 8; i++) mix(build[i]);
+
+    char name[24];
+    snprintf(name, sizeof(name), "/%016llx" JS_BYTECODE_EXT, (unsigned long long)key);
+    return String(JS_BYTECODE_CACHE_DIR) + name;
+}
+
+#endif
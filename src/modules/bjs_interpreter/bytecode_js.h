@@ -0,0 +1,44 @@
+#if !defined(LITE_VERSION) && !defined(DISABLE_INTERPRETER)
+#ifndef __BYTECODE_JS_H__
+#define __BYTECODE_JS_H__
+
+#include "helpers_js.h"
+
+// Compiled scripts are the mquickjs bytecode image (JSBytecodeHeader + data), the same
+// layout `mqjs -o` writes, so files built on the host load here too.
+#define JS_BYTECODE_EXT ".bjsc"
+#define JS_BYTECODE_CACHE_DIR "/BruceJS/.cache"
+
+// Defined in interpreter.cpp, the only unit that includes the generated stdlib
+JSContext *js_new_compile_context(void *mem_buf, size_t mem_size);
+
+// Parses `source` in a temporary context and writes its bytecode to `out`.
+// eval_flags are the JS_Parse ones (JS_EVAL_RETVAL for modules returning their wrapper).
+bool js_compile_to_file(
+    const char *source, size_t source_len, const char *filename, int eval_flags, File &out
+);
+// Same, to `path` through a temp file so a power loss never leaves half an image
+bool js_compile_to_path(
+    const char *source, size_t source_len, const char *filename, int eval_flags, FS &fs, const String &path
+);
+
+// Reads and compiles a script file (eval_flags 0 for main scripts)
+bool js_compile_file(FS &fs, const String &source_path, const String &out_path, int eval_flags = 0);
+// script.js -> script.bjsc
+String js_compiled_path(const String &source_path);
+
+// Loads a bytecode image into a buffer that lives until js_bytecode_release_all().
+// Returns the function to pass to JS_Run(), JS_EXCEPTION (thrown) on errors.
+JSValue js_load_bytecode(JSContext *ctx, FS &fs, const String &path);
+// Same for an image already in RAM (malloc'ed), which is owned by the loader from now on
+JSValue js_load_bytecode_image(JSContext *ctx, uint8_t *buf, size_t len);
+bool js_is_bytecode_file(FS &fs, const String &path);
+
+// Frees every loaded image, call after JS_FreeContext()
+void js_bytecode_release_all();
+
+// Cache file for a source: keyed by its SHA-256, the eval flags and the firmware build, on the same FS
+String js_bytecode_cache_path(FS &fs, const String &source_path, int eval_flags = 0);
+
+#endif
+#endif
@@ -1,8 +1,13 @@
 #if !defined(LITE_VERSION) && !defined(DISABLE_INTERPRETER)
 #include "globals_js.h"
+#include "interpreter.h"
+#include "module_loader_js.h"
 #include "user_classes_js.h"
 
 #include "mbedtls/base64.h"
+#include <algorithm>
+#include <new>
+#include <vector>
 
 JSValue js_gc(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
     JS_GC(ctx);
@@ -24,23 +29,52 @@ JSValue js_load(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
     return ret;
 }
 
-/* timers */
+/* timers
+ * Callbacks live in a JS array (kTimersFuncsProp), indexed by slot. A timer id is the slot
+ * plus the slot generation in the upper bits, so an id kept after its timer ended never
+ * matches the timer that reuses the slot. The native side keeps a min-heap of due times.
+ * Cleared timers are dropped lazily: their heap entry carries the slot generation and is
+ * discarded when it reaches the top (or on compaction).
+ */
+#define TIMER_SLOT_BITS 16
+#define TIMER_SLOT_MASK ((1u << TIMER_SLOT_BITS) - 1)
+#define TIMER_GEN_MASK 0x7FFFu // keeps ids positive int32
+
 typedef struct {
-    bool allocated;
-    JSGCRef func;
     int64_t timeout;     /* next due time in ms */
+    uint32_t seq;        /* keeps FIFO order between timers due at the same ms */
+    uint32_t slot;       /* timer id, index in the callbacks array */
+    uint32_t gen;        /* slot generation when scheduled */
     int32_t interval_ms; /* period for intervals */
     bool repeat;
-    bool main;
 } JSTimer;
 
-#define MAX_TIMERS 16
-
 typedef struct {
-    JSTimer timers[MAX_TIMERS];
+    std::vector<JSTimer> heap;       /* min-heap on (timeout, seq) */
+    std::vector<uint32_t> slotGen;   /* bumped every time a slot is released, never 0 */
+    std::vector<uint8_t> slotUsed;   /* 0 free, 1 timer, 2 main */
+    std::vector<uint32_t> freeSlots; /* released slots, reused before growing the array */
+    std::vector<uint32_t> mainSlots; /* runtime.main() callbacks, run when brought to foreground */
+    uint32_t nextSeq;
+    uint32_t live;      /* scheduled (non main) timers */
+    uint32_t listeners; /* native event listeners, see js_add_event_listeners */
 } JSTimerContextState;
 
+typedef struct {
+    JSNativeEventHandler handler;
+    void *arg;
+} JSNativeEvent;
+
+#define JS_EVENT_QUEUE_LEN 16
+
 static const char *kTimersStateProp = "__bruce_timers_state";
+static const char *kTimersFuncsProp = "__bruce_timers_funcs";
+static QueueHandle_t js_event_queue = NULL;
+static volatile bool js_events_enabled = false;
+
+static bool timer_later(const JSTimer &a, const JSTimer &b) {
+    return a.timeout != b.timeout ? a.timeout > b.timeout : (int32_t)(a.seq - b.seq) > 0;
+}
 
 static JSTimerContextState *get_timer_state(JSContext *ctx, bool create) {
     JSValue global = JS_GetGlobalObject(ctx);
@@ -53,30 +87,106 @@ static JSTimerContextState *get_timer_state(JSContext *ctx, bool create) {
 
     if (!create) return NULL;
 
-    JSTimerContextState *state = (JSTimerContextState *)calloc(1, sizeof(JSTimerContextState));
+    JSTimerContextState *state = new (std::nothrow) JSTimerContextState();
     if (!state) return NULL;
 
     if (!JS_IsObject(ctx, holder)) { holder = JS_NewObjectClassUser(ctx, JS_CLASS_TIMERS_STATE); }
     JS_SetOpaque(ctx, holder, state);
     JS_SetPropertyStr(ctx, global, kTimersStateProp, holder);
+    JS_SetPropertyStr(ctx, global, kTimersFuncsProp, JS_NewArray(ctx, 0));
     return state;
 }
 
-void native_timers_state_finalizer(JSContext *ctx, void *opaque) {
-    JSTimerContextState *state = (JSTimerContextState *)opaque;
-    if (!state) return;
-    for (int i = 0; i < MAX_TIMERS; i++) {
-        if (state->timers[i].allocated) {
-            JS_DeleteGCRef(ctx, &state->timers[i].func);
-            state->timers[i].allocated = false;
-        }
+static JSValue get_timer_funcs(JSContext *ctx) {
+    return JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), kTimersFuncsProp);
+}
+
+static int timer_id(JSTimerContextState *state, uint32_t slot) {
+    return (int)((state->slotGen[slot] << TIMER_SLOT_BITS) | slot);
+}
+
+// Slot of a live timer id, false when the id is unknown or its timer already ended
+static bool timer_id_slot(JSTimerContextState *state, int id, uint32_t &slot) {
+    if (id <= 0) return false;
+    slot = (uint32_t)id & TIMER_SLOT_MASK;
+    return slot < state->slotUsed.size() && state->slotUsed[slot] &&
+           state->slotGen[slot] == (uint32_t)id >> TIMER_SLOT_BITS;
+}
+
+// Stores func in a free slot and returns the slot, -1 when the arena or the id space is full
+static int alloc_timer_slot(JSContext *ctx, JSTimerContextState *state, JSValue func, uint8_t kind) {
+    uint32_t slot;
+    if (!state->freeSlots.empty()) {
+        slot = state->freeSlots.back();
+    } else {
+        slot = state->slotUsed.size();
+        if (slot > TIMER_SLOT_MASK) return -1;
     }
-    free(state);
+    JSValue funcs = get_timer_funcs(ctx);
+    if (!JS_IsObject(ctx, funcs)) return -1;
+    if (JS_IsException(JS_SetPropertyUint32(ctx, funcs, slot, func))) return -1;
+
+    if (slot == state->slotUsed.size()) {
+        state->slotUsed.push_back(kind);
+        state->slotGen.push_back(1);
+    } else {
+        state->freeSlots.pop_back();
+        state->slotUsed[slot] = kind;
+    }
+    return (int)slot;
 }
 
-void js_timers_init(JSContext *ctx) { (void)get_timer_state(ctx, true); }
+static void release_timer_slot(JSContext *ctx, JSTimerContextState *state, uint32_t slot) {
+    if (slot >= state->slotUsed.size() || !state->slotUsed[slot]) return;
+    if (state->slotUsed[slot] == 2) {
+        auto &mains = state->mainSlots;
+        mains.erase(std::remove(mains.begin(), mains.end(), slot), mains.end());
+    } else {
+        state->live--;
+    }
+    state->slotUsed[slot] = 0;
+    state->slotGen[slot] = (state->slotGen[slot] + 1) & TIMER_GEN_MASK;
+    if (!state->slotGen[slot]) state->slotGen[slot] = 1;
+    state->freeSlots.push_back(slot);
+    JS_SetPropertyUint32(ctx, get_timer_funcs(ctx), slot, JS_UNDEFINED);
+}
+
+static void push_timer(JSTimerContextState *state, JSTimer timer) {
+    timer.seq = state->nextSeq++;
+    state->heap.push_back(timer);
+    std::push_heap(state->heap.begin(), state->heap.end(), timer_later);
+}
+
+static bool timer_is_stale(JSTimerContextState *state, const JSTimer &timer) {
+    return state->slotGen[timer.slot] != timer.gen;
+}
+
+// Drops cleared timers when they make up most of the heap (setTimeout/clearTimeout debouncing)
+static void compact_timers(JSTimerContextState *state) {
+    if (state->heap.size() < 16 || state->heap.size() < state->live * 2) return;
+    state->heap.erase(
+        std::remove_if(
+            state->heap.begin(),
+            state->heap.end(),
+            [state](const JSTimer &t) { return timer_is_stale(state, t); }
+        ),
+        state->heap.end()
+    );
+    std::make_heap(state->heap.begin(), state->heap.end(), timer_later);
+}
+
+void native_timers_state_finalizer(JSContext *ctx, void *opaque) { delete (JSTimerContextState *)opaque; }
+
+void js_timers_init(JSContext *ctx) {
+    (void)get_timer_state(ctx, true);
+    if (!js_event_queue) js_event_queue = xQueueCreate(JS_EVENT_QUEUE_LEN, sizeof(JSNativeEvent));
+    js_events_enabled = js_event_queue != NULL;
+}
 
 void js_timers_deinit(JSContext *ctx) {
+    js_events_enabled = false;
+    if (js_event_queue) xQueueReset(js_event_queue); // the queue is kept, native tasks may still hold it
+
     JSValue global = JS_GetGlobalObject(ctx);
     JSValue holder = JS_GetPropertyStr(ctx, global, kTimersStateProp);
     if (!JS_IsObject(ctx, holder)) return;
@@ -84,115 +194,93 @@ void js_timers_deinit(JSContext *ctx) {
     JSTimerContextState *state = (JSTimerContextState *)JS_GetOpaque(ctx, holder);
     if (!state) return;
 
-    for (int i = 0; i < MAX_TIMERS; i++) {
-        if (state->timers[i].allocated) {
-            JS_DeleteGCRef(ctx, &state->timers[i].func);
-            state->timers[i].allocated = false;
-        }
-    }
-
     JS_SetOpaque(ctx, holder, NULL);
-    free(state);
+    delete state;
 
     JS_SetPropertyStr(ctx, global, kTimersStateProp, JS_UNDEFINED);
+    JS_SetPropertyStr(ctx, global, kTimersFuncsProp, JS_UNDEFINED);
 }
 
-int js_add_main_timer(JSContext *ctx, JSValue func) {
-    JSTimer *th;
-    int i;
-    JSValue *pfunc;
+bool js_post_event(JSNativeEventHandler handler, void *arg) {
+    if (!js_events_enabled || !handler) return false;
+    JSNativeEvent ev = {handler, arg};
+    if (xQueueSend(js_event_queue, &ev, 0) != pdTRUE) return false;
+    interpreterWake();
+    return true;
+}
 
+bool js_post_event_from_isr(JSNativeEventHandler handler, void *arg) {
+    TaskHandle_t task = interpreterTaskHandler;
+    if (!js_events_enabled || !handler || !task) return false;
+    JSNativeEvent ev = {handler, arg};
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(js_event_queue, &ev, &woken) != pdTRUE) return false;
+    vTaskNotifyGiveFromISR(task, &woken);
+    portYIELD_FROM_ISR(woken);
+    return true;
+}
+
+void js_add_event_listeners(JSContext *ctx, int delta) {
+    JSTimerContextState *state = get_timer_state(ctx, true);
+    if (!state) return;
+    if (delta < 0 && (uint32_t)-delta > state->listeners) state->listeners = 0;
+    else state->listeners += delta;
+}
+
+int js_add_main_timer(JSContext *ctx, JSValue func) {
     if (!JS_IsFunction(ctx, func)) return -1;
 
     JSTimerContextState *state = get_timer_state(ctx, true);
     if (!state) return -1;
 
-    for (i = 0; i < MAX_TIMERS; i++) {
-        th = &state->timers[i];
-        if (!th->allocated) {
-            pfunc = JS_AddGCRef(ctx, &th->func);
-            *pfunc = func;
-            th->timeout = millis();
-            th->interval_ms = 0;
-            th->repeat = false;
-            th->main = true;
-            th->allocated = true;
-            return i;
-        }
-    }
-
-    return -1;
+    int slot = alloc_timer_slot(ctx, state, func, 2);
+    if (slot < 0) return -1;
+    state->mainSlots.push_back(slot);
+    return timer_id(state, slot);
 }
 
-JSValue js_setTimeout(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
-    JSTimer *th;
-    int delay, i;
-    JSValue *pfunc;
+static JSValue js_add_timer(JSContext *ctx, JSValue *argv, bool repeat) {
+    int delay;
 
     if (!JS_IsFunction(ctx, argv[0])) return JS_ThrowTypeError(ctx, "not a function");
     if (JS_ToInt32(ctx, &delay, argv[1])) return JS_EXCEPTION;
+    if (delay < 0) delay = 0;
 
     JSTimerContextState *state = get_timer_state(ctx, true);
     if (!state) return JS_ThrowInternalError(ctx, "out of memory");
 
-    for (i = 0; i < MAX_TIMERS; i++) {
-        th = &state->timers[i];
-        if (!th->allocated) {
-            pfunc = JS_AddGCRef(ctx, &th->func);
-            *pfunc = argv[0];
-            th->timeout = millis() + delay;
-            th->interval_ms = 0;
-            th->repeat = false;
-            th->main = false;
-            th->allocated = true;
-            return JS_NewInt32(ctx, i);
-        }
-    }
-    return JS_ThrowInternalError(ctx, "too many timers");
+    int slot = alloc_timer_slot(ctx, state, argv[0], 1);
+    if (slot < 0) return JS_ThrowOutOfMemory(ctx);
+
+    JSTimer th;
+    th.timeout = millis() + delay;
+    th.slot = slot;
+    th.gen = state->slotGen[slot];
+    th.interval_ms = repeat ? delay : 0;
+    th.repeat = repeat;
+    push_timer(state, th);
+    state->live++;
+    return JS_NewInt32(ctx, timer_id(state, slot));
 }
 
-JSValue js_setInterval(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
-    JSTimer *th;
-    int delay, i;
-    JSValue *pfunc;
-
-    if (!JS_IsFunction(ctx, argv[0])) return JS_ThrowTypeError(ctx, "not a function");
-    if (JS_ToInt32(ctx, &delay, argv[1])) return JS_EXCEPTION;
-
-    JSTimerContextState *state = get_timer_state(ctx, true);
-    if (!state) return JS_ThrowInternalError(ctx, "out of memory");
+JSValue js_setTimeout(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    return js_add_timer(ctx, argv, false);
+}
 
-    for (i = 0; i < MAX_TIMERS; i++) {
-        th = &state->timers[i];
-        if (!th->allocated) {
-            pfunc = JS_AddGCRef(ctx, &th->func);
-            *pfunc = argv[0];
-            th->timeout = millis() + delay;
-            th->interval_ms = delay;
-            th->repeat = true;
-            th->main = false;
-            th->allocated = true;
-            return JS_NewInt32(ctx, i);
-        }
-    }
-    return JS_ThrowInternalError(ctx, "too many timers");
+JSValue js_setInterval(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    return js_add_timer(ctx, argv, true);
 }
 
 JSValue js_clearTimeout(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
-    int timer_id;
-    JSTimer *th;
-
-    if (JS_ToInt32(ctx, &timer_id, argv[0])) return JS_EXCEPTION;
-    if (timer_id >= 0 && timer_id < MAX_TIMERS) {
-        JSTimerContextState *state = get_timer_state(ctx, false);
-        if (!state) return JS_UNDEFINED;
-
-        th = &state->timers[timer_id];
-        if (th->allocated) {
-            JS_DeleteGCRef(ctx, &th->func);
-            th->allocated = false;
-        }
-    }
+    int id;
+
+    if (JS_ToInt32(ctx, &id, argv[0])) return JS_EXCEPTION;
+    JSTimerContextState *state = get_timer_state(ctx, false);
+    uint32_t slot;
+    if (!state || !timer_id_slot(state, id, slot)) return JS_UNDEFINED;
+
+    release_timer_slot(ctx, state, slot);
+    compact_timers(state);
     return JS_UNDEFINED;
 }
 
@@ -200,66 +288,74 @@ JSValue js_clearInterval(JSContext *ctx, JSValue *this_val, int argc, JSValue *a
     return js_clearTimeout(ctx, this_val, argc, argv);
 }
 
-void run_timers(JSContext *ctx) {
-    int64_t min_delay;
-    int64_t delayMs;
-    int64_t cur_time;
-    bool has_timer;
-    int i;
-    JSTimer *th;
-    struct timespec ts;
+// Calls the callback in `slot`. One shot timers release their slot first so the
+// callback can reuse it; returns false when the script threw.
+static bool call_timer(JSContext *ctx, JSTimerContextState *state, uint32_t slot, bool release) {
+    JSValue ret;
+    if (JS_StackCheck(ctx, 2)) goto fail;
+    JS_PushArg(ctx, JS_GetPropertyUint32(ctx, get_timer_funcs(ctx), slot)); /* func name */
+    JS_PushArg(ctx, JS_NULL);                                               /* this */
+    if (release) release_timer_slot(ctx, state, slot);
+
+    ret = JS_Call(ctx, 0);
+    if (JS_IsException(ret)) {
+    fail:
+        log_e("Error in run_timers");
+        JSValue obj = JS_GetException(ctx);
+        JS_PrintValueF(ctx, obj, JS_DUMP_LONG);
+        return false;
+    }
+    return true;
+}
+
+// Runs the posted events; false when a handler ended the script
+static bool run_native_events(JSContext *ctx) {
+    JSNativeEvent ev;
+    while (js_events_enabled && xQueueReceive(js_event_queue, &ev, 0) == pdTRUE) {
+        if (!ev.handler(ctx, ev.arg)) return false;
+    }
+    return true;
+}
 
+void run_timers(JSContext *ctx) {
     JSTimerContextState *state = get_timer_state(ctx, false);
     if (!state) return;
 
     while (interpreter_state >= 0) {
-        min_delay = 1000;
-        cur_time = millis();
-        has_timer = false;
-        for (i = 0; i < MAX_TIMERS; i++) {
-            th = &state->timers[i];
-            if (th->allocated) {
-                if (th->main && interpreter_state != 2) { continue; }
-                if (th->main && interpreter_state == 2) { interpreter_state = 3; }
-                has_timer = true;
-                delayMs = th->timeout - cur_time;
-                if (delayMs <= 0) {
-                    JSValue ret;
-                    /* the timer expired */
-                    if (JS_StackCheck(ctx, 2)) goto fail;
-                    JS_PushArg(ctx, th->func.val); /* func name */
-                    JS_PushArg(ctx, JS_NULL);      /* this */
-
-                    if (!th->repeat && !th->main) {
-                        JS_DeleteGCRef(ctx, &th->func);
-                        th->allocated = false;
-                    } else {
-                        // Reschedule before calling so callbacks can clearInterval safely.
-                        // Keep cadence by advancing from the previous due time.
-                        th->timeout = th->timeout + (int64_t)th->interval_ms;
-                    }
-
-                    ret = JS_Call(ctx, 0);
-                    if (JS_IsException(ret)) {
-                    fail:
-                        log_e("Error in run_timers");
-                        JSValue obj = JS_GetException(ctx);
-                        JS_PrintValueF(ctx, obj, JS_DUMP_LONG);
-                        return;
-                    }
-
-                    if (th->main) { interpreter_state = 0; }
-
-                    // If interval callback threw, state may still be allocated; keep going.
-                    min_delay = 0;
-                    break;
-                } else if (delayMs < min_delay) {
-                    min_delay = delayMs;
-                }
+        if (!run_native_events(ctx)) return;
+
+        if (!state->mainSlots.empty() && interpreter_state == 2) {
+            interpreter_state = 3;
+            if (!call_timer(ctx, state, state->mainSlots.front(), false)) return;
+            interpreter_state = 0;
+            continue;
+        }
+
+        while (!state->heap.empty() && timer_is_stale(state, state->heap.front())) {
+            std::pop_heap(state->heap.begin(), state->heap.end(), timer_later);
+            state->heap.pop_back();
+        }
+        if (state->heap.empty() && !state->listeners) break;
+
+        int64_t delayMs = state->heap.empty() ? 1000 : state->heap.front().timeout - (int64_t)millis();
+        if (delayMs <= 0) {
+            /* the timer expired */
+            std::pop_heap(state->heap.begin(), state->heap.end(), timer_later);
+            JSTimer th = state->heap.back();
+            state->heap.pop_back();
+            if (th.repeat) {
+                // Reschedule before calling so callbacks can clearInterval safely.
+                // Keep cadence by advancing from the previous due time.
+                th.timeout += th.interval_ms;
+                push_timer(state, th);
             }
+            if (!call_timer(ctx, state, th.slot, !th.repeat)) return;
+            continue;
         }
-        if (!has_timer) break;
-        if (min_delay > 0) { delay(min_delay); }
+
+        // Sleep until the next timer, a posted event or a state change (interpreterWake) wakes us up
+        if (delayMs > 1000) delayMs = 1000;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(delayMs));
     }
 }
 
@@ -294,18 +390,8 @@ JSValue js_performance_now(JSContext *ctx, JSValue *this_val, int argc, JSValue
     return JS_NewInt64(ctx, (int64_t)millis());
 }
 
-// TODO: Implement user module
 JSValue native_require(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
-    if (argc < 1) { return JS_ThrowTypeError(ctx, "require() expects 1 argument"); }
-
-    JSCStringBuf name_buf;
-    const char *name = JS_ToCString(ctx, argv[0], &name_buf);
-    if (!name) { return JS_EXCEPTION; }
-
-    JSValue global = JS_GetGlobalObject(ctx);
-    JSValue val = JS_GetPropertyStr(ctx, global, name);
-
-    return val;
+    return js_require(ctx, argc, argv);
 }
 
 JSValue native_assert(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
@@ -15,6 +15,17 @@ JSValue js_setInterval(JSContext *ctx, JSValue *this_val, int argc, JSValue *arg
 JSValue js_clearInterval(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
 void run_timers(JSContext *ctx);
 
+// Runs on the interpreter task between timers, with the JS context. Returning false ends the
+// script, as a timer callback that threw does.
+typedef bool (*JSNativeEventHandler)(JSContext *ctx, void *arg);
+// Queues handler(ctx, arg) from any task (or ISR) and wakes run_timers() right away.
+// Returns false when no script is running or the queue is full.
+bool js_post_event(JSNativeEventHandler handler, void *arg);
+bool js_post_event_from_isr(JSNativeEventHandler handler, void *arg);
+// Native event sources count their JS listeners here, run_timers() keeps waiting for
+// events while any is registered, even with no timer left
+void js_add_event_listeners(JSContext *ctx, int delta);
+
 int js_add_main_timer(JSContext *ctx, JSValue func);
 
 void native_timers_state_finalizer(JSContext *ctx, void *opaque);
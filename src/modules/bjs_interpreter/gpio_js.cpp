@@ -1,7 +1,9 @@
 #if !defined(LITE_VERSION) && !defined(DISABLE_INTERPRETER)
 #include "gpio_js.h"
 
+#include "globals_js.h"
 #include "helpers_js.h"
+#include <driver/gpio.h>
 
 JSValue native_digitalWrite(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
     int pin = 0;
@@ -181,4 +183,91 @@ JSValue native_pins(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv)
     JS_SetPropertyStr(ctx, obj, "ir_rx", JS_NewInt32(ctx, RXLED));
     return obj;
 }
+
+/* gpio.attachInterrupt(pin, callback, mode) / gpio.detachInterrupt(pin)
+ * The ISR only posts an event, callback(pin, level) runs on the interpreter task. Edges that
+ * come in before the callback ran are merged into one call.
+ */
+static const char *kGpioIrqProp = "__bruce_gpio_irq"; // callbacks by pin, keeps them alive
+static volatile bool gpioIrqPending[SOC_GPIO_PIN_COUNT];
+static uint64_t gpioIrqAttached = 0; // interpreter task only
+
+static bool gpio_irq_event(JSContext *ctx, void *arg) {
+    int pin = (int)(intptr_t)arg;
+    gpioIrqPending[pin] = false;
+    if (!(gpioIrqAttached >> pin & 1)) return true; // detached since
+
+    if (JS_StackCheck(ctx, 4)) return false;
+    JSValue funcs = JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), kGpioIrqProp);
+    JS_PushArg(ctx, JS_NewInt32(ctx, digitalRead(pin)));    /* level */
+    JS_PushArg(ctx, JS_NewInt32(ctx, pin));                 /* pin */
+    JS_PushArg(ctx, JS_GetPropertyUint32(ctx, funcs, pin)); /* func */
+    JS_PushArg(ctx, JS_NULL);                               /* this */
+    JSValue ret = JS_Call(ctx, 2);
+    if (JS_IsException(ret)) {
+        log_e("Error in gpio interrupt callback");
+        JSValue obj = JS_GetException(ctx);
+        JS_PrintValueF(ctx, obj, JS_DUMP_LONG);
+        return false;
+    }
+    return true;
+}
+
+static void IRAM_ATTR gpio_irq_isr(void *arg) {
+    int pin = (int)(intptr_t)arg;
+    if (gpioIrqPending[pin]) return;
+    gpioIrqPending[pin] = true;
+    if (!js_post_event_from_isr(gpio_irq_event, arg)) gpioIrqPending[pin] = false;
+}
+
+static int gpio_irq_pin(JSContext *ctx, int argc, JSValue *argv) {
+    int pin = -1;
+    if (argc > 0 && JS_IsNumber(ctx, argv[0])) JS_ToInt32(ctx, &pin, argv[0]);
+    return pin >= 0 && pin < SOC_GPIO_PIN_COUNT && GPIO_IS_VALID_GPIO(pin) ? pin : -1;
+}
+
+JSValue native_attachInterrupt(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    int pin = gpio_irq_pin(ctx, argc, argv);
+    if (pin < 0) return JS_ThrowTypeError(ctx, "gpio.attachInterrupt(): invalid pin");
+    if (argc < 2 || !JS_IsFunction(ctx, argv[1])) {
+        return JS_ThrowTypeError(ctx, "gpio.attachInterrupt(): callback must be a function");
+    }
+    int mode = CHANGE;
+    if (argc > 2 && JS_IsNumber(ctx, argv[2])) JS_ToInt32(ctx, &mode, argv[2]);
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue funcs = JS_GetPropertyStr(ctx, global, kGpioIrqProp);
+    if (!JS_IsObject(ctx, funcs)) {
+        funcs = JS_NewArray(ctx, 0);
+        JS_SetPropertyStr(ctx, global, kGpioIrqProp, funcs);
+    }
+    if (JS_IsException(JS_SetPropertyUint32(ctx, funcs, pin, argv[1]))) return JS_EXCEPTION;
+
+    if (!(gpioIrqAttached >> pin & 1)) {
+        gpioIrqAttached |= 1ULL << pin;
+        js_add_event_listeners(ctx, 1);
+    }
+    gpioIrqPending[pin] = false;
+    attachInterruptArg(pin, gpio_irq_isr, (void *)(intptr_t)pin, mode);
+    return JS_UNDEFINED;
+}
+
+JSValue native_detachInterrupt(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    int pin = gpio_irq_pin(ctx, argc, argv);
+    if (pin < 0 || !(gpioIrqAttached >> pin & 1)) return JS_UNDEFINED;
+
+    detachInterrupt(pin);
+    gpioIrqAttached &= ~(1ULL << pin);
+    js_add_event_listeners(ctx, -1);
+    JSValue funcs = JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), kGpioIrqProp);
+    if (JS_IsObject(ctx, funcs)) JS_SetPropertyUint32(ctx, funcs, pin, JS_UNDEFINED);
+    return JS_UNDEFINED;
+}
+
+void js_gpio_deinit() {
+    for (int pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++) {
+        if (gpioIrqAttached >> pin & 1) detachInterrupt(pin);
+    }
+    gpioIrqAttached = 0;
+}
 #endif
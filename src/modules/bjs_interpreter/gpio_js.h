@@ -23,7 +23,13 @@ JSValue native_ledcDetach(JSContext *ctx, JSValue *this_val, int argc, JSValue *
 
 JSValue native_pinMode(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
 JSValue native_pins(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+
+JSValue native_attachInterrupt(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+JSValue native_detachInterrupt(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
 }
 
+// Detaches the interrupts a script left attached, called when it ends
+void js_gpio_deinit();
+
 #endif
 #endif
@@ -8,15 +8,28 @@ extern "C" {
 #include "mqjs_stdlib.h"
 }
 
+#include "bytecode_js.h"
 #include "display_js.h"
 #include "globals_js.h"
 
 char *script = NULL;
+static size_t scriptLen = 0;
+static bool scriptIsBytecode = false;
+// Set when the script runs from the bytecode cache, so a cache entry that fails to load can be dropped
+static FS *scriptCacheFs = NULL;
+static String scriptCachePath = "";
 char *scriptDirpath = NULL;
 char *scriptName = NULL;
 
 TaskHandle_t interpreterTaskHandler = NULL;
 
+JSContext *js_new_compile_context(void *mem_buf, size_t mem_size) {
+    // prepare_compilation keeps the heap layout JS_PrepareBytecode() needs
+    JSContext *ctx = JS_NewContext2(mem_buf, mem_size, &js_stdlib, TRUE);
+    if (ctx) JS_SetLogFunc(ctx, js_log_func);
+    return ctx;
+}
+
 void interpreterHandler(void *pvParameters) {
     printMemoryUsage("init interpreter");
     if (script == NULL) { return; }
@@ -83,22 +96,45 @@ void interpreterHandler(void *pvParameters) {
     JS_SetPropertyStr(ctx, global, "INPUT_PULLUP", JS_NewInt32(ctx, INPUT_PULLUP));
     JS_SetPropertyStr(ctx, global, "PULLDOWN", JS_NewInt32(ctx, PULLDOWN));
     JS_SetPropertyStr(ctx, global, "INPUT_PULLDOWN", JS_NewInt32(ctx, INPUT_PULLDOWN));
+    JS_SetPropertyStr(ctx, global, "RISING", JS_NewInt32(ctx, RISING));
+    JS_SetPropertyStr(ctx, global, "FALLING", JS_NewInt32(ctx, FALLING));
+    JS_SetPropertyStr(ctx, global, "CHANGE", JS_NewInt32(ctx, CHANGE));
 
     printMemoryUsage("context created");
 
-    size_t scriptSize = strlen(script);
-    log_d("Script length: %zu\n", scriptSize);
-
-    JSValue val = JS_Eval(ctx, (const char *)script, scriptSize, scriptName, 0);
+    log_d("Script length: %zu (%s)\n", scriptLen, scriptIsBytecode ? "bytecode" : "source");
+
+    JSValue val = JS_UNDEFINED;
+    if (scriptIsBytecode) {
+        // The image is used in place and released with the context
+        val = js_load_bytecode_image(ctx, (uint8_t *)script, scriptLen);
+        script = NULL;
+        if (JS_IsException(val) && scriptCacheFs) {
+            // Corrupted or stale cache entry: drop it and run the source, the next launch compiles it again
+            JS_GetException(ctx);
+            scriptCacheFs->remove(scriptCachePath);
+            String source = String(scriptDirpath) + "/" + scriptName;
+            script = readBigFile(scriptCacheFs, source, false, &scriptLen);
+            scriptIsBytecode = false;
+            if (!script) val = JS_ThrowTypeError(ctx, "cannot read %s", source.c_str());
+        }
+    }
+    if (!scriptIsBytecode && script) {
+        val = JS_Parse(ctx, script, scriptLen, scriptName, 0);
+        free(script); // parsed, the text is not needed anymore
+    }
+    script = NULL;
+    if (!JS_IsException(val)) val = JS_Run(ctx, val);
+    scriptCacheFs = NULL;
+    scriptCachePath = "";
 
     run_timers(ctx);
+    js_gpio_deinit(); // before the event queue goes, no interrupt posts into a dead context
 
     LongPress = false;
     if (JS_IsException(val)) { js_fatal_error_handler(ctx); }
 
     // Clean up.
-    free((char *)script);
-    script = NULL;
     free((char *)scriptDirpath);
     scriptDirpath = NULL;
     free((char *)scriptName);
@@ -107,6 +143,7 @@ void interpreterHandler(void *pvParameters) {
     js_timers_deinit(ctx);
     JS_FreeContext(ctx);
     free(mem_buf);
+    js_bytecode_release_all();
 
     printMemoryUsage("deinit interpreter");
 
@@ -115,6 +152,11 @@ void interpreterHandler(void *pvParameters) {
     return;
 }
 
+void interpreterWake() {
+    TaskHandle_t task = interpreterTaskHandler;
+    if (task != NULL) xTaskNotifyGive(task);
+}
+
 void startInterpreterTask() {
     if (interpreterTaskHandler != NULL) {
         log_w("Interpreter task already running");
@@ -144,7 +186,7 @@ void run_bjs_script() {
         };
         loopOptions(options);
     }
-    filename = loopSD(*fs, true, "BJS|JS");
+    filename = loopSD(*fs, true, "BJS|JS|BJSC");
     vTaskDelay(pdMS_TO_TICKS(200));
     if (filename == "") { return; }
     run_bjs_script_headless(*fs, filename);
@@ -153,6 +195,8 @@ void run_bjs_script() {
 bool run_bjs_script_headless(char *code) {
     script = code;
     if (script == NULL) { return false; }
+    scriptLen = strlen(script);
+    scriptIsBytecode = false;
     scriptDirpath = strdup("/scripts");
     scriptName = strdup("index.js");
 
@@ -162,9 +206,25 @@ bool run_bjs_script_headless(char *code) {
     return true;
 }
 
-bool run_bjs_script_headless(FS fs, String filename) {
-    script = readBigFile(&fs, filename);
+bool run_bjs_script_headless(FS &fs, String filename) {
+    // Sources run from their compiled copy in the bytecode cache, built on the first launch
+    String cache = "";
+    if (!js_is_bytecode_file(fs, filename)) {
+        cache = js_bytecode_cache_path(fs, filename);
+        if (cache != "" && !fs.exists(cache) && !js_compile_file(fs, filename, cache)) cache = "";
+    }
+    script = readBigFile(&fs, cache != "" ? cache : filename, true, &scriptLen);
+    if (script != NULL && cache != "" && !JS_IsBytecode((const uint8_t *)script, scriptLen)) {
+        // not an image (truncated, written by something else): rebuild it, or run the source
+        free(script);
+        fs.remove(cache);
+        if (!js_compile_file(fs, filename, cache)) cache = "";
+        script = readBigFile(&fs, cache != "" ? cache : filename, true, &scriptLen);
+    }
     if (script == NULL) { return false; }
+    scriptIsBytecode = JS_IsBytecode((const uint8_t *)script, scriptLen);
+    scriptCacheFs = scriptIsBytecode && cache != "" ? &fs : NULL;
+    scriptCachePath = cache;
 
     int slash = filename.lastIndexOf('/');
     scriptName = strdup(filename.c_str() + slash + 1);
@@ -243,7 +303,7 @@ std::vector<Option> getScriptsOptionsList(String currentPath, bool saveStartupSc
             int dotIndex = nameOnly.lastIndexOf(".");
             String ext = dotIndex >= 0 ? nameOnly.substring(dotIndex + 1) : "";
             ext.toUpperCase();
-            if (ext != "JS" && ext != "BJS") continue;
+            if (ext != "JS" && ext != "BJS" && ext != "BJSC") continue;
 
             String entry_title = nameOnly.substring(0, nameOnly.lastIndexOf(".")); // remove the extension
             opt.push_back({entry_title.c_str(), [=]() {
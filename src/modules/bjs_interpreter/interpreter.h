@@ -10,9 +10,11 @@ extern TaskHandle_t interpreterTaskHandler;
 // part of the team!
 
 void interpreterHandler(void *pvParameters);
+// Wakes the interpreter task when it sleeps waiting for the next JS timer
+void interpreterWake();
 void run_bjs_script();
 bool run_bjs_script_headless(char *code);
-bool run_bjs_script_headless(FS fs, String filename);
+bool run_bjs_script_headless(FS &fs, String filename);
 
 String getScriptsFolder(FS *&fs);
 std::vector<Option>
@@ -20,6 +20,7 @@
  *   - maxMs: {number} - Recording duration in milliseconds (0 = unlimited, default: 8000)
  *   - stopOnSel: {boolean} - Stop recording when SEL button is pressed (default: true)
  *   - gain: {number} - Audio gain multiplier, range 0.5-4.0 (default: 1.0)
+ *   - adpcm: {boolean} - Store IMA-ADPCM, about 4x smaller than 16-bit PCM (default: false)
  *
  * @returns {object} - Recording result
  *   - ok: {boolean} - Success status
@@ -27,6 +28,7 @@
  *   - bytes: {number} - File size in bytes
  *   - sampleRateHz: {number} - Sample rate (always 48000)
  *   - channels: {number} - Channel count (always 1 for mono)
+ *   - overruns: {number} - Audio blocks lost because the storage was too slow
  *
  * @example
  *   // Simple 8-second recording with default settings
@@ -58,6 +60,7 @@ JSValue native_micRecordWav(JSContext *ctx, JSValue *this_val, int argc, JSValue
     uint32_t maxMs = 8000; // Default: 8 seconds
     bool stopOnSel = true; // Default: stop on button press
     float gain = 1.0f;     // Default: no gain adjustment
+    bool adpcm = false;    // Default: 16-bit PCM
 
     if (argc > 1 && JS_IsObject(ctx, argv[1])) {
         // Parse maxMs (recording duration)
@@ -83,6 +86,10 @@ JSValue native_micRecordWav(JSContext *ctx, JSValue *this_val, int argc, JSValue
             // Validate gain range (0.5x to 4.0x)
             if (parsedGain >= 0.5f && parsedGain <= 4.0f) { gain = parsedGain; }
         }
+
+        // Parse adpcm (compressed output)
+        JSValue adpcmVal = JS_GetPropertyStr(ctx, argv[1], "adpcm");
+        if (JS_IsBool(adpcmVal)) { adpcm = JS_ToBool(ctx, adpcmVal); }
     }
 
     // ===== RESOLVE FILESYSTEM =====
@@ -107,7 +114,9 @@ JSValue native_micRecordWav(JSContext *ctx, JSValue *this_val, int argc, JSValue
 
     // ===== SETUP RECORDING CALLBACK =====
     uint32_t outBytes = 0;
-    auto jsCallback = [&]() -> bool {
+    uint32_t overruns = 0;
+    auto jsCallback = [&](const MicRecordStats &stats) -> bool {
+        overruns = stats.overruns;
         // Check if user wants to stop via button press
         if (stopOnSel) {
             InputHandler(); // Update button states
@@ -120,12 +129,13 @@ JSValue native_micRecordWav(JSContext *ctx, JSValue *this_val, int argc, JSValue
 
     // ===== EXECUTE RECORDING =====
     bool ok = mic_record_wav_to_path(
-        fs,        // Filesystem pointer
-        path,      // Output file path
-        maxMs,     // Recording duration (0 = unlimited)
-        &outBytes, // [OUT] Bytes written
-        gain,      // Audio gain multiplier
-        jsCallback // Progress callback with stop control
+        fs,         // Filesystem pointer
+        path,       // Output file path
+        maxMs,      // Recording duration (0 = unlimited)
+        &outBytes,  // [OUT] Bytes written
+        gain,       // Audio gain multiplier
+        jsCallback, // Progress callback with stop control
+        adpcm       // IMA-ADPCM instead of PCM
     );
 
     // ===== BUILD RESULT OBJECT =====
@@ -135,6 +145,7 @@ JSValue native_micRecordWav(JSContext *ctx, JSValue *this_val, int argc, JSValue
     JS_SetPropertyStr(ctx, obj, "bytes", JS_NewInt32(ctx, (int32_t)outBytes));
     JS_SetPropertyStr(ctx, obj, "sampleRateHz", JS_NewInt32(ctx, 48000));
     JS_SetPropertyStr(ctx, obj, "channels", JS_NewInt32(ctx, 1));
+    JS_SetPropertyStr(ctx, obj, "overruns", JS_NewInt32(ctx, (int32_t)overruns));
 
     return obj;
 }
@@ -147,6 +158,8 @@ JSValue native_micRecordWav(JSContext *ctx, JSValue *this_val, int argc, JSValue
  * @param options {object} - Optional configuration
  *   - numSamples: {number} - Number of samples to capture (64-4096, default: 1024)
  *   - sampleRate: {number} - Sample rate in Hz (8000, 16000, 22050, 32000, 44100, 48000, default: 16000)
+ *     Other rates from 1000 Hz are reached by decimating a rate that is a multiple of them (e.g. 4000,
+ *     11025, 24000); anything else falls back to 16000. The rate used is in the result.
  *   - gain: {number} - Audio gain multiplier 0.5-4.0 (default: 2.0)
  *
  * @returns {object}
@@ -190,18 +203,8 @@ JSValue native_micCaptureSamples(JSContext *ctx, JSValue *this_val, int argc, JS
         if (JS_IsNumber(ctx, rateVal)) {
             int tmp = 0;
             JS_ToInt32(ctx, &tmp, rateVal);
-            // Validate supported sample rates
-            switch (tmp) {
-                case 8000:
-                case 16000:
-                case 22050:
-                case 32000:
-                case 44100:
-                case 48000: sampleRate = (uint32_t)tmp; break;
-                default:
-                    // Keep default 16000
-                    break;
-            }
+            // mic_capture_samples() resolves the rate, only the range is checked here
+            if (tmp >= 1000 && tmp <= 48000) { sampleRate = (uint32_t)tmp; }
         }
 
         // Parse gain
@@ -243,4 +246,147 @@ JSValue native_micCaptureSamples(JSContext *ctx, JSValue *this_val, int argc, JS
     return obj;
 }
 
+/**
+ * JavaScript binding for streaming audio frames
+ *
+ * @function mic.streamSamples(options, callback)
+ *
+ * @param options {object} - Optional configuration
+ *   - frameSize: {number} - Samples per frame (64-4096, default: 512)
+ *   - sampleRate: {number} - Sample rate in Hz, same values as captureSamples (default: 16000)
+ *   - gain: {number} - Audio gain multiplier 0.5-4.0 (default: 2.0)
+ *   - maxMs: {number} - Stream duration in milliseconds (0 = until stopped, default: 0)
+ *   - stopOnSel: {boolean} - Stop when SEL button is pressed (default: true)
+ *   - binary: {boolean} - Frames as Uint8Array of little endian int16 instead of arrays (default: false)
+ *
+ * @param callback {function} - Called as callback(samples, index) for each frame, return false to stop.
+ *   Audio keeps being buffered by the I2S DMA while it runs, but a callback slower than a frame
+ *   loses samples.
+ *
+ * @returns {object}
+ *   - ok: {boolean} - Success status
+ *   - sampleRate: {number} - Actual sample rate used in Hz
+ *   - frames: {number} - Frames delivered to the callback
+ *
+ * @example
+ * // Print the peak of each 20ms frame for 5 seconds
+ * mic.streamSamples({ frameSize: 320, sampleRate: 16000, maxMs: 5000 }, function (samples) {
+ *     var peak = 0;
+ *     for (var i = 0; i < samples.length; i++) peak = Math.max(peak, Math.abs(samples[i]));
+ *     println(peak);
+ * });
+ */
+JSValue native_micStreamSamples(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    (void)this_val;
+
+    // Parse options with defaults
+    uint32_t frameSize = 512;
+    uint32_t sampleRate = 16000;
+    float gain = 2.0f;
+    uint32_t maxMs = 0;
+    bool stopOnSel = true;
+    bool binary = false;
+
+    JSValue callbackArg = argc > 1 ? argv[1] : (argc > 0 ? argv[0] : JS_UNDEFINED);
+    if (!JS_IsFunction(ctx, callbackArg)) {
+        return JS_ThrowTypeError(ctx, "%s: callback must be a function", "streamSamples");
+    }
+
+    if (argc > 1 && JS_IsObject(ctx, argv[0])) {
+        JSValue sizeVal = JS_GetPropertyStr(ctx, argv[0], "frameSize");
+        if (JS_IsNumber(ctx, sizeVal)) {
+            int tmp = 0;
+            JS_ToInt32(ctx, &tmp, sizeVal);
+            if (tmp >= 64 && tmp <= 4096) { frameSize = (uint32_t)tmp; }
+        }
+
+        JSValue rateVal = JS_GetPropertyStr(ctx, argv[0], "sampleRate");
+        if (JS_IsNumber(ctx, rateVal)) {
+            int tmp = 0;
+            JS_ToInt32(ctx, &tmp, rateVal);
+            if (tmp >= 1000 && tmp <= 48000) { sampleRate = (uint32_t)tmp; }
+        }
+
+        JSValue gainVal = JS_GetPropertyStr(ctx, argv[0], "gain");
+        if (JS_IsNumber(ctx, gainVal)) {
+            double tmp = 0;
+            JS_ToNumber(ctx, &tmp, gainVal);
+            if (tmp >= 0.5 && tmp <= 4.0) { gain = (float)tmp; }
+        }
+
+        JSValue maxMsVal = JS_GetPropertyStr(ctx, argv[0], "maxMs");
+        if (JS_IsNumber(ctx, maxMsVal)) {
+            int tmp = 0;
+            JS_ToInt32(ctx, &tmp, maxMsVal);
+            if (tmp >= 0) { maxMs = (uint32_t)tmp; }
+        }
+
+        JSValue stopVal = JS_GetPropertyStr(ctx, argv[0], "stopOnSel");
+        if (JS_IsBool(stopVal)) { stopOnSel = JS_ToBool(ctx, stopVal); }
+
+        JSValue binaryVal = JS_GetPropertyStr(ctx, argv[0], "binary");
+        if (JS_IsBool(binaryVal)) { binary = JS_ToBool(ctx, binaryVal); }
+    }
+
+    // the callback and the frame being built have to survive the garbage collections frames cause
+    JSGCRef callbackRef, frameRef;
+    JSValue *callback = JS_AddGCRef(ctx, &callbackRef);
+    JSValue *frame = JS_AddGCRef(ctx, &frameRef);
+    *callback = callbackArg;
+    *frame = JS_UNDEFINED;
+
+    bool threw = false;
+    uint32_t index = 0;
+    auto onFrame = [&](const int16_t *samples, uint32_t count) -> bool {
+        if (stopOnSel) {
+            InputHandler(); // Update button states
+            if (check(SelPress)) return false;
+        }
+
+        if (binary) {
+            *frame = JS_NewUint8ArrayCopy(ctx, (const uint8_t *)samples, count * sizeof(int16_t));
+        } else {
+            *frame = JS_NewArray(ctx, count);
+            for (uint32_t i = 0; i < count && !JS_IsException(*frame); i++) {
+                JS_SetPropertyUint32(ctx, *frame, i, JS_NewInt32(ctx, (int32_t)samples[i]));
+            }
+        }
+        if (JS_IsException(*frame)) {
+            threw = true;
+            return false;
+        }
+        if (JS_StackCheck(ctx, 4)) {
+            JS_ThrowOutOfMemory(ctx);
+            threw = true;
+            return false;
+        }
+        JS_PushArg(ctx, JS_NewInt32(ctx, (int32_t)index++)); /* index */
+        JS_PushArg(ctx, *frame);                              /* samples */
+        JS_PushArg(ctx, *callback);                           /* func */
+        JS_PushArg(ctx, JS_NULL);                             /* this */
+        JSValue ret = JS_Call(ctx, 2);
+        *frame = JS_UNDEFINED;
+        if (JS_IsException(ret)) {
+            threw = true;
+            return false;
+        }
+        return !(JS_IsBool(ret) && !JS_ToBool(ctx, ret));
+    };
+
+    uint32_t actualSampleRate = 0;
+    uint32_t frames = 0;
+    bool ok = mic_stream_samples(frameSize, sampleRate, gain, maxMs, onFrame, &actualSampleRate, &frames);
+
+    JS_DeleteGCRef(ctx, &frameRef);
+    JS_DeleteGCRef(ctx, &callbackRef);
+    if (threw) return JS_EXCEPTION;
+
+    // Build result object
+    JSValue obj = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, obj, "ok", JS_NewBool(ok ? 1 : 0));
+    JS_SetPropertyStr(ctx, obj, "sampleRate", JS_NewInt32(ctx, (int32_t)actualSampleRate));
+    JS_SetPropertyStr(ctx, obj, "frames", JS_NewInt32(ctx, (int32_t)frames));
+    return obj;
+}
+
 #endif
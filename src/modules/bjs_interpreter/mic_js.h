@@ -16,6 +16,9 @@ JSValue native_micRecordWav(JSContext *ctx, JSValue *this_val, int argc, JSValue
 
 // Raw sample capture
 JSValue native_micCaptureSamples(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+
+// Streaming capture, frames go to a callback
+JSValue native_micStreamSamples(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
 }
 #endif
 
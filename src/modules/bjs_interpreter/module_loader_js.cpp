@@ -0,0 +1,213 @@
+#if !defined(LITE_VERSION) && !defined(DISABLE_INTERPRETER)
+#include "module_loader_js.h"
+#include "bytecode_js.h"
+#include "core/sd_functions.h"
+#include <vector>
+
+static const char *kModulesProp = "__bruce_modules";
+static const char *kRequireFactoryProp = "__bruce_require_factory";
+
+static const char kModulePrefix[] = "(function (exports, require, module, __filename, __dirname) {";
+static const char kModuleSuffix[] = "\n})";
+// Binds the native require to the directory of the module calling it
+static const char kRequireFactory[] = "(function (r, d) { return function (p) { return r(p, d); }; })";
+
+static bool is_module_path(const String &name) {
+    return name.startsWith("/") || name.startsWith("./") || name.startsWith("../");
+}
+
+// Joins base and name, resolving "." and ".." segments
+static String normalize_path(const String &base, const String &name) {
+    String joined = name.startsWith("/") ? name : base + "/" + name;
+    std::vector<String> parts;
+    int start = 0;
+    while (start <= (int)joined.length()) {
+        int end = joined.indexOf('/', start);
+        if (end < 0) end = joined.length();
+        String part = joined.substring(start, end);
+        if (part == "..") {
+            if (!parts.empty()) parts.pop_back();
+        } else if (part != "" && part != ".") {
+            parts.push_back(part);
+        }
+        start = end + 1;
+    }
+    String path = "";
+    for (const String &part : parts) path += "/" + part;
+    return path == "" ? "/" : path;
+}
+
+static bool is_file(FS &fs, const String &path) {
+    if (!fs.exists(path)) return false;
+    File file = fs.open(path, FILE_READ);
+    bool ok = file && !file.isDirectory();
+    if (file) file.close();
+    return ok;
+}
+
+static bool resolve_module(const String &base, const String &name, FS *&fs, String &path) {
+    static const char *suffixes[] = {"", ".js", "/index.js"};
+    String target = normalize_path(base, name);
+    FS *filesystems[] = {sdcardMounted ? (FS *)&SD : NULL, &LittleFS};
+    for (FS *candidate : filesystems) {
+        if (!candidate) continue;
+        for (const char *suffix : suffixes) {
+            if (is_file(*candidate, target + suffix)) {
+                fs = candidate;
+                path = target + suffix;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static JSValue get_modules(JSContext *ctx) {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue modules = JS_GetPropertyStr(ctx, global, kModulesProp);
+    if (JS_IsObject(ctx, modules)) return modules;
+    JS_SetPropertyStr(ctx, global, kModulesProp, JS_NewObject(ctx));
+    return JS_GetPropertyStr(ctx, global, kModulesProp);
+}
+
+// Returns the module wrapper function: cached bytecode, freshly compiled bytecode,
+// or parsed in this context when the cache can't be written (no memory, read-only FS)
+static JSValue load_module_function(JSContext *ctx, FS &fs, const String &path) {
+    String cache = js_bytecode_cache_path(fs, path, JS_EVAL_RETVAL);
+    if (cache != "" && fs.exists(cache)) {
+        JSValue func = js_load_bytecode(ctx, fs, cache);
+        if (!JS_IsException(func)) return JS_Run(ctx, func);
+        JS_GetException(ctx); // stale or corrupted, rebuild it
+        fs.remove(cache);
+    }
+
+    size_t source_len = 0;
+    char *source = readBigFile(&fs, path, false, &source_len);
+    if (!source) return JS_ThrowTypeError(ctx, "cannot read module %s", path.c_str());
+
+    size_t wrapped_len = sizeof(kModulePrefix) - 1 + source_len + sizeof(kModuleSuffix) - 1;
+    char *wrapped = (char *)(psramFound() ? ps_malloc(wrapped_len + 1) : malloc(wrapped_len + 1));
+    if (!wrapped) {
+        free(source);
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    memcpy(wrapped, kModulePrefix, sizeof(kModulePrefix) - 1);
+    memcpy(wrapped + sizeof(kModulePrefix) - 1, source, source_len);
+    memcpy(wrapped + sizeof(kModulePrefix) - 1 + source_len, kModuleSuffix, sizeof(kModuleSuffix));
+    free(source);
+
+    JSValue ret = JS_UNDEFINED;
+    bool done = false;
+    if (cache != "" && js_compile_to_path(wrapped, wrapped_len, path.c_str(), JS_EVAL_RETVAL, fs, cache)) {
+        JSValue func = js_load_bytecode(ctx, fs, cache);
+        if (!JS_IsException(func)) {
+            ret = JS_Run(ctx, func);
+            done = true;
+        } else {
+            JS_GetException(ctx);
+        }
+    }
+    if (!done) ret = JS_Eval(ctx, wrapped, wrapped_len, path.c_str(), JS_EVAL_RETVAL);
+    free(wrapped);
+    return ret;
+}
+
+// The GC compacts the arena: values are fetched again after anything that allocates
+static JSValue make_local_require(JSContext *ctx, const String &dirname) {
+    JSValue factory = JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), kRequireFactoryProp);
+    if (!JS_IsFunction(ctx, factory)) {
+        factory = JS_Eval(ctx, kRequireFactory, sizeof(kRequireFactory) - 1, "<require>", JS_EVAL_RETVAL);
+        if (JS_IsException(factory)) return factory;
+        JS_SetPropertyStr(ctx, JS_GetGlobalObject(ctx), kRequireFactoryProp, factory);
+    }
+
+    if (JS_StackCheck(ctx, 4)) return JS_ThrowOutOfMemory(ctx);
+    // arguments are pushed last first, then the function and `this`
+    JS_PushArg(ctx, JS_NewString(ctx, dirname.c_str()));
+    JS_PushArg(ctx, JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), "require"));
+    JS_PushArg(ctx, JS_GetPropertyStr(ctx, JS_GetGlobalObject(ctx), kRequireFactoryProp));
+    JS_PushArg(ctx, JS_NULL);
+    return JS_Call(ctx, 2);
+}
+
+JSValue js_require(JSContext *ctx, int argc, JSValue *argv) {
+    if (argc < 1) { return JS_ThrowTypeError(ctx, "require() expects 1 argument"); }
+
+    JSCStringBuf name_buf;
+    const char *name_str = JS_ToCString(ctx, argv[0], &name_buf);
+    if (!name_str) { return JS_EXCEPTION; }
+    String name = name_str;
+
+    JSValue global = JS_GetGlobalObject(ctx);
+    if (!is_module_path(name)) return JS_GetPropertyStr(ctx, global, name.c_str()); // built-in
+
+    String base = "/";
+    JSValue baseVal = argc > 1 ? argv[1] : JS_GetPropertyStr(ctx, global, "__dirpath");
+    if (JS_IsString(ctx, baseVal)) {
+        JSCStringBuf base_buf;
+        const char *s = JS_ToCString(ctx, baseVal, &base_buf);
+        if (s) base = s;
+    }
+
+    FS *fs = NULL;
+    String path;
+    if (!resolve_module(base, name, fs, path)) {
+        return JS_ThrowTypeError(ctx, "Cannot find module '%s'", name.c_str());
+    }
+    String key = String(fs == &SD ? "sd:" : "littlefs:") + path;
+    String dirname = path.substring(0, path.lastIndexOf('/'));
+    if (dirname == "") dirname = "/";
+
+    JSValue cached = JS_GetPropertyStr(ctx, get_modules(ctx), key.c_str());
+    if (JS_IsObject(ctx, cached)) return JS_GetPropertyStr(ctx, cached, "exports");
+
+    // Registered before running so circular requires get the partial exports
+    JSGCRef module_ref, func_ref, require_ref;
+    JSValue *module = JS_AddGCRef(ctx, &module_ref);
+    JSValue *func = JS_AddGCRef(ctx, &func_ref);
+    JSValue *local_require = JS_AddGCRef(ctx, &require_ref);
+    *module = JS_NewObject(ctx);
+    *func = JS_UNDEFINED;
+    *local_require = JS_UNDEFINED;
+    JSValue value = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, *module, "exports", value);
+    value = JS_NewString(ctx, path.c_str());
+    JS_SetPropertyStr(ctx, *module, "id", value);
+    value = get_modules(ctx);
+    JS_SetPropertyStr(ctx, value, key.c_str(), *module);
+
+    JSValue ret = JS_EXCEPTION;
+    *func = load_module_function(ctx, *fs, path);
+    if (!JS_IsException(*func) && !JS_IsFunction(ctx, *func)) {
+        *func = JS_ThrowTypeError(ctx, "invalid module %s", path.c_str());
+    }
+    if (!JS_IsException(*func)) *local_require = make_local_require(ctx, dirname);
+
+    if (!JS_IsException(*func) && !JS_IsException(*local_require)) {
+        if (JS_StackCheck(ctx, 7)) {
+            ret = JS_ThrowOutOfMemory(ctx);
+        } else {
+            JS_PushArg(ctx, JS_NewString(ctx, dirname.c_str()));        /* __dirname */
+            JS_PushArg(ctx, JS_NewString(ctx, path.c_str()));           /* __filename */
+            JS_PushArg(ctx, *module);                                    /* module */
+            JS_PushArg(ctx, *local_require);                             /* require */
+            JS_PushArg(ctx, JS_GetPropertyStr(ctx, *module, "exports")); /* exports */
+            JS_PushArg(ctx, *func);                                      /* func */
+            JS_PushArg(ctx, JS_GetPropertyStr(ctx, *module, "exports")); /* this */
+            ret = JS_Call(ctx, 5);
+        }
+    }
+
+    if (JS_IsException(ret)) {
+        // a failed module is loaded again on the next require, like node
+        JS_SetPropertyStr(ctx, get_modules(ctx), key.c_str(), JS_UNDEFINED);
+    } else {
+        ret = JS_GetPropertyStr(ctx, *module, "exports");
+    }
+    JS_DeleteGCRef(ctx, &require_ref);
+    JS_DeleteGCRef(ctx, &func_ref);
+    JS_DeleteGCRef(ctx, &module_ref);
+    return ret;
+}
+
+#endif
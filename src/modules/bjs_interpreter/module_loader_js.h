@@ -0,0 +1,18 @@
+#if !defined(LITE_VERSION) && !defined(DISABLE_INTERPRETER)
+#ifndef __MODULE_LOADER_JS_H__
+#define __MODULE_LOADER_JS_H__
+
+#include "helpers_js.h"
+
+// CommonJS require(name[, base]).
+// Names without "/", "./" or "../" return the built-in module of that name (display, storage...).
+// Paths are resolved against base (the requiring module's directory, __dirpath for the main
+// script), trying name, name.js and name/index.js on the SD card first, then LittleFS.
+// Each module runs once per context wrapped in
+//   function (exports, require, module, __filename, __dirname)
+// and its module.exports is cached. The wrapper is compiled once to bytecode under
+// JS_BYTECODE_CACHE_DIR, so later runs skip parsing.
+JSValue js_require(JSContext *ctx, int argc, JSValue *argv);
+
+#endif
+#endif
@@ -454,6 +454,7 @@ const JSPropDef js_storage[] = {
     JS_CFUNC_DEF("rmdir", 1, native_storageRmdir),
     JS_CFUNC_DEF("spaceLittleFS", 0, native_storageSpaceLittleFS),
     JS_CFUNC_DEF("spaceSDCard", 0, native_storageSpaceSDCard),
+    JS_CFUNC_DEF("open", 2, native_storageOpen),
     JS_PROP_END,
 };
 
@@ -495,6 +496,9 @@ static const JSPropDef js_gpio[] = {
     JS_CFUNC_DEF("ledcDetach", 3, native_ledcDetach),
 
     JS_CFUNC_DEF("pins", 0, native_pins),
+
+    JS_CFUNC_DEF("attachInterrupt", 3, native_attachInterrupt),
+    JS_CFUNC_DEF("detachInterrupt", 1, native_detachInterrupt),
     JS_PROP_END,
 };
 
@@ -531,6 +535,7 @@ const JSClassDef js_wifi_obj = JS_OBJECT_DEF("WiFi", js_wifi);
 static const JSPropDef js_mic[] = {
     JS_CFUNC_DEF("recordWav", 2, native_micRecordWav),
     JS_CFUNC_DEF("captureSamples", 1, native_micCaptureSamples),
+    JS_CFUNC_DEF("streamSamples", 2, native_micStreamSamples),
     JS_PROP_END,
 };
 
@@ -754,6 +759,22 @@ static const JSPropDef js_buffer[] = {
 static const JSClassDef js_buffer_class =
     JS_CLASS_DEF("Buffer", 0, NULL, JS_CLASS_BUFFER, js_buffer, js_buffer_proto, NULL, NULL);
 
+/* FileHandle (storage.open) */
+static const JSPropDef js_file_handle_proto[] = {
+    JS_CFUNC_DEF("read", 2, native_fileHandleRead),
+    JS_CFUNC_DEF("readLine", 0, native_fileHandleReadLine),
+    JS_CFUNC_DEF("write", 1, native_fileHandleWrite),
+    JS_CFUNC_DEF("seek", 2, native_fileHandleSeek),
+    JS_CFUNC_DEF("tell", 0, native_fileHandleTell),
+    JS_CFUNC_DEF("size", 0, native_fileHandleSize),
+    JS_CFUNC_DEF("close", 0, native_fileHandleClose),
+    JS_PROP_END,
+};
+
+static const JSClassDef js_file_handle_class = JS_CLASS_DEF(
+    "FileHandle", 0, NULL, JS_CLASS_FILE_HANDLE, NULL, js_file_handle_proto, NULL, native_file_handle_finalizer
+);
+
 static const JSPropDef js_internal_functions[] = {
     JS_PROP_CLASS_DEF("TimersState", &js_timers_state_class),
     JS_PROP_END,
@@ -864,6 +885,7 @@ static const JSPropDef js_global_object[] = {
     JS_PROP_CLASS_DEF("TextViewer", &js_textviewer_class),
     JS_PROP_CLASS_DEF("Gif", &js_gif_class),
     JS_PROP_CLASS_DEF("Buffer", &js_buffer_class),
+    JS_PROP_CLASS_DEF("FileHandle", &js_file_handle_class),
 
     JS_PROP_CLASS_DEF("__internal_functions", &js_internal_functions_obj),
 
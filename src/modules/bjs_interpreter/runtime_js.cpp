@@ -22,7 +22,7 @@ JSValue native_runtimeMain(JSContext *ctx, JSValue *this_val, int argc, JSValue
     if (argc < 1 || !JS_IsFunction(ctx, argv[0])) return JS_ThrowTypeError(ctx, "not a function");
 
     int id = js_add_main_timer(ctx, argv[0]);
-    if (id < 0) return JS_ThrowInternalError(ctx, "too many timers");
+    if (id < 0) return JS_ThrowOutOfMemory(ctx);
     return JS_NewInt32(ctx, id);
 }
 
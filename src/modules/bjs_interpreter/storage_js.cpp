@@ -4,6 +4,47 @@
 #include "core/sd_functions.h"
 
 #include "helpers_js.h"
+#include "user_classes_js.h"
+
+#include <new>
+
+#define FILE_HANDLE_BUFFER_SIZE 512
+
+typedef struct {
+    File file;
+    uint8_t buf[FILE_HANDLE_BUFFER_SIZE]; // read-ahead, file.position() is at its end
+    size_t pos;
+    size_t len;
+} FileHandleData;
+
+// Offset of the first `needle` occurrence at or after the current position, -1 if not found.
+// Reads the file chunk by chunk, keeping needle_len - 1 bytes between chunks.
+static int64_t find_in_file(File &file, const char *needle, size_t needle_len) {
+    if (needle_len == 0) return file.position();
+    size_t cap = FILE_HANDLE_BUFFER_SIZE + needle_len;
+    char *buf = (char *)malloc(cap);
+    if (!buf) return -1;
+
+    int64_t found = -1;
+    size_t kept = 0;
+    size_t base = file.position(); // file offset of buf[0]
+    while (found < 0) {
+        int n = file.read((uint8_t *)buf + kept, cap - kept);
+        if (n <= 0) break;
+        size_t len = kept + n;
+        for (size_t i = 0; i + needle_len <= len; i++) {
+            if (buf[i] == needle[0] && memcmp(buf + i, needle, needle_len) == 0) {
+                found = base + i;
+                break;
+            }
+        }
+        kept = len < needle_len - 1 ? len : needle_len - 1;
+        memmove(buf, buf + len - kept, kept);
+        base += len - kept;
+    }
+    free(buf);
+    return found;
+}
 
 JSValue native_storageReaddir(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
     (void)this_val;
@@ -123,23 +164,23 @@ JSValue native_storageWrite(JSContext *ctx, JSValue *this_val, int argc, JSValue
             file.seek(pos, SeekSet);
         }
     } else if (argc > 3 && JS_IsString(ctx, argv[3])) {
-        size_t tmpSize = 0;
-        char *fileContent = readBigFile(fileParams.fs, fileParams.path, false, &tmpSize);
-        if (fileContent == NULL) {
+        File reader = (fileParams.fs)->open(fileParams.path, FILE_READ);
+        if (!reader) {
             file.close();
             return JS_ThrowTypeError(
                 ctx, "%s: Could not read file: %s", "storageWrite", fileParams.path.c_str()
             );
         }
+        size_t needleLen = 0;
         JSCStringBuf sb2;
-        const char *needle = JS_ToCString(ctx, argv[3], &sb2);
-        char *foundPos = strstr(fileContent, needle);
-        if (foundPos) {
-            file.seek(foundPos - fileContent, SeekSet);
+        const char *needle = JS_ToCStringLen(ctx, &needleLen, argv[3], &sb2);
+        int64_t foundPos = needle ? find_in_file(reader, needle, needleLen) : -1;
+        reader.close();
+        if (foundPos >= 0) {
+            file.seek(foundPos, SeekSet);
         } else {
             file.seek(0, SeekEnd);
         }
-        free(fileContent);
     }
 
     if (dataPtr != NULL && dataSize > 0) { file.write((const uint8_t *)dataPtr, dataSize); }
@@ -148,6 +189,205 @@ JSValue native_storageWrite(JSContext *ctx, JSValue *this_val, int argc, JSValue
     return JS_NewBool(true);
 }
 
+JSValue native_storageOpen(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    (void)this_val;
+    // usage: storage.open(path: string | Path, mode?: "r" | "r+" | "w" | "w+" | "a" | "a+"): FileHandle
+    String mode = "r";
+    if (argc > 1 && JS_IsString(ctx, argv[1])) {
+        JSCStringBuf mb;
+        const char *modeString = JS_ToCString(ctx, argv[1], &mb);
+        if (modeString) mode = modeString;
+    }
+    if (mode != "r" && mode != "r+" && mode != "w" && mode != "w+" && mode != "a" && mode != "a+") {
+        return JS_ThrowTypeError(ctx, "%s: Invalid mode: %s", "storageOpen", mode.c_str());
+    }
+    bool reading = mode == "r" || mode == "r+";
+
+    FileParamsJS fileParams = js_get_path_from_params(ctx, argv, reading);
+    if (!fileParams.path.startsWith("/")) fileParams.path = "/" + fileParams.path;
+    if (reading && !fileParams.exist) {
+        return JS_ThrowTypeError(ctx, "%s: File: %s does not exist", "storageOpen", fileParams.path.c_str());
+    }
+
+    File file = (fileParams.fs)->open(fileParams.path, mode.c_str(), !reading);
+    if (!file || file.isDirectory()) {
+        return JS_ThrowTypeError(ctx, "%s: Could not open file: %s", "storageOpen", fileParams.path.c_str());
+    }
+
+    JSValue obj = JS_NewObjectClassUser(ctx, JS_CLASS_FILE_HANDLE);
+    if (JS_IsException(obj)) {
+        file.close();
+        return obj;
+    }
+
+    FileHandleData *d = new (std::nothrow) FileHandleData();
+    if (!d) {
+        file.close();
+        return JS_ThrowOutOfMemory(ctx);
+    }
+    d->file = file;
+    d->pos = 0;
+    d->len = 0;
+    JS_SetOpaque(ctx, obj, d);
+    return obj;
+}
+
+static FileHandleData *getFileHandle(JSContext *ctx, JSValue obj) {
+    if (!JS_IsObject(ctx, obj)) return NULL;
+    if (JS_GetClassID(ctx, obj) != JS_CLASS_FILE_HANDLE) return NULL;
+    return (FileHandleData *)JS_GetOpaque(ctx, obj);
+}
+
+// Logical position: the file position minus what is still unread in the buffer
+static size_t fileHandleTell(FileHandleData *d) { return d->file.position() - (d->len - d->pos); }
+
+// Puts the file back at the logical position before it is written or moved
+static void fileHandleDropBuffer(FileHandleData *d) {
+    if (d->pos < d->len) d->file.seek(fileHandleTell(d), SeekSet);
+    d->pos = d->len = 0;
+}
+
+static bool fileHandleFill(FileHandleData *d) {
+    if (d->pos < d->len) return true;
+    int n = d->file.read(d->buf, FILE_HANDLE_BUFFER_SIZE);
+    d->pos = 0;
+    d->len = n > 0 ? n : 0;
+    return d->len > 0;
+}
+
+JSValue native_fileHandleRead(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    // usage: handle.read(n?: number = 512, binary?: boolean): string | Uint8Array | null (end of file)
+    FileHandleData *d = getFileHandle(ctx, *this_val);
+    if (d == NULL) return JS_ThrowTypeError(ctx, "FileHandle: closed");
+
+    int n = FILE_HANDLE_BUFFER_SIZE;
+    if (argc > 0 && JS_IsNumber(ctx, argv[0])) JS_ToInt32(ctx, &n, argv[0]);
+    bool binary = argc > 1 && JS_IsBool(argv[1]) && JS_ToBool(ctx, argv[1]);
+    if (n <= 0) return binary ? JS_NewUint8ArrayCopy(ctx, d->buf, 0) : JS_NewString(ctx, "");
+
+    size_t tell = fileHandleTell(d);
+    size_t remaining = d->file.size() > tell ? d->file.size() - tell : 0;
+    if (remaining == 0) return JS_NULL;
+    size_t want = (size_t)n < remaining ? (size_t)n : remaining;
+
+    uint8_t *out = (uint8_t *)malloc(want);
+    if (!out) return JS_ThrowOutOfMemory(ctx);
+    size_t got = 0;
+    while (got < want && fileHandleFill(d)) {
+        size_t chunk = d->len - d->pos;
+        if (chunk > want - got) chunk = want - got;
+        memcpy(out + got, d->buf + d->pos, chunk);
+        d->pos += chunk;
+        got += chunk;
+    }
+
+    JSValue ret;
+    if (got == 0) {
+        ret = JS_NULL;
+    } else if (binary) {
+        ret = JS_NewUint8ArrayCopy(ctx, out, got);
+    } else {
+        ret = JS_NewStringLen(ctx, (const char *)out, got);
+    }
+    free(out);
+    return ret;
+}
+
+JSValue native_fileHandleReadLine(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    // usage: handle.readLine(): string | null (end of file), without the line ending
+    FileHandleData *d = getFileHandle(ctx, *this_val);
+    if (d == NULL) return JS_ThrowTypeError(ctx, "FileHandle: closed");
+
+    String line;
+    bool any = false;
+    while (fileHandleFill(d)) {
+        any = true;
+        const uint8_t *start = d->buf + d->pos;
+        const uint8_t *nl = (const uint8_t *)memchr(start, '\n', d->len - d->pos);
+        size_t chunk = nl ? nl - start : d->len - d->pos;
+        line.concat((const char *)start, chunk);
+        d->pos += chunk;
+        if (nl) {
+            d->pos++; // skip '\n'
+            break;
+        }
+    }
+    if (!any) return JS_NULL;
+    if (line.endsWith("\r")) line.remove(line.length() - 1);
+    return JS_NewStringLen(ctx, line.c_str(), line.length());
+}
+
+JSValue native_fileHandleWrite(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    // usage: handle.write(data: string | Uint8Array): number (bytes written)
+    FileHandleData *d = getFileHandle(ctx, *this_val);
+    if (d == NULL) return JS_ThrowTypeError(ctx, "FileHandle: closed");
+
+    size_t len = 0;
+    const char *data = NULL;
+    JSCStringBuf sb;
+    if (argc > 0 && JS_IsString(ctx, argv[0])) {
+        data = JS_ToCStringLen(ctx, &len, argv[0], &sb);
+    } else if (argc > 0 && JS_IsTypedArray(ctx, argv[0])) {
+        data = JS_GetTypedArrayBuffer(ctx, &len, argv[0]);
+    }
+    if (data == NULL) return JS_ThrowTypeError(ctx, "FileHandle.write: expected string or Uint8Array");
+
+    fileHandleDropBuffer(d);
+    return JS_NewInt32(ctx, len > 0 ? d->file.write((const uint8_t *)data, len) : 0);
+}
+
+JSValue native_fileHandleSeek(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    // usage: handle.seek(offset: number, whence?: "set" | "cur" | "end"): boolean
+    FileHandleData *d = getFileHandle(ctx, *this_val);
+    if (d == NULL) return JS_ThrowTypeError(ctx, "FileHandle: closed");
+
+    int offset = 0;
+    if (argc > 0 && JS_IsNumber(ctx, argv[0])) JS_ToInt32(ctx, &offset, argv[0]);
+    int64_t base = 0;
+    if (argc > 1 && JS_IsString(ctx, argv[1])) {
+        JSCStringBuf wb;
+        const char *whence = JS_ToCString(ctx, argv[1], &wb);
+        if (whence && strcmp(whence, "cur") == 0) {
+            base = fileHandleTell(d);
+        } else if (whence && strcmp(whence, "end") == 0) {
+            base = d->file.size();
+        }
+    }
+    int64_t target = base + offset;
+    if (target < 0) return JS_NewBool(false);
+
+    d->pos = d->len = 0;
+    return JS_NewBool(d->file.seek(target, SeekSet));
+}
+
+JSValue native_fileHandleTell(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    FileHandleData *d = getFileHandle(ctx, *this_val);
+    if (d == NULL) return JS_ThrowTypeError(ctx, "FileHandle: closed");
+    return JS_NewUint32(ctx, fileHandleTell(d));
+}
+
+JSValue native_fileHandleSize(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    FileHandleData *d = getFileHandle(ctx, *this_val);
+    if (d == NULL) return JS_ThrowTypeError(ctx, "FileHandle: closed");
+    return JS_NewUint32(ctx, d->file.size());
+}
+
+JSValue native_fileHandleClose(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
+    FileHandleData *d = getFileHandle(ctx, *this_val);
+    if (d) {
+        native_file_handle_finalizer(ctx, d);
+        JS_SetOpaque(ctx, *this_val, NULL);
+    }
+    return JS_UNDEFINED;
+}
+
+void native_file_handle_finalizer(JSContext *ctx, void *opaque) {
+    FileHandleData *d = (FileHandleData *)opaque;
+    if (!d) return;
+    d->file.close();
+    delete d;
+}
+
 JSValue native_storageRename(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv) {
     (void)this_val;
     (void)argc;
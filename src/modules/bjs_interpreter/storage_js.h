@@ -18,6 +18,19 @@ JSValue native_storageMkdir(JSContext *ctx, JSValue *this_val, int argc, JSValue
 JSValue native_storageRmdir(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
 JSValue native_storageSpaceLittleFS(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
 JSValue native_storageSpaceSDCard(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+JSValue native_storageOpen(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+
+// FileHandle class (storage.open)
+JSValue native_fileHandleRead(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+JSValue native_fileHandleReadLine(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+JSValue native_fileHandleWrite(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+JSValue native_fileHandleSeek(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+JSValue native_fileHandleTell(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+JSValue native_fileHandleSize(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+JSValue native_fileHandleClose(JSContext *ctx, JSValue *this_val, int argc, JSValue *argv);
+
+// finalizer used by the runtime when FileHandle instances are freed
+void native_file_handle_finalizer(JSContext *ctx, void *opaque);
 }
 
 #endif
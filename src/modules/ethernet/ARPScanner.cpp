@@ -24,6 +24,7 @@
 #include "modules/ethernet/MACFlooding.h"
 #include <ETH.h>
 #endif
+#include <atomic>
 #include <globals.h>
 #include <sstream>
 void run_arp_scanner() {
@@ -39,8 +40,9 @@ void run_arp_scanner() {
 #endif
 }
 
-ARPScanner::ARPScanner(esp_netif_t *_esp_net_interface) {
+ARPScanner::ARPScanner(esp_netif_t *_esp_net_interface, const ARPSweepConfig &config) {
     esp_net_interface = _esp_net_interface;
+    sweepConfig = config;
     setup();
 }
 
@@ -56,6 +58,7 @@ ARPScanner::~ARPScanner() {}
 #define ETH_ARP_HW_TYPE 1
 #define ETHERNET_PROTOCOL_ARP 0x0806
 #define PACKET_LENGTH 42 // ETH packet + ARP packet
+#define ARP_SIGHTINGS (2 * ARP_SWEEP_MAX_WINDOW)
 
 uint8_t broadcast_mac_address[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 uint8_t ether_frame[PACKET_LENGTH];
@@ -70,13 +73,106 @@ void toBytes(IPAddress ip, uint8_t *bytes) {
     bytes[3] = ip[3];
 }
 
-void ARPScanner::readArpTableETH(netif *iface) {
-    for (uint32_t i = 0; i < ARP_TABLE_SIZE; ++i) {
-        ip4_addr_t *ip_ret;
-        eth_addr *eth_ret;
-        if (etharp_get_entry(i, &ip_ret, &iface, &eth_ret)) { hostslist_eth.emplace_back(ip_ret, eth_ret); }
+struct ArpSighting {
+    uint32_t ip_be;
+    uint8_t mac[MAC_ADDRESS_LENGTH];
+};
+static std::atomic<QueueHandle_t> arpSightings{nullptr};
+static std::atomic<int> arpSnoopRunning{0}; // hook calls in progress, see sweep() teardown
+static netif_input_fn arpNextInput = nullptr;
+
+// Sits in front of the netif input during a sweep and runs in the driver task for every frame.
+// ARP senders (replies, and hosts announcing themselves) are copied out, so nothing depends on
+// the small lwIP ARP table, and the frame always goes on to lwIP untouched.
+static err_t arpSnoopInput(struct pbuf *p, struct netif *inp) {
+    const uint8_t *frame = (const uint8_t *)p->payload;
+    if (p->len >= ETH_HDRLEN + ARP_HDRLEN && frame[12] == (ETHERNET_PROTOCOL_ARP >> 8) &&
+        frame[13] == (ETHERNET_PROTOCOL_ARP & 0xFF)) {
+        ArpSighting sighting;
+        memcpy(sighting.mac, frame + ETH_HDRLEN + 8, MAC_ADDRESS_LENGTH); // sender MAC
+        memcpy(&sighting.ip_be, frame + ETH_HDRLEN + 14, IPV4_LENGTH);    // sender IP
+        arpSnoopRunning++;
+        QueueHandle_t queue = arpSightings;
+        if (queue) xQueueSend(queue, &sighting, 0);
+        arpSnoopRunning--;
     }
-    etharp_cleanup_netif(iface);
+    return arpNextInput(p, inp);
+}
+
+void ARPScanner::addHost(uint32_t ip_be, const uint8_t *mac) {
+    ip4_addr_t ip{ip_be};
+    eth_addr eth;
+    memcpy(eth.addr, mac, MAC_ADDRESS_LENGTH);
+    hostslist_eth.emplace_back(&ip, &eth);
+}
+
+// Probes first..last (host byte order) in windows of sweepConfig.window requests. The TCP/IP core
+// lock is only held while a burst of requests is sent, other lwIP traffic keeps flowing between
+// bursts. Hosts are added to hostslist_eth as their replies come in.
+void ARPScanner::sweep(netif *iface, uint32_t first, uint32_t last, uint32_t ownIp) {
+    ARPSweep arp;
+    if (!arp.begin(first, last, sweepConfig, millis())) {
+        displayError("Not enough memory", true);
+        return;
+    }
+    arp.skip(ownIp);
+    QueueHandle_t queue = xQueueCreate(ARP_SIGHTINGS, sizeof(ArpSighting));
+    if (queue == nullptr) {
+        displayError("Not enough memory", true);
+        return;
+    }
+    arpSightings = queue;
+
+    LOCK_TCPIP_CORE();
+    arpNextInput = iface->input;
+    iface->input = arpSnoopInput;
+    UNLOCK_TCPIP_CORE();
+
+    uint32_t lastUpdate = 0;
+    while (!arp.done()) {
+        uint32_t ip_le;
+        LOCK_TCPIP_CORE();
+        while (arp.nextProbe(millis(), ip_le)) {
+            ip4_addr_t ip_be{htonl(ip_le)};
+            err_t res = etharp_request(iface, &ip_be);
+            if (res != ERR_OK) {
+                Serial.println(
+                    "Arp req for: " + IPAddress(ip_be.addr).toString() + " failed with ec: " + res
+                );
+            }
+        }
+        UNLOCK_TCPIP_CORE();
+
+        // collect what arrived, waiting a little for the first one
+        ArpSighting sighting;
+        TickType_t wait = pdMS_TO_TICKS(10);
+        while (xQueueReceive(queue, &sighting, wait) == pdTRUE) {
+            if (arp.onReply(ntohl(sighting.ip_be))) addHost(sighting.ip_be, sighting.mac);
+            wait = 0;
+        }
+        arp.expire(millis());
+
+        if (millis() - lastUpdate > 500) { // Update display every 500ms
+            displayRedStripe(
+                "Probed " + String(arp.progress()) + "/" + String(arp.total()) + ", " +
+                    String(arp.found()) + " hosts",
+                getComplementaryColor2(bruceConfig.priColor),
+                bruceConfig.priColor
+            );
+            lastUpdate = millis();
+        }
+        // Stops search on EscPress
+        if (check(EscPress)) break;
+    }
+
+    LOCK_TCPIP_CORE();
+    iface->input = arpNextInput;
+    UNLOCK_TCPIP_CORE();
+    // A frame may still be inside the hook. Once the handle is gone new calls leave the queue alone,
+    // and a call that got it before is counted in arpSnoopRunning.
+    arpSightings = nullptr;
+    while (arpSnoopRunning > 0) vTaskDelay(1);
+    vQueueDelete(queue);
 }
 
 #include "ARPSpoofer.h"
@@ -127,7 +223,6 @@ void ping_target(ip_addr_t target) {
 }
 
 void ARPScanner::setup() {
-    LOCK_TCPIP_CORE();
     hostslist_eth.clear();
 
     options.clear();
@@ -151,8 +246,15 @@ void ARPScanner::setup() {
     ip_info.netmask.addr = ntohl(ip_info.netmask.addr);
     gateway = ip_info.gw.addr;
 
-    const uint32_t networkAddress = ntohl(gateway) & ip_info.netmask.addr;
-    const uint32_t broadcast = networkAddress | ~ip_info.netmask.addr;
+    // bigger networks are cut to the /16 around our address
+    uint32_t netmask = ip_info.netmask.addr;
+    if (~netmask >= ARP_SWEEP_MAX_HOSTS) netmask = 0xFFFF0000;
+    const uint32_t networkAddress = ip_info.ip.addr & netmask;
+    const uint32_t broadcast = networkAddress | ~netmask;
+    if (broadcast - networkAddress < 2) {
+        displayError("No hosts to scan", true);
+        return;
+    }
 
     // get iface
     struct netif *net_iface = (struct netif *)esp_netif_get_netif_impl(esp_net_interface);
@@ -162,57 +264,18 @@ void ARPScanner::setup() {
         return;
     }
 
-    etharp_cleanup_netif(net_iface); // to avoid gateway duplication
-
-    // send arp requests, read table each ARP_TABLE_SIZE requests
-    uint16_t tableReadCounter = 0;
-    uint32_t hostsScanned = 0;
-    const uint32_t totalHosts = broadcast - networkAddress - 1;
-    static uint32_t lastUpdate = 0;
-
-    for (uint32_t ip_le = networkAddress + 1; ip_le < broadcast; ip_le++) {
-        if (ip_le == ip_info.ip.addr || ip_le == gateway) continue;
-
-        ip4_addr_t ip_be{htonl(ip_le)}; // big endian
+    sweep(net_iface, networkAddress + 1, broadcast - 1, ip_info.ip.addr);
 
-        hostsScanned++;
-        if (millis() - lastUpdate > 500) { // Update display every 500ms
-            displayRedStripe(
-                "Probing " + String(hostsScanned) + " of " + String(totalHosts) + " hosts",
-                getComplementaryColor2(bruceConfig.priColor),
-                bruceConfig.priColor
-            );
-            lastUpdate = millis();
-        }
-
-        err_t res = etharp_request(net_iface, &ip_be);
-
-        if (res != ERR_OK) {
-            Serial.println("Arp req for: " + IPAddress(ip_be.addr).toString() + "failed with ec: " + res);
-        } else {
-            ++tableReadCounter;
-        }
-
-        vTaskDelay(arpRequestDelay);
-
-        // read table if we sent ARP_TABLE_SIZE requests
-        if (tableReadCounter == ARP_TABLE_SIZE) {
-            readArpTableETH(net_iface);
-            tableReadCounter = 0;
-        }
-        // Stops search on EscPress
-        if (check(EscPress)) break;
-    }
-    UNLOCK_TCPIP_CORE();
     auto it = std::find_if(hostslist_eth.begin(), hostslist_eth.end(), [this](const Host &host) {
         return host.ip == gateway;
     });
 
-    // Sometimes happens that gateway is not scanned, so force ping and then read again ARP table
+    // Sometimes happens that gateway is not scanned, so force ping and then read the ARP table
     if (it == hostslist_eth.end()) {
         ip_addr_t target;
         target.type = IPADDR_TYPE_V4;
         target.u_addr.ip4.addr = gateway;
+        wait_ping = true;
         ping_target(target); // Ping target to force ARP request
 
         while (wait_ping) { delay(1); }
@@ -223,11 +286,12 @@ void ARPScanner::setup() {
         gateway_ip.addr = gateway;
 
         // Search gateway in the ARP table
+        LOCK_TCPIP_CORE();
         s8_t arp_find_result = etharp_find_addr(net_iface, &gateway_ip, &eth_ret, &ipaddr_ret);
+        if (arp_find_result >= 0) addHost(gateway_ip.addr, eth_ret->addr);
+        UNLOCK_TCPIP_CORE();
 
         if (arp_find_result < 0) { Serial.println("Gateway MAC not found."); }
-
-        readArpTableETH(net_iface); // Update hostlists
     }
 
 ScanHostMenu:
@@ -283,12 +347,7 @@ void ARPScanner::afterScanOptions(const Host &host) {
     int opt = 0;
     IPAddress gw = gateway;
     options = {
-        {"Host info",
-         [=]() {
-             HostInfo(
-                 host, wifiConnected
-             ); // At this point we are sure that if user use WiFi is connected for sure
-         }},
+        {"Host info", [=]() { HostInfo{host}; }},
 #ifndef LITE_VERSION
         {"SSH Connect", lambdaHelper(ssh_setup, host.ip.toString())},
 #endif
@@ -1,6 +1,7 @@
 #ifndef ARP_SCANNER_H
 #define ARP_SCANNER_H
 #if !defined(LITE_VERSION)
+#include "ARPSweep.h"
 #include "Arduino.h"
 #include "IPAddress.h"
 #include "modules/wifi/scan_hosts.h"
@@ -11,11 +12,11 @@
 class ARPScanner {
 private:
     esp_netif_t *esp_net_interface;
-    TickType_t arpRequestDelay =
-        20u / portTICK_PERIOD_MS; // can be relatively low, helps to not overwhelm the stream
+    ARPSweepConfig sweepConfig; // probe window and rate, keeps the link usable during the scan
 
     void setup();
-    void readArpTableETH(netif *iface);
+    void sweep(netif *iface, uint32_t first, uint32_t last, uint32_t ownIp);
+    void addHost(uint32_t ip_be, const uint8_t *mac);
     IPAddress gateway;
 
     std::vector<Host> hostslist_eth;
@@ -24,7 +25,7 @@ private:
 
 public:
     ARPScanner() {};
-    ARPScanner(esp_netif_t *esp_net_interface);
+    ARPScanner(esp_netif_t *esp_net_interface, const ARPSweepConfig &config = ARPSweepConfig());
     ~ARPScanner();
 };
 
@@ -0,0 +1,117 @@
+#include "ARPSweep.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+bool ARPSweep::begin(uint32_t first, uint32_t last, const ARPSweepConfig &config, uint32_t now) {
+    end();
+    if (last < first || last - first >= ARP_SWEEP_MAX_HOSTS) return false;
+    _first = first;
+    _last = last;
+    size_t words = ((size_t)(last - first) >> 5) + 1;
+    _seen = (uint32_t *)heap_caps_malloc(words * sizeof(uint32_t), MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    if (!_seen) _seen = (uint32_t *)heap_caps_malloc(words * sizeof(uint32_t), MALLOC_CAP_8BIT);
+    if (!_seen) return false;
+    memset(_seen, 0, words * sizeof(uint32_t));
+
+    _config = config;
+    if (_config.window == 0) _config.window = 1;
+    if (_config.window > ARP_SWEEP_MAX_WINDOW) _config.window = ARP_SWEEP_MAX_WINDOW;
+    if (_config.rate == 0) _config.rate = 1;
+    memset(_slots, 0, sizeof(_slots));
+    _next = first;
+    _inFlight = 0;
+    _credit = 1000; // first probe goes out right away
+    _lastRefill = now;
+    _found = _sent = 0;
+    return true;
+}
+
+void ARPSweep::end() {
+    if (_seen) heap_caps_free(_seen);
+    _seen = nullptr;
+    _next = _last = _first = 0;
+    _inFlight = 0;
+}
+
+bool ARPSweep::seen(uint32_t ip) const {
+    uint32_t i = ip - _first;
+    return _seen[i >> 5] & (1u << (i & 31));
+}
+
+void ARPSweep::markSeen(uint32_t ip) {
+    uint32_t i = ip - _first;
+    _seen[i >> 5] |= 1u << (i & 31);
+}
+
+void ARPSweep::skip(uint32_t ip) {
+    if (_seen && inRange(ip)) markSeen(ip);
+}
+
+void ARPSweep::refill(uint32_t now) {
+    uint32_t max = _config.window * 1000u;
+    uint64_t credit = _credit + (uint64_t)(now - _lastRefill) * _config.rate;
+    _credit = credit > max ? max : credit;
+    _lastRefill = now;
+}
+
+bool ARPSweep::take(Slot &slot, uint32_t now, uint32_t &ip) {
+    _credit -= 1000;
+    slot.sentAt = now;
+    slot.due = false;
+    slot.tries++;
+    _sent++;
+    ip = slot.ip;
+    return true;
+}
+
+bool ARPSweep::nextProbe(uint32_t now, uint32_t &ip) {
+    if (!_seen) return false;
+    refill(now);
+    if (_credit < 1000) return false;
+
+    // retries first, their addresses are the oldest in the window
+    for (int i = 0; i < _config.window; i++) {
+        Slot &slot = _slots[i];
+        if (slot.tries && slot.due) return take(slot, now, ip);
+    }
+    if (_inFlight >= _config.window) return false;
+
+    while (_next <= _last && seen(_next)) _next++;
+    if (_next > _last) return false;
+    for (int i = 0; i < _config.window; i++) {
+        Slot &slot = _slots[i];
+        if (slot.tries) continue;
+        slot.ip = _next++;
+        _inFlight++;
+        return take(slot, now, ip);
+    }
+    return false;
+}
+
+bool ARPSweep::onReply(uint32_t ip) {
+    if (!_seen || !inRange(ip) || seen(ip)) return false;
+    markSeen(ip);
+    _found++;
+    for (int i = 0; i < _config.window; i++) {
+        Slot &slot = _slots[i];
+        if (slot.tries && slot.ip == ip) {
+            slot.tries = 0;
+            _inFlight--;
+            break;
+        }
+    }
+    return true;
+}
+
+void ARPSweep::expire(uint32_t now) {
+    for (int i = 0; i < _config.window; i++) {
+        Slot &slot = _slots[i];
+        if (!slot.tries || slot.due || now - slot.sentAt < _config.timeoutMs) continue;
+        if (slot.tries <= _config.retries) {
+            slot.due = true;
+        } else {
+            slot.tries = 0;
+            _inFlight--;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef ARP_SWEEP_H
+#define ARP_SWEEP_H
+#include <stddef.h>
+#include <stdint.h>
+
+#define ARP_SWEEP_MAX_WINDOW 64
+#define ARP_SWEEP_MAX_HOSTS 65536 // a /16, bigger ranges are cut by the caller
+
+struct ARPSweepConfig {
+    uint16_t window = 64;     // probes waiting for a reply at the same time
+    uint16_t rate = 200;      // probes per second, burst up to a full window
+    uint16_t timeoutMs = 250; // time given to each probe
+    uint8_t retries = 1;      // extra probes sent to silent addresses
+};
+
+// Scheduler for an ARP sweep over a range of IPv4 addresses (host byte order).
+// No I/O here: the caller sends what nextProbe() hands out, feeds every ARP reply it sees to
+// onReply() and calls expire() regularly. Probes go out in a bounded window at a fixed rate,
+// addresses that already answered (or announced themselves) are never probed again.
+class ARPSweep {
+public:
+    ARPSweep() = default;
+    ~ARPSweep() { end(); }
+    ARPSweep(const ARPSweep &) = delete;
+    ARPSweep &operator=(const ARPSweep &) = delete;
+
+    // Sweeps first..last, inclusive. False if the range is empty, too big or no memory was found.
+    bool begin(uint32_t first, uint32_t last, const ARPSweepConfig &config, uint32_t now);
+    void end();
+    // Never probes `ip` and ignores its replies (our own address)
+    void skip(uint32_t ip);
+
+    // Next address to send a request to, false while the window is full or the rate is reached
+    bool nextProbe(uint32_t now, uint32_t &ip);
+    // Reply (or announcement) from `ip`. True the first time for an address of the range.
+    bool onReply(uint32_t ip);
+    // Frees the window slots of probes that got no answer in time, retrying them if allowed
+    void expire(uint32_t now);
+    bool done() const { return _next > _last && _inFlight == 0; }
+
+    uint32_t total() const { return _last - _first + 1; }
+    uint32_t progress() const { return _next - _first; } // addresses probed at least once
+    uint32_t found() const { return _found; }
+    uint32_t sent() const { return _sent; }
+    uint16_t inFlight() const { return _inFlight; }
+
+private:
+    struct Slot {
+        uint32_t ip;
+        uint32_t sentAt;
+        uint8_t tries; // 0: free
+        bool due;      // timed out, waiting to be sent again
+    };
+
+    ARPSweepConfig _config;
+    uint32_t *_seen = nullptr; // one bit per address: answered or skipped
+    uint32_t _first = 0;
+    uint32_t _last = 0;
+    uint64_t _next = 0; // next address never probed, can pass 0xFFFFFFFF
+    Slot _slots[ARP_SWEEP_MAX_WINDOW];
+    uint16_t _inFlight = 0;
+    uint32_t _credit = 0; // probes allowed now, in 1/1000
+    uint32_t _lastRefill = 0;
+    uint32_t _found = 0;
+    uint32_t _sent = 0;
+
+    bool inRange(uint32_t ip) const { return ip >= _first && ip <= _last; }
+    bool seen(uint32_t ip) const;
+    void markSeen(uint32_t ip);
+    void refill(uint32_t now);
+    bool take(Slot &slot, uint32_t now, uint32_t &ip);
+};
+
+#endif
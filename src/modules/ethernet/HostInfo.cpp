@@ -6,78 +6,18 @@
  */
 
 #include "HostInfo.h"
-#include "ESPNetifEthernetClient.h"
+#include "PortScanner.h"
 #include "core/display.h"
 #include "core/net_utils.h"
 #include "core/scrollableTextArea.h"
 
-HostInfo::HostInfo(const Host &host, bool wifi) {
-#if !defined(LITE_VERSION)
-    if (!wifi) {
-        eth_client = new ESPNetifEthernetClient();
-    } else {
-        wifi_client = new WiFiClient();
-    }
-#else
-    wifi_client = new WiFiClient();
-#endif
+HostInfo::HostInfo(const Host &host) { setup(host); }
 
-    setup(host);
-}
-
-HostInfo::~HostInfo() {
-#if !defined(LITE_VERSION)
-    if (eth_client != nullptr) {
-        delete eth_client;
-    } else {
-        delete wifi_client;
-    }
-#else
-    delete wifi_client;
-#endif
-}
-
-void HostInfo::client_stop() {
-#if !defined(LITE_VERSION)
-    if (eth_client != nullptr) {
-        eth_client->client_close(sockfd);
-    } else {
-        wifi_client->stop();
-    }
-#else
-    wifi_client->stop();
-#endif
-}
-
-void HostInfo::client_connect(IPAddress ip, int port) {
-#if !defined(LITE_VERSION)
-    if (eth_client != nullptr) {
-        sockfd = eth_client->connect(ip, port, 3000);
-    } else {
-        wifi_client->connect(ip, port);
-    }
-#else
-    wifi_client->connect(ip, port);
-#endif
-}
-
-bool HostInfo::client_connected() {
-#if !defined(LITE_VERSION)
-    if (eth_client != nullptr) {
-        return eth_client->connected(sockfd);
-    } else {
-        return wifi_client->connected();
-    }
-#else
-    return wifi_client->connected();
-#endif
-}
+HostInfo::~HostInfo() {}
 
 void HostInfo::setup(const Host &host) {
-    const int TIMEOUT_MS = 150; // Timeout for connection attempt
-
     // Array of TCP ports to scan
-    const int portNumbers[] = {
+    static const uint16_t portNumbers[] = {
         19, 20, 21, 22, 23, 25, 42, 53, 67, 68, 69, 80, 88,
         110, 111, 113, 119, 123, 135, 137, 139, 143, 161, 162,
         179, 194, 389, 427, 443, 445, 464, 465, 500, 514, 515,
@@ -108,44 +48,38 @@ void HostInfo::setup(const Host &host) {
 
     area.draw();
 
-    //bool scanCanceled = false;
-
-    for (int i = 0; i < portCount; i++) {
-        int port = portNumbers[i];
+    // Ports are reported as they resolve, a window of connects is kept in flight
+    PortScanner scanner;
+    scanner.begin((uint32_t)host.ip, portNumbers, portCount, PortScanConfig());
+    int closed = 0;
+    int filtered = 0;
+    auto onResult = [&](uint16_t port, PortState state, uint32_t rttUs) {
+        if (state == PortState::Closed) {
+            closed++;
+        } else if (state == PortState::Filtered) {
+            filtered++;
+        } else {
+            area.addLine(String(port) + " (" + String(rttUs / 1000.0f, 1) + " ms)");
+            Serial.println(port, DEC);
+            area.draw();
+        }
+    };
 
+    bool scanCanceled = false;
+    while (scanner.poll(50, onResult)) {
         if (check(EscPress)) {
             returnToMenu = true;
+            scanCanceled = true;
             break;
         }
-
-        client_connect(host.ip, port);
-        unsigned long startTime = millis();
-
-        bool connected = false;
-        while (millis() - startTime < TIMEOUT_MS) {
-            if (client_connected()) {
-                connected = true;
-                break;
-            }
-            continue;
-        }
-
-        if (connected) {
-            area.addLine(String(port));
-            Serial.println(port, DEC);
-            area.draw();
-        }
-
-        client_stop();
     }
+    scanner.end();
 
-    /*
     if (scanCanceled) {
-        tft.print("Scan Canceled!");
+        area.addLine("Scan Canceled!");
     } else {
-        tft.print("Done!");
+        area.addLine("Closed: " + String(closed) + ", filtered: " + String(filtered));
     }
-    */
 
     area.show();
 }
@@ -1,15 +1,10 @@
 #ifndef HOST_INFO_H
 #define HOST_INFO_H
 
-#include "ESPNetifEthernetClient.h"
 #include "modules/wifi/scan_hosts.h"
 #include <map>
 class HostInfo {
 private:
-    WiFiClient *wifi_client = nullptr;
-#if !defined(LITE_VERSION)
-    ESPNetifEthernetClient *eth_client = nullptr;
-#endif
     void setup(const Host &host);
     /*
     std::map<int, const char *> portServices = {
@@ -140,14 +135,11 @@ private:
         {49156, "Windows RPC"                                                      },
         {49157, "Windows RPC"                                                      }
     }; */
-    void client_stop();
-    void client_connect(IPAddress ip, int port);
-    bool client_connected();
-    int sockfd = -1;
 
 public:
     HostInfo();
-    HostInfo(const Host &host, bool wifi);
+    // Ports are probed through lwIP sockets, which route to the interface of the host's subnet
+    HostInfo(const Host &host);
     ~HostInfo();
 };
 
@@ -0,0 +1,159 @@
+#include "PortScanner.h"
+#include <Arduino.h>
+#include <errno.h>
+#include <string.h>
+#if defined(NATIVE_BUILD)
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#else
+#include "lwip/sockets.h"
+#endif
+
+namespace {
+// Reset instead of FIN: no pcb left behind in TIME_WAIT for every probed port
+void closeProbe(int fd) {
+    struct linger lin = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+    close(fd);
+}
+} // namespace
+
+void PortScanner::begin(uint32_t ip, const uint16_t *ports, size_t count, const PortScanConfig &config) {
+    end();
+    _config = config;
+    _window = constrain(config.window, 1, PORT_SCANNER_MAX_WINDOW);
+    _ip = ip;
+    _ports = ports;
+    _count = count;
+    _next = _done = _open = 0;
+    _srttUs = -1;
+    _rttvarUs = 0;
+}
+
+void PortScanner::end() {
+    for (Probe &probe : _probes) {
+        if (probe.busy) closeProbe(probe.fd);
+        probe.busy = false;
+    }
+    _inFlight = 0;
+}
+
+uint32_t PortScanner::timeoutMs() const {
+    if (_srttUs < 0) return _config.initialTimeoutMs;
+    uint32_t ms = (_srttUs + 4 * _rttvarUs) / 1000 + 1;
+    return constrain(ms, (uint32_t)_config.minTimeoutMs, (uint32_t)_config.maxTimeoutMs);
+}
+
+// RFC 6298 smoothing, in microseconds
+void PortScanner::sample(uint32_t rttUs) {
+    int32_t rtt = min(rttUs, (uint32_t)INT32_MAX / 8);
+    if (_srttUs < 0) {
+        _srttUs = rtt;
+        _rttvarUs = rtt / 2;
+        return;
+    }
+    _rttvarUs += (abs(_srttUs - rtt) - _rttvarUs) / 4;
+    _srttUs += (rtt - _srttUs) / 8;
+}
+
+void PortScanner::finish(Probe &probe, PortState state, uint32_t now, const ResultCallback &onResult) {
+    uint32_t rtt = 0;
+    if (state != PortState::Filtered) {
+        rtt = now - probe.startUs;
+        sample(rtt);
+    }
+    if (probe.fd >= 0) closeProbe(probe.fd);
+    probe.busy = false;
+    _inFlight--;
+    _done++;
+    if (state == PortState::Open) _open++;
+    if (onResult) onResult(probe.port, state, rtt);
+}
+
+void PortScanner::fill(const ResultCallback &onResult) {
+    for (Probe &probe : _probes) {
+        if (_inFlight >= _window || _next >= _count) return;
+        if (probe.busy) continue;
+
+        probe.port = _ports[_next];
+        probe.fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (probe.fd < 0) {
+            // out of sockets: keep the window to what the stack can give, or give up on the port
+            if (_inFlight > 0) {
+                _window = _inFlight;
+                return;
+            }
+            _next++;
+            probe.busy = true;
+            _inFlight++;
+            finish(probe, PortState::Filtered, micros(), onResult);
+            continue;
+        }
+        _next++;
+        probe.busy = true;
+        _inFlight++;
+        fcntl(probe.fd, F_SETFL, fcntl(probe.fd, F_GETFL, 0) | O_NONBLOCK);
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(probe.port);
+        addr.sin_addr.s_addr = _ip;
+        probe.startUs = micros();
+        if (connect(probe.fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            finish(probe, PortState::Open, micros(), onResult);
+        } else if (errno == ECONNREFUSED) {
+            finish(probe, PortState::Closed, micros(), onResult);
+        } else if (errno != EINPROGRESS) {
+            finish(probe, PortState::Filtered, micros(), onResult); // unreachable
+        }
+    }
+}
+
+bool PortScanner::poll(uint32_t waitMs, const ResultCallback &onResult) {
+    fill(onResult);
+    if (_inFlight == 0) return _done < _count;
+
+    // sleep until something resolves, the oldest probe times out or waitMs passed
+    fd_set writable, failed;
+    FD_ZERO(&writable);
+    FD_ZERO(&failed);
+    int maxFd = -1;
+    uint32_t now = micros();
+    uint32_t timeoutUs = timeoutMs() * 1000;
+    uint32_t waitUs = waitMs * 1000;
+    for (Probe &probe : _probes) {
+        if (!probe.busy) continue;
+        FD_SET(probe.fd, &writable);
+        FD_SET(probe.fd, &failed);
+        maxFd = max(maxFd, probe.fd);
+        uint32_t age = now - probe.startUs;
+        waitUs = min(waitUs, age >= timeoutUs ? 0 : timeoutUs - age);
+    }
+    struct timeval tv;
+    tv.tv_sec = waitUs / 1000000;
+    tv.tv_usec = waitUs % 1000000;
+    int ready = select(maxFd + 1, nullptr, &writable, &failed, &tv);
+
+    now = micros();
+    timeoutUs = timeoutMs() * 1000;
+    for (Probe &probe : _probes) {
+        if (!probe.busy) continue;
+        if (ready > 0 && (FD_ISSET(probe.fd, &writable) || FD_ISSET(probe.fd, &failed))) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(probe.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            // lwIP reports a refused connect as a reset
+            PortState state = PortState::Filtered;
+            if (err == 0) state = PortState::Open;
+            else if (err == ECONNREFUSED || err == ECONNRESET) state = PortState::Closed;
+            finish(probe, state, now, onResult);
+        } else if (now - probe.startUs >= timeoutUs) {
+            finish(probe, PortState::Filtered, now, onResult);
+        }
+    }
+    return _done < _count;
+}
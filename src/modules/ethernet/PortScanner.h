@@ -0,0 +1,70 @@
+#ifndef PORT_SCANNER_H
+#define PORT_SCANNER_H
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PORT_SCANNER_MAX_WINDOW 16
+
+enum class PortState : uint8_t { Open, Closed, Filtered };
+
+struct PortScanConfig {
+    uint8_t window = 8;               // connects in flight, lwIP has few sockets to spare
+    uint16_t initialTimeoutMs = 1000; // until the first answer gives an RTT
+    uint16_t minTimeoutMs = 150;
+    uint16_t maxTimeoutMs = 1500;
+};
+
+// TCP connect scanner on non-blocking sockets (lwIP on the device, BSD sockets on the host).
+// Up to `window` connects are in flight, each port is reported as soon as it resolves: open on a
+// completed handshake, closed on a reset, filtered when nothing came back in time. The timeout
+// follows the measured RTT like TCP's RTO (srtt + 4 * rttvar), clamped to the configured range.
+class PortScanner {
+public:
+    // port, state, RTT in microseconds (0 for filtered ports)
+    typedef std::function<void(uint16_t, PortState, uint32_t)> ResultCallback;
+
+    PortScanner() = default;
+    ~PortScanner() { end(); }
+    PortScanner(const PortScanner &) = delete;
+    PortScanner &operator=(const PortScanner &) = delete;
+
+    // `ip` in network byte order, `ports` must stay valid until the scan ends
+    void begin(uint32_t ip, const uint16_t *ports, size_t count, const PortScanConfig &config);
+    // Closes what is still in flight
+    void end();
+    // Keeps the window full and waits up to `waitMs` for results. False once every port is reported.
+    bool poll(uint32_t waitMs, const ResultCallback &onResult);
+
+    size_t total() const { return _count; }
+    size_t done() const { return _done; }
+    size_t open() const { return _open; }
+    uint32_t timeoutMs() const;
+
+private:
+    struct Probe {
+        int fd;
+        uint16_t port;
+        bool busy;
+        uint32_t startUs;
+    };
+
+    PortScanConfig _config;
+    uint32_t _ip = 0;
+    const uint16_t *_ports = nullptr;
+    size_t _count = 0;
+    size_t _next = 0;
+    size_t _done = 0;
+    size_t _open = 0;
+    uint8_t _window = 0; // shrinks when the stack runs out of sockets
+    uint8_t _inFlight = 0;
+    Probe _probes[PORT_SCANNER_MAX_WINDOW] = {};
+    int32_t _srttUs = -1; // no sample yet
+    int32_t _rttvarUs = 0;
+
+    void fill(const ResultCallback &onResult);
+    void finish(Probe &probe, PortState state, uint32_t now, const ResultCallback &onResult);
+    void sample(uint32_t rttUs);
+};
+
+#endif
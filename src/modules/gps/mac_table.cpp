@@ -0,0 +1,129 @@
+#include "mac_table.h"
+#include <ctype.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+
+namespace {
+const uint16_t STAMP_MASK = 0x7FFF;
+
+uint16_t stampOf(uint64_t slot) { return (slot >> 48) & STAMP_MASK; }
+uint16_t ageOf(uint64_t slot, uint16_t now) { return (now - stampOf(slot)) & STAMP_MASK; }
+} // namespace
+
+bool MacTable::begin(size_t slots, size_t internalSlots) {
+    end();
+    size_t n = 16;
+    while (n * 2 <= slots) n *= 2;
+    _slots = (uint64_t *)heap_caps_malloc(n * sizeof(uint64_t), MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    if (!_slots) {
+        while (n > 16 && n > internalSlots) n /= 2;
+        _slots = (uint64_t *)heap_caps_malloc(n * sizeof(uint64_t), MALLOC_CAP_8BIT);
+    }
+    if (!_slots) return false;
+    _mask = n - 1;
+    clear();
+    return true;
+}
+
+void MacTable::end() {
+    if (_slots) heap_caps_free(_slots);
+    _slots = nullptr;
+    _mask = 0;
+    _count = 0;
+}
+
+void MacTable::clear() {
+    if (_slots) memset(_slots, 0, capacity() * sizeof(uint64_t));
+    _count = 0;
+    _evicted = 0;
+}
+
+size_t MacTable::home(uint64_t mac) const {
+    // the low bytes of consecutive BSSIDs differ by one, mix before masking
+    uint64_t h = mac * 0x9E3779B97F4A7C15ULL;
+    return (h >> 32) & _mask;
+}
+
+bool MacTable::contains(uint64_t mac) const {
+    if (!_slots) return false;
+    mac &= MAC_MASK;
+    for (size_t i = home(mac);; i = (i + 1) & _mask) {
+        if (!(_slots[i] & USED)) return false;
+        if ((_slots[i] & MAC_MASK) == mac) return true;
+    }
+}
+
+bool MacTable::insert(uint64_t mac, uint16_t now) {
+    if (!_slots) return true;
+    mac &= MAC_MASK;
+    const uint64_t entry = USED | ((uint64_t)(now & STAMP_MASK) << 48) | mac;
+    size_t i = home(mac);
+    for (; _slots[i] & USED; i = (i + 1) & _mask) {
+        if ((_slots[i] & MAC_MASK) == mac) {
+            _slots[i] = entry;
+            return false;
+        }
+    }
+    _slots[i] = entry;
+    _count++;
+    if (_count * 4 >= capacity() * 3) evict(now);
+    return true;
+}
+
+// Backward shift deletion: pulls the rest of the cluster back so no probe chain is broken
+void MacTable::removeAt(size_t i) {
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & _mask;
+        if (!(_slots[j] & USED)) break;
+        size_t k = home(_slots[j] & MAC_MASK);
+        // move j into the hole unless its home lies cyclically in (i, j]
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (stays) continue;
+        _slots[i] = _slots[j];
+        i = j;
+    }
+    _slots[i] = 0;
+    _count--;
+}
+
+void MacTable::evict(uint16_t now) {
+    uint16_t oldest = 0;
+    for (size_t i = 0; i <= _mask; i++) {
+        if ((_slots[i] & USED) && ageOf(_slots[i], now) > oldest) oldest = ageOf(_slots[i], now);
+    }
+
+    // drop everything older than a shrinking cutoff until half of the table is free
+    uint16_t cutoff = oldest / 2;
+    while (_count * 2 > capacity()) {
+        for (size_t i = 0; i <= _mask; i++) {
+            // removeAt() may shift another entry into i, look at it again
+            while ((_slots[i] & USED) && ageOf(_slots[i], now) > cutoff) {
+                removeAt(i);
+                _evicted++;
+            }
+        }
+        if (cutoff == 0) break;
+        cutoff /= 2;
+    }
+    // everything was seen in the current minute: start over rather than refuse new entries
+    if (_count * 4 >= capacity() * 3) {
+        _evicted += _count;
+        memset(_slots, 0, capacity() * sizeof(uint64_t));
+        _count = 0;
+    }
+}
+
+bool MacTable::parse(const char *mac, uint64_t &out) {
+    uint64_t value = 0;
+    int nibbles = 0;
+    for (; *mac; mac++) {
+        char c = *mac;
+        if (c == ':' || c == '-') continue;
+        if (!isxdigit((unsigned char)c) || ++nibbles > 12) return false;
+        value = (value << 4) | (isdigit((unsigned char)c) ? c - '0' : tolower(c) - 'a' + 10);
+    }
+    if (nibbles != 12) return false;
+    out = value;
+    return true;
+}
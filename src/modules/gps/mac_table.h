@@ -0,0 +1,49 @@
+#ifndef __MAC_TABLE_H__
+#define __MAC_TABLE_H__
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed size set of 48-bit MAC addresses (open addressing, linear probing).
+// The slots are allocated once, PSRAM first, so memory use is known when the session starts.
+// Every entry carries a 15-bit "last seen" stamp (the caller's clock, minutes for wardriving).
+// When the table is 3/4 full the entries not seen for the longest time are evicted until it is
+// half full, so a long session only forgets what has been out of range for a while.
+class MacTable {
+public:
+    MacTable() = default;
+    ~MacTable() { end(); }
+    MacTable(const MacTable &) = delete;
+    MacTable &operator=(const MacTable &) = delete;
+
+    // `slots` is rounded down to a power of two. Without PSRAM at most `internalSlots` are used.
+    bool begin(size_t slots, size_t internalSlots = 2048);
+    void end();
+    bool ready() const { return _slots != nullptr; }
+    void clear();
+
+    // Adds `mac` or refreshes its stamp. True when it was not in the table.
+    bool insert(uint64_t mac, uint16_t now);
+    bool contains(uint64_t mac) const;
+
+    size_t size() const { return _count; }
+    size_t capacity() const { return _mask + 1; }
+    uint32_t evicted() const { return _evicted; }
+
+    // "aa:bb:cc:dd:ee:ff", "AA-BB-..." or 12 hex digits
+    static bool parse(const char *mac, uint64_t &out);
+
+private:
+    static const uint64_t USED = 1ULL << 63;
+    static const uint64_t MAC_MASK = (1ULL << 48) - 1;
+
+    uint64_t *_slots = nullptr;
+    size_t _mask = 0;
+    size_t _count = 0;
+    uint32_t _evicted = 0;
+
+    size_t home(uint64_t mac) const;
+    void removeAt(size_t i);
+    void evict(uint16_t now);
+};
+
+#endif
@@ -13,7 +13,7 @@
 #include "core/wifi/wifi_common.h"
 #include "current_year.h"
 #include "modules/ble/ble_common.h"
-#include <cctype>
+#include <algorithm>
 
 #define MAX_WAIT 5000
 
@@ -21,25 +21,6 @@
 #define NIMBLE_V2_PLUS 1
 #endif
 
-static bool parseMacToU64(const String &mac, uint64_t &out) {
-    uint64_t value = 0;
-    int nibbles = 0;
-    for (size_t i = 0; i < mac.length(); i++) {
-        char c = mac[i];
-        if (c == ':' || c == '-') continue;
-        if (!isxdigit(static_cast<unsigned char>(c))) return false;
-        value <<= 4;
-        if (c >= '0' && c <= '9') value |= static_cast<uint64_t>(c - '0');
-        else if (c >= 'a' && c <= 'f') value |= static_cast<uint64_t>(c - 'a' + 10);
-        else if (c >= 'A' && c <= 'F') value |= static_cast<uint64_t>(c - 'A' + 10);
-        else return false;
-        nibbles++;
-        if (nibbles > 12) return false;
-    }
-    if (nibbles != 12) return false;
-    out = value;
-    return true;
-}
 Wardriving::Wardriving(bool scanWiFi, bool scanBLE) {
     this->scanWiFi = scanWiFi;
     this->scanBLE = scanBLE;
@@ -65,6 +46,8 @@ void Wardriving::setup() {
     padprintln("Initializing...");
 
     loadAlertMACs();
+    if (!registeredMACs.begin(REGISTERED_MAC_SLOTS, REGISTERED_MAC_SLOTS_NO_PSRAM))
+        padprintln("No memory for the MAC table, duplicates will be logged");
     begin_wifi();
     if (!begin_gps()) return;
 
@@ -114,6 +97,8 @@ void Wardriving::end() {
 
     GPSserial.end();
     restorePins();
+    csvLog.end();
+    registeredMACs.end();
     returnToMenu = true;
     gpsConnected = false;
 }
@@ -223,41 +208,15 @@ String Wardriving::auth_mode_to_string(wifi_auth_mode_t authMode) {
 }
 
 void Wardriving::scanWiFiBLE() {
-    FS *fs;
-    if (!getFsStorage(fs)) {
-        padprintln("Storage setup error");
-        displayError("Storage setup error", true);
-        returnToMenu = true;
-        return;
-    }
-
     if (filename == "") create_filename();
 
-    if (!(*fs).exists("/BruceWardriving")) (*fs).mkdir("/BruceWardriving");
-
-    bool is_new_file = false;
-    if (!(*fs).exists("/BruceWardriving/" + filename)) is_new_file = true;
-    File file = (*fs).open("/BruceWardriving/" + filename, is_new_file ? FILE_WRITE : FILE_APPEND);
-
-    if (!file) {
+    if (!csvLog.isOpen() && !open_log()) {
         padprintln("Failed to open file for writing");
         displayError("Failed to open file for writing", true);
         returnToMenu = true;
         return;
     }
 
-    if (is_new_file) {
-        file.println(
-            "WigleWifi-1.6,appRelease=v" + String(BRUCE_VERSION) + ",model=M5Stack GPS Unit,release=v" +
-            String(BRUCE_VERSION) +
-            ",device=ESP32 M5Stack,display=SPI TFT,board=ESP32 M5Stack,brand=Bruce,star=Sol,body=4,subBody=1"
-        );
-        file.println(
-            "MAC,SSID,AuthMode,FirstSeen,Channel,Frequency,RSSI,CurrentLatitude,CurrentLongitude,"
-            "AltitudeMeters,AccuracyMeters,RCOIs,MfgrId,Type"
-        );
-    }
-
     padprintf("Coord: %.6f, %.6f\n", gps.location.lat(), gps.location.lng());
     padprintln("Start Scanning...");
 
@@ -271,14 +230,9 @@ void Wardriving::scanWiFiBLE() {
     if (networksFound > 0) {
         for (int i = 0; i < networksFound; i++) {
             String macAddress = WiFi.BSSIDstr(i);
-            uint64_t macKey = 0;
-            bool macKeyOk = parseMacToU64(macAddress, macKey);
 
             // Check if MAC was already found in this session
-            enforceRegisteredMACLimit();
-            if (!macKeyOk || registeredMACs.find(macKey) == registeredMACs.end()) {
-
-                if (macKeyOk) registeredMACs.insert(macKey); // Adds MAC to cache
+            if (registerMAC(macAddress)) {
                 int32_t channel = WiFi.channel(i);
 
                 char buffer[512];
@@ -303,7 +257,7 @@ void Wardriving::scanWiFiBLE() {
                     gps.altitude.meters(),
                     gps.hdop.hdop() * 1.0
                 );
-                file.print(buffer);
+                csvLog.push(buffer);
 
                 // Check for alert
                 checkForAlert(macAddress, "WiFi", WiFi.SSID(i));
@@ -324,7 +278,6 @@ void Wardriving::scanWiFiBLE() {
         if (!bleInitialized || pBLEScan == nullptr) {
             if (!BLEDevice::init("")) {
                 Serial.println(" Failed to init BLE");
-                file.close();
                 vTaskDelay(500 / portTICK_PERIOD_MS);
                 return;
             }
@@ -381,12 +334,7 @@ void Wardriving::scanWiFiBLE() {
             } catch (...) { continue; }
 
             // Check if MAC was already found in this session
-            enforceRegisteredMACLimit();
-            uint64_t macKey = 0;
-            bool macKeyOk = parseMacToU64(address, macKey);
-            if (!macKeyOk || registeredMACs.find(macKey) == registeredMACs.end()) {
-                if (macKeyOk) registeredMACs.insert(macKey); // Adds MAC to cache
-
+            if (registerMAC(address)) {
                 char buffer[512];
                 char manufacturerIdStr[8] = "";
                 if (manufacturerId != 0) {
@@ -411,7 +359,7 @@ void Wardriving::scanWiFiBLE() {
                     gps.hdop.hdop() * 1.0,
                     manufacturerIdStr
                 );
-                file.print(buffer);
+                csvLog.push(buffer);
 
                 // Check for alert
                 checkForAlert(address, "BLE", name);
@@ -433,16 +381,31 @@ scan_summary:
         if (scanBLE) summary += " BLE: " + String(bleFound);
         padprintln(summary);
     }
-
-    file.close();
 }
 
-void Wardriving::enforceRegisteredMACLimit() {
-    if (registeredMACs.size() < MAX_REGISTERED_MACS) return;
+// The log stays open for the whole session, rows are written by its own task
+bool Wardriving::open_log() {
+    FS *fs;
+    if (!getFsStorage(fs)) return false;
+    if (!(*fs).exists("/BruceWardriving")) (*fs).mkdir("/BruceWardriving");
 
-    registeredMACs.clear();
-    macCacheClears++;
-    padprintln("MAC cache cleared to prevent heap overflow");
+    String header =
+        "WigleWifi-1.6,appRelease=v" + String(BRUCE_VERSION) + ",model=M5Stack GPS Unit,release=v" +
+        String(BRUCE_VERSION) +
+        ",device=ESP32 M5Stack,display=SPI TFT,board=ESP32 M5Stack,brand=Bruce,star=Sol,body=4,subBody=1\n"
+        "MAC,SSID,AuthMode,FirstSeen,Channel,Frequency,RSSI,CurrentLatitude,CurrentLongitude,"
+        "AltitudeMeters,AccuracyMeters,RCOIs,MfgrId,Type\n";
+    String path = "/BruceWardriving/" + filename;
+    // without memory for the encoder fall back to plain CSV
+    if (bruceConfig.wardrivingGzip && csvLog.begin(*fs, path + ".gz", header, true)) return true;
+    return csvLog.begin(*fs, path, header, false);
+}
+
+// True the first time a MAC is seen in the session. Seeing it again keeps it from being evicted.
+bool Wardriving::registerMAC(const String &macAddress) {
+    uint64_t macKey;
+    if (!MacTable::parse(macAddress.c_str(), macKey)) return true;
+    return registeredMACs.insert(macKey, (millis() - sessionStartMs) / 60000);
 }
 
 int Wardriving::scanWiFiNetworks() {
@@ -463,13 +426,13 @@ void Wardriving::loadAlertMACs() {
             while (alertFile.available()) {
                 String line = alertFile.readStringUntil('\n');
                 line.trim();
-                if (line.length() > 0 && !line.startsWith("#")) {
-                    // Convert to lowercase for consistent comparison
-                    line.toLowerCase();
-                    alertMACs.insert(line);
-                }
+                uint64_t macKey;
+                if (line.startsWith("#") || !MacTable::parse(line.c_str(), macKey)) continue;
+                alertMACs.push_back(macKey);
             }
             alertFile.close();
+            std::sort(alertMACs.begin(), alertMACs.end());
+            alertMACs.erase(std::unique(alertMACs.begin(), alertMACs.end()), alertMACs.end());
             if (alertMACs.size() > 0) { padprintln("Loaded " + String(alertMACs.size()) + " alert MACs"); }
         }
     } else {
@@ -517,10 +480,10 @@ void Wardriving::releasePins() {
 }
 
 void Wardriving::checkForAlert(const String &macAddress, const String &deviceType, const String &deviceName) {
-    String macLower = macAddress;
-    macLower.toLowerCase();
+    uint64_t macKey;
+    if (alertMACs.empty() || !MacTable::parse(macAddress.c_str(), macKey)) return;
 
-    if (alertMACs.find(macLower) != alertMACs.end()) {
+    if (std::binary_search(alertMACs.begin(), alertMACs.end(), macKey)) {
         String alertMsg = "ALERT: " + deviceType + " found!";
         if (deviceName.length() > 0) { alertMsg += " Name: " + deviceName; }
         alertMsg += " MAC: " + macAddress;
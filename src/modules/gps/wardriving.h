@@ -9,12 +9,14 @@
 #ifndef __WAR_DRIVING_H__
 #define __WAR_DRIVING_H__
 
+#include "mac_table.h"
+#include "wardriving_log.h"
 #include "modules/ble/ble_common.h"
 #include <TinyGPS++.h>
 #include <cstdint>
 #include <esp_wifi_types.h>
 #include <globals.h>
-#include <set>
+#include <vector>
 
 class Wardriving {
 public:
@@ -40,16 +42,18 @@ private:
     String filename = "";
     TinyGPSPlus gps;
     HardwareSerial GPSserial = HardwareSerial(2); // Uses UART2 for GPS
-    std::set<uint64_t> registeredMACs;            // Store and track registered MAC (packed 48-bit)
-    std::set<String> alertMACs;                   // Store alert MAC addresses from file
+    WardrivingLog csvLog;                         // Session CSV file, written by a background task
+    MacTable registeredMACs;                      // MACs already logged this session (packed 48-bit)
+    std::vector<uint64_t> alertMACs;              // Sorted alert MAC addresses from file (packed 48-bit)
     bool scanWiFi = false;                        // Flag to scan WiFi networks
     bool scanBLE = false;                         // Flag to scan Bluetooth devices
     bool bleInitialized = false;                  // BLE init guard for wardriving
     int wifiNetworkCount = 0;                     // Counter fo wifi networks
     int bluetoothDeviceCount = 0;                 // Counter for bluetooth devices
     int foundMACAddressCount = 0;                 // Counter for found MAC addresses
-    uint32_t macCacheClears = 0;                  // Number of times MAC cache was cleared
-    static constexpr size_t MAX_REGISTERED_MACS = 250;
+    // 256KB of PSRAM, ~24k MACs before the ones out of range the longest are forgotten
+    static constexpr size_t REGISTERED_MAC_SLOTS = 32768;
+    static constexpr size_t REGISTERED_MAC_SLOTS_NO_PSRAM = 2048;
 
     bool rxPinReleased = false;
 
@@ -73,8 +77,9 @@ private:
     /////////////////////////////////////////////////////////////////////////////////////
     void set_position(void);
     void scanWiFiBLE(void);
+    bool open_log(void);
     int scanWiFiNetworks(void);
-    void enforceRegisteredMACLimit(void);
+    bool registerMAC(const String &macAddress);
     void loadAlertMACs(void);
     void checkForAlert(const String &macAddress, const String &deviceType, const String &deviceName = "");
     String auth_mode_to_string(wifi_auth_mode_t authMode);
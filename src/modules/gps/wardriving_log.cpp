@@ -0,0 +1,125 @@
+#include "wardriving_log.h"
+#include <esp_heap_caps.h>
+
+bool WardrivingLog::begin(FS &fs, const String &path, const String &header, bool gzip) {
+    end();
+    _file = fs.open(path, FILE_APPEND); // creates it when missing
+    if (!_file) return false;
+    bool isNew = _file.size() == 0;
+
+    _batch = (uint8_t *)heap_caps_malloc(WARDRIVING_LOG_BATCH, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    if (!_batch) _batch = (uint8_t *)heap_caps_malloc(WARDRIVING_LOG_BATCH, MALLOC_CAP_8BIT);
+    if (!_batch || !_ring.begin(WARDRIVING_LOG_RING) || (gzip && !_gz.begin(_file))) {
+        end();
+        if (isNew) fs.remove(path);
+        return false;
+    }
+    _gzip = gzip;
+    _path = path;
+    _fill = 0;
+    _rows = _dropped = _fileWrites = 0;
+    if (isNew) put((const uint8_t *)header.c_str(), header.length());
+
+    _stop = false;
+    _running = true;
+    if (xTaskCreate(writerTask, "wardrive_log", 4096, this, 1, &_task) != pdPASS) {
+        // no task, push() writes in place
+        _task = nullptr;
+        _running = false;
+    }
+    return true;
+}
+
+void WardrivingLog::end() {
+    if (_task) {
+        _stop = true;
+        xTaskNotifyGive(_task);
+        while (_running) vTaskDelay(10 / portTICK_PERIOD_MS);
+        _task = nullptr;
+    }
+    if (_file) {
+        writeOut();
+        if (_gzip) _gz.finish();
+        _file.close();
+    }
+    _gz.end();
+    _ring.end();
+    if (_batch) heap_caps_free(_batch);
+    _batch = nullptr;
+    _fill = 0;
+    _gzip = false;
+}
+
+bool WardrivingLog::push(const char *row) {
+    size_t len = strlen(row);
+    if (!_file || !len) return false;
+    if (!_task) {
+        put((const uint8_t *)row, len);
+        if (_fill && millis() - _firstPending >= WARDRIVING_LOG_FLUSH_MS) writeOut();
+        _rows++;
+        return true;
+    }
+    for (int tries = 0;; tries++) {
+        uint8_t *p = _ring.reserve(len);
+        if (p) {
+            memcpy(p, row, len);
+            _ring.commit();
+            xTaskNotifyGive(_task);
+            _rows++;
+            return true;
+        }
+        // ring full: the card is slow, give the writer up to ~100ms before dropping the row
+        if (tries >= 20) {
+            _dropped++;
+            return false;
+        }
+        xTaskNotifyGive(_task);
+        vTaskDelay(5 / portTICK_PERIOD_MS);
+    }
+}
+
+void WardrivingLog::writerTask(void *arg) {
+    WardrivingLog *log = (WardrivingLog *)arg;
+    while (!log->_stop) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+        log->collect();
+        if (log->_fill && millis() - log->_firstPending >= WARDRIVING_LOG_FLUSH_MS) log->writeOut();
+    }
+    log->collect(); // end() writes the last batch once the task is gone
+    log->_running = false;
+    vTaskDelete(nullptr);
+}
+
+void WardrivingLog::collect() {
+    size_t len;
+    const uint8_t *row;
+    while ((row = _ring.peek(len))) {
+        put(row, len);
+        _ring.release();
+    }
+}
+
+void WardrivingLog::put(const uint8_t *data, size_t len) {
+    if (!_fill) _firstPending = millis();
+    while (len) {
+        size_t n = min(len, (size_t)WARDRIVING_LOG_BATCH - _fill);
+        memcpy(_batch + _fill, data, n);
+        _fill += n;
+        data += n;
+        len -= n;
+        if (_fill == WARDRIVING_LOG_BATCH) writeOut();
+    }
+}
+
+void WardrivingLog::writeOut() {
+    if (!_fill) return;
+    if (_gzip) {
+        _gz.write(_batch, _fill);
+        _gz.flush(); // what is on the card stays readable if power is lost
+    } else {
+        _file.write(_batch, _fill);
+    }
+    _file.flush();
+    _fileWrites++;
+    _fill = 0;
+}
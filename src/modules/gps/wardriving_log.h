@@ -0,0 +1,61 @@
+#ifndef __WARDRIVING_LOG_H__
+#define __WARDRIVING_LOG_H__
+#include "core/gzip_writer.h"
+#include "modules/wifi/packet_ring.h"
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Session scoped wardriving CSV writer.
+// The scan loop queues rows in a ring and a low priority task appends them to a file that stays
+// open for the whole session. Rows are batched in RAM and reach the card when the batch is full
+// or WARDRIVING_LOG_FLUSH_MS after the oldest one, optionally through a streaming gzip encoder.
+#define WARDRIVING_LOG_RING 8192
+#define WARDRIVING_LOG_BATCH 4096
+#define WARDRIVING_LOG_FLUSH_MS 10000
+
+class WardrivingLog {
+public:
+    WardrivingLog() = default;
+    ~WardrivingLog() { end(); }
+    WardrivingLog(const WardrivingLog &) = delete;
+    WardrivingLog &operator=(const WardrivingLog &) = delete;
+
+    // Opens `path` for appending, `header` (full lines) is written when the file is new.
+    // With gzip the file gets one more gzip member; false if no memory or file was available.
+    bool begin(FS &fs, const String &path, const String &header, bool gzip);
+    // Writes what is queued, ends the gzip stream and closes the file
+    void end();
+    bool isOpen() const { return _file; }
+    const String &path() const { return _path; }
+
+    // Queues one CSV line. Waits a little for the writer when the ring is full, false if dropped.
+    bool push(const char *row);
+
+    uint32_t rows() const { return _rows; }
+    uint32_t dropped() const { return _dropped; }
+    uint32_t fileWrites() const { return _fileWrites; }
+
+private:
+    File _file;
+    String _path;
+    PacketRing _ring;
+    GzipWriter _gz;
+    bool _gzip = false;
+    uint8_t *_batch = nullptr;
+    size_t _fill = 0;
+    uint32_t _firstPending = 0;
+    uint32_t _rows = 0;
+    uint32_t _dropped = 0;
+    uint32_t _fileWrites = 0;
+    TaskHandle_t _task = nullptr;
+    volatile bool _stop = false;
+    volatile bool _running = false;
+
+    static void writerTask(void *arg);
+    void collect();
+    void writeOut();
+    void put(const uint8_t *data, size_t len);
+};
+
+#endif
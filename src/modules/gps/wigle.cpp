@@ -82,9 +82,17 @@ void Wigle::dump_wigle_info() {
     padprintln("");
 }
 
+// Multipart part header, the trailer is _upload_file's closing boundary
+static String upload_part_header(const String &filename, const String &boundary) {
+    bool gz = filename.endsWith(".gz") || filename.endsWith(".GZ");
+    return "--" + boundary + "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"" + filename +
+           "\"\r\nContent-Type: " + (gz ? "application/gzip" : "text/csv") + "\r\n\r\n";
+}
+
+static String upload_part_trailer(const String &boundary) { return "\r\n--" + boundary + "--\r\n\r\n"; }
+
 void Wigle::send_upload_headers(WiFiClientSecure &client, String filename, int filesize, String boundary) {
-    // Content-Disposition header size.
-    int cd_header_len = 147 - 45 - 8 + filename.length() + 2 * (boundary.length() + 2);
+    String part = upload_part_header(filename, boundary);
 
     client.println("POST /api/v2/file/upload HTTP/1.0");
     client.print("Host: ");
@@ -96,16 +104,17 @@ void Wigle::send_upload_headers(WiFiClientSecure &client, String filename, int f
     client.print("Content-Type: multipart/form-data; boundary=");
     client.println(boundary);
     client.print("Content-Length: ");
-    client.println(filesize + cd_header_len);
+    client.println(part.length() + filesize + upload_part_trailer(boundary).length());
     client.println();
 
     // Start content-disposition file header:
-    client.println("--" + boundary);
-    client.print("Content-Disposition: form-data; name=\"file\"; filename=\"");
-    client.print(filename);
-    client.println("\"");
-    client.println("Content-Type: text/csv");
-    client.println();
+    client.print(part);
+}
+
+// Wardriving logs, plain or gzipped (Wigle takes .csv.gz as is)
+static bool is_wigle_file(String name) {
+    name.toLowerCase();
+    return name.endsWith(".csv") || name.endsWith(".csv.gz");
 }
 
 bool Wigle::upload(FS *fs, String filepath, bool auto_delete) {
@@ -160,10 +169,7 @@ bool Wigle::upload_all(FS *fs, String folder, bool auto_delete) {
 
         if (!isDir) {
 
-            int dotIndex = nameOnly.lastIndexOf(".");
-            String ext = dotIndex >= 0 ? nameOnly.substring(dotIndex + 1) : "";
-            ext.toUpperCase();
-            if (ext.equals("CSV")) {
+            if (is_wigle_file(nameOnly)) {
                 File file = fs->open(fullPath);
 
                 if (file) {
@@ -215,11 +221,7 @@ bool Wigle::_upload_file(File file, String upload_message) {
         progressHandler(percent, 100, upload_message);
     }
 
-    client.println();
-    client.print("--");
-    client.print(boundary);
-    client.println("--");
-    client.println();
+    client.print(upload_part_trailer(boundary));
     client.flush();
 
     Serial.println("File transfer complete");
@@ -5,6 +5,7 @@
 #include "core/sd_functions.h"
 #include "core/settings.h"
 #include "core/type_convertion.h"
+#include "ir_database.h"
 #include "ir_utils.h"
 #include <IRutils.h>
 
@@ -70,145 +71,87 @@ void selectRecentIrMenu() {
     return;
 }
 
-bool txIrFile(FS *fs, String filepath, bool hideDefaultUI) {
-    // SPAM all codes of the file
+static IRCode *irCodeFromEntry(const IrDbEntry &entry, const String &filepath) {
+    IRCode *code = new IRCode(entry.protocol, entry.address, entry.command, entry.data, entry.bits);
+    code->name = entry.name;
+    code->type = entry.raw ? "raw" : "parsed";
+    code->frequency = entry.frequency;
+    if (entry.raw) code->data = entry.timingsToString();
+    code->filepath = entry.name + " " + filepath.substring(1 + filepath.lastIndexOf("/"));
+    return code;
+}
 
-    int total_codes = 0;
-    String line;
+static void sendIrDbEntry(const IrDbEntry &entry, bool hideDefaultUI) {
+    if (entry.raw) {
+        sendRawTimings(entry.frequency, entry.timings.data(), entry.timings.size(), hideDefaultUI);
+        return;
+    }
+    IRCode code(entry.protocol, entry.address, entry.command, entry.data, entry.bits);
+    sendIRCommand(&code, hideDefaultUI);
+}
+
+// Pauses on Select, returns true when the user cancels with Esc while paused
+static bool irSpamCancelled(bool hideDefaultUI) {
+    // if user is pushing (holding down) TRIGGER button, stop transmission early
+    if (!check(SelPress)) return false;
+    bool endingEarly = false;
+    while (check(SelPress)) yield();
+    if (!hideDefaultUI) { displayTextLine("Paused"); }
 
-    File databaseFile = fs->open(filepath, FILE_READ);
+    while (!check(SelPress)) { // If Presses Select again, continues
+        if (check(EscPress)) {
+            endingEarly = true;
+            break;
+        }
+    }
+    while (check(SelPress)) { yield(); }
+    if (!endingEarly && !hideDefaultUI) { displayTextLine("Running, Wait"); }
+    return endingEarly;
+}
+
+bool txIrFile(FS *fs, String filepath, bool hideDefaultUI) {
+    // SPAM all codes of the file, from the compiled cache when it could be built
+    IrDatabase db;
+    File databaseFile;
+    bool compiled = db.open(*fs, filepath);
+    if (!compiled) databaseFile = fs->open(filepath, FILE_READ);
 
     setup_ir_pin(bruceConfigPins.irTx, OUTPUT);
     // digitalWrite(bruceConfigPins.irTx, LED_ON);
 
-    if (!databaseFile) {
+    if (!compiled && !databaseFile) {
         Serial.println("Failed to open database file.");
         displayError("Fail to open file");
         delay(2000);
         return false;
     }
-    Serial.println("Opened database file.");
+    Serial.println(compiled ? "Opened compiled IR database." : "Opened database file.");
 
-    bool endingEarly = false;
+    int total_codes = 0;
     int codes_sent = 0;
-    uint16_t frequency = 0;
-    String rawData = "";
-    String protocol = "";
-    String address = "";
-    String command = "";
-    String value = "";
-    uint8_t bits = 32;
-
-    databaseFile.seek(0); // comes back to first position
-
-    // count the number of codes to replay
-    while (databaseFile.available()) {
-        line = databaseFile.readStringUntil('\n');
-        if (line.startsWith("type:")) total_codes++;
-    }
-
-    Serial.printf("\nStarted SPAM all codes with: %d codes", total_codes);
-    // comes back to first position, beggining of the file
-    databaseFile.seek(0);
-    while (databaseFile.available()) {
+    auto sendNext = [&](IrDbEntry &entry) {
         if (!hideDefaultUI) { progressHandler(codes_sent, total_codes); }
-        line = databaseFile.readStringUntil('\n');
-        if (line.endsWith("\r")) line.remove(line.length() - 1);
-
-        if (line.startsWith("type:")) {
-            codes_sent++;
-            String type = line.substring(5);
-            type.trim();
-            Serial.println("Type: " + type);
-            if (type == "raw") {
-                Serial.println("RAW code");
-                while (databaseFile.available()) {
-                    line = databaseFile.readStringUntil('\n');
-                    if (line.endsWith("\r")) line.remove(line.length() - 1);
-
-                    if (line.startsWith("frequency:")) {
-                        line = line.substring(10);
-                        line.trim();
-                        frequency = line.toInt();
-                        Serial.printf("Frequency: %d\n", frequency);
-                    } else if (line.startsWith("data:")) {
-                        rawData = line.substring(5);
-                        rawData.trim();
-                        Serial.println("RawData: " + rawData);
-                    } else if ((frequency != 0 && rawData != "") || line.startsWith("#")) {
-                        IRCode code;
-                        code.type = "raw";
-                        code.data = rawData;
-                        code.frequency = frequency;
-                        sendIRCommand(&code, hideDefaultUI);
-
-                        rawData = "";
-                        frequency = 0;
-                        type = "";
-                        line = "";
-                        break;
-                    }
-                }
-            } else if (type == "parsed") {
-                Serial.println("PARSED");
-                while (databaseFile.available()) {
-                    line = databaseFile.readStringUntil('\n');
-                    if (line.endsWith("\r")) line.remove(line.length() - 1);
-
-                    if (line.startsWith("protocol:")) {
-                        protocol = line.substring(9);
-                        protocol.trim();
-                        Serial.println("Protocol: " + protocol);
-                    } else if (line.startsWith("address:")) {
-                        address = line.substring(8);
-                        address.trim();
-                        Serial.println("Address: " + address);
-                    } else if (line.startsWith("command:")) {
-                        command = line.substring(8);
-                        command.trim();
-                        Serial.println("Command: " + command);
-                    } else if (line.startsWith("value:") || line.startsWith("state:")) {
-                        value = line.substring(6);
-                        value.trim();
-                        Serial.println("Value: " + value);
-                    } else if (line.startsWith("bits:")) {
-                        bits = line.substring(strlen("bits:")).toInt();
-                        Serial.println("bits: " + bits);
-                    } else if (line.indexOf("#") != -1) { // TODO: also detect EOF
-                        IRCode code(protocol, address, command, value, bits);
-                        sendIRCommand(&code, hideDefaultUI);
-
-                        protocol = "";
-                        address = "";
-                        command = "";
-                        value = "";
-                        bits = 32;
-                        type = "";
-                        line = "";
-                        break;
-                    }
-                }
-            }
-        }
-        // if user is pushing (holding down) TRIGGER button, stop transmission early
-        if (check(SelPress)) // Pause TV-B-Gone
-        {
-            while (check(SelPress)) yield();
-            if (!hideDefaultUI) { displayTextLine("Paused"); }
-
-            while (!check(SelPress)) { // If Presses Select again, continues
-                if (check(EscPress)) {
-                    endingEarly = true;
-                    break;
-                }
-            }
-            while (check(SelPress)) { yield(); }
-            if (endingEarly) break; // Cancels  custom IR Spam
-            if (!hideDefaultUI) { displayTextLine("Running, Wait"); }
+        codes_sent++;
+        sendIrDbEntry(entry, hideDefaultUI);
+        return !irSpamCancelled(hideDefaultUI);
+    };
+
+    if (compiled) {
+        total_codes = db.count();
+        Serial.printf("\nStarted SPAM all codes with: %d codes", total_codes);
+        IrDbEntry entry;
+        for (uint32_t i = 0; i < db.count(); i++) {
+            if (db.read(i, entry) && !sendNext(entry)) break;
         }
-    } // end while file has lines to process
-    databaseFile.close();
-    Serial.println("closed");
+        db.close();
+    } else {
+        // No room for the cache, stream the text file instead
+        IrDatabase::parse(databaseFile, [&](IrDbEntry &) { return ++total_codes > 0; });
+        Serial.printf("\nStarted SPAM all codes with: %d codes", total_codes);
+        databaseFile.seek(0);
+        IrDatabase::parse(databaseFile, sendNext);
+        databaseFile.close();
+    }
     Serial.println("EXTRA finished");
 
     resetCodesArray();
@@ -600,6 +543,25 @@ bool sendDecodedCommand(String protocol, String value, uint8_t bits, bool hideDe
 }
 
 void sendRawCommand(uint16_t frequency, String rawData, bool hideDefaultUI) {
+    // Parse raw data string in a single pass
+    std::vector<uint16_t> timings;
+    timings.reserve(rawData.length() / 4 + 1);
+    const char *p = rawData.c_str();
+    char *end;
+    while (*p) {
+        unsigned long value = strtoul(p, &end, 10);
+        if (end == p) {
+            p++;
+            continue;
+        }
+        timings.push_back(value > 0xFFFF ? 0xFFFF : value);
+        p = end;
+    }
+    Serial.println("Parsing raw data complete.");
+    sendRawTimings(frequency, timings.data(), timings.size(), hideDefaultUI);
+}
+
+void sendRawTimings(uint16_t frequency, const uint16_t *timings, uint16_t count, bool hideDefaultUI) {
 #ifdef USE_BOOST /// ENABLE 5V OUTPUT
     PPM.enableOTG();
 #endif
@@ -608,38 +570,13 @@ void sendRawCommand(uint16_t frequency, String rawData, bool hideDefaultUI) {
     irsend.begin();
     if (!hideDefaultUI) { displayTextLine("Sending.."); }
 
-    uint16_t dataBufferSize = 1;
-    for (int i = 0; i < rawData.length(); i++) {
-        if (rawData[i] == ' ') dataBufferSize += 1;
-    }
-    uint16_t *dataBuffer = (uint16_t *)malloc((dataBufferSize) * sizeof(uint16_t));
-
-    uint16_t count = 0;
-    // Parse raw data string
-    while (rawData.length() > 0 && count < dataBufferSize) {
-        int delimiterIndex = rawData.indexOf(' ');
-        if (delimiterIndex == -1) { delimiterIndex = rawData.length(); }
-        String dataChunk = rawData.substring(0, delimiterIndex);
-        rawData.remove(0, delimiterIndex + 1);
-        dataBuffer[count++] = (dataChunk.toInt());
-    }
-
-    Serial.println("Parsing raw data complete.");
-    // Serial.println(count);
-    // Serial.println(dataBuffer[count-1]);
-    // Serial.println(dataBuffer[0]);
-
     // Send raw command
-    irsend.sendRaw(dataBuffer, count, frequency);
+    irsend.sendRaw(timings, count, frequency);
 
     if (bruceConfigPins.irTxRepeats > 0) {
-        for (uint8_t i = 1; i <= bruceConfigPins.irTxRepeats; i++) {
-            irsend.sendRaw(dataBuffer, count, frequency);
-        }
+        for (uint8_t i = 1; i <= bruceConfigPins.irTxRepeats; i++) { irsend.sendRaw(timings, count, frequency); }
     }
 
-    free(dataBuffer);
-
     Serial.println(
         "Sent Raw Command" + (bruceConfigPins.irTxRepeats > 0
                                   ? " (1 initial + " + String(bruceConfigPins.irTxRepeats) + " repeats)"
@@ -651,15 +588,17 @@ void sendRawCommand(uint16_t frequency, String rawData, bool hideDefaultUI) {
 bool chooseCmdIrFile(FS *fs, String filepath) {
     checkIrTxPin();
     resetCodesArray();
-    int total_codes = 0;
+    const uint32_t maxCodes = 100;
+    IrDatabase db;
     File databaseFile;
 
     returnToMenu = true;
 
-    databaseFile = fs->open(filepath, FILE_READ);
+    bool compiled = db.open(*fs, filepath);
+    if (!compiled) databaseFile = fs->open(filepath, FILE_READ);
     drawMainBorder();
 
-    if (!databaseFile) {
+    if (!compiled && !databaseFile) {
         Serial.println("Failed to open IR file.");
         return false;
     }
@@ -667,58 +606,47 @@ bool chooseCmdIrFile(FS *fs, String filepath) {
 
     setup_ir_pin(bruceConfigPins.irTx, OUTPUT);
 
-    // Mode to choose and send command by command (limitted to 100 commands)
-    String line;
-    String txt;
-    codes.push_back(new IRCode());
-
-    while (databaseFile.available() && total_codes < 100) {
-        line = databaseFile.readStringUntil('\n');
-        txt = line.substring(line.indexOf(":") + 1);
-        txt.trim();
-
-        if (line.startsWith("name:")) {
-            if (codes[total_codes]->name != "") {
-                total_codes++;
-                codes.push_back(new IRCode());
-            }
-            // save signal name
-            codes[total_codes]->name = txt;
-            codes[total_codes]->filepath = txt + " " + filepath.substring(1 + filepath.lastIndexOf("/"));
-        }
-
-        if (line.startsWith("type:")) codes[total_codes]->type = txt;
-        if (line.startsWith("protocol:")) codes[total_codes]->protocol = txt;
-        if (line.startsWith("address:")) codes[total_codes]->address = txt;
-        if (line.startsWith("frequency:")) codes[total_codes]->frequency = txt.toInt();
-        if (line.startsWith("bits:")) codes[total_codes]->bits = txt.toInt();
-        if (line.startsWith("command:")) codes[total_codes]->command = txt;
-        if (line.startsWith("data:") || line.startsWith("value:") || line.startsWith("state:")) {
-            codes[total_codes]->data = txt;
-        }
-
-        if (line.startsWith("#") && total_codes < codes.size() && codes[total_codes]->name != "") {
-            total_codes++;
-            codes.push_back(new IRCode());
-        }
-    }
-
     options = {};
     bool exit = false;
     bool goToMainMenu = false;
     bool actionTaken = false;
 
-    for (auto code : codes) {
-        if (code->name != "") {
-            options.push_back({code->name.c_str(), [code, &actionTaken]() {
-                               actionTaken = true;
-                               sendIRCommand(code);
-                               addToRecentCodes(code);
-                           }});
+    // Mode to choose and send command by command (limitted to 100 commands)
+    std::vector<String> names;
+    IrDbEntry entry;
+    if (compiled) {
+        // Only the names are loaded, the selected signal is read from the cache when sent
+        uint32_t total_codes = std::min(db.count(), maxCodes);
+        names.reserve(total_codes);
+        for (uint32_t i = 0; i < total_codes; i++) {
+            names.push_back(db.read(i, entry, false) ? entry.name : String(""));
+            if (names.back() == "") continue;
+            options.push_back({names.back().c_str(), [i, &db, &entry, &filepath, &actionTaken]() {
+                                   actionTaken = true;
+                                   if (!db.read(i, entry)) return;
+                                   sendIrDbEntry(entry, false);
+                                   IRCode *code = irCodeFromEntry(entry, filepath);
+                                   addToRecentCodes(code);
+                                   delete code;
+                               }});
+        }
+    } else {
+        IrDatabase::parse(databaseFile, [&](IrDbEntry &e) {
+            codes.push_back(irCodeFromEntry(e, filepath));
+            return codes.size() < maxCodes;
+        });
+        databaseFile.close();
+        for (auto code : codes) {
+            if (code->name != "") {
+                options.push_back({code->name.c_str(), [code, &actionTaken]() {
+                                       actionTaken = true;
+                                       sendIRCommand(code);
+                                       addToRecentCodes(code);
+                                   }});
+            }
         }
     }
     options.push_back({"Main Menu", [&]() { actionTaken = true; exit = true; goToMainMenu = true; }});
-    databaseFile.close();
 
 #ifdef USE_BOOST /// DISABLE 5V OUTPUT
     PPM.disableOTG();
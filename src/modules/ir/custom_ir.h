@@ -40,6 +40,7 @@ struct IRCode {
 // Custom IR
 void sendIRCommand(IRCode *code, bool hideDefaultUI = false);
 void sendRawCommand(uint16_t frequency, String rawData, bool hideDefaultUI = false);
+void sendRawTimings(uint16_t frequency, const uint16_t *timings, uint16_t count, bool hideDefaultUI = false);
 void sendNECCommand(String address, String command, bool hideDefaultUI = false);
 void sendNECextCommand(String address, String command, bool hideDefaultUI = false);
 void sendRC5Command(String address, String command, bool hideDefaultUI = false);
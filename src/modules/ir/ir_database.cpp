@@ -0,0 +1,333 @@
+#include "ir_database.h"
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+namespace {
+const char IRDB_CACHE_DIR[] = "/BruceIR/.cache";
+const char IRDB_MAGIC[4] = {'B', 'I', 'R', 'C'};
+const uint16_t IRDB_VERSION = 1;
+const size_t IRDB_MAX_VALUE = 255;
+
+struct __attribute__((packed)) IrDbFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t sourceSize;
+    uint32_t sourceMtime;
+    uint32_t count;
+    uint32_t indexOffset; // uint32 record offsets, `count` of them
+};
+
+// Followed by name, protocol, address, command and data (not terminated), then the timings
+struct __attribute__((packed)) IrDbRecordHeader {
+    uint8_t raw;
+    uint8_t bits;
+    uint16_t frequency;
+    uint16_t timingCount;
+    uint8_t nameLen;
+    uint8_t protocolLen;
+    uint8_t addressLen;
+    uint8_t commandLen;
+    uint8_t dataLen;
+    uint8_t reserved;
+};
+
+enum class IrKey : uint8_t { Other, Name, Type, Frequency, Bits, Protocol, Address, Command, Data };
+
+IrKey keyFromString(const char *key) {
+    if (strcmp(key, "name") == 0) return IrKey::Name;
+    if (strcmp(key, "type") == 0) return IrKey::Type;
+    if (strcmp(key, "frequency") == 0) return IrKey::Frequency;
+    if (strcmp(key, "bits") == 0) return IrKey::Bits;
+    if (strcmp(key, "protocol") == 0) return IrKey::Protocol;
+    if (strcmp(key, "address") == 0) return IrKey::Address;
+    if (strcmp(key, "command") == 0) return IrKey::Command;
+    if (strcmp(key, "data") == 0 || strcmp(key, "value") == 0 || strcmp(key, "state") == 0) return IrKey::Data;
+    return IrKey::Other;
+}
+
+uint8_t clampLen(const String &s) { return s.length() > IRDB_MAX_VALUE ? IRDB_MAX_VALUE : s.length(); }
+
+uint32_t fnv1a(const String &s) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < s.length(); i++) {
+        hash ^= (uint8_t)s[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+} // namespace
+
+void IrDbEntry::clear() {
+    raw = false;
+    bits = 32;
+    frequency = 0;
+    name = "";
+    protocol = "";
+    address = "";
+    command = "";
+    data = "";
+    timings.clear(); // keeps the capacity for the next signal
+}
+
+String IrDbEntry::timingsToString() const {
+    String out;
+    out.reserve(timings.size() * 5);
+    for (size_t i = 0; i < timings.size(); i++) {
+        if (i) out += ' ';
+        out += String(timings[i]);
+    }
+    return out;
+}
+
+String IrDatabase::cachePath(const String &path) {
+    char name[16];
+    snprintf(name, sizeof(name), "/%08lx.bir", (unsigned long)fnv1a(path));
+    return String(IRDB_CACHE_DIR) + name;
+}
+
+bool IrDatabase::parse(File &src, const std::function<bool(IrDbEntry &)> &onEntry) {
+    if (!src) return false;
+    enum { LineStart, InKey, InValue, InTimings, Skip } state = LineStart;
+    IrDbEntry entry;
+    bool hasType = false;
+    IrKey key = IrKey::Other;
+    char keyBuf[16];
+    size_t keyLen = 0;
+    char value[IRDB_MAX_VALUE + 1];
+    size_t valueLen = 0;
+    uint32_t num = 0;
+    bool inNum = false;
+
+    // Hands over the current signal, a new one starts on every "name:" or "#" line
+    auto emit = [&]() -> bool {
+        bool cont = !hasType || onEntry(entry);
+        entry.clear();
+        hasType = false;
+        return cont;
+    };
+    auto pushTiming = [&]() {
+        if (inNum && entry.timings.size() < 0xFFFF) entry.timings.push_back(num > 0xFFFF ? 0xFFFF : num);
+        num = 0;
+        inNum = false;
+    };
+    auto endLine = [&]() -> bool {
+        bool cont = true;
+        if (state == InTimings) pushTiming();
+        if (state == InValue) {
+            while (valueLen > 0 && isspace((unsigned char)value[valueLen - 1])) valueLen--;
+            value[valueLen] = '\0';
+            switch (key) {
+                case IrKey::Name:
+                    if (hasType || entry.name != "") cont = emit();
+                    entry.name = value;
+                    break;
+                case IrKey::Type:
+                    entry.raw = strcasecmp(value, "raw") == 0;
+                    hasType = true;
+                    break;
+                case IrKey::Frequency: entry.frequency = strtoul(value, nullptr, 10); break;
+                case IrKey::Bits: entry.bits = strtoul(value, nullptr, 10); break;
+                case IrKey::Protocol: entry.protocol = value; break;
+                case IrKey::Address: entry.address = value; break;
+                case IrKey::Command: entry.command = value; break;
+                case IrKey::Data: entry.data = value; break;
+                default: break;
+            }
+        }
+        state = LineStart;
+        keyLen = 0;
+        valueLen = 0;
+        return cont;
+    };
+
+    uint8_t buf[512];
+    int n;
+    while ((n = src.read(buf, sizeof(buf))) > 0) {
+        for (int i = 0; i < n; i++) {
+            char c = (char)buf[i];
+            if (c == '\n') {
+                if (state != Skip && state != LineStart && !endLine()) return true;
+                state = LineStart;
+                continue;
+            }
+            switch (state) {
+                case LineStart:
+                    if (c == '#') {
+                        if (!emit()) return true;
+                        state = Skip;
+                    } else if (!isspace((unsigned char)c)) {
+                        keyBuf[0] = c;
+                        keyLen = 1;
+                        state = InKey;
+                    }
+                    break;
+                case InKey:
+                    if (c == ':') {
+                        keyBuf[keyLen] = '\0';
+                        key = keyFromString(keyBuf);
+                        state = (key == IrKey::Data && entry.raw) ? InTimings : InValue;
+                    } else if (keyLen < sizeof(keyBuf) - 1) {
+                        keyBuf[keyLen++] = c;
+                    }
+                    break;
+                case InValue:
+                    if (valueLen == 0 && isspace((unsigned char)c)) break;
+                    if (valueLen < IRDB_MAX_VALUE) value[valueLen++] = c;
+                    break;
+                case InTimings:
+                    if (c >= '0' && c <= '9') {
+                        num = num * 10 + (c - '0');
+                        inNum = true;
+                    } else {
+                        pushTiming();
+                    }
+                    break;
+                case Skip: break;
+            }
+        }
+    }
+    if (state != Skip && state != LineStart && !endLine()) return true;
+    emit();
+    return true;
+}
+
+bool IrDatabase::compile(File &src, File &dst) {
+    if (!src || !dst) return false;
+    IrDbFileHeader header;
+    memcpy(header.magic, IRDB_MAGIC, sizeof(IRDB_MAGIC));
+    header.version = IRDB_VERSION;
+    header.reserved = 0;
+    header.sourceSize = src.size();
+    header.sourceMtime = src.getLastWrite();
+    header.count = 0;
+    header.indexOffset = 0;
+    if (dst.write((const uint8_t *)&header, sizeof(header)) != sizeof(header)) return false;
+
+    std::vector<uint32_t> offsets;
+    uint32_t pos = sizeof(header);
+    bool ok = true;
+    src.seek(0);
+    parse(src, [&](IrDbEntry &e) {
+        IrDbRecordHeader rec;
+        rec.raw = e.raw;
+        rec.bits = e.bits;
+        rec.frequency = e.frequency;
+        rec.timingCount = e.raw ? e.timings.size() : 0;
+        rec.nameLen = clampLen(e.name);
+        rec.protocolLen = clampLen(e.protocol);
+        rec.addressLen = clampLen(e.address);
+        rec.commandLen = clampLen(e.command);
+        rec.dataLen = clampLen(e.data);
+        rec.reserved = 0;
+        size_t len = sizeof(rec) + rec.nameLen + rec.protocolLen + rec.addressLen + rec.commandLen +
+                     rec.dataLen + rec.timingCount * sizeof(uint16_t);
+        size_t written = dst.write((const uint8_t *)&rec, sizeof(rec));
+        written += dst.write((const uint8_t *)e.name.c_str(), rec.nameLen);
+        written += dst.write((const uint8_t *)e.protocol.c_str(), rec.protocolLen);
+        written += dst.write((const uint8_t *)e.address.c_str(), rec.addressLen);
+        written += dst.write((const uint8_t *)e.command.c_str(), rec.commandLen);
+        written += dst.write((const uint8_t *)e.data.c_str(), rec.dataLen);
+        if (rec.timingCount) {
+            written += dst.write((const uint8_t *)e.timings.data(), rec.timingCount * sizeof(uint16_t));
+        }
+        if (written != len) {
+            ok = false;
+            return false;
+        }
+        offsets.push_back(pos);
+        pos += len;
+        return true;
+    });
+    if (!ok) return false;
+
+    size_t indexLen = offsets.size() * sizeof(uint32_t);
+    if (indexLen && dst.write((const uint8_t *)offsets.data(), indexLen) != indexLen) return false;
+    header.count = offsets.size();
+    header.indexOffset = pos;
+    if (!dst.seek(0)) return false;
+    return dst.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+}
+
+bool IrDatabase::load(FS &fs, const String &cache, uint32_t sourceSize, uint32_t sourceMtime) {
+    _file = fs.open(cache, FILE_READ);
+    if (!_file) return false;
+    IrDbFileHeader header;
+    bool valid = _file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                 memcmp(header.magic, IRDB_MAGIC, sizeof(IRDB_MAGIC)) == 0 &&
+                 header.version == IRDB_VERSION && header.sourceSize == sourceSize &&
+                 header.sourceMtime == sourceMtime && header.count < 0x10000 &&
+                 header.indexOffset + header.count * sizeof(uint32_t) <= _file.size();
+    if (valid) {
+        _index.resize(header.count);
+        size_t len = header.count * sizeof(uint32_t);
+        valid = _file.seek(header.indexOffset) && (size_t)_file.read((uint8_t *)_index.data(), len) == len;
+    }
+    if (!valid) close();
+    return valid;
+}
+
+bool IrDatabase::open(FS &fs, const String &path) {
+    close();
+    File src = fs.open(path, FILE_READ);
+    if (!src) return false;
+    uint32_t size = src.size();
+    uint32_t mtime = src.getLastWrite();
+    String cache = cachePath(path);
+    if (load(fs, cache, size, mtime)) {
+        src.close();
+        return true;
+    }
+
+    // Missing or stale, compile it next to the others
+    if (!fs.exists("/BruceIR")) fs.mkdir("/BruceIR");
+    if (!fs.exists(IRDB_CACHE_DIR)) fs.mkdir(IRDB_CACHE_DIR);
+    String tmp = cache + ".tmp";
+    File dst = fs.open(tmp, FILE_WRITE);
+    bool ok = dst && compile(src, dst);
+    if (dst) dst.close();
+    src.close();
+    if (ok) {
+        fs.remove(cache);
+        ok = fs.rename(tmp, cache);
+    } else {
+        fs.remove(tmp);
+    }
+    return ok && load(fs, cache, size, mtime);
+}
+
+void IrDatabase::close() {
+    if (_file) _file.close();
+    _index.clear();
+}
+
+bool IrDatabase::read(uint32_t index, IrDbEntry &entry, bool withTimings) {
+    if (!_file || index >= _index.size()) return false;
+    IrDbRecordHeader rec;
+    if (!_file.seek(_index[index])) return false;
+    if (_file.read((uint8_t *)&rec, sizeof(rec)) != sizeof(rec)) return false;
+
+    entry.clear();
+    entry.raw = rec.raw;
+    entry.bits = rec.bits;
+    entry.frequency = rec.frequency;
+    char buf[IRDB_MAX_VALUE + 1];
+    auto readString = [&](uint8_t len, String &out) {
+        if ((size_t)_file.read((uint8_t *)buf, len) != len) return false;
+        buf[len] = '\0';
+        out = buf;
+        return true;
+    };
+    if (!readString(rec.nameLen, entry.name) || !readString(rec.protocolLen, entry.protocol) ||
+        !readString(rec.addressLen, entry.address) || !readString(rec.commandLen, entry.command) ||
+        !readString(rec.dataLen, entry.data)) {
+        return false;
+    }
+    if (withTimings && rec.timingCount) {
+        entry.timings.resize(rec.timingCount);
+        size_t len = rec.timingCount * sizeof(uint16_t);
+        if ((size_t)_file.read((uint8_t *)entry.timings.data(), len) != len) return false;
+    }
+    return true;
+}
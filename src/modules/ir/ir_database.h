@@ -0,0 +1,54 @@
+#ifndef __IR_DATABASE_H__
+#define __IR_DATABASE_H__
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <vector>
+
+// One signal of a Flipper .ir file
+struct IrDbEntry {
+    bool raw = false;
+    uint8_t bits = 32;
+    uint16_t frequency = 0;
+    String name = "";
+    String protocol = "";
+    String address = "";
+    String command = "";
+    String data = "";               // value/state of parsed signals
+    std::vector<uint16_t> timings; // raw signals, already parsed
+
+    void clear();
+    String timingsToString() const;
+};
+
+// Compiled IR database.
+// The first time an .ir file is opened it is compiled to a binary cache under
+// /BruceIR/.cache on the same filesystem, keyed by the source size and mtime.
+// The cache holds one record per signal (fixed header, strings, timings as
+// packed uint16) and an offset table, so entry N can be sent without parsing text.
+class IrDatabase {
+public:
+    ~IrDatabase() { close(); }
+
+    // Opens the cache for `path`, compiling it first when missing or stale
+    bool open(FS &fs, const String &path);
+    void close();
+    bool isOpen() const { return _file; }
+    uint32_t count() const { return _index.size(); }
+
+    // Reads entry `index`. Timings are skipped when withTimings is false (menus).
+    bool read(uint32_t index, IrDbEntry &entry, bool withTimings = true);
+
+    // Streams a .ir text file, calling onEntry for every complete signal. Stops when it returns false.
+    static bool parse(File &src, const std::function<bool(IrDbEntry &)> &onEntry);
+    static bool compile(File &src, File &dst);
+    static String cachePath(const String &path);
+
+private:
+    bool load(FS &fs, const String &cache, uint32_t sourceSize, uint32_t sourceMtime);
+
+    File _file;
+    std::vector<uint32_t> _index;
+};
+
+#endif
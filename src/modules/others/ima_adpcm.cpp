@@ -0,0 +1,128 @@
+#include "ima_adpcm.h"
+#include <string.h>
+
+namespace {
+const int8_t INDEX_TABLE[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+const int16_t STEP_TABLE[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,
+    25,    28,    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,
+    88,    97,    107,   118,   130,   143,   157,   173,   190,   209,   230,   253,   279,
+    307,   337,   371,   408,   449,   494,   544,   598,   658,   724,   796,   876,   963,
+    1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,  2272,  2499,  2749,  3024,  3327,
+    3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,  9493,  10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+void put16(uint8_t *p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+void put32(uint8_t *p, uint32_t v) {
+    put16(p, v);
+    put16(p + 2, v >> 16);
+}
+} // namespace
+
+void ImaAdpcmEncoder::begin() {
+    _fill = 0;
+    _predictor = 0;
+    _index = 0;
+    _samples = 0;
+    _blocks = 0;
+}
+
+// Quantizes the difference to the prediction and steps the decoder state the same way a decoder will
+uint8_t ImaAdpcmEncoder::encode(int16_t sample) {
+    int step = STEP_TABLE[_index];
+    int diff = sample - _predictor;
+    uint8_t nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    int delta = step >> 3;
+    if (diff >= step) {
+        nibble |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        nibble |= 1;
+        delta += step;
+    }
+
+    _predictor += (nibble & 8) ? -delta : delta;
+    if (_predictor > 32767) _predictor = 32767;
+    else if (_predictor < -32768) _predictor = -32768;
+    _index += INDEX_TABLE[nibble];
+    if (_index < 0) _index = 0;
+    else if (_index > 88) _index = 88;
+    return nibble;
+}
+
+void ImaAdpcmEncoder::put(int16_t sample) {
+    if (_fill == 0) {
+        // the block header restarts the decoder on an exact sample
+        _predictor = sample;
+        put16(_block, (uint16_t)sample);
+        _block[2] = _index;
+        _block[3] = 0;
+    } else {
+        size_t pos = 4 + (_fill - 1) / 2;
+        uint8_t nibble = encode(sample);
+        if ((_fill - 1) & 1) _block[pos] |= nibble << 4;
+        else _block[pos] = nibble;
+    }
+    _fill++;
+}
+
+bool ImaAdpcmEncoder::flush(Print &out) {
+    _fill = 0;
+    _blocks++;
+    return out.write(_block, sizeof(_block)) == sizeof(_block);
+}
+
+bool ImaAdpcmEncoder::write(const int16_t *samples, size_t count, Print &out) {
+    bool ok = true;
+    for (size_t i = 0; i < count; i++) {
+        put(samples[i]);
+        if (_fill == IMA_ADPCM_SAMPLES_PER_BLOCK) ok = flush(out) && ok;
+    }
+    _samples += count;
+    return ok;
+}
+
+bool ImaAdpcmEncoder::finish(Print &out) {
+    if (_fill == 0) return true;
+    // decoders want whole blocks, the fact chunk tells them where the audio really ends
+    int16_t last = _predictor;
+    while (_fill < IMA_ADPCM_SAMPLES_PER_BLOCK) put(last);
+    return flush(out);
+}
+
+void ImaAdpcmEncoder::wavHeader(uint8_t *h, uint32_t sampleRate, uint32_t dataBytes, uint32_t samples) {
+    memcpy(h, "RIFF", 4);
+    put32(h + 4, IMA_ADPCM_WAV_HEADER - 8 + dataBytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put32(h + 16, 20);
+    put16(h + 20, 0x0011); // IMA ADPCM
+    put16(h + 22, 1);      // mono
+    put32(h + 24, sampleRate);
+    put32(h + 28, (uint64_t)sampleRate * IMA_ADPCM_BLOCK_BYTES / IMA_ADPCM_SAMPLES_PER_BLOCK);
+    put16(h + 32, IMA_ADPCM_BLOCK_BYTES);
+    put16(h + 34, 4); // bits per sample
+    put16(h + 36, 2); // extra format bytes
+    put16(h + 38, IMA_ADPCM_SAMPLES_PER_BLOCK);
+    memcpy(h + 40, "fact", 4);
+    put32(h + 44, 4);
+    put32(h + 48, samples);
+    memcpy(h + 52, "data", 4);
+    put32(h + 56, dataBytes);
+}
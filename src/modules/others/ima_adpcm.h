@@ -0,0 +1,41 @@
+#ifndef __IMA_ADPCM_H__
+#define __IMA_ADPCM_H__
+#include <Print.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// IMA-ADPCM encoder for mono WAV files (format tag 0x0011), 4 bits per sample.
+// Audio is cut in blocks of IMA_ADPCM_BLOCK_BYTES: a 4 byte header holding the first sample and
+// the step index, then two samples per byte, low nibble first. Each block can be decoded alone.
+#define IMA_ADPCM_BLOCK_BYTES 1024
+#define IMA_ADPCM_SAMPLES_PER_BLOCK ((IMA_ADPCM_BLOCK_BYTES - 4) * 2 + 1)
+#define IMA_ADPCM_WAV_HEADER 60 // RIFF, fmt (20 bytes), fact and data chunk headers
+
+class ImaAdpcmEncoder {
+public:
+    void begin();
+    // Encodes `count` samples, every completed block is written to `out`. False on a short write.
+    bool write(const int16_t *samples, size_t count, Print &out);
+    // Writes the last, partial, block padded with its last sample
+    bool finish(Print &out);
+
+    uint32_t samples() const { return _samples; }
+    uint32_t bytes() const { return _blocks * IMA_ADPCM_BLOCK_BYTES; }
+
+    // WAV header for `samples` samples stored in `dataBytes` bytes of blocks
+    static void wavHeader(uint8_t *header, uint32_t sampleRate, uint32_t dataBytes, uint32_t samples);
+
+private:
+    uint8_t _block[IMA_ADPCM_BLOCK_BYTES];
+    size_t _fill = 0; // samples in _block
+    int32_t _predictor = 0;
+    int _index = 0;
+    uint32_t _samples = 0;
+    uint32_t _blocks = 0;
+
+    uint8_t encode(int16_t sample);
+    void put(int16_t sample);
+    bool flush(Print &out);
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include "core/powerSave.h"
 #include "core/settings.h"
 #include "driver/gpio.h"
+#include "ima_adpcm.h"
+#include "modules/wifi/packet_ring.h"
 #include "soc/gpio_struct.h"
 #include "soc/io_mux_reg.h"
 #include <cmath>
@@ -18,13 +20,13 @@ static i2s_chan_handle_t i2s_chan = nullptr;
 #endif
 
 #define FFT_SIZE 1024
-#define SPECTRUM_WIDTH 200
-#define SPECTRUM_HEIGHT 124
-#define HISTORY_LEN (SPECTRUM_WIDTH + 1)
+#define SPECTRUM_BINS (FFT_SIZE / 4) // shown bins, up to 12kHz
+#define SPECTRUM_FLOOR_DB -80.0f     // level drawn as the first palette colour
+#define MIC_DMA_FRAMES 256
+#define MIC_READER_FRAMES 3 // FFT blocks in flight between the reader task and the spectrogram
+#define MIC_REC_BLOCK 1024        // samples per I2S read while recording
+#define MIC_REC_RING (512 * 1024) // ~5s of audio waiting for the card (32KB without PSRAM)
 
-static int16_t *i2s_buffer = nullptr;
-static uint8_t *fftHistory = nullptr; // Linear buffer [WIDTH + 1][HEIGHT]
-static uint16_t posData = 0;
 #define MIC_SAMPLE_RATE 48000
 
 #ifndef PIN_CLK
@@ -43,7 +45,8 @@ gpio_num_t mic_bclk_pin = (gpio_num_t)I2S_PIN_NO_CHANGE;
 static MicConfig mic_config = {
     .record_time_ms = 10000, // default 10 sec
     .gain = 2.0f,            // default gain (1.0f = no gain apply)
-    .stealth_mode = false    // default stealth off
+    .stealth_mode = false,   // default stealth off
+    .adpcm = false           // default 16-bit PCM
 };
 
 static void apply_gain_to_buffer(int16_t *buffer, size_t samples, float gain) {
@@ -113,10 +116,68 @@ const unsigned char ImageData[768] PROGMEM = {
     0xFF, 0xFF, 0xFD,
 };
 
-static inline uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
-    return (r << (5 + 6)) | (g << 5) | b;
-    // return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+namespace {
+// Reads FFT_SIZE sample blocks on its own core so no audio is lost while the screen is pushed.
+// Blocks go round between the two queues: `empty` ones are filled and sent to `full`.
+struct MicReader {
+    int16_t *frames[MIC_READER_FRAMES] = {};
+    QueueHandle_t empty = nullptr;
+    QueueHandle_t full = nullptr;
+    TaskHandle_t task = nullptr;
+    volatile bool stop = false;
+    volatile bool running = false;
+
+    bool begin();
+    void end();
+};
+
+void micReaderTask(void *arg) {
+    MicReader *reader = (MicReader *)arg;
+    int16_t *frame = nullptr;
+    while (!reader->stop) {
+        if (!frame && xQueueReceive(reader->empty, &frame, pdMS_TO_TICKS(100)) != pdTRUE) continue;
+        size_t bytesRead = 0;
+        i2s_channel_read(i2s_chan, frame, FFT_SIZE * sizeof(int16_t), &bytesRead, 100);
+        // a short read timed out, start the block over
+        if (bytesRead != FFT_SIZE * sizeof(int16_t)) continue;
+        xQueueSend(reader->full, &frame, 0);
+        frame = nullptr;
+    }
+    reader->running = false;
+    vTaskDelete(NULL);
+}
+
+bool MicReader::begin() {
+    empty = xQueueCreate(MIC_READER_FRAMES, sizeof(int16_t *));
+    full = xQueueCreate(MIC_READER_FRAMES, sizeof(int16_t *));
+    if (!empty || !full) return false;
+    for (auto &frame : frames) {
+        frame = (int16_t *)heap_caps_malloc(FFT_SIZE * sizeof(int16_t), MALLOC_CAP_8BIT);
+        if (!frame) return false;
+        xQueueSend(empty, &frame, 0);
+    }
+    stop = false;
+    running = true;
+    if (xTaskCreatePinnedToCore(micReaderTask, "mic_reader", 4096, this, 2, &task, 0) != pdPASS) {
+        running = false;
+        return false;
+    }
+    return true;
+}
+
+void MicReader::end() {
+    stop = true;
+    for (int i = 0; running && i < 50; i++) delay(10);
+    task = nullptr;
+    for (auto &frame : frames) {
+        if (frame) heap_caps_free(frame);
+        frame = nullptr;
+    }
+    if (empty) vQueueDelete(empty);
+    if (full) vQueueDelete(full);
+    empty = full = nullptr;
 }
+} // namespace
 
 bool deinitMicroPhone() {
     // Disable codec, if exists
@@ -131,19 +192,19 @@ bool deinitMicroPhone() {
     return err;
 }
 
-bool InitI2SMicroPhone() {
+bool InitI2SMicroPhone(uint32_t sampleRate = MIC_SAMPLE_RATE) {
     // Enable codec, if exists
     _setup_codec_mic(true);
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
     chan_cfg.dma_desc_num = 8;
-    chan_cfg.dma_frame_num = SPECTRUM_HEIGHT;
+    chan_cfg.dma_frame_num = MIC_DMA_FRAMES;
     esp_err_t err = i2s_new_channel(&chan_cfg, NULL, &i2s_chan);
 #if defined(MIC_INMP441) // #ifdef PIN_WS // INMP441
     i2s_std_slot_config_t slot_cfg =
         I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
     slot_cfg.slot_bit_width = I2S_SLOT_BIT_WIDTH_16BIT;
     const i2s_std_config_t std_cfg = {
-        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(MIC_SAMPLE_RATE),
+        .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sampleRate),
         .slot_cfg = slot_cfg,
         .gpio_cfg = {
                      .mclk = I2S_GPIO_UNUSED,
@@ -166,8 +227,8 @@ bool InitI2SMicroPhone() {
 #else
         i2s_config.clk_cfg.clk_src = i2s_clock_src_t::I2S_CLK_SRC_PLL_160M;
 #endif
-        i2s_config.clk_cfg.sample_rate_hz = MIC_SAMPLE_RATE;                           // dummy setting
-        i2s_config.clk_cfg.mclk_multiple = i2s_mclk_multiple_t::I2S_MCLK_MULTIPLE_256; // dummy setting
+        i2s_config.clk_cfg.sample_rate_hz = sampleRate;
+        i2s_config.clk_cfg.mclk_multiple = i2s_mclk_multiple_t::I2S_MCLK_MULTIPLE_256;
         i2s_config.slot_cfg.data_bit_width = i2s_data_bit_width_t::I2S_DATA_BIT_WIDTH_16BIT;
         i2s_config.slot_cfg.slot_bit_width = i2s_slot_bit_width_t::I2S_SLOT_BIT_WIDTH_16BIT;
         i2s_config.slot_cfg.slot_mode = i2s_slot_mode_t::I2S_SLOT_MODE_MONO;
@@ -189,7 +250,7 @@ bool InitI2SMicroPhone() {
         err = i2s_channel_init_std_mode(i2s_chan, &i2s_config);
     } else {
 
-        i2s_pdm_rx_clk_config_t clk_cfg = I2S_PDM_RX_CLK_DEFAULT_CONFIG(MIC_SAMPLE_RATE);
+        i2s_pdm_rx_clk_config_t clk_cfg = I2S_PDM_RX_CLK_DEFAULT_CONFIG(sampleRate);
         i2s_pdm_rx_slot_config_t slot_cfg =
             I2S_PDM_RX_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
         slot_cfg.slot_bit_width = I2S_SLOT_BIT_WIDTH_16BIT;
@@ -220,74 +281,88 @@ void mic_test_one_task() {
     const int displayX = MARGIN_X;
     const int displayY = MARGIN_Y;
 
-    // Alloc framebuffer
-    uint16_t *frameBuffer;
-    if (psramFound()) frameBuffer = (uint16_t *)ps_malloc(displayWidth * displayHeight * sizeof(uint16_t));
+    // Waterfall: frequency along x, newest line on top. The lines are a ring, so each FFT writes
+    // a single line and the ring reaches the screen in two pushes, [head, end) then [0, head).
+    uint16_t *ring;
+    if (psramFound()) ring = (uint16_t *)ps_malloc(displayWidth * displayHeight * sizeof(uint16_t));
     else {
         closeSdCard();
-        frameBuffer = (uint16_t *)malloc(displayWidth * displayHeight * sizeof(uint16_t));
+        ring = (uint16_t *)malloc(displayWidth * displayHeight * sizeof(uint16_t));
     }
 
-    if (!frameBuffer) {
-        Serial.println("Error alloc drawing frameBuffer, exiting");
-        displayError("Not Enough RAM", true);
-        return;
-    }
+    // the plan (and its twiddle factors) is made once, not per frame
+    fft_config_t *plan = fft_init(FFT_SIZE, FFT_REAL, FFT_FORWARD, NULL, NULL);
+    float *window = (float *)malloc(FFT_SIZE * sizeof(float));
+    uint16_t *palette = (uint16_t *)malloc(256 * sizeof(uint16_t));
+    uint16_t *firstBin = (uint16_t *)malloc((displayWidth + 1) * sizeof(uint16_t));
+    MicReader reader;
 
-    // Border around the spectrogram
-    tft.drawRect(displayX - 2, displayY - 2, displayWidth + 4, displayHeight + 4, bruceConfig.priColor);
-
-    while (1) {
-        fft_config_t *plan = fft_init(FFT_SIZE, FFT_REAL, FFT_FORWARD, NULL, NULL);
-        size_t bytesread;
-        i2s_channel_read(i2s_chan, (char *)i2s_buffer, FFT_SIZE * sizeof(int16_t), &bytesread, portMAX_DELAY);
-
-        int16_t *samples = (int16_t *)i2s_buffer;
-
-        for (int i = 0; i < FFT_SIZE; i++) { plan->input[i] = (float)samples[i] / 32768.0f; }
-
-        fft_execute(plan);
-
-        for (int i = 1; i < FFT_SIZE / 4 && i < SPECTRUM_HEIGHT; i++) {
-            float re = plan->output[2 * i];
-            float im = plan->output[2 * i + 1];
-            float mag = re * re + im * im;
-            if (mag > 1.0f) mag = 1.0f;
-            uint8_t value = map(mag * 2000, 0, 2000, 0, 255);
-            fftHistory[posData * SPECTRUM_HEIGHT + (SPECTRUM_HEIGHT - i)] = value;
+    if (!ring || !plan || !window || !palette || !firstBin || !reader.begin()) {
+        Serial.println("Error alloc spectrogram buffers, exiting");
+        displayError("Not Enough RAM", true);
+    } else {
+        // Hann window, scaled so a full scale sine peaks at 1.0 (0dB)
+        for (int i = 0; i < FFT_SIZE; i++) {
+            float hann = 0.5f - 0.5f * cosf(2.0f * PI * i / (FFT_SIZE - 1));
+            window[i] = hann / (32768.0f * FFT_SIZE / 4);
+        }
+        for (int i = 0; i < 256; i++) {
+            uint8_t r = pgm_read_byte(&ImageData[i * 3 + 0]);
+            uint8_t g = pgm_read_byte(&ImageData[i * 3 + 1]);
+            uint8_t b = pgm_read_byte(&ImageData[i * 3 + 2]);
+            palette[i] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        }
+        // x draws the loudest of bins [firstBin[x], firstBin[x + 1]), skipping DC
+        for (int x = 0; x <= displayWidth; x++) firstBin[x] = 1 + x * (SPECTRUM_BINS - 1) / displayWidth;
+        for (int x = 1; x <= displayWidth; x++) {
+            firstBin[x] = max(firstBin[x], (uint16_t)(firstBin[x - 1] + 1));
         }
 
-        posData = (posData + 1) % HISTORY_LEN;
-
-        fft_destroy(plan);
-
-        // ===== RENDER WITH SCALING =====
-        for (int y = 0; y < displayHeight; y++) {
-            // Original spectrum y-display y-map
-            int srcY = (y * SPECTRUM_HEIGHT) / displayHeight;
-
-            for (int x = 0; x < displayWidth; x++) {
-                // Original spectrum display x-map
-                int srcX = (x * SPECTRUM_WIDTH) / displayWidth;
-                int index = (srcX + posData) % HISTORY_LEN;
+        memset(ring, 0, displayWidth * displayHeight * sizeof(uint16_t));
+        // Border around the spectrogram
+        tft.drawRect(displayX - 2, displayY - 2, displayWidth + 4, displayHeight + 4, bruceConfig.priColor);
+
+        bool swapBytes = tft.getSwapBytes();
+        tft.setSwapBytes(true);
+        int head = 0;
+        while (1) {
+            int16_t *samples;
+            if (xQueueReceive(reader.full, &samples, pdMS_TO_TICKS(200)) == pdTRUE) {
+                for (int i = 0; i < FFT_SIZE; i++) plan->input[i] = samples[i] * window[i];
+                xQueueSend(reader.empty, &samples, 0);
+                fft_execute(plan);
+
+                head = head ? head - 1 : displayHeight - 1;
+                uint16_t *line = ring + head * displayWidth;
+                for (int x = 0; x < displayWidth; x++) {
+                    float power = 0;
+                    for (int bin = firstBin[x]; bin < firstBin[x + 1] && bin < FFT_SIZE / 2; bin++) {
+                        float re = plan->output[2 * bin];
+                        float im = plan->output[2 * bin + 1];
+                        power = max(power, re * re + im * im);
+                    }
+                    float db = power > 0 ? 10.0f * log10f(power) : SPECTRUM_FLOOR_DB;
+                    int level = (db - SPECTRUM_FLOOR_DB) * 255 / -SPECTRUM_FLOOR_DB;
+                    line[x] = palette[constrain(level, 0, 255)];
+                }
 
-                uint8_t val = fftHistory[index * SPECTRUM_HEIGHT + srcY];
-                uint16_t color = rgb565(
-                    pgm_read_byte(&ImageData[val * 3 + 0]),
-                    pgm_read_byte(&ImageData[val * 3 + 1]),
-                    pgm_read_byte(&ImageData[val * 3 + 2])
-                );
-                frameBuffer[y * displayWidth + x] = color;
+                tft.pushImage(displayX, displayY, displayWidth, displayHeight - head, line);
+                if (head) tft.pushImage(displayX, displayY + displayHeight - head, displayWidth, head, ring);
             }
+            wakeUpScreen();
+            if (check(SelPress) || check(EscPress)) break;
         }
-
-        tft.pushImage(displayX, displayY, displayWidth, displayHeight, frameBuffer);
-        wakeUpScreen();
-        if (check(SelPress) || check(EscPress)) break;
+        tft.setSwapBytes(swapBytes);
     }
+
+    reader.end();
     i2s_channel_disable(i2s_chan);
 
-    free(frameBuffer);
+    if (plan) fft_destroy(plan);
+    free(window);
+    free(palette);
+    free(firstBin);
+    free(ring);
 }
 
 bool isGPIOOutput(gpio_num_t gpio) {
@@ -302,6 +377,33 @@ bool isGPIOOutput(gpio_num_t gpio) {
     }
 }
 
+// Powers the mic and starts I2S at `sampleRate`. `gpioInput` tells micEnd() how to restore GPIO0.
+static bool micBegin(uint32_t sampleRate, bool &gpioInput) {
+    ioExpander.turnPinOnOff(IO_EXP_MIC, HIGH);
+    gpioInput = false;
+    if (!isGPIOOutput(GPIO_NUM_0)) {
+        gpioInput = true;
+        gpio_hold_en(GPIO_NUM_0);
+    }
+    return InitI2SMicroPhone(sampleRate);
+}
+
+static void micEnd(bool gpioInput) {
+    deinitMicroPhone();
+    delay(10);
+
+    // Restore GPIO
+    if (gpioInput) {
+        gpio_hold_dis(GPIO_NUM_0);
+        pinMode(GPIO_NUM_0, INPUT);
+    } else {
+        pinMode(GPIO_NUM_0, OUTPUT);
+        digitalWrite(GPIO_NUM_0, LOW);
+    }
+
+    ioExpander.turnPinOnOff(IO_EXP_MIC, LOW);
+}
+
 void mic_test() {
     ioExpander.turnPinOnOff(IO_EXP_MIC, HIGH);
     // Devices that use GPIO 0 to navigation (or any other purposes) will break after start mic
@@ -312,28 +414,9 @@ void mic_test() {
     }
     Serial.println("Mic Spectrum start");
     InitI2SMicroPhone();
-    // Alloc buffers in PSRAM if available
-    if (psramFound()) {
-        i2s_buffer = (int16_t *)ps_malloc(FFT_SIZE * sizeof(int16_t));
-        fftHistory = (uint8_t *)ps_malloc(HISTORY_LEN * SPECTRUM_HEIGHT);
-    } else {
-        i2s_buffer = (int16_t *)malloc(FFT_SIZE * sizeof(int16_t));
-        fftHistory = (uint8_t *)malloc(HISTORY_LEN * SPECTRUM_HEIGHT);
-    }
-    if (!i2s_buffer || !fftHistory) {
-        displayError("Fail to alloc buffers, exiting", true);
-        return;
-    }
-
-    memset(fftHistory, 0, HISTORY_LEN * SPECTRUM_HEIGHT);
 
     mic_test_one_task();
 
-    free(i2s_buffer);
-    free(fftHistory);
-    i2s_buffer = nullptr;
-    fftHistory = nullptr;
-
     delay(10);
     if (deinitMicroPhone()) Serial.println("Fail disabling I2S Driver");
     if (gpioInput) {
@@ -401,32 +484,94 @@ void CreateWavHeader(byte *header, int waveDataSize) {
     header[43] = (byte)((waveDataSize >> 24) & 0xFF);
 }
 
+namespace {
+// I2S -> ring -> card. The reader task only moves audio into the ring and the writer task only
+// drains it, so when the card stalls (cluster allocation, internal GC) the ring takes the backlog
+// instead of the I2S DMA overflowing. Blocks that find the ring full are lost and counted.
+struct MicRecorder {
+    PacketRing ring;
+    ImaAdpcmEncoder adpcm;
+    File file;
+    float gain = 1.0f;
+    bool useAdpcm = false;
+    TaskHandle_t reader = nullptr;
+    TaskHandle_t writer = nullptr;
+    volatile bool stopReader = false;
+    volatile bool stopWriter = false;
+    volatile bool readerRunning = false;
+    volatile bool writerRunning = false;
+    volatile bool failed = false;
+    volatile uint32_t samples = 0; // handed to the file or the encoder
+    int16_t overflow[MIC_REC_BLOCK]; // where I2S is drained to while the ring is full
+};
+
+void micRecordReader(void *arg) {
+    MicRecorder *rec = (MicRecorder *)arg;
+    while (!rec->stopReader) {
+        uint8_t *p = rec->ring.reserve(MIC_REC_BLOCK * sizeof(int16_t));
+        int16_t *block = p ? (int16_t *)p : rec->overflow;
+        size_t bytesRead = 0;
+        esp_err_t err = i2s_channel_read(i2s_chan, block, MIC_REC_BLOCK * sizeof(int16_t), &bytesRead, 1000);
+        if (err != ESP_OK) {
+            Serial.printf("I2S read error: %s\n", esp_err_to_name(err));
+            rec->failed = true;
+            break;
+        }
+        if (!p) continue;
+        apply_gain_to_buffer(block, MIC_REC_BLOCK, rec->gain);
+        rec->ring.commit();
+        xTaskNotifyGive(rec->writer);
+    }
+    rec->readerRunning = false;
+    vTaskDelete(NULL);
+}
+
+void micRecordWriter(void *arg) {
+    MicRecorder *rec = (MicRecorder *)arg;
+    for (;;) {
+        bool stopping = rec->stopWriter; // checked before draining, the last blocks still get written
+        size_t len;
+        const uint8_t *p;
+        while ((p = rec->ring.peek(len))) {
+            size_t count = len / sizeof(int16_t);
+            bool ok = rec->useAdpcm ? rec->adpcm.write((const int16_t *)p, count, rec->file)
+                                    : rec->file.write(p, len) == len;
+            rec->ring.release();
+            if (!ok) rec->failed = true;
+            rec->samples += count;
+        }
+        if (stopping) break;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    }
+    rec->writerRunning = false;
+    vTaskDelete(NULL);
+}
+} // namespace
+
 bool mic_record_wav_to_path(
     FS *fs, const String &path, uint32_t max_ms, uint32_t *out_bytes, float gain,
-    std::function<bool(void)> onProgress
+    std::function<bool(const MicRecordStats &)> onProgress, bool adpcm
 ) {
     if (out_bytes) *out_bytes = 0;
     if (fs == nullptr) return false;
     if (path.length() == 0) return false;
 
-    ioExpander.turnPinOnOff(IO_EXP_MIC, HIGH);
+    MicRecorder *rec = new (std::nothrow) MicRecorder();
+    if (!rec) return false;
+    if (!rec->ring.begin(MIC_REC_RING)) {
+        delete rec;
+        return false;
+    }
+    rec->gain = gain;
+    rec->useAdpcm = adpcm;
+    rec->adpcm.begin();
+    const size_t headerSize = adpcm ? IMA_ADPCM_WAV_HEADER : 44;
 
     // GPIO PROTECTION: Centrally managed here (safe for JS and GUI)
     bool gpioInput = false;
-    if (!isGPIOOutput(GPIO_NUM_0)) {
-        gpioInput = true;
-        gpio_hold_en(GPIO_NUM_0);
-    }
-
-    bool ok = false;
-    do {
-        if (!InitI2SMicroPhone()) break;
-
-        // Buffer Allocation
-        if (psramFound()) i2s_buffer = (int16_t *)ps_malloc(FFT_SIZE * sizeof(int16_t));
-        else i2s_buffer = (int16_t *)malloc(FFT_SIZE * sizeof(int16_t));
-        if (!i2s_buffer) break;
+    bool ok = micBegin(MIC_SAMPLE_RATE, gpioInput);
 
+    if (ok) {
         // Path Management
         String fixedPath = path;
         if (!fixedPath.startsWith("/")) fixedPath = "/" + fixedPath;
@@ -438,70 +583,80 @@ bool mic_record_wav_to_path(
             if (!fs->exists(dir)) fs->mkdir(dir);
         }
 
-        File audioFile = fs->open(fixedPath, FILE_WRITE, true);
-        if (!audioFile) break;
-
-        const int headerSize = 44;
-        byte header[headerSize] = {0};
-        audioFile.write(header, headerSize);
-
-        uint32_t dataSize = 0;
-        const int bytesPerRead = FFT_SIZE * sizeof(int16_t);
-        const unsigned long startMillis = millis();
-
-        while (true) {
-            // 1. Timeout
-            if (max_ms > 0 && (millis() - startMillis) >= max_ms) break;
-
-            // 2. EXTERNAL CALLBACK (GUI update or custom check stop)
-            // If the callback exists and returns FALSE, stop recording.
-            if (onProgress && !onProgress()) break;
-
-            size_t bytesRead = 0;
-            esp_err_t err = i2s_channel_read(i2s_chan, (char *)i2s_buffer, bytesPerRead, &bytesRead, 1000);
-            if (err != ESP_OK) {
-                Serial.printf("I2S read error: %s\n", esp_err_to_name(err));
-                break; // Exit Loop
-            }
-            if (bytesRead > 0) {
-                apply_gain_to_buffer(i2s_buffer, bytesRead / sizeof(int16_t), gain);
-                audioFile.write((const uint8_t *)i2s_buffer, bytesRead);
-                dataSize += (uint32_t)bytesRead;
-            }
-
-            // Watchdog reset and yield to other tasks
-            delay(1);
-            yield();
+        rec->file = fs->open(fixedPath, FILE_WRITE, true);
+        ok = rec->file;
+    }
+    if (ok) {
+        byte header[IMA_ADPCM_WAV_HEADER] = {0};
+        rec->file.write(header, headerSize);
+
+        rec->writerRunning = true;
+        if (xTaskCreate(micRecordWriter, "mic_writer", 4096, rec, 2, &rec->writer) != pdPASS) {
+            rec->writer = nullptr;
+            rec->writerRunning = false;
+            ok = false;
         }
+    }
+    if (ok) {
+        rec->readerRunning = true;
+        if (xTaskCreatePinnedToCore(micRecordReader, "mic_reader", 4096, rec, 5, &rec->reader, 0) != pdPASS) {
+            rec->reader = nullptr;
+            rec->readerRunning = false;
+            ok = false;
+        }
+    }
 
-        audioFile.seek(0);
-        CreateWavHeader(header, dataSize);
-        audioFile.write(header, headerSize);
-        audioFile.close();
-
-        if (out_bytes) *out_bytes = dataSize + headerSize;
-        ok = true;
-    } while (0);
+    MicRecordStats stats = {};
+    const unsigned long startMillis = millis();
+    while (ok && !rec->failed) {
+        // 1. Timeout
+        stats.elapsedMs = millis() - startMillis;
+        if (max_ms > 0 && stats.elapsedMs >= max_ms) break;
+
+        // 2. EXTERNAL CALLBACK (GUI update or custom check stop)
+        // If the callback exists and returns FALSE, stop recording.
+        stats.bytes = headerSize + (adpcm ? rec->adpcm.bytes() : rec->samples * sizeof(int16_t));
+        stats.overruns = rec->ring.drops();
+        stats.bufferUsed = rec->ring.used();
+        stats.bufferSize = rec->ring.capacity();
+        if (onProgress && !onProgress(stats)) break;
+
+        delay(20);
+    }
 
-    // Cleanup
-    if (i2s_buffer) {
-        free(i2s_buffer);
-        i2s_buffer = nullptr;
+    // The reader stops first so everything it queued still reaches the card
+    if (rec->reader) {
+        rec->stopReader = true;
+        while (rec->readerRunning) delay(5);
+    }
+    if (rec->writer) {
+        rec->stopWriter = true;
+        xTaskNotifyGive(rec->writer);
+        while (rec->writerRunning) delay(5);
     }
 
-    delay(10);
-    deinitMicroPhone();
+    if (rec->file) {
+        byte header[IMA_ADPCM_WAV_HEADER];
+        uint32_t dataSize = 0;
+        if (adpcm) {
+            if (!rec->adpcm.finish(rec->file)) rec->failed = true;
+            dataSize = rec->adpcm.bytes();
+            ImaAdpcmEncoder::wavHeader(header, MIC_SAMPLE_RATE, dataSize, rec->adpcm.samples());
+        } else {
+            dataSize = rec->samples * sizeof(int16_t);
+            CreateWavHeader(header, dataSize);
+        }
+        rec->file.seek(0);
+        rec->file.write(header, headerSize);
+        rec->file.close();
 
-    // Restore GPIO
-    if (gpioInput) {
-        gpio_hold_dis(GPIO_NUM_0);
-        pinMode(GPIO_NUM_0, INPUT);
-    } else {
-        pinMode(GPIO_NUM_0, OUTPUT);
-        digitalWrite(GPIO_NUM_0, LOW);
+        if (out_bytes) *out_bytes = dataSize + headerSize;
+        if (rec->ring.drops()) Serial.printf("Recording lost %u blocks to overruns\n", rec->ring.drops());
     }
+    ok = ok && !rec->failed;
 
-    ioExpander.turnPinOnOff(IO_EXP_MIC, LOW);
+    micEnd(gpioInput);
+    delete rec;
     return ok;
 }
 
@@ -521,8 +676,9 @@ void mic_record_app() {
     const int ITEM_TIME = 0;
     const int ITEM_GAIN = 1;
     const int ITEM_STEALTH = 2;
-    const int ITEM_START = 3;
-    const int NUM_ITEMS = 4;
+    const int ITEM_FORMAT = 3;
+    const int ITEM_START = 4;
+    const int NUM_ITEMS = 5;
 
     uint8_t originalBrightness = currentScreenBrightness; // ← Backup Brightness value
 
@@ -534,6 +690,7 @@ void mic_record_app() {
     int time_seconds = mic_config.record_time_ms / 1000;
     float gain_value = mic_config.gain;
     bool stealth_enabled = mic_config.stealth_mode;
+    bool adpcm_enabled = mic_config.adpcm;
 
     // ===== HELPER FOR UI DRAWING =====
 
@@ -544,7 +701,7 @@ void mic_record_app() {
         if (itemIndex < ITEM_START) {
             yPos = START_Y + itemIndex * (ITEM_HEIGHT + 8);
         } else {
-            yPos = START_Y + 2 * (ITEM_HEIGHT + 8) + ITEM_HEIGHT + 15;
+            yPos = START_Y + (ITEM_START - 1) * (ITEM_HEIGHT + 8) + ITEM_HEIGHT + 15;
         }
 
         // 1. CLEAN: Delete only the area of ​​this specific item
@@ -614,6 +771,15 @@ void mic_record_app() {
                 tft.print(stealth_enabled ? "ON" : "OFF");
                 break;
             }
+            case ITEM_FORMAT: {
+                tft.setCursor(MARGIN + 2, contentY);
+                tft.print("Format:");
+                const char *formatText = adpcm_enabled ? "ADPCM" : "PCM";
+                int formatWidth = strlen(formatText) * 6 * TEXT_SIZE_LARGE;
+                tft.setCursor(tftWidth - MARGIN - rightMargin - formatWidth, contentY);
+                tft.print(formatText);
+                break;
+            }
             case ITEM_START: {
                 uint16_t btnColor = isSelected ? TFT_RED : TFT_DARKGREY;
                 tft.fillRoundRect(MARGIN, yPos, tftWidth - 2 * MARGIN, BUTTON_HEIGHT, 8, btnColor);
@@ -710,6 +876,12 @@ void mic_record_app() {
                         value_changed = true;
                     }
                     break;
+                case ITEM_FORMAT:
+                    if (check(PrevPress) || check(NextPress)) {
+                        adpcm_enabled = !adpcm_enabled;
+                        value_changed = true;
+                    }
+                    break;
             }
 
             if (check(SelPress) || check(EscPress)) {
@@ -742,6 +914,7 @@ void mic_record_app() {
         mic_config.record_time_ms = time_seconds * 1000;
         mic_config.gain = gain_value;
         mic_config.stealth_mode = stealth_enabled;
+        mic_config.adpcm = adpcm_enabled;
 
         FS *fs = nullptr;
         if (!getFsStorage(fs) || fs == nullptr) {
@@ -822,8 +995,13 @@ void mic_record_app() {
         unsigned long lastUpdate = 0;
         String lastTimerStr = "";
 
+        // Buffer fill and lost blocks, under the timer
+        const int STATS_Y = TIMER_Y + TIMER_SIZE * 8 + 20;
+        MicRecordStats lastStats = {};
+
         // ===== CALLBACK DURING RECORDING =====
-        auto onRecordingLoop = [&]() -> bool {
+        auto onRecordingLoop = [&](const MicRecordStats &stats) -> bool {
+            lastStats = stats;
             InputHandler();
             if (check(SelPress)) return false;
 
@@ -872,13 +1050,27 @@ void mic_record_app() {
                         tft.setCursor((tftWidth - labelWidth) / 2, TIMER_Y + TIMER_SIZE * 8 + 5);
                         tft.print(label);
                     }
+
+                    char statsStr[40];
+                    snprintf(
+                        statsStr,
+                        sizeof(statsStr),
+                        "Buf: %3u%%  Lost: %u",
+                        (unsigned)(stats.bufferSize ? stats.bufferUsed * 100 / stats.bufferSize : 0),
+                        (unsigned)stats.overruns
+                    );
+                    tft.setTextSize(TEXT_SIZE_SMALL);
+                    tft.setTextColor(stats.overruns ? TFT_RED : bruceConfig.priColor, bruceConfig.bgColor);
+                    tft.setCursor((tftWidth - (int)strlen(statsStr) * 6) / 2, STATS_Y);
+                    tft.print(statsStr);
                 }
             }
             return true;
         };
 
-        bool success =
-            mic_record_wav_to_path(fs, String(filename), max_ms, &out_bytes, gain_value, onRecordingLoop);
+        bool success = mic_record_wav_to_path(
+            fs, String(filename), max_ms, &out_bytes, gain_value, onRecordingLoop, adpcm_enabled
+        );
 
         if (success) {
             Serial.print("Recording saved: ");
@@ -929,6 +1121,13 @@ void mic_record_app() {
                 tft.print(durStr);
                 tft.print("s");
 
+                if (lastStats.overruns) {
+                    tft.setCursor(MARGIN, infoY + 45);
+                    tft.setTextColor(TFT_RED, bruceConfig.bgColor);
+                    tft.print("Lost blocks: ");
+                    tft.print(lastStats.overruns);
+                }
+
                 delay(2500);
             }
 
@@ -942,6 +1141,45 @@ cleanup_and_exit:
     if (stealth_enabled) { setBrightness(originalBrightness, false); }
 }
 
+// Picks the I2S rate for `requested`: the rate itself when the peripheral runs at it, otherwise the
+// lowest one that is a whole multiple of it, `factor` samples being averaged into one.
+static uint32_t micHardwareRate(uint32_t requested, uint32_t &factor) {
+    static const uint32_t rates[] = {8000, 16000, 22050, 32000, 44100, 48000};
+    factor = 1;
+    for (uint32_t rate : rates) {
+        if (rate == requested) return rate;
+    }
+    for (uint32_t rate : rates) {
+        if (requested && rate > requested && rate % requested == 0 && rate / requested <= MIC_DMA_FRAMES) {
+            factor = rate / requested;
+            return rate;
+        }
+    }
+    return 16000; // Default to 16kHz (good for voice/guitar)
+}
+
+// Fills `out` with `count` samples, reading the I2S DMA ring a block at a time and decimating by
+// `factor`. The DMA keeps filling the ring while the caller is busy between two calls.
+static bool micReadSamples(int16_t *out, uint32_t count, uint32_t factor) {
+    int16_t block[MIC_DMA_FRAMES];
+    uint32_t done = 0;
+    while (done < count) {
+        uint32_t want = min((count - done) * factor, (uint32_t)MIC_DMA_FRAMES);
+        want -= want % factor;
+        size_t bytesRead = 0;
+        esp_err_t err = i2s_channel_read(i2s_chan, (char *)block, want * sizeof(int16_t), &bytesRead, 1000);
+        uint32_t n = bytesRead / sizeof(int16_t) / factor;
+        if (err != ESP_OK || n == 0) return false;
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t sum = 0;
+            for (uint32_t k = 0; k < factor; k++) sum += block[i * factor + k];
+            out[done + i] = sum / (int32_t)factor;
+        }
+        done += n;
+    }
+    return true;
+}
+
 /**
  * Capture raw audio samples from microphone
  * Supports configurable sample rate for better performance
@@ -959,171 +1197,64 @@ bool mic_capture_samples(
     if (numSamples > 4096 || numSamples < 64) return false;
     if (gain < 0.5f || gain > 4.0f) return false;
 
-    // Validate and set sample rate (supported values)
-    // Lower sample rates = faster processing for pitch detection
-    switch (sampleRate) {
-        case 8000:
-        case 16000:
-        case 22050:
-        case 32000:
-        case 44100:
-        case 48000: break;
-        default: sampleRate = 16000; // Default to 16kHz (good for voice/guitar)
-    }
-
-    *outSampleRate = sampleRate;
+    uint32_t factor = 1;
+    uint32_t hardwareRate = micHardwareRate(sampleRate, factor);
+    *outSampleRate = hardwareRate / factor;
 
-    // GPIO PROTECTION (fixed: IO_EXP_MIC not IOEXP_MIC)
-    ioExpander.turnPinOnOff(IO_EXP_MIC, HIGH);
     bool gpioInput = false;
-    if (!isGPIOOutput(GPIO_NUM_0)) {
-        gpioInput = true;
-        gpio_hold_en(GPIO_NUM_0);
-    }
-
-    bool ok = false;
-    i2s_chan_handle_t temp_i2s_chan = nullptr;
-
-    do {
-        // Initialize I2S with custom sample rate
-        _setup_codec_mic(true);
+    bool ok = micBegin(hardwareRate, gpioInput);
 
-        i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_0, I2S_ROLE_MASTER);
-        chan_cfg.dma_desc_num = 8;
-        chan_cfg.dma_frame_num = 256;
-
-        esp_err_t err = i2s_new_channel(&chan_cfg, NULL, &temp_i2s_chan);
-        if (err != ESP_OK) break;
-
-        // Configure I2S with custom sample rate
-#if defined(MIC_INMP441)
-        i2s_std_slot_config_t slot_cfg =
-            I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-        slot_cfg.slot_bit_width = I2S_SLOT_BIT_WIDTH_16BIT;
-
-        const i2s_std_config_t std_cfg = {
-            .clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG(sampleRate), // Custom sample rate
-            .slot_cfg = slot_cfg,
-            .gpio_cfg = {
-                         .mclk = I2S_GPIO_UNUSED,
-                         .bclk = (gpio_num_t)PIN_CLK,
-                         .ws = (gpio_num_t)PIN_WS,
-                         .dout = I2S_GPIO_UNUSED,
-                         .din = (gpio_num_t)PIN_DATA,
-                         .invert_flags = {.mclk_inv = false, .bclk_inv = false, .ws_inv = false},
-                         },
-        };
-        err = i2s_channel_init_std_mode(temp_i2s_chan, &std_cfg);
-#else
-        if (mic_bclk_pin != I2S_PIN_NO_CHANGE) {
-            // Standard I2S mode
-            gpio_num_t mic_ws_pin = (gpio_num_t)PIN_CLK;
-            i2s_std_config_t i2s_config;
-            memset(&i2s_config, 0, sizeof(i2s_std_config_t));
-#if defined(CONFIG_IDF_TARGET_ESP32P4)
-            i2s_config.clk_cfg.clk_src = i2s_clock_src_t::I2S_CLK_SRC_DEFAULT;
-#else
-            i2s_config.clk_cfg.clk_src = i2s_clock_src_t::I2S_CLK_SRC_PLL_160M;
-#endif
-            i2s_config.clk_cfg.sample_rate_hz = sampleRate; // Custom sample rate
-            i2s_config.clk_cfg.mclk_multiple = i2s_mclk_multiple_t::I2S_MCLK_MULTIPLE_256;
-            i2s_config.slot_cfg.data_bit_width = i2s_data_bit_width_t::I2S_DATA_BIT_WIDTH_16BIT;
-            i2s_config.slot_cfg.slot_bit_width = i2s_slot_bit_width_t::I2S_SLOT_BIT_WIDTH_16BIT;
-            i2s_config.slot_cfg.slot_mode = i2s_slot_mode_t::I2S_SLOT_MODE_MONO;
-            i2s_config.slot_cfg.slot_mask = i2s_std_slot_mask_t::I2S_STD_SLOT_LEFT;
-            i2s_config.slot_cfg.ws_width = 16;
-            i2s_config.slot_cfg.bit_shift = true;
-#if SOC_I2S_HW_VERSION_1
-            i2s_config.slot_cfg.msb_right = false;
-#else
-            i2s_config.slot_cfg.left_align = true;
-            i2s_config.slot_cfg.big_endian = false;
-            i2s_config.slot_cfg.bit_order_lsb = false;
-#endif
-            i2s_config.gpio_cfg.bclk = (gpio_num_t)mic_bclk_pin;
-            i2s_config.gpio_cfg.ws = (gpio_num_t)mic_ws_pin;
-            i2s_config.gpio_cfg.dout = (gpio_num_t)I2S_PIN_NO_CHANGE;
-            i2s_config.gpio_cfg.mclk = (gpio_num_t)I2S_PIN_NO_CHANGE;
-            i2s_config.gpio_cfg.din = (gpio_num_t)PIN_DATA;
-            err = i2s_channel_init_std_mode(temp_i2s_chan, &i2s_config);
-        } else {
-            // PDM mode
-            i2s_pdm_rx_clk_config_t clk_cfg = I2S_PDM_RX_CLK_DEFAULT_CONFIG(sampleRate); // Custom sample rate
-            i2s_pdm_rx_slot_config_t slot_cfg =
-                I2S_PDM_RX_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO);
-            slot_cfg.slot_bit_width = I2S_SLOT_BIT_WIDTH_16BIT;
-
-            const i2s_pdm_rx_config_t pdm_cfg = {
-                .clk_cfg = clk_cfg,
-                .slot_cfg = slot_cfg,
-                .gpio_cfg = {
-                             .clk = (gpio_num_t)PIN_CLK,
-                             .din = (gpio_num_t)PIN_DATA,
-                             .invert_flags = {.clk_inv = false},
-                             },
-            };
-            err = i2s_channel_init_pdm_rx_mode(temp_i2s_chan, &pdm_cfg);
-        }
-#endif
-
-        if (err != ESP_OK) break;
-
-        err = i2s_channel_enable(temp_i2s_chan);
-        if (err != ESP_OK) break;
-
-        // Allocate buffer
-        int16_t *buffer;
-        if (psramFound()) {
-            buffer = (int16_t *)ps_malloc(numSamples * sizeof(int16_t));
-        } else {
-            buffer = (int16_t *)malloc(numSamples * sizeof(int16_t));
-        }
-        if (!buffer) break;
-
-        // Capture samples
-        uint32_t microsPerSample = 1000000 / sampleRate;
-        for (uint32_t i = 0; i < numSamples; i++) {
-            size_t bytesRead = 0;
-            err = i2s_channel_read(temp_i2s_chan, (char *)&buffer[i], sizeof(int16_t), &bytesRead, 1000);
-            if (err != ESP_OK || bytesRead == 0) {
-                free(buffer);
-                goto cleanup;
-            }
-
-            // Timing for sample rate
-            delayMicroseconds(microsPerSample);
-            yield();
-        }
+    int16_t *buffer = nullptr;
+    if (ok) {
+        if (psramFound()) buffer = (int16_t *)ps_malloc(numSamples * sizeof(int16_t));
+        else buffer = (int16_t *)malloc(numSamples * sizeof(int16_t));
+        ok = buffer && micReadSamples(buffer, numSamples, factor);
+    }
 
-        // Apply gain
-        apply_gain_to_buffer(buffer, numSamples, gain);
+    micEnd(gpioInput);
 
-        *outSamples = buffer;
-        ok = true;
+    if (!ok) {
+        free(buffer);
+        return false;
+    }
+    apply_gain_to_buffer(buffer, numSamples, gain);
+    *outSamples = buffer;
+    return true;
+}
 
-    } while (0);
+bool mic_stream_samples(
+    uint32_t frameSize, uint32_t sampleRate, float gain, uint32_t maxMs,
+    std::function<bool(const int16_t *, uint32_t)> onFrame, uint32_t *outSampleRate, uint32_t *outFrames
+) {
+    if (outSampleRate) *outSampleRate = 0;
+    if (outFrames) *outFrames = 0;
+    if (!onFrame || frameSize > 4096 || frameSize < 64) return false;
+    if (gain < 0.5f || gain > 4.0f) return false;
 
-cleanup:
-    // Cleanup I2S
-    if (temp_i2s_chan) {
-        i2s_channel_disable(temp_i2s_chan);
-        i2s_del_channel(temp_i2s_chan);
-    }
-    _setup_codec_mic(false);
+    uint32_t factor = 1;
+    uint32_t hardwareRate = micHardwareRate(sampleRate, factor);
+    if (outSampleRate) *outSampleRate = hardwareRate / factor;
 
-    delay(10);
+    // one frame is reused for the whole stream, internal RAM as the callback reads it right away
+    int16_t *frame = (int16_t *)malloc(frameSize * sizeof(int16_t));
+    if (!frame) return false;
 
-    // Restore GPIO
-    if (gpioInput) {
-        gpio_hold_dis(GPIO_NUM_0);
-        pinMode(GPIO_NUM_0, INPUT);
-    } else {
-        pinMode(GPIO_NUM_0, OUTPUT);
-        digitalWrite(GPIO_NUM_0, LOW);
+    bool gpioInput = false;
+    bool ok = micBegin(hardwareRate, gpioInput);
+    uint32_t frames = 0;
+    const unsigned long startMillis = millis();
+    while (ok) {
+        if (maxMs > 0 && (millis() - startMillis) >= maxMs) break;
+        ok = micReadSamples(frame, frameSize, factor);
+        if (!ok) break;
+        apply_gain_to_buffer(frame, frameSize, gain);
+        frames++;
+        if (!onFrame(frame, frameSize)) break;
     }
+    micEnd(gpioInput);
 
-    ioExpander.turnPinOnOff(IO_EXP_MIC, LOW);
-
+    free(frame);
+    if (outFrames) *outFrames = frames;
     return ok;
 }
 
@@ -1133,7 +1264,7 @@ void mic_test_one_task() {}
 void mic_record_app() {}
 bool mic_record_wav_to_path(
     FS *fs, const String &path, uint32_t max_ms, uint32_t *out_bytes, float gain,
-    std::function<bool(void)> onProgress
+    std::function<bool(const MicRecordStats &)> onProgress, bool adpcm
 ) {
     (void)fs;
     (void)path;
@@ -1141,6 +1272,7 @@ bool mic_record_wav_to_path(
     (void)out_bytes;
     (void)gain;
     (void)onProgress;
+    (void)adpcm;
     return false;
 }
 bool mic_capture_samples(
@@ -1153,4 +1285,17 @@ bool mic_capture_samples(
     (void)outSampleRate;
     return false;
 }
+bool mic_stream_samples(
+    uint32_t frameSize, uint32_t sampleRate, float gain, uint32_t maxMs,
+    std::function<bool(const int16_t *, uint32_t)> onFrame, uint32_t *outSampleRate, uint32_t *outFrames
+) {
+    (void)frameSize;
+    (void)sampleRate;
+    (void)gain;
+    (void)maxMs;
+    (void)onFrame;
+    (void)outSampleRate;
+    (void)outFrames;
+    return false;
+}
 #endif
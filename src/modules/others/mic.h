@@ -48,6 +48,19 @@ struct MicConfig {
     uint32_t record_time_ms; ///< Recording duration (0 = unlimited)
     float gain;              ///< Audio gain multiplier (0.5-4.0, default 2.0)
     bool stealth_mode;       ///< Enable low-brightness mode
+    bool adpcm;              ///< Record IMA-ADPCM (~4x smaller) instead of 16-bit PCM
+};
+
+/**
+ * @brief Live recording counters
+ * @note Passed to the mic_record_wav_to_path() progress callback
+ */
+struct MicRecordStats {
+    uint32_t elapsedMs; ///< Time since the recording started
+    uint32_t bytes;     ///< File size so far, header included
+    uint32_t overruns;  ///< Audio blocks lost because the buffer was full
+    size_t bufferUsed;  ///< Bytes waiting for the card
+    size_t bufferSize;  ///< Buffer capacity
 };
 
 /* Mic */
@@ -55,7 +68,7 @@ void mic_test();
 void mic_test_one_task();
 bool mic_record_wav_to_path(
     FS *fs, const String &path, uint32_t max_ms, uint32_t *out_bytes, float gain,
-    std::function<bool(void)> onProgress = nullptr
+    std::function<bool(const MicRecordStats &)> onProgress = nullptr, bool adpcm = false
 );
 void mic_record_app(); // Mic GUI app @Senape3000
 
@@ -64,7 +77,8 @@ void mic_record_app(); // Mic GUI app @Senape3000
  * Returns array of 16-bit PCM samples
  *
  * @param numSamples - Number of samples to capture (64-4096)
- * @param sampleRate - Sample rate in Hz (8000, 16000, 22050, 32000, 44100, 48000)
+ * @param sampleRate - Sample rate in Hz (8000, 16000, 22050, 32000, 44100, 48000, or any rate
+ *                     one of them is a multiple of, which is reached by decimation)
  * @param gain - Audio gain multiplier (0.5-4.0)
  * @param outSamples - [OUT] Pointer to sample buffer (caller must free())
  * @param outSampleRate - [OUT] Actual sample rate used
@@ -73,4 +87,22 @@ void mic_record_app(); // Mic GUI app @Senape3000
 bool mic_capture_samples(
     uint32_t numSamples, uint32_t sampleRate, float gain, int16_t **outSamples, uint32_t *outSampleRate
 );
+
+/**
+ * Stream audio from microphone in fixed-size frames
+ * The frame buffer is reused, onFrame must copy what it wants to keep
+ *
+ * @param frameSize - Samples per frame (64-4096)
+ * @param sampleRate - Sample rate in Hz, same values as mic_capture_samples()
+ * @param gain - Audio gain multiplier (0.5-4.0)
+ * @param maxMs - Stream duration (0 = until onFrame returns false)
+ * @param onFrame - Called with each frame, return false to stop
+ * @param outSampleRate - [OUT] Actual sample rate used
+ * @param outFrames - [OUT] Frames delivered
+ * @return true if the stream ended without an I2S error
+ */
+bool mic_stream_samples(
+    uint32_t frameSize, uint32_t sampleRate, float gain, uint32_t maxMs,
+    std::function<bool(const int16_t *, uint32_t)> onFrame, uint32_t *outSampleRate, uint32_t *outFrames
+);
 #endif
@@ -0,0 +1,32 @@
+#ifndef RF_CODES_H
+#define RF_CODES_H
+
+#include <Arduino.h>
+#include <vector>
+
+struct RfCodes {
+    uint32_t frequency = 0;
+    uint32_t serial = 0;
+    uint64_t key = 0;
+    uint16_t cnt = 0;
+    uint32_t fix = 0;
+    uint32_t hop = 0;
+    uint32_t encrypted = 0;
+    uint8_t btn = 0;
+    String mf_name = "Unknown";
+    String protocol = "";
+    String preset = "";
+    String data = "";
+    int te = 0;
+    std::vector<int> indexed_durations;
+    String filepath = "";
+    int Bit = 0;
+    int BitRAW = 0;
+
+    bool keeloq_check_decrypt(uint32_t decrypt);
+    bool keeloq_check_decrypt_centurion(uint32_t decrypt);
+
+    void keeloq_step(uint16_t step);
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "core/led_control.h"
 #include "core/type_convertion.h"
 #include "rf_utils.h"
+#include "sub_file.h"
 #include <RCSwitch.h>
 
 #define CLOSE_MENU 3
@@ -221,8 +222,6 @@ void display_info(RfCodes &data) {
 bool readSubFile(FS *fs, String filepath, RfCodes &data) {
     struct RfCodes selected_code;
     File databaseFile;
-    String line;
-    String txt;
 
     if (!fs) return false;
 
@@ -236,35 +235,10 @@ bool readSubFile(FS *fs, String filepath, RfCodes &data) {
     Serial.println("Opened sub file.");
     selected_code.filepath = filepath.substring(1 + filepath.lastIndexOf("/"));
 
-    if (!databaseFile) Serial.println("Fail opening file");
     // Store the code(s) in the signal
-    while (databaseFile.available()) {
-        line = databaseFile.readStringUntil('\n');
-        txt = line.substring(line.indexOf(":") + 1);
-        if (txt.endsWith("\r")) txt.remove(txt.length() - 1);
-        txt.trim();
-        if (line.startsWith("Protocol:")) selected_code.protocol = txt;
-        if (line.startsWith("Preset:")) selected_code.preset = txt;
-        if (line.startsWith("Frequency:")) selected_code.frequency = txt.toInt();
-        if (line.startsWith("TE:")) selected_code.te = txt.toInt();
-        if (line.startsWith("Bit:")) bitList.push_back(txt.toInt()); // selected_code.Bit = txt.toInt();
-
-        if (line.startsWith("Manufacturer:")) selected_code.mf_name = txt;
-        if (line.startsWith("Serial:")) selected_code.serial = hexStringToDecimal(txt.c_str());
-        if (line.startsWith("Button:")) selected_code.btn = txt.toInt();
-        if (line.startsWith("Counter:")) selected_code.cnt = txt.toInt();
-
-        if (line.startsWith("Bit_RAW:"))
-            bitRawList.push_back(txt.toInt()); // selected_code.BitRAW = txt.toInt();
-        if (line.startsWith("Key:"))
-            keyList.push_back(
-                hexStringToDecimal(txt.c_str())
-            ); // selected_code.key = hexStringToDecimal(txt.c_str());
-        if (line.startsWith("RAW_Data:") || line.startsWith("Data_RAW:"))
-            rawDataList.push_back(txt); // selected_code.data = txt;
-
-        if (check(EscPress)) break;
-    }
+    parseSubFile(databaseFile, selected_code, bitList, bitRawList, keyList, rawDataList, [] {
+        return check(EscPress);
+    });
 
     databaseFile.close();
 
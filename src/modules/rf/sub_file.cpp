@@ -0,0 +1,32 @@
+#include "sub_file.h"
+#include "core/type_convertion.h"
+
+void parseSubFile(
+    File &file, RfCodes &code, std::vector<int> &bits, std::vector<int> &bitRaws, std::vector<uint64_t> &keys,
+    std::vector<String> &rawData, const std::function<bool()> &cancel
+) {
+    String line;
+    String txt;
+    while (file.available()) {
+        line = file.readStringUntil('\n');
+        txt = line.substring(line.indexOf(":") + 1);
+        if (txt.endsWith("\r")) txt.remove(txt.length() - 1);
+        txt.trim();
+        if (line.startsWith("Protocol:")) code.protocol = txt;
+        if (line.startsWith("Preset:")) code.preset = txt;
+        if (line.startsWith("Frequency:")) code.frequency = txt.toInt();
+        if (line.startsWith("TE:")) code.te = txt.toInt();
+        if (line.startsWith("Bit:")) bits.push_back(txt.toInt());
+
+        if (line.startsWith("Manufacturer:")) code.mf_name = txt;
+        if (line.startsWith("Serial:")) code.serial = hexStringToDecimal(txt.c_str());
+        if (line.startsWith("Button:")) code.btn = txt.toInt();
+        if (line.startsWith("Counter:")) code.cnt = txt.toInt();
+
+        if (line.startsWith("Bit_RAW:")) bitRaws.push_back(txt.toInt());
+        if (line.startsWith("Key:")) keys.push_back(hexStringToDecimal(txt.c_str()));
+        if (line.startsWith("RAW_Data:") || line.startsWith("Data_RAW:")) rawData.push_back(txt);
+
+        if (cancel && cancel()) break;
+    }
+}
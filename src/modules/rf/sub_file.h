@@ -0,0 +1,15 @@
+#ifndef __SUB_FILE_H__
+#define __SUB_FILE_H__
+
+#include "rf_codes.h"
+#include <FS.h>
+#include <functional>
+
+// Reads the fields of a Flipper .sub file into `code`. The signals it holds are appended, one per
+// line, to the lists txSubFile() sends from. `cancel` is polled once per line.
+void parseSubFile(
+    File &file, RfCodes &code, std::vector<int> &bits, std::vector<int> &bitRaws, std::vector<uint64_t> &keys,
+    std::vector<String> &rawData, const std::function<bool()> &cancel = nullptr
+);
+
+#endif
@@ -0,0 +1,110 @@
+#include "packet_ring.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+bool PacketRing::begin(size_t capacity, size_t internalCapacity) {
+    end();
+    capacity &= ~(size_t)3;
+    if (capacity < 64) return false;
+    _buf = (uint8_t *)heap_caps_malloc(capacity, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+    if (!_buf) {
+        // No PSRAM, settle for a smaller internal buffer
+        capacity = capacity > internalCapacity ? internalCapacity & ~(size_t)3 : capacity;
+        if (capacity < 64) return false;
+        _buf = (uint8_t *)heap_caps_malloc(capacity, MALLOC_CAP_8BIT);
+    }
+    if (!_buf) return false;
+    _cap = capacity;
+    _head.store(0, std::memory_order_relaxed);
+    _tail.store(0, std::memory_order_relaxed);
+    resetStats();
+    return true;
+}
+
+void PacketRing::end() {
+    if (_buf) heap_caps_free(_buf);
+    _buf = nullptr;
+    _cap = 0;
+    _head.store(0, std::memory_order_relaxed);
+    _tail.store(0, std::memory_order_relaxed);
+}
+
+uint8_t *PacketRing::reserve(size_t len) {
+    if (!_buf) return nullptr;
+    const size_t need = recordSize(len);
+    const uint32_t h = _head.load(std::memory_order_relaxed);
+    const uint32_t t = _tail.load(std::memory_order_acquire);
+
+    // head == tail means empty, so the producer must never catch up with the tail
+    if (h >= t) {
+        const size_t toEnd = _cap - h;
+        if (need < toEnd || (need == toEnd && t > 0)) {
+            _resPos = h;
+            _resWrap = false;
+        } else if (need < t) {
+            _resPos = 0;
+            _resWrap = true;
+        } else {
+            _drops++;
+            return nullptr;
+        }
+    } else if (need < t - h) {
+        _resPos = h;
+        _resWrap = false;
+    } else {
+        _drops++;
+        return nullptr;
+    }
+    _resLen = len;
+    return _buf + _resPos + sizeof(uint32_t);
+}
+
+void PacketRing::commit() {
+    const uint32_t h = _head.load(std::memory_order_relaxed);
+    if (_resWrap) memcpy(_buf + h, &WRAP_MARKER, sizeof(uint32_t));
+    memcpy(_buf + _resPos, &_resLen, sizeof(uint32_t));
+
+    uint32_t next = _resPos + recordSize(_resLen);
+    if (next >= _cap) next = 0;
+    _head.store(next, std::memory_order_release);
+
+    _records++;
+    size_t u = used();
+    if (u > _highWater) _highWater = u;
+}
+
+const uint8_t *PacketRing::peek(size_t &len) {
+    if (!_buf) return nullptr;
+    uint32_t t = _tail.load(std::memory_order_relaxed);
+    const uint32_t h = _head.load(std::memory_order_acquire);
+    if (t == h) return nullptr;
+
+    uint32_t recLen;
+    memcpy(&recLen, _buf + t, sizeof(uint32_t));
+    if (recLen == WRAP_MARKER) {
+        t = 0;
+        _tail.store(0, std::memory_order_release);
+        if (t == h) return nullptr;
+        memcpy(&recLen, _buf, sizeof(uint32_t));
+    }
+    _readLen = len = recLen;
+    return _buf + t + sizeof(uint32_t);
+}
+
+void PacketRing::release() {
+    uint32_t next = _tail.load(std::memory_order_relaxed) + recordSize(_readLen);
+    if (next >= _cap) next = 0;
+    _tail.store(next, std::memory_order_release);
+}
+
+size_t PacketRing::used() const {
+    const uint32_t h = _head.load(std::memory_order_acquire);
+    const uint32_t t = _tail.load(std::memory_order_acquire);
+    return h >= t ? h - t : _cap - t + h;
+}
+
+void PacketRing::resetStats() {
+    _drops = 0;
+    _records = 0;
+    _highWater = used();
+}
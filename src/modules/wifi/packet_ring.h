@@ -0,0 +1,64 @@
+#ifndef __PACKET_RING_H__
+#define __PACKET_RING_H__
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Single producer / single consumer ring of variable sized records.
+// The buffer is allocated once (PSRAM first) so the producer, usually the
+// promiscuous RX callback, never touches the heap. Records are contiguous in
+// memory: one that would cross the end of the buffer starts again at offset 0.
+//
+// Producer:  uint8_t *p = ring.reserve(len); fill p; ring.commit();
+// Consumer:  const uint8_t *p = ring.peek(len); use p; ring.release();
+class PacketRing {
+public:
+    PacketRing() = default;
+    ~PacketRing() { end(); }
+    PacketRing(const PacketRing &) = delete;
+    PacketRing &operator=(const PacketRing &) = delete;
+
+    // Allocates `capacity` bytes (rounded down to 4), PSRAM first. Without PSRAM at most
+    // `internalCapacity` bytes are taken from internal RAM. Returns false if no memory was found.
+    bool begin(size_t capacity, size_t internalCapacity = 32768);
+    void end();
+    bool ready() const { return _buf != nullptr; }
+
+    // Producer side. reserve() returns nullptr (and counts a drop) when the record doesn't fit.
+    uint8_t *reserve(size_t len);
+    void commit();
+
+    // Consumer side. peek() returns nullptr when the ring is empty.
+    const uint8_t *peek(size_t &len);
+    void release();
+
+    bool empty() const { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+    size_t capacity() const { return _cap; }
+    size_t used() const;
+    size_t highWater() const { return _highWater; }
+    uint32_t drops() const { return _drops; }
+    uint32_t records() const { return _records; }
+    void resetStats();
+
+private:
+    static const uint32_t WRAP_MARKER = 0xFFFFFFFF;
+    static size_t recordSize(size_t len) { return (sizeof(uint32_t) + len + 3) & ~(size_t)3; }
+
+    uint8_t *_buf = nullptr;
+    size_t _cap = 0;
+    std::atomic<uint32_t> _head{0}; // written by producer only
+    std::atomic<uint32_t> _tail{0}; // written by consumer only
+
+    // Pending reservation, producer only
+    uint32_t _resPos = 0;
+    uint32_t _resLen = 0;
+    bool _resWrap = false;
+
+    size_t _readLen = 0; // length of the record handed out by peek()
+
+    volatile uint32_t _drops = 0;
+    volatile uint32_t _records = 0;
+    volatile size_t _highWater = 0;
+};
+
+#endif
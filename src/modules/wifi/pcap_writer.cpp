@@ -0,0 +1,235 @@
+#include "pcap_writer.h"
+#include <algorithm>
+#include <esp_heap_caps.h>
+
+namespace {
+struct __attribute__((packed)) PcapFileHeader {
+    uint32_t magic_number;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+};
+
+struct __attribute__((packed)) PcapRecordHeader {
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+};
+
+// pcapng Section Header Block followed by one Interface Description Block, no options
+struct __attribute__((packed)) PcapNgFileHeader {
+    uint32_t shb_type;
+    uint32_t shb_len;
+    uint32_t byte_order_magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int64_t section_len;
+    uint32_t shb_len_trailer;
+    uint32_t idb_type;
+    uint32_t idb_len;
+    uint16_t link_type;
+    uint16_t reserved;
+    uint32_t snaplen;
+    uint32_t idb_len_trailer;
+};
+
+// Enhanced Packet Block up to the packet data
+struct __attribute__((packed)) PcapNgPacketHeader {
+    uint32_t type;
+    uint32_t len;
+    uint32_t interface_id;
+    uint32_t ts_high;
+    uint32_t ts_low;
+    uint32_t cap_len;
+    uint32_t orig_len;
+};
+
+const size_t RADIOTAP_MAX_LEN = 13;
+
+uint16_t channelToFreq(uint8_t channel) {
+    if (channel == 14) return 2484;
+    if (channel < 14) return 2407 + 5 * channel;
+    return 5000 + 5 * channel;
+}
+} // namespace
+
+PcapWriter::PcapWriter(size_t blockSize, uint32_t flushIntervalMs)
+    : _blockSize(blockSize < 512 ? 512 : blockSize), _flushIntervalMs(flushIntervalMs) {}
+
+PcapWriter::~PcapWriter() { close(); }
+
+size_t PcapWriter::fileHeaderSize(PcapFormat format) {
+    return format == PcapFormat::PcapNg ? sizeof(PcapNgFileHeader) : sizeof(PcapFileHeader);
+}
+
+size_t PcapWriter::buildFileHeader(uint8_t *out, PcapFormat format, uint16_t linkType) {
+    if (format == PcapFormat::PcapNg) {
+        PcapNgFileHeader h;
+        h.shb_type = 0x0A0D0D0A;
+        h.shb_len = h.shb_len_trailer = 28;
+        h.byte_order_magic = 0x1A2B3C4D;
+        h.version_major = 1;
+        h.version_minor = 0;
+        h.section_len = -1;
+        h.idb_type = 1;
+        h.idb_len = h.idb_len_trailer = 20;
+        h.link_type = linkType;
+        h.reserved = 0;
+        h.snaplen = SNAPLEN;
+        memcpy(out, &h, sizeof(h));
+        return sizeof(h);
+    }
+    PcapFileHeader h;
+    h.magic_number = 0xa1b2c3d4;
+    h.version_major = 2;
+    h.version_minor = 4;
+    h.thiszone = 0;
+    h.sigfigs = 0;
+    h.snaplen = SNAPLEN;
+    h.network = linkType;
+    memcpy(out, &h, sizeof(h));
+    return sizeof(h);
+}
+
+// Minimal radiotap header: channel (bit 3) and dBm antenna signal (bit 5)
+size_t PcapWriter::buildRadiotap(uint8_t *out, const PcapRadioInfo *radio) {
+    uint32_t present = radio ? (1 << 3) | (1 << 5) : 0;
+    uint16_t len = radio ? RADIOTAP_MAX_LEN : 8;
+    out[0] = 0; // version
+    out[1] = 0; // pad
+    memcpy(out + 2, &len, sizeof(len));
+    memcpy(out + 4, &present, sizeof(present));
+    if (radio) {
+        uint16_t freq = radio->channel ? channelToFreq(radio->channel) : 0;
+        uint16_t flags = radio->channel == 0 ? 0 : radio->channel <= 14 ? 0x0080 : 0x0100;
+        memcpy(out + 8, &freq, sizeof(freq));
+        memcpy(out + 10, &flags, sizeof(flags));
+        out[12] = (uint8_t)radio->rssi;
+    }
+    return len;
+}
+
+bool PcapWriter::writeFileHeader(File &file, PcapFormat format, uint16_t linkType) {
+    if (!file) return false;
+    uint8_t header[sizeof(PcapNgFileHeader)];
+    size_t len = buildFileHeader(header, format, linkType);
+    return file.write(header, len) == len;
+}
+
+bool PcapWriter::open(FS &fs, const String &path, PcapFormat format, bool append, uint16_t linkType) {
+    close();
+    if (!_buf) {
+        // Internal DMA capable RAM lets the SD driver write without a bounce buffer
+        _buf = (uint8_t *)heap_caps_malloc(_blockSize, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!_buf) _buf = (uint8_t *)heap_caps_malloc(_blockSize, MALLOC_CAP_8BIT);
+        if (!_buf) return false;
+    }
+    _file = fs.open(path, append ? FILE_APPEND : FILE_WRITE);
+    if (!_file) {
+        close();
+        return false;
+    }
+    _path = path;
+    _format = format;
+    _linkType = linkType;
+    _fill = 0;
+    _packets = 0;
+    _fileWrites = 0;
+    _fileOffset = append ? _file.size() : 0;
+    _lastFlush = millis();
+    if (_fileOffset == 0) {
+        uint8_t header[sizeof(PcapNgFileHeader)];
+        size_t len = buildFileHeader(header, format, linkType);
+        return put(header, len);
+    }
+    return true;
+}
+
+void PcapWriter::close() {
+    if (_file) {
+        flush();
+        _file.close();
+    }
+    _fill = 0;
+    _path = "";
+    if (_buf) heap_caps_free(_buf);
+    _buf = nullptr;
+}
+
+bool PcapWriter::writeOut(size_t len) {
+    size_t written = _file.write(_buf, len);
+    _fileOffset += written;
+    _fileWrites++;
+    _fill = 0;
+    return written == len;
+}
+
+bool PcapWriter::put(const void *data, size_t len) {
+    const uint8_t *src = (const uint8_t *)data;
+    bool ok = true;
+    while (len > 0) {
+        size_t limit = blockLimit();
+        size_t n = std::min(limit - _fill, len);
+        memcpy(_buf + _fill, src, n);
+        _fill += n;
+        src += n;
+        len -= n;
+        if (_fill == limit) ok &= writeOut(_fill);
+    }
+    return ok;
+}
+
+bool PcapWriter::writePacket(
+    const uint8_t *data, uint32_t len, uint32_t ts_sec, uint32_t ts_usec, const PcapRadioInfo *radio
+) {
+    if (!_file || !_buf || !data) return false;
+
+    uint8_t rt[RADIOTAP_MAX_LEN];
+    size_t rtLen = _linkType == LINKTYPE_IEEE802_11_RADIOTAP ? buildRadiotap(rt, radio) : 0;
+    uint32_t capLen = len + rtLen;
+    bool ok;
+
+    if (_format == PcapFormat::PcapNg) {
+        static const uint8_t zeros[3] = {0, 0, 0};
+        uint32_t pad = (4 - (capLen & 3)) & 3;
+        uint64_t ts = (uint64_t)ts_sec * 1000000ULL + ts_usec; // default if_tsresol is microseconds
+        PcapNgPacketHeader h;
+        h.type = 6;
+        h.len = sizeof(PcapNgPacketHeader) + capLen + pad + sizeof(uint32_t);
+        h.interface_id = 0;
+        h.ts_high = (uint32_t)(ts >> 32);
+        h.ts_low = (uint32_t)ts;
+        h.cap_len = h.orig_len = capLen;
+        ok = put(&h, sizeof(h));
+        if (rtLen) ok &= put(rt, rtLen);
+        ok &= put(data, len);
+        if (pad) ok &= put(zeros, pad);
+        ok &= put(&h.len, sizeof(h.len));
+    } else {
+        PcapRecordHeader h = {ts_sec, ts_usec, capLen, capLen};
+        ok = put(&h, sizeof(h));
+        if (rtLen) ok &= put(rt, rtLen);
+        ok &= put(data, len);
+    }
+    _packets++;
+    return ok;
+}
+
+bool PcapWriter::flush() {
+    if (!_file) return false;
+    bool ok = true;
+    if (_fill) ok = writeOut(_fill);
+    _file.flush();
+    _lastFlush = millis();
+    return ok;
+}
+
+bool PcapWriter::flushIfDue() {
+    if (!_file || !_fill) return true;
+    if (millis() - _lastFlush < _flushIntervalMs) return true;
+    return flush();
+}
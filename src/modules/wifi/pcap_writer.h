@@ -0,0 +1,83 @@
+#ifndef __PCAP_WRITER_H__
+#define __PCAP_WRITER_H__
+#include <Arduino.h>
+#include <FS.h>
+
+enum class PcapFormat : uint8_t {
+    Pcap,   // classic libpcap, what most handshake tools expect
+    PcapNg, // pcapng, one section and one interface
+};
+
+// Per packet radio metadata, written as a radiotap header when the
+// writer was opened with LINKTYPE_IEEE802_11_RADIOTAP
+struct PcapRadioInfo {
+    int8_t rssi = 0;     // dBm
+    uint8_t channel = 0; // 0 = unknown
+};
+
+// Buffered capture file writer.
+// Records are coalesced in RAM and written in whole blocks aligned to the
+// block size, so the SD card sees a few large writes instead of several tiny
+// ones per packet. The buffer is pushed on a size threshold (block full) or a
+// time threshold (flushIfDue), and always on flush()/close().
+class PcapWriter {
+public:
+    static const uint16_t LINKTYPE_IEEE802_11 = 105;
+    static const uint16_t LINKTYPE_IEEE802_11_RADIOTAP = 127;
+    static const uint32_t SNAPLEN = 2500;
+
+    explicit PcapWriter(size_t blockSize = 4096, uint32_t flushIntervalMs = 1000);
+    ~PcapWriter();
+    PcapWriter(const PcapWriter &) = delete;
+    PcapWriter &operator=(const PcapWriter &) = delete;
+
+    // Opens (or creates) a capture file. With append=true and a non empty file the
+    // existing header is kept, the caller must use the format the file was created with.
+    bool open(
+        FS &fs, const String &path, PcapFormat format, bool append = false,
+        uint16_t linkType = LINKTYPE_IEEE802_11
+    );
+    void close();
+    bool isOpen() const { return _file; }
+    const String &path() const { return _path; }
+    PcapFormat format() const { return _format; }
+
+    bool writePacket(
+        const uint8_t *data, uint32_t len, uint32_t ts_sec, uint32_t ts_usec,
+        const PcapRadioInfo *radio = nullptr
+    );
+    bool flush();
+    bool flushIfDue();
+
+    size_t pending() const { return _fill; }
+    uint32_t packets() const { return _packets; }
+    uint32_t fileWrites() const { return _fileWrites; }
+
+    // Writes a file header straight to an already open file (no buffering)
+    static bool writeFileHeader(
+        File &file, PcapFormat format = PcapFormat::Pcap, uint16_t linkType = LINKTYPE_IEEE802_11
+    );
+    static size_t fileHeaderSize(PcapFormat format);
+
+private:
+    bool put(const void *data, size_t len);
+    bool writeOut(size_t len);
+    size_t blockLimit() const { return _blockSize - (_fileOffset % _blockSize); }
+    static size_t buildFileHeader(uint8_t *out, PcapFormat format, uint16_t linkType);
+    static size_t buildRadiotap(uint8_t *out, const PcapRadioInfo *radio);
+
+    File _file;
+    String _path;
+    PcapFormat _format = PcapFormat::Pcap;
+    uint16_t _linkType = LINKTYPE_IEEE802_11;
+    uint8_t *_buf = nullptr;
+    size_t _blockSize;
+    size_t _fill = 0;
+    uint64_t _fileOffset = 0;
+    uint32_t _flushIntervalMs;
+    uint32_t _lastFlush = 0;
+    uint32_t _packets = 0;
+    uint32_t _fileWrites = 0;
+};
+
+#endif
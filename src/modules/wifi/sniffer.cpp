@@ -22,7 +22,7 @@
 #include "nvs_flash.h"
 #include <algorithm>
 #include <ctype.h>
-#include <map>
+#include <new>
 #include <set>
 #include <vector>
 
@@ -41,6 +41,8 @@
 #include <SPI.h>
 #include <SdFat.h>
 #endif
+#include "modules/wifi/packet_ring.h"
+#include "modules/wifi/pcap_writer.h"
 #include "modules/wifi/wifi_atks.h" // to use deauth frames and cmds
 
 //===== SETTINGS =====//
@@ -68,38 +70,62 @@ uint32_t beacon_frames = 0;
 uint32_t start_time = 0;
 long deauth_tmp = 0;
 
-File _pcap_file;
-File _deauth_file;
+// Capture files go through buffered writers, owned by the writer task under fileMutex
+#if defined(BOARD_HAS_PSRAM)
+const size_t PCAP_BLOCK_SIZE = 8192;
+#else
+const size_t PCAP_BLOCK_SIZE = 4096;
+#endif
+PcapWriter rawWriter(PCAP_BLOCK_SIZE);
+PcapWriter deauthWriter(PCAP_BLOCK_SIZE);
+PcapWriter hsWriter(1024, 500); // current handshake file, kept open while frames keep coming
+PcapFormat captureFormat = PcapFormat::Pcap;
 bool deauthFileOpen = false;
 SnifferMode currentMode = SnifferMode::HandshakesOnly;
 bool sdDetected = false;
 FS *activeFs = &LittleFS;
 SemaphoreHandle_t fileMutex = nullptr;
-QueueHandle_t snifferQueue = nullptr;
+PacketRing snifferRing;
 TaskHandle_t snifferWriterHandle = nullptr;
 StaticSemaphore_t fileMutexBuffer;
 SemaphoreHandle_t handshakeMutex = nullptr;
 StaticSemaphore_t handshakeMutexBuffer;
-std::set<BeaconList> registeredBeacons;
 std::set<String> SavedHS; // Saves the MAC of beacon HS detected in the session
 String filename = "/BrucePCAP/" + (String)FILENAME + ".pcap";
 String deauthFilename = "/BrucePCAP/deauth_0.pcap";
 int deauthFileIndex = 0;
 int rawFileIndex = 0;
-std::map<uint64_t, String> beaconSsidCache;
 const size_t MAX_CAPTURE_SSID_LEN = 32;
-const size_t SNIFFER_QUEUE_DEPTH = 48;
+// Preallocated capture ring, the RX callback copies frames straight into it
+#if defined(BOARD_HAS_PSRAM)
+const size_t SNIFFER_RING_SIZE = 256 * 1024;
+#else
+const size_t SNIFFER_RING_SIZE = 24 * 1024;
+#endif
+const size_t SNIFFER_RING_INTERNAL_SIZE = 24 * 1024; // when the PSRAM allocation fails
+const size_t SNIFFER_WRITER_BATCH = 32; // records written per file lock
 std::set<uint64_t> handshakeReadyBssids;
 portMUX_TYPE handshakeReadyMux = portMUX_INITIALIZER_UNLOCKED;
 std::set<uint64_t> handshakeBeaconLogged;
 
-// --- New globals for beacon last-seen tracking & cleanup ---
-std::map<uint64_t, uint32_t> beaconLastSeen; // key = macToKey(mac) -> last seen millis()
-const uint32_t BEACON_TIMEOUT_MS = 120000;   // 2 minutes
+// APs heard in beacons. The table has a fixed size so the RX callback never allocates: when it is
+// full, the AP not heard from for the longest time makes room for the new one.
+const size_t SNIFFER_MAX_BEACONS = 64;
+struct BeaconEntry {
+    uint64_t key = 0;      // macToKey(mac)
+    uint32_t lastSeen = 0; // millis()
+    uint8_t mac[6] = {0};
+    uint8_t channel = 0;
+    char ssid[MAX_CAPTURE_SSID_LEN + 1] = {0};
+};
+BeaconEntry beaconTable[SNIFFER_MAX_BEACONS];
+size_t beaconCount = 0;
+portMUX_TYPE beaconMux = portMUX_INITIALIZER_UNLOCKED;
+const uint32_t BEACON_TIMEOUT_MS = 120000; // 2 minutes
 unsigned long lastBeaconCleanup = 0;
 
+// Ring record: this header, then a wifi_promiscuous_pkt_t (rx_ctrl + payload) copy
 struct SnifferQueueItem {
-    wifi_promiscuous_pkt_t *packet = nullptr;
     uint32_t ts_sec = 0;
     uint32_t ts_usec = 0;
     uint16_t raw_len = 0;
@@ -112,6 +138,10 @@ struct SnifferQueueItem {
     bool saveDeauth = false;
     uint8_t bssid[6] = {0};
     char ssid[MAX_CAPTURE_SSID_LEN + 1] = {0};
+
+    wifi_promiscuous_pkt_t *packet() const {
+        return (wifi_promiscuous_pkt_t *)((uint8_t *)this + sizeof(SnifferQueueItem));
+    }
 };
 
 struct FrameInfo {
@@ -122,17 +152,15 @@ struct FrameInfo {
     int eapolMsgNum = -1;
     uint8_t apAddr[6] = {0};
     uint64_t apKey = 0;
-    String ssid;
+    char ssid[MAX_CAPTURE_SSID_LEN + 1] = {0};
 };
 
 static bool ensureSnifferBackend();
 static void snifferWriterTask(void *param);
-static wifi_promiscuous_pkt_t *duplicatePacket(const wifi_promiscuous_pkt_t *pkt, uint16_t length);
-static void releasePacketCopy(wifi_promiscuous_pkt_t *packet);
 static uint64_t macToKey(const void *mac); // changed to const void *
 static void copyMac(uint8_t *dest, const uint8_t *src);
-static String extractSsid(const wifi_promiscuous_pkt_t *packet);
-static void copySsidToBuffer(const String &ssid, char *buffer, size_t len);
+static size_t extractSsid(const wifi_promiscuous_pkt_t *packet, char *out, size_t outLen);
+static void copySsidToBuffer(const char *ssid, char *buffer, size_t len);
 static String sanitizeSsid(const char *ssid);
 static String macToHex(const uint8_t *mac);
 static String buildHandshakePath(const uint8_t *mac, const char *ssid);
@@ -148,6 +176,7 @@ static void ensureDirectories(FS &Fs);
 static void openDeauthFile(FS &Fs);
 static void closeRawFile();
 static void closeDeauthFile();
+static void closeHandshakeFile();
 static bool lockFileMutex(TickType_t ticks = portMAX_DELAY);
 static void unlockFileMutex();
 static String currentModeString();
@@ -155,12 +184,14 @@ static bool rawCaptureEnabled();
 static bool handshakeCaptureEnabled();
 static bool deauthCaptureEnabled();
 static FrameInfo analyzeFrame(wifi_promiscuous_pkt_t *pkt);
-static String resolveSsidForFrame(FrameInfo &info, const wifi_promiscuous_pkt_t *packet);
-static void registerBeacon(const uint8_t *apAddr);
+static void resolveSsidForFrame(FrameInfo &info, const wifi_promiscuous_pkt_t *packet);
+static void registerBeacon(const FrameInfo &info);
+static void clearBeacons();
 
 // --- New helper prototypes ---
 static void cleanupStaleBeacons();
 static size_t countActiveBeaconsOnChannel(uint8_t channel);
+static size_t beaconMacsOnChannel(uint8_t channel, uint8_t (*macs)[6], size_t maxItems);
 static std::vector<String> recentSsidsOnChannel(uint8_t channel, size_t maxItems = 5);
 
 // --Deauth sent clean
@@ -262,6 +293,7 @@ typedef struct pcaprec_hdr_s {
     uint32_t orig_len; /* longueur réelle du paquet */
 } pcaprec_hdr_t;
 
+// Called by the writer task with fileMutex held
 void saveHandshake(const wifi_promiscuous_pkt_t *packet, bool beacon, FS &Fs, const char *ssidLabel) {
     // Construire le nom du fichier en utilisant les adresses MAC de l'AP et du client
     const uint8_t *addr1 = packet->payload + 4;  // Adresse du destinataire (Adresse 1)
@@ -283,41 +315,36 @@ void saveHandshake(const wifi_promiscuous_pkt_t *packet, bool beacon, FS &Fs, co
 
     // Si probe est true et que le fichier n'existe pas, ignorer l'enregistrement
     if (beacon && !fichierExiste) { return; }
+    if (beacon) {
+        uint64_t beaconKey = macToKey(apAddr);
+        if (handshakeBeaconRecorded(beaconKey)) { return; }
+        registerHandshakeBeacon(beaconKey);
+    }
 
+    // Handshake files stay classic pcap, wifi_atks pre-creates them with that header.
     // Ouvrir le fichier en mode ajout si existant sinon en mode écriture
-    File fichierPcap = Fs.open(
-        filePath, fichierExiste ? FILE_APPEND : FILE_WRITE
-    ); // if the file already exists in the new session, will overwrite it
-    if (!fichierPcap) {
-        Serial.println("Fail creating the EAPOL/Handshake PCAP file");
-        return;
+    // (if the file already exists in the new session, will overwrite it)
+    if (!hsWriter.isOpen() || hsWriter.path() != filePath) {
+        if (!hsWriter.open(Fs, filePath, PcapFormat::Pcap, fichierExiste)) {
+            Serial.println("Fail creating the EAPOL/Handshake PCAP file");
+            return;
+        }
     }
 
-    if (!beacon && !fichierExiste) {
+    if (!fichierExiste) {
         // Serial.println("New EAPOL/Handshake PCAP file, writing header");
         registerHandshakeRecord(filePath);
         num_HS++;
-        writeHeader(fichierPcap);
         markHandshakeReady(macToKey(apAddr));
     }
-    if (beacon && fichierExiste) {
-        uint64_t beaconKey = macToKey(apAddr);
-        if (handshakeBeaconRecorded(beaconKey)) {
-            fichierPcap.close();
-            return;
-        }
-        registerHandshakeBeacon(beaconKey);
-    }
 
     // Écrire l'en-tête du paquet et le paquet lui-même dans le fichier
-    pcaprec_hdr_t pcap_packet_header;
-    pcap_packet_header.ts_sec = packet->rx_ctrl.timestamp / 1000000;
-    pcap_packet_header.ts_usec = packet->rx_ctrl.timestamp % 1000000;
-    pcap_packet_header.incl_len = packet->rx_ctrl.sig_len;
-    pcap_packet_header.orig_len = packet->rx_ctrl.sig_len;
-    fichierPcap.write((const byte *)&pcap_packet_header, sizeof(pcaprec_hdr_t));
-    fichierPcap.write(packet->payload, packet->rx_ctrl.sig_len);
-    fichierPcap.close();
+    hsWriter.writePacket(
+        packet->payload,
+        packet->rx_ctrl.sig_len,
+        packet->rx_ctrl.timestamp / 1000000,
+        packet->rx_ctrl.timestamp % 1000000
+    );
 }
 
 static String sanitizeSsid(const char *ssid) {
@@ -435,25 +462,60 @@ static void resetHandshakeBeaconCache() {
     }
 }
 
-static void registerBeacon(const uint8_t *apAddr) {
-    if (!apAddr) return;
-    BeaconList beacon;
-    memcpy(beacon.MAC, apAddr, sizeof(beacon.MAC));
-    beacon.channel = ch;
-    registeredBeacons.insert(beacon);
+// Call with beaconMux held
+static BeaconEntry *findBeacon(uint64_t key) {
+    for (size_t i = 0; i < beaconCount; i++) {
+        if (beaconTable[i].key == key) return &beaconTable[i];
+    }
+    return nullptr;
+}
+
+static void registerBeacon(const FrameInfo &info) {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&beaconMux);
+    BeaconEntry *e = findBeacon(info.apKey);
+    if (!e && beaconCount < SNIFFER_MAX_BEACONS) e = &beaconTable[beaconCount++];
+    if (!e) {
+        e = &beaconTable[0];
+        for (size_t i = 1; i < beaconCount; i++) {
+            if (now - beaconTable[i].lastSeen > now - e->lastSeen) e = &beaconTable[i];
+        }
+    }
+    e->key = info.apKey;
+    e->lastSeen = now;
+    e->channel = ch;
+    copyMac(e->mac, info.apAddr);
+    copySsidToBuffer(info.ssid, e->ssid, sizeof(e->ssid));
+    portEXIT_CRITICAL(&beaconMux);
 }
 
-static String resolveSsidForFrame(FrameInfo &info, const wifi_promiscuous_pkt_t *packet) {
-    if (!packet) return "";
+static void clearBeacons() {
+    portENTER_CRITICAL(&beaconMux);
+    beaconCount = 0;
+    portEXIT_CRITICAL(&beaconMux);
+}
+
+bool sniffer_beacon_seen(const uint8_t *mac, uint8_t channel) {
+    uint64_t key = macToKey(mac);
+    portENTER_CRITICAL(&beaconMux);
+    BeaconEntry *e = findBeacon(key);
+    bool seen = e && e->channel == channel;
+    portEXIT_CRITICAL(&beaconMux);
+    return seen;
+}
+
+static void resolveSsidForFrame(FrameInfo &info, const wifi_promiscuous_pkt_t *packet) {
+    info.ssid[0] = '\0';
+    if (!packet) return;
     if (info.isBeacon) {
         beacon_frames++;
-        String ssid = extractSsid(packet);
-        beaconSsidCache[info.apKey] = ssid;
-        return ssid;
+        extractSsid(packet, info.ssid, sizeof(info.ssid));
+        return;
     }
-    auto it = beaconSsidCache.find(info.apKey);
-    if (it != beaconSsidCache.end()) { return it->second; }
-    return "";
+    portENTER_CRITICAL(&beaconMux);
+    BeaconEntry *e = findBeacon(info.apKey);
+    if (e) copySsidToBuffer(e->ssid, info.ssid, sizeof(info.ssid));
+    portEXIT_CRITICAL(&beaconMux);
 }
 
 static FrameInfo analyzeFrame(wifi_promiscuous_pkt_t *pkt) {
@@ -491,12 +553,8 @@ static FrameInfo analyzeFrame(wifi_promiscuous_pkt_t *pkt) {
         }
     }
 
-    info.ssid = resolveSsidForFrame(info, pkt);
-    if (info.isBeacon) {
-        registerBeacon(info.apAddr);
-        // UPDATE last-seen timestamp for this beacon
-        beaconLastSeen[info.apKey] = (uint32_t)millis();
-    }
+    resolveSsidForFrame(info, pkt);
+    if (info.isBeacon) registerBeacon(info);
 
     return info;
 }
@@ -510,52 +568,38 @@ static uint64_t macToKey(const void *mac) {
 
 static void copyMac(uint8_t *dest, const uint8_t *src) { memcpy(dest, src, 6); }
 
-static void copySsidToBuffer(const String &ssid, char *buffer, size_t len) {
+static void copySsidToBuffer(const char *ssid, char *buffer, size_t len) {
     if (!buffer || len == 0) return;
-    size_t copyLen = std::min<size_t>(ssid.length(), len - 1);
-    memcpy(buffer, ssid.c_str(), copyLen);
+    size_t copyLen = ssid ? strnlen(ssid, len - 1) : 0;
+    memcpy(buffer, ssid, copyLen);
     buffer[copyLen] = '\0';
 }
 
-static String extractSsid(const wifi_promiscuous_pkt_t *packet) {
-    if (!packet) return "";
+// Copies the printable chars of the SSID tag into out, returns its length
+static size_t extractSsid(const wifi_promiscuous_pkt_t *packet, char *out, size_t outLen) {
+    if (!out || outLen == 0) return 0;
+    out[0] = '\0';
+    if (!packet) return 0;
     const uint8_t *payload = packet->payload;
     int len = packet->rx_ctrl.sig_len;
-    if (len < 36) return "";
+    if (len < 36) return 0;
     int offset = 36;
     while (offset + 1 < len) {
         uint8_t tagNumber = payload[offset];
         uint8_t tagLength = payload[offset + 1];
         if (offset + 2 + tagLength > len) break;
         if (tagNumber == 0x00) {
-            String ssid = "";
-            for (int i = 0; i < tagLength; ++i) {
+            size_t n = 0;
+            for (int i = 0; i < tagLength && n + 1 < outLen; ++i) {
                 uint8_t chValue = payload[offset + 2 + i];
-                if (isprint(chValue)) { ssid += (char)chValue; }
+                if (isprint(chValue)) { out[n++] = (char)chValue; }
             }
-            return ssid;
+            out[n] = '\0';
+            return n;
         }
         offset += 2 + tagLength;
     }
-    return "";
-}
-
-static wifi_promiscuous_pkt_t *duplicatePacket(const wifi_promiscuous_pkt_t *pkt, uint16_t length) {
-    size_t total = sizeof(wifi_pkt_rx_ctrl_t) + length;
-    uint8_t *buffer = (uint8_t *)heap_caps_malloc(total, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
-    if (!buffer) { buffer = (uint8_t *)heap_caps_malloc(total, MALLOC_CAP_8BIT); }
-    if (!buffer) { buffer = (uint8_t *)malloc(total); }
-    if (!buffer) { return nullptr; }
-    auto *copy = reinterpret_cast<wifi_promiscuous_pkt_t *>(buffer);
-    memcpy(copy, pkt, sizeof(wifi_pkt_rx_ctrl_t));
-    memcpy(buffer + sizeof(wifi_pkt_rx_ctrl_t), pkt->payload, length);
-    copy->rx_ctrl.sig_len = length;
-    return copy;
-}
-
-static void releasePacketCopy(wifi_promiscuous_pkt_t *packet) {
-    if (!packet) return;
-    heap_caps_free(packet);
+    return 0;
 }
 
 static bool lockFileMutex(TickType_t ticks) {
@@ -573,17 +617,24 @@ static void ensureDirectories(FS &Fs) {
     if (!Fs.exists("/BrucePCAP/handshakes")) { Fs.mkdir("/BrucePCAP/handshakes"); }
 }
 
+static const char *captureExtension() { return captureFormat == PcapFormat::PcapNg ? ".pcapng" : ".pcap"; }
+
+// pcapng captures carry a radiotap header with the RSSI and channel of each frame
+static uint16_t captureLinkType() {
+    return captureFormat == PcapFormat::PcapNg ? PcapWriter::LINKTYPE_IEEE802_11_RADIOTAP
+                                               : PcapWriter::LINKTYPE_IEEE802_11;
+}
+
 static void openDeauthFile(FS &Fs) {
     ensureDirectories(Fs);
     closeDeauthFile();
-    deauthFilename = "/BrucePCAP/deauth_" + String(deauthFileIndex) + ".pcap";
+    deauthFilename = "/BrucePCAP/deauth_" + String(deauthFileIndex) + captureExtension();
     while (Fs.exists(deauthFilename)) {
         deauthFileIndex++;
-        deauthFilename = "/BrucePCAP/deauth_" + String(deauthFileIndex) + ".pcap";
+        deauthFilename = "/BrucePCAP/deauth_" + String(deauthFileIndex) + captureExtension();
     }
     if (lockFileMutex(pdMS_TO_TICKS(200))) {
-        _deauth_file = Fs.open(deauthFilename, FILE_WRITE);
-        deauthFileOpen = _deauth_file && writeHeader(_deauth_file);
+        deauthFileOpen = deauthWriter.open(Fs, deauthFilename, captureFormat, false, captureLinkType());
         unlockFileMutex();
         if (!deauthFileOpen) { Serial.println("Fail opening deauth capture file"); }
     }
@@ -591,10 +642,7 @@ static void openDeauthFile(FS &Fs) {
 
 static void closeRawFile() {
     if (lockFileMutex(pdMS_TO_TICKS(200))) {
-        if (_pcap_file) {
-            _pcap_file.flush();
-            _pcap_file.close();
-        }
+        rawWriter.close();
         rawFileOpen = false;
         unlockFileMutex();
     }
@@ -602,19 +650,23 @@ static void closeRawFile() {
 
 static void closeDeauthFile() {
     if (lockFileMutex(pdMS_TO_TICKS(200))) {
-        if (_deauth_file) {
-            _deauth_file.flush();
-            _deauth_file.close();
-        }
+        deauthWriter.close();
         deauthFileOpen = false;
         unlockFileMutex();
     }
 }
 
-static bool rawCaptureEnabled() { return currentMode == SnifferMode::Full && rawFileOpen && _pcap_file; }
+static void closeHandshakeFile() {
+    if (lockFileMutex(pdMS_TO_TICKS(200))) {
+        hsWriter.close();
+        unlockFileMutex();
+    }
+}
+
+static bool rawCaptureEnabled() { return currentMode == SnifferMode::Full && rawFileOpen; }
 static bool handshakeCaptureEnabled() { return currentMode != SnifferMode::DeauthOnly; }
 static bool deauthCaptureEnabled() {
-    return currentMode == SnifferMode::DeauthOnly && deauthFileOpen && _deauth_file;
+    return currentMode == SnifferMode::DeauthOnly && deauthFileOpen;
 }
 
 static String currentModeString() {
@@ -628,8 +680,7 @@ static String currentModeString() {
 static bool ensureSnifferBackend() {
     if (!fileMutex) { fileMutex = xSemaphoreCreateMutexStatic(&fileMutexBuffer); }
     if (!handshakeMutex) { handshakeMutex = xSemaphoreCreateMutexStatic(&handshakeMutexBuffer); }
-    if (!snifferQueue) { snifferQueue = xQueueCreate(SNIFFER_QUEUE_DEPTH, sizeof(SnifferQueueItem)); }
-    if (!snifferQueue) { return false; }
+    if (!snifferRing.ready() && !snifferRing.begin(SNIFFER_RING_SIZE, SNIFFER_RING_INTERNAL_SIZE)) { return false; }
     if (!snifferWriterHandle) {
 #if SOC_CPU_CORES_NUM > 1
         BaseType_t res = xTaskCreatePinnedToCore(
@@ -644,36 +695,55 @@ static bool ensureSnifferBackend() {
     return snifferWriterHandle != nullptr;
 }
 
+static void writeCaptureRecord(PcapWriter &writer, const SnifferQueueItem &item) {
+    const wifi_promiscuous_pkt_t *pkt = item.packet();
+    PcapRadioInfo radio;
+    radio.rssi = pkt->rx_ctrl.rssi;
+    radio.channel = pkt->rx_ctrl.channel;
+    writer.writePacket(pkt->payload, item.raw_len, item.ts_sec, item.ts_usec, &radio);
+}
+
+// All writes are called with fileMutex held by the writer task
 static void handleRawWrite(const SnifferQueueItem &item) {
-    if (!rawCaptureEnabled() || !item.packet) { return; }
-    if (lockFileMutex(pdMS_TO_TICKS(200))) {
-        newPacketSD(item.ts_sec, item.ts_usec, item.raw_len, item.packet->payload, _pcap_file);
-        unlockFileMutex();
-    }
+    if (!rawCaptureEnabled()) { return; }
+    writeCaptureRecord(rawWriter, item);
 }
 
 static void handleHandshakeWrite(const SnifferQueueItem &item) {
-    if (!handshakeCaptureEnabled() || !item.packet) { return; }
-    saveHandshake(item.packet, item.isBeacon, *activeFs, item.ssid);
+    if (!handshakeCaptureEnabled()) { return; }
+    saveHandshake(item.packet(), item.isBeacon, *activeFs, item.ssid);
 }
 
 static void handleDeauthWrite(const SnifferQueueItem &item) {
-    if (!deauthCaptureEnabled() || !item.packet) { return; }
-    if (lockFileMutex(pdMS_TO_TICKS(200))) {
-        newPacketSD(item.ts_sec, item.ts_usec, item.raw_len, item.packet->payload, _deauth_file);
-        unlockFileMutex();
-    }
+    if (!deauthCaptureEnabled()) { return; }
+    writeCaptureRecord(deauthWriter, item);
 }
 
 static void snifferWriterTask(void *param) {
     (void)param;
-    SnifferQueueItem item;
     while (true) {
-        if (xQueueReceive(snifferQueue, &item, portMAX_DELAY) == pdTRUE) {
-            if (item.saveRaw) { handleRawWrite(item); }
-            if (item.saveHandshake) { handleHandshakeWrite(item); }
-            if (item.saveDeauth) { handleDeauthWrite(item); }
-            releasePacketCopy(item.packet);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(250));
+        // Drain in batches, taking the file lock once per batch instead of once per frame.
+        // Records only reach the card when a writer block fills up or its flush interval expires.
+        while (!snifferRing.empty()) {
+            if (!lockFileMutex(pdMS_TO_TICKS(200))) break;
+            for (size_t n = 0; n < SNIFFER_WRITER_BATCH; ++n) {
+                size_t len = 0;
+                const SnifferQueueItem *item = (const SnifferQueueItem *)snifferRing.peek(len);
+                if (!item) break;
+                if (item->saveRaw) { handleRawWrite(*item); }
+                if (item->saveDeauth) { handleDeauthWrite(*item); }
+                if (item->saveHandshake) { handleHandshakeWrite(*item); }
+                snifferRing.release();
+            }
+            unlockFileMutex();
+            taskYIELD();
+        }
+        if (lockFileMutex(pdMS_TO_TICKS(50))) {
+            rawWriter.flushIfDue();
+            deauthWriter.flushIfDue();
+            hsWriter.flushIfDue();
+            unlockFileMutex();
         }
     }
 }
@@ -681,6 +751,7 @@ static void snifferWriterTask(void *param) {
 bool sniffer_prepare_storage(FS *fs, bool sdDetectedParam) {
     if (!ensureSnifferBackend()) { return false; }
     if (!fs) { fs = &LittleFS; }
+    if (fs != activeFs) { closeHandshakeFile(); }
     activeFs = fs;
     isLittleFS = (fs == &LittleFS);
     sdDetected = sdDetectedParam;
@@ -713,14 +784,20 @@ SnifferMode sniffer_get_mode() { return currentMode; }
 bool sniffer_full_mode_available() { return sdDetected; }
 
 void sniffer_wait_for_flush(uint32_t timeoutMs) {
-    if (!snifferQueue) { return; }
+    if (!snifferRing.ready()) { return; }
     TickType_t start = xTaskGetTickCount();
     TickType_t deadline = pdMS_TO_TICKS(timeoutMs);
-    while (uxQueueMessagesWaiting(snifferQueue) > 0) {
+    while (!snifferRing.empty()) {
         vTaskDelay(pdMS_TO_TICKS(10));
         if (timeoutMs == 0) { continue; }
         if ((xTaskGetTickCount() - start) > deadline) { break; }
     }
+    if (lockFileMutex(pdMS_TO_TICKS(200))) {
+        rawWriter.flush();
+        deauthWriter.flush();
+        hsWriter.flush();
+        unlockFileMutex();
+    }
 }
 
 void sniffer_reset_handshake_cache() {
@@ -745,49 +822,20 @@ void printAddress(const uint8_t *addr) {
 /* write packet to file */
 void newPacketSD(uint32_t ts_sec, uint32_t ts_usec, uint32_t len, uint8_t *buf, File pcap_file) {
     if (pcap_file) {
-
-        uint32_t orig_len = len;
-        uint32_t incl_len = len;
         // if(incl_len > snaplen) incl_len = snaplen; /* safty check that the packet isn't too big (I ran into
         // problems here) */
-
-        pcap_file.write((uint8_t *)&ts_sec, sizeof(ts_sec));
-        pcap_file.write((uint8_t *)&ts_usec, sizeof(ts_usec));
-        pcap_file.write((uint8_t *)&incl_len, sizeof(incl_len));
-        pcap_file.write((uint8_t *)&orig_len, sizeof(orig_len));
-
-        pcap_file.write(buf, incl_len);
+        pcaprec_hdr_t header = {ts_sec, ts_usec, len, len};
+        pcap_file.write((uint8_t *)&header, sizeof(header));
+        pcap_file.write(buf, len);
     }
 }
 
-bool writeHeader(File file) {
-    uint32_t magic_number = 0xa1b2c3d4;
-    uint16_t version_major = 2;
-    uint16_t version_minor = 4;
-    uint32_t thiszone = 0;
-    uint32_t sigfigs = 0;
-    uint32_t snaplen = 2500;
-    uint32_t network = 105;
-
-    if (file) {
-
-        file.write((uint8_t *)&magic_number, sizeof(magic_number));
-        file.write((uint8_t *)&version_major, sizeof(version_major));
-        file.write((uint8_t *)&version_minor, sizeof(version_minor));
-        file.write((uint8_t *)&thiszone, sizeof(thiszone));
-        file.write((uint8_t *)&sigfigs, sizeof(sigfigs));
-        file.write((uint8_t *)&snaplen, sizeof(snaplen));
-        file.write((uint8_t *)&network, sizeof(network));
-
-        return true;
-    }
-    return false;
-}
+bool writeHeader(File file) { return PcapWriter::writeFileHeader(file); }
 
 /* will be executed on every packet the ESP32 gets while being in promiscuous mode */
 // Sniffer callback
 void sniffer(void *buf, wifi_promiscuous_pkt_type_t type) {
-    if (!snifferQueue && !ensureSnifferBackend()) { return; }
+    if (!snifferRing.ready() && !ensureSnifferBackend()) { return; }
     // If using LittleFS to save .pcaps and storage is exhausted, stop promiscuous mode
     if (isLittleFS && !littleFsSpaceAvailable) {
         littleFsWasFull = true; // storage triggered exit
@@ -813,34 +861,36 @@ void sniffer(void *buf, wifi_promiscuous_pkt_type_t type) {
 
     if (!saveRaw && !saveHandshake && !saveDeauth) { return; }
 
-    wifi_promiscuous_pkt_t *copy = duplicatePacket(pkt, ctrl.sig_len);
-    if (!copy) { return; }
+    // Copy the frame straight into the preallocated ring, nothing is allocated here
+    const uint16_t length = ctrl.sig_len;
+    uint8_t *slot = snifferRing.reserve(sizeof(SnifferQueueItem) + sizeof(wifi_pkt_rx_ctrl_t) + length);
+    if (!slot) { return; } // ring full, counted as a drop
+
+    SnifferQueueItem *item = new (slot) SnifferQueueItem();
+    wifi_promiscuous_pkt_t *copy = item->packet();
+    memcpy(&copy->rx_ctrl, &ctrl, sizeof(wifi_pkt_rx_ctrl_t));
+    memcpy(copy->payload, pkt->payload, length);
     if (frameInfo.isBeacon && copy->rx_ctrl.sig_len >= 4) { copy->rx_ctrl.sig_len -= 4; }
 
-    SnifferQueueItem item;
-    item.packet = copy;
     uint64_t pktTimestamp = copy->rx_ctrl.timestamp;
-    item.ts_sec = pktTimestamp / 1000000ULL;
-    item.ts_usec = pktTimestamp % 1000000ULL;
-    item.raw_len = ctrl.sig_len;
-    if (type == WIFI_PKT_MGMT && item.raw_len >= 4) { item.raw_len -= 4; }
-    item.type = type;
-    item.isBeacon = frameInfo.isBeacon;
-    item.isHandshakeFrame = frameInfo.isEapol;
-    item.isDeauthFrame = frameInfo.isDeauth;
-    item.saveRaw = saveRaw;
-    item.saveHandshake = saveHandshake;
-    item.saveDeauth = saveDeauth;
-    copyMac(item.bssid, frameInfo.apAddr);
-    String ssidLabel = frameInfo.ssid.length() == 0 ? "UNKNOWN" : frameInfo.ssid;
-    copySsidToBuffer(ssidLabel, item.ssid, sizeof(item.ssid));
+    item->ts_sec = pktTimestamp / 1000000ULL;
+    item->ts_usec = pktTimestamp % 1000000ULL;
+    item->raw_len = length;
+    if (type == WIFI_PKT_MGMT && item->raw_len >= 4) { item->raw_len -= 4; }
+    item->type = type;
+    item->isBeacon = frameInfo.isBeacon;
+    item->isHandshakeFrame = frameInfo.isEapol;
+    item->isDeauthFrame = frameInfo.isDeauth;
+    item->saveRaw = saveRaw;
+    item->saveHandshake = saveHandshake;
+    item->saveDeauth = saveDeauth;
+    copyMac(item->bssid, frameInfo.apAddr);
+    copySsidToBuffer(frameInfo.ssid[0] ? frameInfo.ssid : "UNKNOWN", item->ssid, sizeof(item->ssid));
+    snifferRing.commit();
 
     BaseType_t taskWoken = pdFALSE;
-    if (xQueueSendFromISR(snifferQueue, &item, &taskWoken) != pdTRUE) {
-        releasePacketCopy(copy);
-    } else if (taskWoken) {
-        portYIELD_FROM_ISR();
-    }
+    if (snifferWriterHandle) vTaskNotifyGiveFromISR(snifferWriterHandle, &taskWoken);
+    if (taskWoken) { portYIELD_FROM_ISR(); }
 }
 
 // esp_err_t event_handler(void *ctx, system_event_t *event){ return ESP_OK; }
@@ -865,14 +915,13 @@ void event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, voi
 void openFile(FS &Fs) {
     ensureDirectories(Fs);
     closeRawFile();
-    filename = "/BrucePCAP/" + (String)FILENAME + String(rawFileIndex) + ".pcap";
+    filename = "/BrucePCAP/" + (String)FILENAME + String(rawFileIndex) + captureExtension();
     while (Fs.exists(filename)) {
         rawFileIndex++;
-        filename = "/BrucePCAP/" + (String)FILENAME + String(rawFileIndex) + ".pcap";
+        filename = "/BrucePCAP/" + (String)FILENAME + String(rawFileIndex) + captureExtension();
     }
     if (lockFileMutex(pdMS_TO_TICKS(200))) {
-        _pcap_file = Fs.open(filename, FILE_WRITE);
-        rawFileOpen = _pcap_file && writeHeader(_pcap_file);
+        rawFileOpen = rawWriter.open(Fs, filename, captureFormat, false, captureLinkType());
         unlockFileMutex();
         if (!rawFileOpen) { Serial.println("Fail opening the file"); }
     }
@@ -881,66 +930,57 @@ void openFile(FS &Fs) {
 // --- New helper implementations ---
 
 static void cleanupStaleBeacons() {
-    unsigned long now = millis();
-    std::vector<BeaconList> toRemove;
-    for (auto it = registeredBeacons.begin(); it != registeredBeacons.end(); ++it) {
-        uint64_t key = macToKey(it->MAC);
-        auto lastIt = beaconLastSeen.find(key);
-        if (lastIt == beaconLastSeen.end() || (now - (unsigned long)lastIt->second) > BEACON_TIMEOUT_MS) {
-            toRemove.push_back(*it);
-        }
-    }
-    for (const auto &b : toRemove) {
-        // erase by matching MAC bytes
-        for (auto it = registeredBeacons.begin(); it != registeredBeacons.end();) {
-            if (memcmp(it->MAC, b.MAC, 6) == 0) {
-                it = registeredBeacons.erase(it);
-            } else {
-                ++it;
-            }
-        }
-        uint64_t key = macToKey(b.MAC);
-        beaconSsidCache.erase(key);
-        beaconLastSeen.erase(key);
+    uint32_t now = millis();
+    portENTER_CRITICAL(&beaconMux);
+    for (size_t i = 0; i < beaconCount;) {
+        // order doesn't matter, the last entry fills the hole
+        if (now - beaconTable[i].lastSeen > BEACON_TIMEOUT_MS) beaconTable[i] = beaconTable[--beaconCount];
+        else i++;
     }
+    portEXIT_CRITICAL(&beaconMux);
 }
 
 static size_t countActiveBeaconsOnChannel(uint8_t channel) {
-    unsigned long now = millis();
+    uint32_t now = millis();
     size_t cnt = 0;
-    for (const auto &b : registeredBeacons) {
-        if (b.channel != channel) continue;
-        uint64_t key = macToKey(b.MAC);
-        auto it = beaconLastSeen.find(key);
-        if (it != beaconLastSeen.end() && (now - (unsigned long)it->second) <= BEACON_TIMEOUT_MS) { ++cnt; }
+    portENTER_CRITICAL(&beaconMux);
+    for (size_t i = 0; i < beaconCount; i++) {
+        const BeaconEntry &b = beaconTable[i];
+        if (b.channel == channel && now - b.lastSeen <= BEACON_TIMEOUT_MS) ++cnt;
     }
+    portEXIT_CRITICAL(&beaconMux);
     return cnt;
 }
 
+// Copies the MACs of the APs seen on `channel`, so they can be used without holding the lock
+static size_t beaconMacsOnChannel(uint8_t channel, uint8_t (*macs)[6], size_t maxItems) {
+    size_t n = 0;
+    portENTER_CRITICAL(&beaconMux);
+    for (size_t i = 0; i < beaconCount && n < maxItems; i++) {
+        if (beaconTable[i].channel == channel) copyMac(macs[n++], beaconTable[i].mac);
+    }
+    portEXIT_CRITICAL(&beaconMux);
+    return n;
+}
+
 static std::vector<String> recentSsidsOnChannel(uint8_t channel, size_t maxItems) {
-    std::vector<String> out;
-    unsigned long now = millis();
-    for (const auto &b : registeredBeacons) {
-        if (b.channel != channel) continue;
-        uint64_t key = macToKey(b.MAC);
-        auto lastIt = beaconLastSeen.find(key);
-        if (lastIt == beaconLastSeen.end() || (now - (unsigned long)lastIt->second) > BEACON_TIMEOUT_MS)
-            continue;
-        auto ssidIt = beaconSsidCache.find(key);
-        if (ssidIt == beaconSsidCache.end()) continue;
-        String ss = ssidIt->second;
-        if (ss.length() == 0) continue;
+    const size_t MAX_ITEMS = 8;
+    char found[MAX_ITEMS][MAX_CAPTURE_SSID_LEN + 1];
+    size_t n = 0;
+    if (maxItems > MAX_ITEMS) maxItems = MAX_ITEMS;
+    uint32_t now = millis();
+    portENTER_CRITICAL(&beaconMux);
+    for (size_t i = 0; i < beaconCount && n < maxItems; i++) {
+        const BeaconEntry &b = beaconTable[i];
+        if (b.channel != channel || b.ssid[0] == '\0' || now - b.lastSeen > BEACON_TIMEOUT_MS) continue;
         bool dup = false;
-        for (auto &x : out)
-            if (x == ss) {
-                dup = true;
-                break;
-            }
-        if (!dup) {
-            out.push_back(ss);
-            if (out.size() >= maxItems) break;
-        }
+        for (size_t j = 0; j < n && !dup; j++) dup = strcmp(found[j], b.ssid) == 0;
+        if (!dup) memcpy(found[n++], b.ssid, sizeof(b.ssid));
     }
+    portEXIT_CRITICAL(&beaconMux);
+
+    std::vector<String> out;
+    for (size_t i = 0; i < n; i++) out.push_back(found[i]);
     return out;
 }
 
@@ -984,9 +1024,7 @@ void sniffer_setup() {
     tft.setCursor(80, 100);
 
     sniffer_reset_handshake_cache(); // Need to clear to restart HS count
-    registeredBeacons.clear();
-    beaconSsidCache.clear();
-    beaconLastSeen.clear(); // ensure starts empty
+    clearBeacons(); // ensure starts empty
 
     /* setup wifi */
     ensureWifiPlatform();
@@ -1084,7 +1122,6 @@ void sniffer_setup() {
             }
             if (millis() - _tmp > 700) { // longpress detected to exit
                 returnToMenu = true;
-                _pcap_file.close();
                 break;
             }
 #endif
@@ -1106,7 +1143,6 @@ void sniffer_setup() {
         // T-Embed has a different btn for Escape, different from StickCs that uses Previous btn
         if (check(EscPress)) {
             returnToMenu = true;
-            _pcap_file.close();
             break;
         }
 #endif
@@ -1141,6 +1177,17 @@ void sniffer_setup() {
                      loopOptions(modeOptions, MENU_TYPE_SUBMENU, "Capture Mode");
                      redraw = true;
                  }                                                                                        },
+                {captureFormat == PcapFormat::PcapNg ? "Save as .pcap" : "Save as .pcapng",
+                 [=]() {
+                     captureFormat =
+                         captureFormat == PcapFormat::PcapNg ? PcapFormat::Pcap : PcapFormat::PcapNg;
+                     sniffer_wait_for_flush(1000);
+                     if (sniffer_get_mode() == SnifferMode::Full) {
+                         openFile(*Fs);
+                     } else if (sniffer_get_mode() == SnifferMode::DeauthOnly) {
+                         openDeauthFile(*Fs);
+                     }
+                 }                                                                                        },
                 {deauth ? "Disable deauth attack" : "Enable deauth attack", [&]() { deauth = !deauth; }   },
                 {"Reset Counters",
                  [&]() {
@@ -1149,9 +1196,9 @@ void sniffer_setup() {
                      num_HS = 0;
                      start_time = millis();
                      beacon_frames = 0;
-                     registeredBeacons.clear();
-                     beaconSsidCache.clear();
+                     clearBeacons();
                      sniffer_reset_handshake_cache();
+                     snifferRing.resetStats();
                      deauth_tmp = millis();
                  }                                                                                        },
                 {"Exit Sniffer",                                            [&]() { returnToMenu = true; }},
@@ -1198,11 +1245,18 @@ void sniffer_setup() {
             } else padprintln("Silent mode.");
 
             padprintln("Run time " + String(runtime / 60) + ":" + String(runtime % 60));
+            if (snifferRing.ready()) {
+                padprintln(
+                    "Buffer " + String(snifferRing.used() * 100 / snifferRing.capacity()) + "% peak " +
+                    String(snifferRing.highWater() * 100 / snifferRing.capacity()) + "% drops " +
+                    String(snifferRing.drops())
+                );
+            }
 
             // New: show beacon counts and recent SSIDs
             size_t activeOnChannel = countActiveBeaconsOnChannel(all_wifi_channels[ch]);
             padprintln(
-                "Beacons " + String(beacon_frames) + " tot. /" + String(registeredBeacons.size()) +
+                "Beacons " + String(beacon_frames) + " tot. /" + String(beaconCount) +
                 " cached / ch " + String(activeOnChannel) + " active"
             );
 
@@ -1239,32 +1293,19 @@ void sniffer_setup() {
 
         if (currentTime - lastTime > 100) tft.drawPixel(0, 0, 0);
 
-        if ((rawCaptureEnabled() || deauthCaptureEnabled()) && currentTime - lastTime > 1000) {
-            if (lockFileMutex(pdMS_TO_TICKS(50))) {
-                if (rawCaptureEnabled()) { _pcap_file.flush(); }
-                if (deauthCaptureEnabled()) { _deauth_file.flush(); }
-                unlockFileMutex();
-            }
-            lastTime = currentTime; // update time
-        }
-
         if (deauth && (millis() - deauth_tmp) > DEAUTH_INTERVAL) {
             bool deauth_sent = false;
-            if (registeredBeacons.size() > 40)
-                registeredBeacons.clear(); // Clear registered beacons to restart search and avoid restarts
             Serial.println("<<---- Starting Deauthentication Process ---->>");
-            for (auto registeredBeacon : registeredBeacons) {
-                if (registeredBeacon.channel == ch) {
-                    memcpy(&ap_record.bssid, registeredBeacon.MAC, 6);
-                    wsl_bypasser_send_raw_frame(
-                        &ap_record, registeredBeacon.channel
-                    ); // writes the buffer with the information
-                    // XXX: ap_record reused between this and wifi_atks.h
-                    send_raw_frame(deauth_frame, 26);
-                    deauth_sent = true;
-                    deauth_counter++;
-                    vTaskDelay(2 / portTICK_RATE_MS);
-                }
+            uint8_t targets[SNIFFER_MAX_BEACONS][6];
+            size_t targetCount = beaconMacsOnChannel(ch, targets, SNIFFER_MAX_BEACONS);
+            for (size_t i = 0; i < targetCount; i++) {
+                memcpy(&ap_record.bssid, targets[i], 6);
+                wsl_bypasser_send_raw_frame(&ap_record, ch); // writes the buffer with the information
+                // XXX: ap_record reused between this and wifi_atks.h
+                send_raw_frame(deauth_frame, 26);
+                deauth_sent = true;
+                deauth_counter++;
+                vTaskDelay(2 / portTICK_RATE_MS);
             }
 
             if (deauth_sent) {
@@ -1302,6 +1343,7 @@ Exit:
     sniffer_wait_for_flush(1000);
     closeRawFile();
     closeDeauthFile();
+    closeHandshakeFile();
     wifiDisconnect();
     vTaskDelay(1 / portTICK_RATE_MS);
 }
@@ -61,8 +61,9 @@ bool sniffer_prepare_storage(FS *fs, bool sdDetected);
 void sniffer_wait_for_flush(uint32_t timeoutMs = 2000);
 void sniffer_reset_handshake_cache();
 void markHandshakeReady(uint64_t key);
+// True when a beacon of `mac` was heard on `channel` since the sniffer started
+bool sniffer_beacon_seen(const uint8_t *mac, uint8_t channel);
 
-extern std::set<BeaconList> registeredBeacons;
 extern std::set<String> SavedHS;
 
 void newPacketSD(uint32_t ts_sec, uint32_t ts_usec, uint32_t len, uint8_t *buf, File pcap_file);
@@ -18,9 +18,9 @@
  * https://components.espressif.com/components/espressif/asio/versions/1.28.0/examples/socks4
  *
  * This module implements the **server** (ESP32 as proxy). Bruce uses the Arduino
- * framework; the Asio component is ESP-IDF–oriented, so we use WiFiServer/WiFiClient
- * here. An Asio-based server would follow the same protocol and the esp-protocols
- * socks4/async_request patterns (with acceptor + relay instead of client connect).
+ * framework; the Asio component is ESP-IDF–oriented, so the relay is a select() loop
+ * over lwIP sockets (socks4_relay.h) serving several clients at once, each one a small
+ * state machine with its own relay buffers.
  */
 void socks4Proxy(uint16_t port = 1080);
 #endif
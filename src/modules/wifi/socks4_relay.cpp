@@ -0,0 +1,441 @@
+#include "socks4_relay.h"
+#include <Arduino.h>
+#include <errno.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+#if defined(NATIVE_BUILD)
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#else
+#include "lwip/dns.h"
+#include "lwip/sockets.h"
+#include "lwip/tcpip.h"
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+const uint8_t SOCKS4_VERSION = 4;
+const uint8_t SOCKS4_CMD_CONNECT = 1;
+const uint8_t SOCKS4_REP_GRANTED = 90;
+const uint8_t SOCKS4_REP_REJECTED = 91;
+const size_t SOCKS4_MIN_BUFFER = 512; // room for a request with a long user id and host name
+
+void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK); }
+
+void setNoDelay(int fd) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+
+enum DnsResult : uint8_t { DNS_PENDING, DNS_DONE, DNS_FAILED };
+
+#if defined(NATIVE_BUILD)
+// The host has no asynchronous resolver at hand, getaddrinfo() answers at once
+DnsResult dnsStart(const char *host, uint32_t &ip, uint32_t &lookup) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *res = nullptr;
+    if (getaddrinfo(host, nullptr, &hints, &res) != 0 || !res) return DNS_FAILED;
+    ip = ((struct sockaddr_in *)res->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(res);
+    lookup = 0;
+    return DNS_DONE;
+}
+
+DnsResult dnsCheck(uint32_t lookup, uint32_t &ip) { return DNS_FAILED; }
+#else
+// Answers of dns_gethostbyname(), written by the tcpip thread. A query is known by a number that
+// never repeats, so an answer coming after its connection was closed lands nowhere.
+#define DNS_ANSWERS (2 * SOCKS4_RELAY_MAX_CLIENTS)
+struct DnsAnswer {
+    uint32_t lookup;
+    uint32_t ip;
+    DnsResult result;
+};
+DnsAnswer dnsAnswers[DNS_ANSWERS];
+uint32_t dnsLookups = 0;
+portMUX_TYPE dnsMux = portMUX_INITIALIZER_UNLOCKED;
+
+void dnsFound(const char *name, const ip_addr_t *addr, void *arg) {
+    uint32_t lookup = (uintptr_t)arg;
+    portENTER_CRITICAL(&dnsMux);
+    DnsAnswer &answer = dnsAnswers[lookup % DNS_ANSWERS];
+    if (answer.lookup == lookup) {
+        answer.result = addr && IP_IS_V4(addr) ? DNS_DONE : DNS_FAILED;
+        if (answer.result == DNS_DONE) answer.ip = ip_2_ip4(addr)->addr;
+    }
+    portEXIT_CRITICAL(&dnsMux);
+}
+
+// DNS_DONE with `ip` when the name is cached, DNS_PENDING when dnsCheck(lookup) will tell
+DnsResult dnsStart(const char *host, uint32_t &ip, uint32_t &lookup) {
+    portENTER_CRITICAL(&dnsMux);
+    lookup = ++dnsLookups;
+    dnsAnswers[lookup % DNS_ANSWERS] = {lookup, 0, DNS_PENDING};
+    portEXIT_CRITICAL(&dnsMux);
+
+    ip_addr_t addr;
+    LOCK_TCPIP_CORE();
+    err_t err = dns_gethostbyname(host, &addr, dnsFound, (void *)(uintptr_t)lookup);
+    UNLOCK_TCPIP_CORE();
+    if (err == ERR_INPROGRESS) return DNS_PENDING;
+    if (err != ERR_OK || !IP_IS_V4(&addr)) return DNS_FAILED;
+    ip = ip_2_ip4(&addr)->addr;
+    return DNS_DONE;
+}
+
+DnsResult dnsCheck(uint32_t lookup, uint32_t &ip) {
+    portENTER_CRITICAL(&dnsMux);
+    const DnsAnswer &answer = dnsAnswers[lookup % DNS_ANSWERS];
+    DnsResult result = answer.lookup == lookup ? answer.result : DNS_FAILED; // reused by a newer one
+    if (result == DNS_DONE) ip = answer.ip;
+    portEXIT_CRITICAL(&dnsMux);
+    return result;
+}
+#endif
+} // namespace
+
+bool Socks4Relay::begin(uint16_t port, const Socks4RelayConfig &config, EventCallback onEvent) {
+    end();
+    _config = config;
+    _config.maxClients = constrain(config.maxClients, 1, SOCKS4_RELAY_MAX_CLIENTS);
+    if (_config.bufferSize < SOCKS4_MIN_BUFFER) _config.bufferSize = SOCKS4_MIN_BUFFER;
+    _onEvent = onEvent;
+    _accepted = 0;
+
+    _listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listener < 0) return false;
+    int one = 1;
+    setsockopt(_listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(_listener, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(_listener, _config.maxClients) < 0) {
+        close(_listener);
+        _listener = -1;
+        return false;
+    }
+    setNonBlocking(_listener);
+    return true;
+}
+
+void Socks4Relay::end() {
+    for (Slot &slot : _slots) {
+        if (slot.state != FREE) closeSlot(slot);
+    }
+    if (_listener >= 0) close(_listener);
+    _listener = -1;
+}
+
+void Socks4Relay::emit(const Slot &slot, Socks4Event event) {
+    if (_onEvent) _onEvent(slot, event);
+}
+
+void Socks4Relay::acceptClient(uint32_t now) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    int fd = accept(_listener, (struct sockaddr *)&addr, &len);
+    if (fd < 0) return;
+
+    Slot *slot = nullptr;
+    for (Slot &s : _slots) {
+        if (s.state == FREE) {
+            slot = &s;
+            break;
+        }
+    }
+    size_t size = 2 * _config.bufferSize;
+    uint8_t *mem = slot ? (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM) : nullptr;
+    if (slot && !mem) mem = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    if (!mem) {
+        close(fd);
+        return;
+    }
+
+    setNonBlocking(fd);
+    setNoDelay(fd);
+    memset(slot, 0, sizeof(Slot));
+    slot->id = ++_accepted;
+    slot->clientIp = addr.sin_addr.s_addr;
+    slot->state = REQUEST;
+    slot->stateAt = now;
+    slot->client = fd;
+    slot->target = -1;
+    slot->up.buf = mem;
+    slot->down.buf = mem + _config.bufferSize;
+    _active++;
+    emit(*slot, Socks4Event::Accepted);
+}
+
+void Socks4Relay::closeSlot(Slot &slot) {
+    if (slot.client >= 0) close(slot.client);
+    if (slot.target >= 0) close(slot.target);
+    heap_caps_free(slot.up.buf); // both pipes share one allocation
+    slot.state = FREE;
+    _active--;
+    emit(slot, Socks4Event::Closed);
+}
+
+// Queues the 8 byte answer, it goes out with whatever the destination sends next
+void Socks4Relay::reply(Slot &slot, uint8_t code) {
+    Pipe &p = slot.down;
+    uint8_t *r = p.buf + p.tail;
+    r[0] = 0;
+    r[1] = code;
+    r[2] = slot.dstPort >> 8;
+    r[3] = slot.dstPort;
+    memcpy(r + 4, &slot.dstIp, 4);
+    p.tail += 8;
+}
+
+void Socks4Relay::reject(Slot &slot, Socks4Event event, uint32_t now) {
+    if (slot.target >= 0) close(slot.target);
+    slot.target = -1;
+    reply(slot, SOCKS4_REP_REJECTED);
+    slot.state = CLOSING;
+    slot.stateAt = now;
+    emit(slot, event);
+}
+
+// Bytes taken by a complete request, 0 while incomplete, -1 if invalid
+int Socks4Relay::parseRequest(Slot &slot) {
+    const uint8_t *p = slot.up.buf;
+    size_t n = slot.up.tail;
+    bool full = n == _config.bufferSize;
+    if (n >= 1 && p[0] != SOCKS4_VERSION) return -1;
+    if (n < 9) return 0;
+
+    // VN, CD, DSTPORT, DSTIP, USERID, NUL
+    const uint8_t *user = (const uint8_t *)memchr(p + 8, 0, n - 8);
+    if (!user) return full ? -1 : 0;
+    size_t used = user - p + 1;
+    slot.dstPort = (uint16_t)p[2] << 8 | p[3];
+    memcpy(&slot.dstIp, p + 4, 4);
+    slot.host[0] = '\0';
+
+    // SOCKS4a: DSTIP is 0.0.0.x with x != 0 and the host name follows
+    if (p[4] == 0 && p[5] == 0 && p[6] == 0 && p[7] != 0) {
+        const uint8_t *name = (const uint8_t *)memchr(p + used, 0, n - used);
+        if (!name) return full ? -1 : 0;
+        size_t len = name - (p + used);
+        if (len == 0 || len >= sizeof(slot.host)) return -1;
+        memcpy(slot.host, p + used, len);
+        slot.host[len] = '\0';
+        used += len + 1;
+    }
+    if (p[1] != SOCKS4_CMD_CONNECT) return -1;
+    return used;
+}
+
+void Socks4Relay::startConnect(Slot &slot, uint32_t now) {
+    if (slot.host[0] == '\0') return connectTarget(slot, now);
+
+    switch (dnsStart(slot.host, slot.dstIp, slot.lookup)) {
+        case DNS_DONE: connectTarget(slot, now); return;
+        case DNS_FAILED: reject(slot, Socks4Event::Failed, now); return;
+        case DNS_PENDING:
+            slot.state = RESOLVING;
+            slot.stateAt = now;
+            return;
+    }
+}
+
+void Socks4Relay::connectTarget(Slot &slot, uint32_t now) {
+    slot.target = socket(AF_INET, SOCK_STREAM, 0);
+    if (slot.target < 0) {
+        reject(slot, Socks4Event::Failed, now);
+        return;
+    }
+    setNonBlocking(slot.target);
+    setNoDelay(slot.target);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(slot.dstPort);
+    addr.sin_addr.s_addr = slot.dstIp;
+    slot.state = CONNECTING;
+    slot.stateAt = now;
+    if (connect(slot.target, (struct sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        reject(slot, Socks4Event::Failed, now);
+    }
+}
+
+// Reads what fits in the pipe. False on a socket error.
+bool Socks4Relay::fill(int fd, Pipe &pipe, uint32_t now) {
+    if (pipe.head == pipe.tail) pipe.head = pipe.tail = 0;
+    if (pipe.tail == _config.bufferSize && pipe.head > 0) {
+        memmove(pipe.buf, pipe.buf + pipe.head, pipe.tail - pipe.head);
+        pipe.tail -= pipe.head;
+        pipe.head = 0;
+    }
+    size_t room = _config.bufferSize - pipe.tail;
+    if (room == 0 || pipe.eof) return true;
+    ssize_t n = recv(fd, pipe.buf + pipe.tail, room, 0);
+    if (n < 0) return wouldBlock();
+    if (n == 0) {
+        pipe.eof = true;
+        return true;
+    }
+    if (pipe.head == pipe.tail) pipe.since = now;
+    pipe.tail += n;
+    return true;
+}
+
+// Sends what the pipe holds. False on a socket error.
+bool Socks4Relay::drain(int fd, Pipe &pipe, uint32_t now, uint32_t &counter, uint32_t &maxQueueMs) {
+    if (pipe.head == pipe.tail) return true;
+    ssize_t n = send(fd, pipe.buf + pipe.head, pipe.tail - pipe.head, MSG_NOSIGNAL);
+    if (n < 0) return wouldBlock();
+    pipe.head += n;
+    counter += n;
+    if (pipe.head == pipe.tail) {
+        maxQueueMs = max(maxQueueMs, now - pipe.since);
+        pipe.head = pipe.tail = 0;
+    }
+    return true;
+}
+
+// Moves data both ways and propagates half-closes. False once the connection is over.
+bool Socks4Relay::relay(Slot &slot, uint32_t now) {
+    if (!fill(slot.client, slot.up, now) || !fill(slot.target, slot.down, now)) return false;
+    // sockets are non-blocking, sending right away saves a round through select()
+    if (!drain(slot.target, slot.up, now, slot.bytesUp, slot.maxQueueMs)) return false;
+    if (!drain(slot.client, slot.down, now, slot.bytesDown, slot.maxQueueMs)) return false;
+
+    if (slot.up.eof && !slot.up.shut && slot.up.head == slot.up.tail) {
+        shutdown(slot.target, SHUT_WR);
+        slot.up.shut = true;
+    }
+    if (slot.down.eof && !slot.down.shut && slot.down.head == slot.down.tail) {
+        shutdown(slot.client, SHUT_WR);
+        slot.down.shut = true;
+    }
+    return !(slot.up.shut && slot.down.shut);
+}
+
+void Socks4Relay::step(Slot &slot, bool readable, bool writable, uint32_t now) {
+    switch (slot.state) {
+        case REQUEST: {
+            if (readable && (!fill(slot.client, slot.up, now) || slot.up.eof)) {
+                closeSlot(slot);
+                return;
+            }
+            int used = parseRequest(slot);
+            if (used < 0) {
+                reject(slot, Socks4Event::Rejected, now);
+            } else if (used > 0) {
+                slot.up.head = used; // anything after the request is relayed once connected
+                startConnect(slot, now);
+            } else if (now - slot.stateAt > _config.requestTimeoutMs) {
+                closeSlot(slot);
+            }
+            return;
+        }
+        case RESOLVING: {
+            DnsResult result = dnsCheck(slot.lookup, slot.dstIp);
+            if (result == DNS_DONE) {
+                connectTarget(slot, now);
+            } else if (result == DNS_FAILED || now - slot.stateAt > _config.connectTimeoutMs) {
+                reject(slot, Socks4Event::Failed, now);
+            }
+            return;
+        }
+        case CONNECTING: {
+            if (!writable) {
+                if (now - slot.stateAt > _config.connectTimeoutMs) reject(slot, Socks4Event::Failed, now);
+                return;
+            }
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(slot.target, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0) {
+                reject(slot, Socks4Event::Failed, now);
+                return;
+            }
+            slot.connectMs = now - slot.stateAt;
+            reply(slot, SOCKS4_REP_GRANTED);
+            slot.down.since = now;
+            slot.state = RELAY;
+            slot.stateAt = now;
+            emit(slot, Socks4Event::Connected);
+            if (!relay(slot, now)) closeSlot(slot);
+            return;
+        }
+        case RELAY:
+            if (!relay(slot, now)) closeSlot(slot);
+            return;
+        case CLOSING: {
+            uint32_t unused = 0;
+            bool ok = drain(slot.client, slot.down, now, unused, unused);
+            if (!ok || slot.down.head == slot.down.tail || now - slot.stateAt > _config.requestTimeoutMs) {
+                closeSlot(slot);
+            }
+            return;
+        }
+        case FREE: return;
+    }
+}
+
+void Socks4Relay::poll(uint32_t waitMs) {
+    if (_listener < 0) return;
+    fd_set readable, writable;
+    FD_ZERO(&readable);
+    FD_ZERO(&writable);
+    int maxFd = -1;
+    auto watch = [&maxFd](int fd, fd_set &set) {
+        FD_SET(fd, &set);
+        maxFd = max(maxFd, fd);
+    };
+
+    if (_active < _config.maxClients) watch(_listener, readable);
+    for (Slot &slot : _slots) {
+        switch (slot.state) {
+            case REQUEST: watch(slot.client, readable); break;
+            case RESOLVING: waitMs = min<uint32_t>(waitMs, 10); break; // the answer has no socket
+            case CONNECTING: watch(slot.target, writable); break;
+            case RELAY:
+                if (!slot.up.eof && slot.up.tail < _config.bufferSize) watch(slot.client, readable);
+                if (!slot.down.eof && slot.down.tail < _config.bufferSize) watch(slot.target, readable);
+                if (slot.up.head != slot.up.tail) watch(slot.target, writable);
+                if (slot.down.head != slot.down.tail) watch(slot.client, writable);
+                break;
+            case CLOSING: watch(slot.client, writable); break;
+            case FREE: break;
+        }
+    }
+
+    struct timeval tv;
+    tv.tv_sec = waitMs / 1000;
+    tv.tv_usec = (waitMs % 1000) * 1000;
+    int ready = maxFd >= 0 ? select(maxFd + 1, &readable, &writable, nullptr, &tv) : 0;
+    if (maxFd < 0) delay(waitMs);
+    if (ready < 0) {
+        FD_ZERO(&readable);
+        FD_ZERO(&writable);
+    }
+
+    uint32_t now = millis();
+    for (Slot &slot : _slots) {
+        if (slot.state == FREE) continue;
+        bool r = FD_ISSET(slot.client, &readable) || (slot.target >= 0 && FD_ISSET(slot.target, &readable));
+        bool w = FD_ISSET(slot.client, &writable) || (slot.target >= 0 && FD_ISSET(slot.target, &writable));
+        step(slot, r, w, now);
+    }
+    // after the slots, so a new client is not stepped with this round's sets
+    if (ready > 0 && FD_ISSET(_listener, &readable)) acceptClient(now);
+}
@@ -0,0 +1,99 @@
+#ifndef SOCKS4_RELAY_H
+#define SOCKS4_RELAY_H
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SOCKS4_RELAY_MAX_CLIENTS 8
+
+struct Socks4RelayConfig {
+    uint8_t maxClients = 6;            // each one takes two sockets
+    size_t bufferSize = 4096;          // per direction, PSRAM first
+    uint32_t requestTimeoutMs = 10000; // for the client to send its request
+    uint32_t connectTimeoutMs = 15000; // for the destination to answer
+};
+
+// One proxied connection, as reported to the UI
+struct Socks4Connection {
+    uint32_t id;
+    uint32_t clientIp; // network byte order
+    uint32_t dstIp;    // network byte order, resolved for SOCKS4a
+    uint16_t dstPort;
+    char host[256];      // SOCKS4a host name, empty for SOCKS4
+    uint32_t bytesUp;    // client to destination
+    uint32_t bytesDown;  // destination to client
+    uint32_t connectMs;  // time taken to reach the destination
+    uint32_t maxQueueMs; // longest time data waited in a relay buffer
+};
+
+enum class Socks4Event : uint8_t { Accepted, Rejected, Connected, Failed, Closed };
+
+// SOCKS4/4a CONNECT relay serving several clients from one select() loop.
+// Every connection is a small state machine (request, resolving, connecting, relaying, closing)
+// with a buffer per direction. SOCKS4a names go through the asynchronous lwIP resolver, so a slow
+// DNS server never stalls the other connections. A side that sends EOF gets its peer shut down for
+// writing once its buffer is flushed, the connection ends when both directions are closed.
+// Plain BSD socket calls only, so the same code runs on lwIP and on a Linux host.
+class Socks4Relay {
+public:
+    typedef std::function<void(const Socks4Connection &, Socks4Event)> EventCallback;
+
+    Socks4Relay() = default;
+    ~Socks4Relay() { end(); }
+    Socks4Relay(const Socks4Relay &) = delete;
+    Socks4Relay &operator=(const Socks4Relay &) = delete;
+
+    // Listens on `port`, false if the socket could not be bound
+    bool begin(uint16_t port, const Socks4RelayConfig &config, EventCallback onEvent = nullptr);
+    // Closes the listener and every connection
+    void end();
+    // One round of the event loop, waits up to `waitMs` for socket activity
+    void poll(uint32_t waitMs);
+
+    uint8_t active() const { return _active; }
+    uint32_t accepted() const { return _accepted; }
+
+private:
+    enum State : uint8_t { FREE, REQUEST, RESOLVING, CONNECTING, RELAY, CLOSING };
+
+    struct Pipe {
+        uint8_t *buf;
+        size_t head; // next byte to send
+        size_t tail; // end of the received bytes
+        uint32_t since; // when the pipe stopped being empty
+        bool eof;       // reading side is done
+        bool shut;      // writing side was shut down
+    };
+
+    struct Slot : Socks4Connection {
+        State state;
+        int client;
+        int target;
+        uint32_t stateAt;
+        uint32_t lookup; // pending DNS query, see RESOLVING
+        Pipe up;   // client to destination
+        Pipe down; // destination to client
+    };
+
+    Socks4RelayConfig _config;
+    EventCallback _onEvent;
+    int _listener = -1;
+    Slot _slots[SOCKS4_RELAY_MAX_CLIENTS] = {};
+    uint8_t _active = 0;
+    uint32_t _accepted = 0;
+
+    void acceptClient(uint32_t now);
+    void closeSlot(Slot &slot);
+    void reject(Slot &slot, Socks4Event event, uint32_t now);
+    void reply(Slot &slot, uint8_t code);
+    int parseRequest(Slot &slot);
+    void startConnect(Slot &slot, uint32_t now);
+    void connectTarget(Slot &slot, uint32_t now);
+    void step(Slot &slot, bool readable, bool writable, uint32_t now);
+    bool relay(Slot &slot, uint32_t now);
+    bool fill(int fd, Pipe &pipe, uint32_t now);
+    bool drain(int fd, Pipe &pipe, uint32_t now, uint32_t &counter, uint32_t &maxQueueMs);
+    void emit(const Slot &slot, Socks4Event event);
+};
+
+#endif
@@ -616,10 +616,7 @@ void capture_handshake(String tssid, String mac, uint8_t channel) {
 
     while (true) {
         // Check if we have beacons
-        BeaconList targetBeacon;
-        memcpy(targetBeacon.MAC, bssid_array, 6);
-        targetBeacon.channel = channel;
-        if (registeredBeacons.find(targetBeacon) != registeredBeacons.end()) { hasBeacons = true; }
+        if (sniffer_beacon_seen(bssid_array, channel)) { hasBeacons = true; }
 
         // Redraw whenever new EAPOL Frame arrives
         if (num_EAPOL > prevNumEAPOL) {
@@ -0,0 +1,77 @@
+// ARPSweep against simulated responders: latency, lost probes, window and rate limits
+#include <gtest/gtest.h>
+#include <map>
+#include <modules/ethernet/ARPSweep.h>
+#include <set>
+
+namespace {
+const uint32_t FIRST = 0x0A000001; // 10.0.0.1
+const uint32_t LAST = 0x0A0003FE;  // 10.0.3.254, a /22
+const uint32_t OWN_IP = 0x0A000005;
+} // namespace
+
+TEST(ARPSweep, FindsEveryResponderOnce) {
+    std::map<uint32_t, uint32_t> latency; // hosts and their reply delay
+    std::set<uint32_t> lossy;             // the first probe to these is lost
+    for (uint32_t ip = FIRST; ip <= LAST; ip += 7) latency[ip] = 5 + ip % 50;
+    for (uint32_t ip = FIRST; ip <= LAST; ip += 21) lossy.insert(ip);
+    latency[FIRST] = latency[LAST] = 10;
+
+    ARPSweepConfig config;
+    ARPSweep sweep;
+    ASSERT_TRUE(sweep.begin(FIRST, LAST, config, 0));
+    sweep.skip(OWN_IP);
+
+    std::multimap<uint32_t, uint32_t> pending; // reply time -> ip
+    std::map<uint32_t, int> probes;
+    std::set<uint32_t> found;
+    uint32_t now = 0;
+    uint16_t maxInFlight = 0;
+    for (; !sweep.done() && now < 100000; now += 5) {
+        uint32_t ip;
+        while (sweep.nextProbe(now, ip)) {
+            ASSERT_NE(ip, OWN_IP);
+            int n = ++probes[ip];
+            auto host = latency.find(ip);
+            if (host == latency.end() || (lossy.count(ip) && n == 1)) continue;
+            pending.insert({now + host->second, ip});
+        }
+        maxInFlight = std::max(maxInFlight, sweep.inFlight());
+        while (!pending.empty() && pending.begin()->first <= now) {
+            uint32_t replier = pending.begin()->second;
+            pending.erase(pending.begin());
+            EXPECT_EQ(sweep.onReply(replier), !found.count(replier)) << std::hex << replier;
+            found.insert(replier);
+        }
+        EXPECT_FALSE(sweep.onReply(0x0B000001)); // out of the range
+        sweep.expire(now);
+    }
+
+    EXPECT_TRUE(sweep.done());
+    EXPECT_EQ(found.size(), latency.size());
+    EXPECT_EQ(sweep.found(), latency.size());
+    EXPECT_EQ(sweep.progress(), sweep.total());
+    EXPECT_LE(maxInFlight, config.window);
+    for (auto &p : probes) EXPECT_LE(p.second, 1 + config.retries) << std::hex << p.first;
+    // past a first burst of a window, no more than `rate` probes per second
+    EXPECT_GE(now, 1000u * (sweep.sent() - config.window) / config.rate);
+}
+
+TEST(ARPSweep, RejectsRangesOverAClassB) {
+    ARPSweep sweep;
+    EXPECT_FALSE(sweep.begin(0, ARP_SWEEP_MAX_HOSTS, ARPSweepConfig(), 0));
+    EXPECT_FALSE(sweep.begin(10, 9, ARPSweepConfig(), 0));
+    EXPECT_TRUE(sweep.begin(0, ARP_SWEEP_MAX_HOSTS - 1, ARPSweepConfig(), 0));
+}
+
+TEST(ARPSweep, EndsAtTheTopOfTheAddressSpace) {
+    ARPSweep sweep;
+    ASSERT_TRUE(sweep.begin(0xFFFFFFF0, 0xFFFFFFFF, ARPSweepConfig(), 0));
+    uint32_t ip, probes = 0;
+    for (uint32_t now = 0; !sweep.done() && now < 100000; now += 10) {
+        while (sweep.nextProbe(now, ip)) probes++;
+        sweep.expire(now);
+    }
+    EXPECT_TRUE(sweep.done());
+    EXPECT_EQ(probes, 32u); // 16 addresses, one retry each
+}
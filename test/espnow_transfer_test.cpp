@@ -0,0 +1,209 @@
+// ESP-NOW file transfer v2: window, reordering, retransmits and the END/END_ACK handshake
+#include <FS.h>
+#include <LittleFS.h>
+#include <core/connect/espnow_transfer.h>
+#include <deque>
+#include <functional>
+#include <gtest/gtest.h>
+#include <native_root.h>
+#include <vector>
+
+namespace {
+
+// One direction of a radio link, frames queue up in `inbox` for the far end. Unlike EspNowLoopback
+// a lost frame is reported as sent (the air ate it after the MAC ack), so only the protocol's ACK
+// bitmap and timers can recover it.
+struct Link : public EspNowTransport {
+    std::deque<std::vector<uint8_t>> inbox;
+    std::deque<bool> reports;
+    std::function<bool(std::vector<uint8_t> &)> lose; // may also alter the frame
+    uint32_t holdEvery = 0;                            // delays one DATA frame in holdEvery
+    uint32_t dataSent = 0;
+    std::vector<uint8_t> held;
+    std::vector<uint8_t> sentTypes;
+
+    bool send(const uint8_t *frame, size_t len) override {
+        std::vector<uint8_t> f(frame, frame + len);
+        sentTypes.push_back(frame[1]);
+        reports.push_back(true);
+        if (lose && lose(f)) return true;
+        if (frame[1] == XFER_DATA && holdEvery && ++dataSent % holdEvery == 0 && held.empty()) {
+            held = f;
+            return true;
+        }
+        inbox.push_back(f);
+        if (!held.empty()) {
+            inbox.push_back(held); // lands after a younger chunk
+            held.clear();
+        }
+        return true;
+    }
+
+    size_t count(uint8_t type) const {
+        size_t n = 0;
+        for (uint8_t t : sentTypes) n += t == type;
+        return n;
+    }
+};
+
+class EspNowTransfer : public ::testing::Test {
+protected:
+    Link toReceiver, toSender;
+    EspNowFileSender sender{toReceiver};
+    EspNowFileReceiver receiver{toSender, [](const String &dir, const String &name, uint32_t) {
+                                    return LittleFS.open("/out/" + name, FILE_WRITE, true);
+                                }};
+    std::vector<uint8_t> content;
+    File source;
+    uint32_t now = 1000;
+
+    void SetUp() override {
+        ASSERT_FALSE(useTempNativeRoot().empty());
+    }
+
+    void makeSource(size_t size) {
+        content.resize(size);
+        uint32_t x = 0x12345678;
+        for (auto &b : content) {
+            x = x * 1664525u + 1013904223u;
+            b = x >> 24;
+        }
+        File f = LittleFS.open("/in/data.bin", FILE_WRITE, true);
+        f.write(content.data(), content.size());
+        f.close();
+        source = LittleFS.open("/in/data.bin");
+        ASSERT_TRUE(source);
+    }
+
+    // receiverFor: how long the receiver keeps reading frames once it has finished
+    void run(uint8_t window, uint32_t receiverFor = ESPNOW_XFER_LINGER_MS) {
+        ASSERT_TRUE(sender.begin(source, "/in", "data.bin", now, window));
+        uint32_t receiverDoneAt = 0;
+        for (uint32_t limit = now + 60000; !sender.finished() && now < limit; now++) {
+            sender.poll(now);
+            while (!toReceiver.reports.empty()) {
+                toReceiver.reports.pop_front();
+                sender.onSent(true);
+            }
+            for (; !toSender.inbox.empty(); toSender.inbox.pop_front()) {
+                sender.onFrame(toSender.inbox.front().data(), toSender.inbox.front().size(), now);
+            }
+
+            if (receiver.finished() && receiverDoneAt == 0) receiverDoneAt = now;
+            if (receiverDoneAt && now - receiverDoneAt >= receiverFor) continue; // endTransfer()
+            receiver.poll(now);
+            for (; !toReceiver.inbox.empty(); toReceiver.inbox.pop_front()) {
+                receiver.onFrame(toReceiver.inbox.front().data(), toReceiver.inbox.front().size(), now);
+            }
+            toSender.reports.clear();
+        }
+    }
+
+    std::vector<uint8_t> received() {
+        File f = LittleFS.open("/out/data.bin");
+        std::vector<uint8_t> data(f ? f.size() : 0);
+        if (f) f.read(data.data(), data.size());
+        return data;
+    }
+};
+
+} // namespace
+
+TEST(EspNowXferCrc32, MatchesZlib) {
+    const char *text = "123456789";
+    EXPECT_EQ(espnowXferCrc32(0, (const uint8_t *)text, 9), 0xCBF43926u);
+    // incremental, as the sender and receiver compute it chunk by chunk
+    uint32_t crc = espnowXferCrc32(0, (const uint8_t *)text, 4);
+    EXPECT_EQ(espnowXferCrc32(crc, (const uint8_t *)text + 4, 5), 0xCBF43926u);
+}
+
+TEST_F(EspNowTransfer, CleanLink) {
+    makeSource(50 * ESPNOW_XFER_PAYLOAD + 17);
+    run(16);
+    EXPECT_EQ(sender.state(), XFER_DONE);
+    EXPECT_EQ(receiver.state(), XFER_DONE);
+    EXPECT_EQ(sender.retransmits(), 0u);
+    EXPECT_EQ(received(), content);
+}
+
+TEST_F(EspNowTransfer, EmptyFile) {
+    makeSource(0);
+    run(16);
+    EXPECT_EQ(sender.state(), XFER_DONE);
+    EXPECT_EQ(receiver.state(), XFER_DONE);
+    EXPECT_TRUE(received().empty());
+}
+
+TEST_F(EspNowTransfer, ReorderedChunksAreBufferedNotResent) {
+    makeSource(40 * ESPNOW_XFER_PAYLOAD + 3);
+    toReceiver.holdEvery = 3;
+    run(8);
+    EXPECT_EQ(sender.state(), XFER_DONE);
+    EXPECT_EQ(sender.retransmits(), 0u);
+    EXPECT_EQ(received(), content);
+}
+
+TEST_F(EspNowTransfer, DroppedDataFramesAreRetransmitted) {
+    makeSource(64 * ESPNOW_XFER_PAYLOAD + 100);
+    uint32_t n = 0;
+    toReceiver.lose = [&](std::vector<uint8_t> &f) { return f[1] == XFER_DATA && ++n % 7 == 0; };
+    run(16);
+    EXPECT_EQ(sender.state(), XFER_DONE);
+    EXPECT_GT(sender.retransmits(), 0u);
+    EXPECT_EQ(received(), content);
+}
+
+TEST_F(EspNowTransfer, DroppedAcksAreRecovered) {
+    makeSource(64 * ESPNOW_XFER_PAYLOAD);
+    uint32_t n = 0;
+    toSender.lose = [&](std::vector<uint8_t> &f) { return f[1] == XFER_ACK && ++n % 3 == 0; };
+    run(32);
+    EXPECT_EQ(sender.state(), XFER_DONE);
+    EXPECT_EQ(received(), content);
+}
+
+TEST_F(EspNowTransfer, WindowOfOne) {
+    makeSource(10 * ESPNOW_XFER_PAYLOAD + 1);
+    uint32_t n = 0;
+    toReceiver.lose = [&](std::vector<uint8_t> &f) { return f[1] == XFER_DATA && ++n % 4 == 0; };
+    run(1);
+    EXPECT_EQ(sender.state(), XFER_DONE);
+    EXPECT_EQ(received(), content);
+}
+
+TEST_F(EspNowTransfer, CorruptedChunkFailsTheCrc) {
+    makeSource(20 * ESPNOW_XFER_PAYLOAD);
+    bool corrupted = false;
+    toReceiver.lose = [&](std::vector<uint8_t> &f) {
+        if (f[1] == XFER_DATA && !corrupted && f[3] == 5) {
+            f[ESPNOW_XFER_HEADER_SIZE + 10] ^= 0x40;
+            corrupted = true;
+        }
+        return false;
+    };
+    run(16);
+    EXPECT_TRUE(corrupted);
+    EXPECT_EQ(receiver.state(), XFER_FAILED);
+    EXPECT_EQ(sender.state(), XFER_FAILED);
+}
+
+TEST_F(EspNowTransfer, LostEndAckIsAnsweredWhileLingering) {
+    makeSource(8 * ESPNOW_XFER_PAYLOAD);
+    bool lost = false;
+    toSender.lose = [&](std::vector<uint8_t> &f) { return f[1] == XFER_END_ACK && !lost && (lost = true); };
+    run(16);
+    EXPECT_TRUE(lost);
+    EXPECT_EQ(receiver.state(), XFER_DONE);
+    EXPECT_EQ(sender.state(), XFER_DONE);
+    EXPECT_EQ(toSender.count(XFER_END_ACK), 2u);
+    EXPECT_EQ(received(), content);
+}
+
+TEST_F(EspNowTransfer, LostEndAckWithoutLingerFailsTheSender) {
+    makeSource(8 * ESPNOW_XFER_PAYLOAD);
+    bool lost = false;
+    toSender.lose = [&](std::vector<uint8_t> &f) { return f[1] == XFER_END_ACK && !lost && (lost = true); };
+    run(16, 0);
+    EXPECT_EQ(receiver.state(), XFER_DONE);
+    EXPECT_EQ(sender.state(), XFER_FAILED); // the file made it, the sender can't know
+}
@@ -0,0 +1,81 @@
+// FileEdit: the /edit body goes to a temp file of its own and replaces the file only once complete
+#include <FS.h>
+#include <LittleFS.h>
+#include <core/file_edit.h>
+#include <gtest/gtest.h>
+#include <native_root.h>
+
+class FileEditTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_FALSE(useTempNativeRoot().empty());
+        write("/conf.txt", "old content");
+    }
+
+    void write(const char *path, const String &text) {
+        File f = LittleFS.open(path, FILE_WRITE, true);
+        f.print(text);
+        f.close();
+    }
+
+    String read(const char *path) {
+        File f = LittleFS.open(path);
+        String text;
+        while (f && f.available()) text += (char)f.read();
+        return text;
+    }
+
+    bool feed(FileEdit &edit, const String &text, size_t chunk) {
+        for (size_t i = 0; i < text.length(); i += chunk) {
+            size_t n = std::min(chunk, (size_t)text.length() - i);
+            if (!edit.write((const uint8_t *)text.c_str() + i, n)) return false;
+        }
+        return true;
+    }
+};
+
+TEST_F(FileEditTest, FormLikeContentIsWrittenAsIs) {
+    // what the web server used to take apart as x=1 & y=2 when it came as text/plain
+    String text = "x=1&y=2\nname=other.txt\n{\"a\": [1, 2]}\n";
+    FileEdit edit;
+    ASSERT_TRUE(edit.begin(LittleFS, "/conf.txt"));
+    ASSERT_TRUE(feed(edit, text, 5));
+    EXPECT_EQ(read("/conf.txt"), "old content"); // nothing replaced before the commit
+    ASSERT_TRUE(edit.commit(text.length()));
+    EXPECT_EQ(read("/conf.txt"), text);
+    EXPECT_FALSE(LittleFS.exists(edit.tempPath()));
+}
+
+TEST_F(FileEditTest, ShortBodyLeavesTheFileAlone) {
+    FileEdit edit;
+    ASSERT_TRUE(edit.begin(LittleFS, "/conf.txt"));
+    ASSERT_TRUE(feed(edit, "x=1", 64));
+    EXPECT_FALSE(edit.commit(100)); // the client went away mid body
+    EXPECT_EQ(read("/conf.txt"), "old content");
+    EXPECT_FALSE(LittleFS.exists(edit.tempPath()));
+}
+
+TEST_F(FileEditTest, AbandonedEditOnlyRemovesItsOwnTemp) {
+    FileEdit first, second;
+    ASSERT_TRUE(first.begin(LittleFS, "/conf.txt"));
+    ASSERT_TRUE(second.begin(LittleFS, "/conf.txt"));
+    EXPECT_NE(first.tempPath(), second.tempPath());
+    ASSERT_TRUE(feed(second, "x=1\nsecond", 4));
+
+    first.abandon(); // its client disconnected while the second edit was still uploading
+    EXPECT_TRUE(LittleFS.exists(second.tempPath()));
+    ASSERT_TRUE(second.commit(10));
+    EXPECT_EQ(read("/conf.txt"), "x=1\nsecond");
+}
+
+TEST_F(FileEditTest, CommittedEditSurvivesTheDisconnect) {
+    {
+        FileEdit edit;
+        ASSERT_TRUE(edit.begin(LittleFS, "/conf.txt"));
+        ASSERT_TRUE(feed(edit, "new", 3));
+        ASSERT_TRUE(edit.commit(3));
+        write("/conf.txt.next", "unrelated");
+    } // the request is freed after the response went out
+    EXPECT_EQ(read("/conf.txt"), "new");
+    EXPECT_EQ(read("/conf.txt.next"), "unrelated");
+}
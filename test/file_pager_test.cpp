@@ -0,0 +1,61 @@
+// FilePager: sliced search and the index it extends
+#include <FS.h>
+#include <LittleFS.h>
+#include <core/file_pager.h>
+#include <gtest/gtest.h>
+#include <native_root.h>
+
+class FilePagerFind : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_FALSE(useTempNativeRoot().empty());
+        File f = LittleFS.open("/log.txt", FILE_WRITE, true);
+        for (int i = 0; i < 20000; i++) f.printf("line %d %s\r\n", i, i % 7 ? "abc" : "a longer filler line");
+        f.print("the needle\nlast");
+        f.close();
+    }
+};
+
+TEST_F(FilePagerFind, StepsResumeWhereTheyStopped) {
+    FilePager pager;
+    ASSERT_TRUE(pager.open(LittleFS, "/log.txt"));
+    uint32_t line = 0, offset = 0;
+    int32_t found;
+    int steps = 0;
+    while ((found = pager.findStep("NEEDLE", line, offset, 4096)) == FILE_PAGER_FIND_MORE) {
+        EXPECT_LE(offset, pager.indexedBytes()); // a resume point never lies past the index
+        steps++;
+    }
+    EXPECT_EQ(found, 20000);
+    EXPECT_GT(steps, 50);
+    EXPECT_EQ(pager.find("needle", 0), 20000);
+    EXPECT_EQ(pager.find("needle", 20001), -1);
+    EXPECT_EQ(*pager.line(20001), "last");
+}
+
+TEST_F(FilePagerFind, SearchBuildsTheSameIndex) {
+    FilePager searched, indexed;
+    ASSERT_TRUE(searched.open(LittleFS, "/log.txt"));
+    ASSERT_TRUE(indexed.open(LittleFS, "/log.txt"));
+    EXPECT_EQ(searched.find("not there", 0), -1);
+    EXPECT_TRUE(searched.indexed());
+    while (!indexed.indexStep()) {}
+    ASSERT_EQ(searched.lineCount(), indexed.lineCount());
+    for (uint32_t n : {0u, 1u, 31u, 32u, 12345u, 20000u, 20001u}) {
+        uint32_t a, b;
+        ASSERT_TRUE(searched.lineOffset(n, a));
+        ASSERT_TRUE(indexed.lineOffset(n, b));
+        EXPECT_EQ(a, b) << "line " << n;
+    }
+}
+
+TEST_F(FilePagerFind, IndexHalfwayThroughALine) {
+    FilePager pager;
+    ASSERT_TRUE(pager.open(LittleFS, "/log.txt"));
+    pager.indexStep(1000); // stops in the middle of a line
+    uint32_t lines = pager.lineCount();
+    uint32_t line = 0, offset = 0;
+    EXPECT_EQ(pager.findStep("line 500 ", line, offset, 1 << 20), 500);
+    EXPECT_GT(pager.lineCount(), lines);
+    EXPECT_EQ(*pager.line(500), "line 500 abc");
+}
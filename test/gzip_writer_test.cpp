@@ -0,0 +1,155 @@
+// GzipWriter: the stream must inflate with zlib, whole and up to any flush() point
+#include <core/gzip_writer.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include <zlib.h>
+
+namespace {
+
+struct Sink : public Print {
+    std::vector<uint8_t> bytes;
+    size_t write(uint8_t c) override {
+        bytes.push_back(c);
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        bytes.insert(bytes.end(), buffer, buffer + size);
+        return size;
+    }
+};
+
+// Inflates `gz` as far as it goes. `complete` tells whether the gzip trailer was reached and
+// zlib found the CRC and ISIZE right.
+std::vector<uint8_t> inflateGzip(const std::vector<uint8_t> &gz, bool &complete) {
+    z_stream zs = {};
+    EXPECT_EQ(inflateInit2(&zs, 16 + MAX_WBITS), Z_OK);
+    std::vector<uint8_t> out;
+    uint8_t buf[4096];
+    zs.next_in = (Bytef *)gz.data();
+    zs.avail_in = gz.size();
+    int ret;
+    do {
+        zs.next_out = buf;
+        zs.avail_out = sizeof(buf);
+        ret = inflate(&zs, Z_SYNC_FLUSH);
+        out.insert(out.end(), buf, buf + sizeof(buf) - zs.avail_out);
+    } while (ret == Z_OK && (zs.avail_in || zs.avail_out == 0));
+    complete = ret == Z_STREAM_END && zs.avail_in == 0;
+    EXPECT_TRUE(ret == Z_OK || ret == Z_STREAM_END || ret == Z_BUF_ERROR) << zs.msg;
+    inflateEnd(&zs);
+    return out;
+}
+
+uint32_t le32(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+
+void expectTrailer(const std::vector<uint8_t> &gz, const std::vector<uint8_t> &data) {
+    ASSERT_GE(gz.size(), 18u);
+    EXPECT_EQ(le32(&gz[gz.size() - 8]), crc32(0, data.data(), data.size()));
+    EXPECT_EQ(le32(&gz[gz.size() - 4]), (uint32_t)data.size());
+}
+
+std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+    std::vector<uint8_t> data(size);
+    for (auto &b : data) {
+        seed = seed * 1664525u + 1013904223u;
+        b = seed >> 24;
+    }
+    return data;
+}
+
+// CSV like a wardriving log: long repeats, short ones and a few literals in between
+std::vector<uint8_t> repetitiveBytes(size_t size) {
+    std::vector<uint8_t> data;
+    for (uint32_t i = 0; data.size() < size; i++) {
+        char line[96];
+        const char *format = "AA:BB:CC:%02X:%02X:%02X,Net_%u,[WPA2_PSK],2024-01-01 10:%02u,6,-%u\n";
+        int n = snprintf(
+            line, sizeof(line), format, i & 0xFF, (i >> 3) & 0xFF, (i * 7) & 0xFF, i % 17, i % 60, 40 + i % 50
+        );
+        data.insert(data.end(), line, line + n);
+        if (i % 97 == 0) data.insert(data.end(), 600, 'z'); // longer than one match
+    }
+    data.resize(size);
+    return data;
+}
+
+std::vector<uint8_t> compress(const std::vector<uint8_t> &data, size_t chunk) {
+    Sink sink;
+    GzipWriter gz;
+    EXPECT_TRUE(gz.begin(sink));
+    for (size_t i = 0; i < data.size(); i += chunk) {
+        gz.write(data.data() + i, std::min(chunk, data.size() - i));
+    }
+    EXPECT_TRUE(gz.finish());
+    EXPECT_TRUE(gz.ok());
+    return sink.bytes;
+}
+
+} // namespace
+
+TEST(GzipWriter, EmptyStream) {
+    std::vector<uint8_t> gz = compress({}, 1);
+    bool complete;
+    EXPECT_TRUE(inflateGzip(gz, complete).empty());
+    EXPECT_TRUE(complete);
+    expectTrailer(gz, {});
+}
+
+TEST(GzipWriter, RandomData) {
+    std::vector<uint8_t> data = randomBytes(15 * GZIP_WRITER_WINDOW + 123, 1);
+    for (size_t chunk : {1, 7, 512, 100000}) {
+        std::vector<uint8_t> gz = compress(data, chunk);
+        bool complete;
+        EXPECT_EQ(inflateGzip(gz, complete), data) << "chunk " << chunk;
+        EXPECT_TRUE(complete);
+        expectTrailer(gz, data);
+    }
+}
+
+TEST(GzipWriter, RepetitiveDataShrinks) {
+    std::vector<uint8_t> data = repetitiveBytes(200000);
+    for (size_t chunk : {3, 1000, 200000}) {
+        std::vector<uint8_t> gz = compress(data, chunk);
+        bool complete;
+        EXPECT_EQ(inflateGzip(gz, complete), data) << "chunk " << chunk;
+        EXPECT_TRUE(complete);
+        expectTrailer(gz, data);
+        EXPECT_LT(gz.size(), data.size() / 3);
+    }
+}
+
+TEST(GzipWriter, FlushedPrefixInflates) {
+    std::vector<uint8_t> data = repetitiveBytes(60000);
+    std::vector<uint8_t> noise = randomBytes(5000, 7);
+    data.insert(data.begin() + 30000, noise.begin(), noise.end());
+
+    Sink sink;
+    GzipWriter gz;
+    ASSERT_TRUE(gz.begin(sink));
+    size_t done = 0;
+    // uneven sizes put the flush points mid line, mid run and right after a window slide
+    for (size_t chunk : {1, 2, 259, 4096, 4097, 8191, 13, 0, 20000, 100000}) {
+        chunk = std::min(chunk, data.size() - done);
+        gz.write(data.data() + done, chunk);
+        done += chunk;
+        ASSERT_TRUE(gz.flush());
+        ASSERT_TRUE(gz.flush()); // an empty sync block in between changes nothing
+
+        bool complete;
+        std::vector<uint8_t> prefix = inflateGzip(sink.bytes, complete);
+        EXPECT_FALSE(complete);
+        ASSERT_EQ(prefix.size(), done);
+        EXPECT_TRUE(std::equal(prefix.begin(), prefix.end(), data.begin()));
+        // a sync flush ends on the empty stored block marker
+        ASSERT_GE(sink.bytes.size(), 4u);
+        EXPECT_EQ(le32(&sink.bytes[sink.bytes.size() - 4]), 0xFFFF0000u);
+    }
+    ASSERT_EQ(done, data.size());
+    ASSERT_TRUE(gz.finish());
+
+    bool complete;
+    EXPECT_EQ(inflateGzip(sink.bytes, complete), data);
+    EXPECT_TRUE(complete);
+    expectTrailer(sink.bytes, data);
+    EXPECT_FALSE(gz.ready()); // finish() released the window
+}
@@ -0,0 +1,61 @@
+// Host shim: filesystems backed by a directory and the framebuffer display
+#include <FS.h>
+#include <LittleFS.h>
+#include <SD.h>
+#include <display/tft.h>
+#include <gtest/gtest.h>
+#include <native_root.h>
+#include <set>
+#include <string>
+
+class NativeShim : public ::testing::Test {
+protected:
+    void SetUp() override { ASSERT_FALSE(useTempNativeRoot().empty()); }
+};
+
+TEST_F(NativeShim, WriteReadSeek) {
+    File f = LittleFS.open("/dir/a.txt", FILE_WRITE, true);
+    ASSERT_TRUE(f);
+    f.print("hello world");
+    f.close();
+
+    f = LittleFS.open("/dir/a.txt");
+    ASSERT_TRUE(f);
+    EXPECT_EQ(f.size(), 11u);
+    ASSERT_TRUE(f.seek(6));
+    uint8_t buf[16] = {};
+    EXPECT_EQ(f.read(buf, sizeof(buf)), 5u);
+    EXPECT_STREQ((const char *)buf, "world");
+    EXPECT_FALSE(SD.exists("/dir/a.txt")); // each filesystem has its own directory
+}
+
+TEST_F(NativeShim, RenameRemoveAndList) {
+    for (const char *name : {"/list/x", "/list/y", "/list/z"}) LittleFS.open(name, FILE_WRITE, true).close();
+    LittleFS.mkdir("/list/sub");
+    ASSERT_TRUE(LittleFS.rename("/list/x", "/list/w"));
+    ASSERT_TRUE(LittleFS.remove("/list/z"));
+
+    std::set<std::string> names;
+    File dir = LittleFS.open("/list");
+    ASSERT_TRUE(dir.isDirectory());
+    for (File e = dir.openNextFile(); e; e = dir.openNextFile()) {
+        names.insert(std::string(e.name()) + (e.isDirectory() ? "/" : ""));
+    }
+    EXPECT_EQ(names, (std::set<std::string>{"w", "y", "sub/"}));
+}
+
+TEST_F(NativeShim, MissingFileDoesNotOpen) {
+    EXPECT_FALSE(LittleFS.open("/nope"));
+    EXPECT_FALSE(LittleFS.exists("/nope"));
+}
+
+TEST(NullDisplay, DrawsIntoFramebuffer) {
+    tft_display display(32, 16);
+    display.fillScreen(0x0000);
+    display.fillRect(4, 2, 3, 3, 0xF800);
+    display.drawPixel(31, 15, 0x07E0);
+    EXPECT_EQ(display.readPixel(5, 3), 0xF800);
+    EXPECT_EQ(display.readPixel(7, 3), 0x0000);
+    EXPECT_EQ(display.readPixel(31, 15), 0x07E0);
+    EXPECT_EQ(display.framebuffer()[3 * 32 + 4], 0xF800);
+}
@@ -0,0 +1,85 @@
+// PortScanner on loopback: 20 listening ports among 220, and a host that never answers
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <modules/ethernet/PortScanner.h>
+#include <netinet/in.h>
+#include <set>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+// Listening socket on an ephemeral loopback port
+int listenOn(uint16_t &port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0) return -1;
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (sockaddr *)&addr, &len);
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+} // namespace
+
+TEST(PortScanner, Loopback220Ports) {
+    std::set<uint16_t> listening;
+    std::vector<int> fds;
+    std::vector<uint16_t> ports;
+    for (int i = 0; i < 20; i++) {
+        uint16_t port;
+        int fd = listenOn(port);
+        ASSERT_GE(fd, 0);
+        fds.push_back(fd);
+        listening.insert(port);
+        ports.push_back(port);
+    }
+    // ports just released by the kernel are closed
+    while (ports.size() < 220) {
+        uint16_t port;
+        int fd = listenOn(port);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        if (!listening.count(port)) ports.push_back(port);
+    }
+
+    PortScanner scanner;
+    PortScanConfig config;
+    config.window = 16;
+    scanner.begin(htonl(INADDR_LOOPBACK), ports.data(), ports.size(), config);
+    std::set<uint16_t> open;
+    size_t reported = 0, closed = 0, filtered = 0;
+    while (scanner.poll(50, [&](uint16_t port, PortState state, uint32_t) {
+        reported++;
+        if (state == PortState::Open) open.insert(port);
+        else if (state == PortState::Closed) closed++;
+        else filtered++;
+    })) {}
+
+    EXPECT_EQ(reported, ports.size());
+    EXPECT_EQ(open, listening);
+    EXPECT_EQ(closed, 200u);
+    EXPECT_EQ(filtered, 0u);
+    EXPECT_EQ(scanner.done(), ports.size());
+    EXPECT_EQ(scanner.open(), listening.size());
+    // loopback RTTs pull the timeout down to its floor
+    EXPECT_EQ(scanner.timeoutMs(), config.minTimeoutMs);
+    for (int fd : fds) close(fd);
+}
+
+TEST(PortScanner, SilentHostIsNeverOpen) {
+    // TEST-NET-1: dropped or unreachable depending on the network, never open and never stuck
+    uint16_t ports[] = {1, 2, 3, 4, 5};
+    PortScanner scanner;
+    PortScanConfig config;
+    config.initialTimeoutMs = 300;
+    scanner.begin(inet_addr("192.0.2.1"), ports, 5, config);
+    size_t reported = 0;
+    while (scanner.poll(50, [&](uint16_t, PortState state, uint32_t) {
+        reported++;
+        EXPECT_NE(state, PortState::Open);
+    })) {}
+    EXPECT_EQ(reported, 5u);
+    EXPECT_EQ(scanner.open(), 0u);
+}